@@ -5,6 +5,7 @@
 #include <QList>
 #include <QString>
 #include <QColor>
+#include <QVector>
 #include <functional>
 
 // VTK前向声明
@@ -39,6 +40,56 @@ class NiftiVisualizationAPI : public QObject
     Q_OBJECT
 
 public:
+    /**
+     * @brief 区块网格生成模式
+     */
+    enum RegionMeshingMode {
+        INTENSITY_ISOSURFACE,    // 在每个区块的MRI灰度上单独提取等值面（默认）
+        SHARED_LABEL_INTERFACES, // 单次遍历标签图像生成所有区块表面，相邻区块共享交界面
+        LABEL_SURFACE_NETS       // 在每个区块的标签掩码上用表面网格提取，顶点更少、无需重度平滑
+    };
+
+    /**
+     * @brief 等值面提取引擎
+     */
+    enum IsosurfaceBackend {
+        MARCHING_CUBES_BACKEND,      // vtkMarchingCubes（串行）
+        FLYING_EDGES_BACKEND,        // vtkFlyingEdges3D（通过vtkSMPTools并行，默认）
+        SIMD_MARCHING_CUBES_BACKEND  // 库内移动立方体内核（SIMD分类，切片并行）
+    };
+
+    /**
+     * @brief 区块表面平滑方法
+     */
+    enum SurfaceSmoothingMethod {
+        LAPLACIAN_SMOOTHING,  // 拉普拉斯平滑（默认，与之前的效果一致）
+        TAUBIN_SMOOTHING      // Taubin平滑，基本保持区块体积
+    };
+
+    /**
+     * @brief NIFTI文件头部信息（probeNiftiFile返回，不包含体素）
+     */
+    struct NiftiFileInfo
+    {
+        bool valid;                 // 头部解析成功
+        int version;                // NIfTI-1或NIfTI-2
+        bool compressed;            // .nii.gz
+        qint64 dimensions[3];       // 空间维度
+        qint64 componentCount;      // 时间及更高维度的乘积，单个三维体数据为1
+        double spacing[3];          // 体素间距（毫米）
+        int datatype;               // NIfTI数据类型编号
+        QString datatypeName;       // 如"uint8"、"int16"、"float32"
+        bool integerType;           // 整数类型（标签图像要求）
+        int qformCode;
+        int sformCode;
+        double qform[4][4];         // 体素索引到世界坐标的矩阵
+        double sform[4][4];
+        qint64 fileSize;            // 磁盘上的文件长度
+        qint64 dataSize;            // 解压后体素数据长度
+
+        NiftiFileInfo();
+    };
+
     /**
      * @brief 构造函数
      * @param parent 父对象
@@ -70,16 +121,75 @@ public:
     /**
      * @brief 加载MRI NIFTI文件
      * @param filePath NIFTI文件路径（.nii或.nii.gz）
-     * @return 加载成功返回true，失败返回false
+     * @return 头部读取成功返回true，失败返回false
+     * @note 加载时只解析头部，体素在第一次需要时（处理区块、预览、直方图等）解码；
+     *       解码失败时通过errorOccurred报告
      */
     bool loadMriNifti(const QString& filePath);
     
     /**
      * @brief 加载脑区标签NIFTI文件
      * @param filePath NIFTI文件路径（.nii或.nii.gz）
-     * @return 加载成功返回true，失败返回false
+     * @return 头部读取成功返回true，失败返回false
+     * @note 与loadMriNifti相同，体素在第一次需要时解码
      */
     bool loadLabelNifti(const QString& filePath);
+    
+    /**
+     * @brief 只读取NIFTI文件头部
+     * @param filePath NIFTI文件路径（.nii或.nii.gz，.nii.gz只解压开头的头部字节）
+     * @return 头部信息，无法解析时valid为false
+     * @note 不读取体素，适合在文件列表中快速显示尺寸、数据类型和兼容性
+     */
+    static NiftiFileInfo probeNiftiFile(const QString& filePath);
+    
+    /**
+     * @brief 在后台加载MRI NIFTI文件，立即返回
+     * @param filePath NIFTI文件路径（.nii或.nii.gz）
+     * @return 头部读取成功并已开始加载返回true
+     * @note 体素在工作线程中解码并生成多分辨率金字塔，完成后替换当前MRI数据；
+     *       进度通过loadProgress报告，所有后台加载完成后发出volumesLoaded。
+     *       可与loadLabelNiftiAsync同时进行，再次加载MRI会取消尚未完成的MRI加载
+     */
+    bool loadMriNiftiAsync(const QString& filePath);
+    
+    /**
+     * @brief 在后台加载脑区标签NIFTI文件，立即返回
+     * @param filePath NIFTI文件路径（.nii或.nii.gz）
+     * @return 头部读取成功并已开始加载返回true
+     * @note 体素在工作线程中解码并统计各标签体素数，其余与loadMriNiftiAsync相同
+     */
+    bool loadLabelNiftiAsync(const QString& filePath);
+    
+    /**
+     * @brief 在后台同时加载MRI和标签NIFTI文件，立即返回
+     * @param mriFilePath MRI文件路径，为空时不加载
+     * @param labelFilePath 标签文件路径，为空时不加载
+     * @return 至少一个文件已开始加载返回true
+     * @note 两个文件在各自的工作线程中并行解码，都完成后发出一次volumesLoaded
+     */
+    bool loadNiftiFilesAsync(const QString& mriFilePath, const QString& labelFilePath);
+    
+    /**
+     * @brief 取消所有尚未完成的后台加载
+     * @note 当前数据保持不变；正在解码的文件完成后结果被丢弃
+     */
+    void cancelLoading();
+    
+    /**
+     * @brief 检查是否正在后台加载文件
+     * @return 正在加载返回true
+     */
+    bool isLoading() const;
+    
+    /**
+     * @brief 判断两个文件的体素网格是否一致
+     * @param first 第一个文件的头部信息
+     * @param second 第二个文件的头部信息
+     * @return 维度相同且间距在1e-4毫米内一致时返回true
+     * @note MRI与标签网格一致时区块划分和灰度直方图不需要重采样
+     */
+    static bool haveMatchingGrids(const NiftiFileInfo& first, const NiftiFileInfo& second);
 
     // ========== 数据处理 ==========
     
@@ -97,6 +207,33 @@ public:
      */
     void processRegions(double minGrayValue, double maxGrayValue);
     
+    /**
+     * @brief 在后台处理脑区块，立即返回
+     * @note 使用当前的灰度值限制；每个区块完成后立即显示并发出regionProcessed信号，
+     *       全部完成后发出regionsProcessed信号
+     */
+    void processRegionsAsync();
+    
+    /**
+     * @brief 在后台处理脑区块（带灰度值限制），立即返回
+     * @param minGrayValue 最小灰度值限制
+     * @param maxGrayValue 最大灰度值限制
+     * @note 再次调用处理、清理区块或加载新文件都会先取消正在进行的处理
+     */
+    void processRegionsAsync(double minGrayValue, double maxGrayValue);
+    
+    /**
+     * @brief 取消正在进行的后台处理
+     * @note 已显示的区块保留，未开始的区块不再生成；会等待正在生成的区块结束
+     */
+    void cancelProcessing();
+    
+    /**
+     * @brief 检查是否正在后台处理区块
+     * @return 正在处理返回true
+     */
+    bool isProcessing() const;
+    
     /**
      * @brief 清理所有区块数据
      */
@@ -141,9 +278,97 @@ public:
      * @brief 设置所有区块的灰度值限制
      * @param minGrayValue 最小灰度值限制
      * @param maxGrayValue 最大灰度值限制
-     * @note 用于适应不同MRI代表脑实质的灰度值不同的情况
+     * @note 用于适应不同MRI代表脑实质的灰度值不同的情况；已处理的区块会立即增量更新：
+     *       只对阈值变化跨过其灰度范围的区块重新提取表面，不需要重新调用processRegions
      */
     void setGrayValueLimits(double minGrayValue, double maxGrayValue);
+    
+    /**
+     * @brief 设置区块网格生成模式
+     * @param mode 网格生成模式
+     * @note SHARED_LABEL_INTERFACES只需要标签数据，交界面三角形只生成一次，
+     *       适合密集的皮层分区；LABEL_SURFACE_NETS同样只需要标签数据，
+     *       生成以四边形为主的平滑表面；下次调用processRegions时生效
+     */
+    void setRegionMeshingMode(RegionMeshingMode mode);
+    
+    /**
+     * @brief 获取区块网格生成模式
+     * @return 当前网格生成模式
+     */
+    RegionMeshingMode getRegionMeshingMode() const;
+    
+    /**
+     * @brief 设置等值面提取引擎
+     * @param backend 提取引擎
+     * @note 同时作用于区块网格、testSimpleVolumeRendering和MRI预览
+     */
+    void setIsosurfaceBackend(IsosurfaceBackend backend);
+    
+    /**
+     * @brief 获取等值面提取引擎
+     * @return 当前提取引擎
+     */
+    IsosurfaceBackend getIsosurfaceBackend() const;
+    
+    /**
+     * @brief 设置区块表面平滑方法
+     * @param method 平滑方法
+     * @note 下次调用processRegions时生效
+     */
+    void setSurfaceSmoothingMethod(SurfaceSmoothingMethod method);
+    
+    /**
+     * @brief 获取区块表面平滑方法
+     * @return 当前平滑方法
+     */
+    SurfaceSmoothingMethod getSurfaceSmoothingMethod() const;
+    
+    /**
+     * @brief 启用或禁用区块细节层次
+     * @param enabled 是否启用（默认启用）
+     * @note 启用时processRegions完成后在后台为每个区块生成简化网格；旋转/缩放期间
+     *       按交互器的期望更新率（帧率）和区块在屏幕上的大小选择层次，交互结束后恢复完整网格
+     */
+    void setLevelOfDetailEnabled(bool enabled);
+    
+    /**
+     * @brief 获取是否启用区块细节层次
+     * @return 启用返回true
+     */
+    bool isLevelOfDetailEnabled() const;
+    
+    /**
+     * @brief 启用或禁用区块网格磁盘缓存
+     * @param enabled 是否启用（默认启用）
+     * @note 缓存键由MRI/标签文件内容、网格模式、等值面后端、平滑方法和灰度值限制计算，
+     *       再次处理相同数据和参数时直接读取缓存的网格，跳过网格生成
+     */
+    void setMeshCacheEnabled(bool enabled);
+    
+    /**
+     * @brief 获取是否启用区块网格磁盘缓存
+     * @return 启用返回true
+     */
+    bool isMeshCacheEnabled() const;
+    
+    /**
+     * @brief 设置网格缓存目录
+     * @param directory 缓存目录（默认为系统缓存目录下的meshcache）
+     */
+    void setMeshCacheDirectory(const QString& directory);
+    
+    /**
+     * @brief 获取网格缓存目录
+     * @return 缓存目录
+     */
+    QString getMeshCacheDirectory() const;
+    
+    /**
+     * @brief 删除缓存目录中的所有网格缓存文件
+     * @return 成功返回true
+     */
+    bool clearMeshCache();
 
     // ========== 信息获取 ==========
     
@@ -173,6 +398,40 @@ public:
      * @return 不透明度（0.0-1.0）
      */
     double getRegionOpacity(int label) const;
+    
+    /**
+     * @brief 获取MRI灰度直方图
+     * @param label 区块标签编号，0表示整幅MRI（含背景）
+     * @param counts 输出各分箱的体素数
+     * @param minValue 输出直方图下界（第一个分箱的下边界）
+     * @param maxValue 输出直方图上界（数据最大值）
+     * @return 直方图可用返回true
+     * @note MRI和标签都解码后在后台单独扫描一次统计（整数类型且范围较小时每个灰度值一个分箱，
+     *       否则1024个等宽分箱），需要尺寸一致的MRI和标签数据；统计完成前返回false
+     */
+    bool getIntensityHistogram(int label, QVector<qint64>& counts, double& minValue, double& maxValue) const;
+    
+    /**
+     * @brief 按直方图计算灰度百分位
+     * @param label 区块标签编号，0表示整幅MRI
+     * @param percent 百分位（0-100）
+     * @return 对应的灰度值，直方图不可用时返回0
+     */
+    double getIntensityPercentile(int label, double percent) const;
+    
+    /**
+     * @brief 按直方图计算Otsu阈值（类间方差最大）
+     * @param label 区块标签编号，0表示整幅MRI
+     * @return 阈值，直方图不可用时返回0
+     */
+    double getOtsuThreshold(int label) const;
+    
+    /**
+     * @brief 按直方图估计灰度值落在[minValue, maxValue]内的体素比例
+     * @param label 区块标签编号，0表示整幅MRI
+     * @return 比例（0.0-1.0），直方图不可用时返回0
+     */
+    double getIntensityFraction(int label, double minValue, double maxValue) const;
 
     // ========== 状态查询 ==========
     
@@ -188,6 +447,12 @@ public:
      */
     bool hasLabelData() const;
     
+    /**
+     * @brief 检查灰度直方图是否已统计完成
+     * @return 可用返回true，此时直方图相关查询不访问体素数据
+     */
+    bool hasIntensityHistogram() const;
+    
     /**
      * @brief 获取区块数量
      * @return 区块数量
@@ -219,6 +484,24 @@ public:
      * @param callback 可见性变化回调函数
      */
     void setRegionVisibilityCallback(std::function<void(int, bool)> callback);
+    
+    /**
+     * @brief 设置单个区块处理完成回调函数（后台处理时）
+     * @param callback 回调函数，参数为区块标签编号、已完成数量和总数量
+     */
+    void setRegionProcessedCallback(std::function<void(int, int, int)> callback);
+    
+    /**
+     * @brief 设置后台加载进度回调函数
+     * @param callback 回调函数，参数为进度百分比（0-100）
+     */
+    void setLoadProgressCallback(std::function<void(int)> callback);
+    
+    /**
+     * @brief 设置后台加载完成回调函数
+     * @param callback 所有后台加载完成后调用
+     */
+    void setVolumesLoadedCallback(std::function<void()> callback);
 
     // ========== 高级功能 ==========
     
@@ -256,6 +539,45 @@ public:
      * @param visible 是否可见
      */
     void setMriPreviewVisible(bool visible);
+    
+    /**
+     * @brief 设置MRI预览的三角形预算
+     * @param triangleBudget 预览表面的目标三角形数上限（默认200000，0表示不限制）
+     * @note 预览前在抽样子网格上估计各等值的表面规模，一次选定满足预算的阈值，只提取一次等值面
+     */
+    void setMriPreviewTriangleBudget(int triangleBudget);
+    
+    /**
+     * @brief 获取MRI预览的三角形预算
+     * @return 三角形预算
+     */
+    int getMriPreviewTriangleBudget() const;
+    
+    /**
+     * @brief 启用或禁用交互期间的渐进细化
+     * @param enabled 是否启用（默认启用）
+     * @note 启用时setGrayValueLimits在满足延迟目标的最粗分辨率上（MRI 2×/4×/8×降采样金字塔）
+     *       立即更新区块表面和MRI预览，停止调整一段时间后再在原始分辨率上细化
+     */
+    void setProgressiveRefinementEnabled(bool enabled);
+    
+    /**
+     * @brief 获取是否启用交互期间的渐进细化
+     * @return 启用返回true
+     */
+    bool isProgressiveRefinementEnabled() const;
+    
+    /**
+     * @brief 设置交互期间单次更新的延迟目标
+     * @param milliseconds 目标耗时（毫秒，默认100）
+     */
+    void setInteractiveLatencyTarget(double milliseconds);
+    
+    /**
+     * @brief 获取交互期间单次更新的延迟目标
+     * @return 目标耗时（毫秒）
+     */
+    double getInteractiveLatencyTarget() const;
 
 signals:
     /**
@@ -275,6 +597,36 @@ signals:
      * @param visible 是否可见
      */
     void regionVisibilityChanged(int label, bool visible);
+    
+    /**
+     * @brief 单个区块处理完成信号（后台处理时）
+     * @param label 区块标签编号
+     * @param completedCount 已完成的区块数量
+     * @param totalCount 区块总数量
+     */
+    void regionProcessed(int label, int completedCount, int totalCount);
+    
+    /**
+     * @brief 后台处理被取消信号
+     */
+    void processingCancelled();
+    
+    /**
+     * @brief 后台加载进度信号
+     * @param percent 已解码的体素数据占本批加载总量的百分比（0-100）
+     */
+    void loadProgress(int percent);
+    
+    /**
+     * @brief 后台加载完成信号
+     * @note 所有进行中的后台加载都结束后发出；失败的文件另外通过errorOccurred报告
+     */
+    void volumesLoaded();
+    
+    /**
+     * @brief 后台加载被取消信号
+     */
+    void loadingCancelled();
 
 private:
     class NiftiVisualizationAPIPrivate;
@@ -282,8 +634,12 @@ private:
     Q_DECLARE_PRIVATE(NiftiVisualizationAPI)
     
     // 私有辅助方法
-    void renderSingleVolume(vtkImageData* imageData, const QColor& color, const QString& name);
+    // labelData为true时imageData是标签图像（体素值可能是紧凑编号），提取前景（值>0）的表面
+    void renderSingleVolume(vtkImageData* imageData, const QColor& color, const QString& name,
+                            bool labelData = false);
     bool createMriPreviewActor(vtkImageData* imageData, vtkSmartPointer<vtkActor> actor);
+    bool updateMriPreview(int level, bool resetCamera);
+    void refineToFullResolution();
 };
 
 #endif // NIFTIVISUALIZATIONAPI_H 
\ No newline at end of file
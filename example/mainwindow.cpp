@@ -7,6 +7,7 @@
 #include <QToolBar>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QTimer>
@@ -78,6 +79,14 @@ void MainWindow::setupAPICallbacks()
     niftiAPI->setRegionVisibilityCallback([this](int label, bool visible) {
         onRegionVisibilityChanged(label, visible);
     });
+    
+    niftiAPI->setLoadProgressCallback([this](int percent) {
+        onLoadProgress(percent);
+    });
+    
+    niftiAPI->setVolumesLoadedCallback([this]() {
+        onVolumesLoaded();
+    });
 }
 
 void MainWindow::createActions()
@@ -111,6 +120,10 @@ void MainWindow::createActions()
     importLabelAct->setStatusTip("通过API导入脑区标签NIFTI文件");
     connect(importLabelAct, &QAction::triggered, this, &MainWindow::importLabelNiftiFile);
 
+    importPairAct = new QAction("同时导入MRI和标签(&B)", this);
+    importPairAct->setStatusTip("通过API在后台同时加载MRI和标签NIFTI文件");
+    connect(importPairAct, &QAction::triggered, this, &MainWindow::importNiftiFilePair);
+
     processRegionsAct = new QAction("处理区块(&P)", this);
     processRegionsAct->setStatusTip("通过API处理脑区块并生成可视化");
     connect(processRegionsAct, &QAction::triggered, this, &MainWindow::processNiftiRegions);
@@ -130,6 +143,7 @@ void MainWindow::createMenus()
     fileMenu = menuBar()->addMenu("文件(&F)");
     fileMenu->addAction(importMriAct);
     fileMenu->addAction(importLabelAct);
+    fileMenu->addAction(importPairAct);
     fileMenu->addSeparator();
     fileMenu->addAction(processRegionsAct);
     fileMenu->addAction(testVolumeAct);
@@ -304,9 +318,9 @@ void MainWindow::importMriNiftiFile()
         "导入MRI NIFTI文件", "", "NIFTI文件 (*.nii *.nii.gz)");
     
     if (!fileName.isEmpty()) {
-        statusBar()->showMessage("正在通过API加载MRI文件...");
-        if (niftiAPI->loadMriNifti(fileName)) {
-            statusBar()->showMessage("MRI文件加载成功", 3000);
+        // 后台解码，界面保持响应；完成后由onVolumesLoaded更新状态
+        if (niftiAPI->loadMriNiftiAsync(fileName)) {
+            statusBar()->showMessage("正在通过API后台加载MRI文件...");
             updateActionStates();
         } else {
             statusBar()->showMessage("MRI文件加载失败", 3000);
@@ -320,9 +334,8 @@ void MainWindow::importLabelNiftiFile()
         "导入标签NIFTI文件", "", "NIFTI文件 (*.nii *.nii.gz)");
     
     if (!fileName.isEmpty()) {
-        statusBar()->showMessage("正在通过API加载标签文件...");
-        if (niftiAPI->loadLabelNifti(fileName)) {
-            statusBar()->showMessage("标签文件加载成功", 3000);
+        if (niftiAPI->loadLabelNiftiAsync(fileName)) {
+            statusBar()->showMessage("正在通过API后台加载标签文件...");
             updateActionStates();
         } else {
             statusBar()->showMessage("标签文件加载失败", 3000);
@@ -330,6 +343,25 @@ void MainWindow::importLabelNiftiFile()
     }
 }
 
+void MainWindow::importNiftiFilePair()
+{
+    QString mriFileName = QFileDialog::getOpenFileName(this,
+        "导入MRI NIFTI文件", "", "NIFTI文件 (*.nii *.nii.gz)");
+    if (mriFileName.isEmpty()) return;
+    
+    QString labelFileName = QFileDialog::getOpenFileName(this,
+        "导入标签NIFTI文件", QFileInfo(mriFileName).absolutePath(), "NIFTI文件 (*.nii *.nii.gz)");
+    if (labelFileName.isEmpty()) return;
+    
+    // 两个文件在后台并行解码
+    if (niftiAPI->loadNiftiFilesAsync(mriFileName, labelFileName)) {
+        statusBar()->showMessage("正在通过API后台加载MRI和标签文件...");
+        updateActionStates();
+    } else {
+        statusBar()->showMessage("MRI和标签文件加载失败", 3000);
+    }
+}
+
 void MainWindow::processNiftiRegions()
 {
     if (!niftiAPI->hasMriData() || !niftiAPI->hasLabelData()) {
@@ -418,7 +450,13 @@ void MainWindow::onGrayValueChanged()
     // 更新API中的灰度值限制
     niftiAPI->setGrayValueLimits(minValue, maxValue);
     
-    statusBar()->showMessage(QString("灰度值限制: [%1, %2]").arg(minValue).arg(maxValue), 2000);
+    // 直方图可用时显示区间内的体素比例，不需要访问体素数据；后台统计完成前不显示
+    QString message = QString("灰度值限制: [%1, %2]").arg(minValue).arg(maxValue);
+    if (niftiAPI->hasIntensityHistogram()) {
+        double fraction = niftiAPI->getIntensityFraction(0, minValue, maxValue);
+        message += QString("，覆盖%1%体素").arg(fraction * 100.0, 0, 'f', 1);
+    }
+    statusBar()->showMessage(message, 2000);
 }
 
 void MainWindow::onPreviewButtonClicked()
@@ -462,6 +500,17 @@ void MainWindow::onRegionsProcessed()
     niftiAPI->render();
 }
 
+void MainWindow::onLoadProgress(int percent)
+{
+    statusBar()->showMessage(QString("正在后台加载NIFTI文件... %1%").arg(percent));
+}
+
+void MainWindow::onVolumesLoaded()
+{
+    statusBar()->showMessage("NIFTI文件加载完成", 3000);
+    updateActionStates();
+}
+
 void MainWindow::onRegionVisibilityChanged(int label, bool visible)
 {
     updateRegionList();
@@ -502,7 +551,8 @@ void MainWindow::updateActionStates()
     bool hasLabel = niftiAPI->hasLabelData();
     bool hasRegions = niftiAPI->hasProcessedRegions();
     
-    processRegionsAct->setEnabled(hasMri && hasLabel);
+    // 后台加载期间数据随时可能被替换，暂不允许处理区块
+    processRegionsAct->setEnabled(hasMri && hasLabel && !niftiAPI->isLoading());
     
     showAllButton->setEnabled(hasRegions);
     hideAllButton->setEnabled(hasRegions);
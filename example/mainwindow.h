@@ -66,6 +66,7 @@ private slots:
     // NIFTI文件导入槽函数（通过API）
     void importMriNiftiFile();
     void importLabelNiftiFile();
+    void importNiftiFilePair();
     void processNiftiRegions();
     
     // 区块管理槽函数（通过API）
@@ -84,6 +85,8 @@ private slots:
     void onNiftiError(const QString& message);
     void onRegionsProcessed();
     void onRegionVisibilityChanged(int label, bool visible);
+    void onLoadProgress(int percent);
+    void onVolumesLoaded();
 
 private:
     // UI组件
@@ -97,6 +100,7 @@ private:
     // NIFTI相关动作
     QAction *importMriAct;
     QAction *importLabelAct;
+    QAction *importPairAct;
     QAction *processRegionsAct;
     QAction *testVolumeAct;
     
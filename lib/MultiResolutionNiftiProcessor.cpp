@@ -0,0 +1,610 @@
+#include "MultiResolutionNiftiProcessor.h"
+#include "niftivolumeloader.h"
+#include "resamplekernel.h"
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSet>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// VTK头文件
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+
+namespace {
+
+// 判断空间信息一致时使用的相对容差
+const double kSpatialTolerance = 1e-3;
+
+ResampleKernel::Method toKernelMethod(MultiResolutionNiftiProcessor::InterpolationMethod method)
+{
+    switch (method) {
+    case MultiResolutionNiftiProcessor::NEAREST_NEIGHBOR: return ResampleKernel::NEAREST;
+    case MultiResolutionNiftiProcessor::CUBIC: return ResampleKernel::CUBIC;
+    default: return ResampleKernel::LINEAR;
+    }
+}
+
+const char* methodName(MultiResolutionNiftiProcessor::InterpolationMethod method)
+{
+    switch (method) {
+    case MultiResolutionNiftiProcessor::NEAREST_NEIGHBOR: return "最近邻";
+    case MultiResolutionNiftiProcessor::CUBIC: return "三次";
+    default: return "线性";
+    }
+}
+
+// 前景掩码（值大于0，只取第一个分量）
+template <typename T>
+void buildForegroundMask(const T* data, vtkIdType numPoints, int stride, std::vector<unsigned char>& mask)
+{
+    mask.resize(static_cast<size_t>(numPoints));
+    for (vtkIdType i = 0; i < numPoints; ++i) {
+        mask[i] = data[i * stride] > 0 ? 1 : 0;
+    }
+}
+
+// 与另一幅图像的前景掩码比较，统计两者都是前景和至少一个是前景的体素数
+template <typename T>
+void countForegroundOverlap(const T* data, vtkIdType numPoints, int stride, const std::vector<unsigned char>& mask,
+                            vtkIdType& overlapCount, vtkIdType& unionCount)
+{
+    for (vtkIdType i = 0; i < numPoints; ++i) {
+        const unsigned char foreground = data[i * stride] > 0 ? 1 : 0;
+        overlapCount += foreground & mask[i];
+        unionCount += foreground | mask[i];
+    }
+}
+
+// 按原生标量类型收集正标签，连续相同的体素只插入一次
+template <typename T>
+void collectLabels(const T* data, vtkIdType numPoints, int stride, QSet<int>& labels)
+{
+    bool hasRun = false;
+    int runLabel = 0;
+    for (vtkIdType i = 0; i < numPoints; ++i) {
+        const int label = static_cast<int>(data[i * stride]);
+        if (hasRun && label == runLabel) continue;
+        hasRun = true;
+        runLabel = label;
+        if (label > 0) labels.insert(label);
+    }
+}
+
+} // namespace
+
+MultiResolutionNiftiProcessor::MultiResolutionNiftiProcessor(QObject *parent)
+    : QObject(parent)
+    , mriSpatialInfo()
+    , labelSpatialInfo()
+{
+}
+
+MultiResolutionNiftiProcessor::~MultiResolutionNiftiProcessor()
+{
+}
+
+// ========== 数据加载 ==========
+
+bool MultiResolutionNiftiProcessor::loadHighResMRI(const QString& filePath)
+{
+    qDebug() << "开始加载高分辨率MRI:" << filePath;
+    if (!loadNiftiFile(filePath, originalMRI)) return false;
+
+    extractSpatialInfo(originalMRI, mriSpatialInfo);
+    processedMRI = nullptr;
+    processedLabels = nullptr;
+    mriSpatialInfo.print("MRI");
+    return true;
+}
+
+bool MultiResolutionNiftiProcessor::loadLowResLabels(const QString& filePath)
+{
+    qDebug() << "开始加载低分辨率标签:" << filePath;
+    if (!loadNiftiFile(filePath, originalLabels)) return false;
+
+    extractSpatialInfo(originalLabels, labelSpatialInfo);
+    processedMRI = nullptr;
+    processedLabels = nullptr;
+    labelSpatialInfo.print("标签");
+    return true;
+}
+
+// ========== 空间配准与重采样 ==========
+
+vtkSmartPointer<vtkImageData> MultiResolutionNiftiProcessor::alignLabelsToMRI(
+    InterpolationMethod interpolationMethod)
+{
+    if (!originalMRI || !originalLabels) {
+        emit errorOccurred("对齐标签前需要先加载MRI和标签数据");
+        return nullptr;
+    }
+    if (interpolationMethod != NEAREST_NEIGHBOR) {
+        qDebug() << "警告: 标签数据使用" << methodName(interpolationMethod) << "插值会产生不存在的标签值";
+    }
+
+    emit processingStarted();
+    // 自定义变换把MRI空间映射到标签空间，正好是输出（MRI网格）到输入（标签）的方向
+    processedLabels = resampleToGrid(originalLabels, mriSpatialInfo, interpolationMethod, customTransform);
+    if (!processedLabels) {
+        emit errorOccurred("标签重采样失败");
+        return nullptr;
+    }
+    emit processingProgress(80);
+
+    validateResampledLabels(originalLabels, processedLabels);
+    emit processingProgress(100);
+    emit processingCompleted();
+    return processedLabels;
+}
+
+vtkSmartPointer<vtkImageData> MultiResolutionNiftiProcessor::alignMRIToLabels(
+    InterpolationMethod interpolationMethod)
+{
+    if (!originalMRI || !originalLabels) {
+        emit errorOccurred("对齐MRI前需要先加载MRI和标签数据");
+        return nullptr;
+    }
+
+    emit processingStarted();
+    // 输出为标签网格，需要标签空间到MRI空间的变换，即自定义变换的逆
+    vtkSmartPointer<vtkMatrix4x4> labelToMri;
+    if (customTransform) {
+        labelToMri = vtkSmartPointer<vtkMatrix4x4>::New();
+        vtkMatrix4x4::Invert(customTransform, labelToMri);
+    }
+    processedMRI = resampleToGrid(originalMRI, labelSpatialInfo, interpolationMethod, labelToMri);
+    if (!processedMRI) {
+        emit errorOccurred("MRI重采样失败");
+        return nullptr;
+    }
+    emit processingProgress(100);
+    emit processingCompleted();
+    return processedMRI;
+}
+
+vtkSmartPointer<vtkImageData> MultiResolutionNiftiProcessor::resampleToCustomResolution(
+    double targetSpacing[3],
+    int targetDimensions[3],
+    vtkImageData* sourceData,
+    InterpolationMethod interpolationMethod)
+{
+    if (!sourceData) {
+        emit errorOccurred("重采样的源数据为空");
+        return nullptr;
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (targetSpacing[i] <= 0.0 || targetDimensions[i] <= 0) {
+            emit errorOccurred("无效的目标体素间距或图像尺寸");
+            return nullptr;
+        }
+    }
+
+    // 目标网格与源数据的第一个体素对齐
+    SpatialInfo sourceInfo;
+    extractSpatialInfo(sourceData, sourceInfo);
+    SpatialInfo targetInfo;
+    for (int i = 0; i < 3; ++i) {
+        targetInfo.spacing[i] = targetSpacing[i];
+        targetInfo.origin[i] = sourceInfo.origin[i];
+        targetInfo.dimensions[i] = targetDimensions[i];
+        targetInfo.bounds[2 * i] = targetInfo.origin[i];
+        targetInfo.bounds[2 * i + 1] = targetInfo.origin[i] + (targetDimensions[i] - 1) * targetSpacing[i];
+    }
+
+    emit processingStarted();
+    vtkSmartPointer<vtkImageData> result = resampleToGrid(sourceData, targetInfo, interpolationMethod, nullptr);
+    if (!result) {
+        emit errorOccurred("重采样失败");
+        return nullptr;
+    }
+    emit processingProgress(100);
+    emit processingCompleted();
+    return result;
+}
+
+// ========== 空间变换 ==========
+
+void MultiResolutionNiftiProcessor::setCustomTransform(vtkMatrix4x4* matrix)
+{
+    if (!matrix) {
+        customTransform = nullptr;
+        return;
+    }
+    customTransform = vtkSmartPointer<vtkMatrix4x4>::New();
+    customTransform->DeepCopy(matrix);
+}
+
+bool MultiResolutionNiftiProcessor::computeAutoAlignment()
+{
+    if (!originalMRI || !originalLabels) {
+        emit errorOccurred("自动配准需要先加载MRI和标签数据");
+        return false;
+    }
+
+    // 平移使两个数据的边界中心重合（MRI空间 → 标签空间）
+    customTransform = vtkSmartPointer<vtkMatrix4x4>::New();
+    customTransform->Identity();
+    for (int i = 0; i < 3; ++i) {
+        const double mriCenter = 0.5 * (mriSpatialInfo.bounds[2 * i] + mriSpatialInfo.bounds[2 * i + 1]);
+        const double labelCenter = 0.5 * (labelSpatialInfo.bounds[2 * i] + labelSpatialInfo.bounds[2 * i + 1]);
+        customTransform->SetElement(i, 3, labelCenter - mriCenter);
+    }
+
+    qDebug() << "自动配准平移:" << customTransform->GetElement(0, 3) << ","
+             << customTransform->GetElement(1, 3) << "," << customTransform->GetElement(2, 3);
+    return true;
+}
+
+// ========== 质量控制 ==========
+
+bool MultiResolutionNiftiProcessor::validateSpatialConsistency()
+{
+    if (!originalMRI || !originalLabels) {
+        emit errorOccurred("空间一致性检查需要先加载MRI和标签数据");
+        return false;
+    }
+
+    const bool consistent = sameVoxelGrid(mriSpatialInfo, labelSpatialInfo);
+    if (consistent) {
+        qDebug() << "MRI与标签的体素网格一致，无需重采样";
+    } else {
+        const double overlap = calculateSpatialOverlap(originalMRI, originalLabels);
+        qDebug() << "MRI与标签的体素网格不一致，分辨率比例:"
+                 << labelSpatialInfo.spacing[0] / mriSpatialInfo.spacing[0] << "x"
+                 << labelSpatialInfo.spacing[1] / mriSpatialInfo.spacing[1] << "x"
+                 << labelSpatialInfo.spacing[2] / mriSpatialInfo.spacing[2]
+                 << "，空间重叠度:" << overlap;
+    }
+    return consistent;
+}
+
+void MultiResolutionNiftiProcessor::printSpatialInfo() const
+{
+    if (originalMRI) mriSpatialInfo.print("MRI");
+    if (originalLabels) labelSpatialInfo.print("标签");
+    if (customTransform) {
+        qDebug() << "自定义变换（MRI空间 → 标签空间）:";
+        for (int r = 0; r < 4; ++r) {
+            qDebug() << "  " << customTransform->GetElement(r, 0) << customTransform->GetElement(r, 1)
+                     << customTransform->GetElement(r, 2) << customTransform->GetElement(r, 3);
+        }
+    }
+}
+
+bool MultiResolutionNiftiProcessor::validateLabelIntegrity(vtkImageData* originalLabels,
+                                                           vtkImageData* resampledLabels)
+{
+    lastLabelComparison.clear();
+    if (!originalLabels || !resampledLabels) return false;
+
+    // 网格不同时把重采样结果最近邻映射回原始网格，往返后的差异即重采样造成的损失
+    vtkSmartPointer<vtkImageData> comparable = resampledLabels;
+    SpatialInfo originalInfo;
+    SpatialInfo resampledInfo;
+    extractSpatialInfo(originalLabels, originalInfo);
+    extractSpatialInfo(resampledLabels, resampledInfo);
+    if (!sameVoxelGrid(originalInfo, resampledInfo)) {
+        // 对齐标签时使用了自定义变换（MRI → 标签），映射回去需要它的逆
+        vtkSmartPointer<vtkMatrix4x4> labelToResampled;
+        if (customTransform && originalLabels == this->originalLabels) {
+            labelToResampled = vtkSmartPointer<vtkMatrix4x4>::New();
+            vtkMatrix4x4::Invert(customTransform, labelToResampled);
+        }
+        comparable = resampleToGrid(resampledLabels, originalInfo, NEAREST_NEIGHBOR, labelToResampled);
+        if (!comparable) return false;
+    }
+
+    // 一次扫描得到所有标签的一致性
+    if (!lastLabelComparison.compute(originalLabels, comparable)) return false;
+
+    const QList<int> introduced = lastLabelComparison.getIntroducedLabels();
+    const QList<int> missing = lastLabelComparison.getVanishedLabels();
+    if (!introduced.isEmpty()) {
+        qDebug() << "标签完整性: 出现原始数据中不存在的标签" << introduced;
+    }
+    if (!missing.isEmpty()) {
+        qDebug() << "标签完整性: 丢失标签" << missing;
+    }
+
+    const LabelAgreement* worst = nullptr;
+    for (const LabelAgreement& agreement : lastLabelComparison.getAgreements()) {
+        if (agreement.referenceCount == 0) continue;
+        if (!worst || agreement.dice() < worst->dice()) worst = &agreement;
+    }
+    qDebug() << "标签一致性: 平均Dice" << lastLabelComparison.meanDice()
+             << "，前景Dice" << lastLabelComparison.foregroundDice();
+    if (worst) {
+        qDebug() << "  最低Dice标签" << worst->label << ":" << worst->dice()
+                 << "，体素数漂移" << worst->countDrift() * 100.0 << "%";
+    }
+    return introduced.isEmpty() && missing.isEmpty();
+}
+
+// ========== 工具方法 ==========
+
+vtkSmartPointer<vtkImageData> MultiResolutionNiftiProcessor::createLabelMask(
+    vtkImageData* labelData, int targetLabel)
+{
+    if (!labelData) return nullptr;
+
+    auto threshold = vtkSmartPointer<vtkImageThreshold>::New();
+    threshold->SetInputData(labelData);
+    threshold->ThresholdBetween(targetLabel, targetLabel);
+    threshold->SetInValue(1);
+    threshold->SetOutValue(0);
+    threshold->SetOutputScalarTypeToUnsignedChar();
+    threshold->Update();
+    return threshold->GetOutput();
+}
+
+vtkSmartPointer<vtkImageData> MultiResolutionNiftiProcessor::applyMaskToMRI(
+    vtkImageData* mriData, vtkImageData* maskData)
+{
+    if (!mriData || !maskData) return nullptr;
+
+    int mriDims[3];
+    int maskDims[3];
+    mriData->GetDimensions(mriDims);
+    maskData->GetDimensions(maskDims);
+    if (mriDims[0] != maskDims[0] || mriDims[1] != maskDims[1] || mriDims[2] != maskDims[2]) {
+        qDebug() << "掩码尺寸与MRI不一致，需要先重采样到同一网格";
+        return nullptr;
+    }
+
+    // 掩码转换为MRI标量类型后逐体素相乘
+    auto cast = vtkSmartPointer<vtkImageCast>::New();
+    cast->SetInputData(maskData);
+    cast->SetOutputScalarType(mriData->GetScalarType());
+
+    auto multiply = vtkSmartPointer<vtkImageMathematics>::New();
+    multiply->SetOperationToMultiply();
+    multiply->SetInput1Data(mriData);
+    multiply->SetInputConnection(1, cast->GetOutputPort());
+    multiply->Update();
+    return multiply->GetOutput();
+}
+
+double MultiResolutionNiftiProcessor::calculateSpatialOverlap(vtkImageData* data1, vtkImageData* data2)
+{
+    if (!data1 || !data2) return 0.0;
+
+    // 体素一一对应时统计前景掩码的重叠。输入可能是MRI，只比较值是否大于0，不按标签统计
+    SpatialInfo info1;
+    SpatialInfo info2;
+    extractSpatialInfo(data1, info1);
+    extractSpatialInfo(data2, info2);
+    vtkDataArray* scalars1 = data1->GetPointData()->GetScalars();
+    vtkDataArray* scalars2 = data2->GetPointData()->GetScalars();
+    if (scalars1 && scalars2 && sameVoxelGrid(info1, info2)) {
+        const vtkIdType numPoints = data1->GetNumberOfPoints();
+        std::vector<unsigned char> mask;
+        vtkIdType overlapCount = 0;
+        vtkIdType unionCount = 0;
+        bool supported = true;
+        switch (scalars1->GetDataType()) {
+            vtkTemplateMacro(buildForegroundMask(static_cast<const VTK_TT*>(scalars1->GetVoidPointer(0)), numPoints,
+                                                 scalars1->GetNumberOfComponents(), mask));
+        default:
+            supported = false;
+        }
+        if (supported) {
+            switch (scalars2->GetDataType()) {
+                vtkTemplateMacro(countForegroundOverlap(static_cast<const VTK_TT*>(scalars2->GetVoidPointer(0)),
+                                                        numPoints, scalars2->GetNumberOfComponents(), mask,
+                                                        overlapCount, unionCount));
+            default:
+                supported = false;
+            }
+        }
+        if (supported) {
+            return unionCount > 0 ? static_cast<double>(overlapCount) / unionCount : 0.0;
+        }
+    }
+
+    // 网格不同（体素不对应）：两个边界框的交集体积 / 并集体积
+    double bounds1[6];
+    double bounds2[6];
+    data1->GetBounds(bounds1);
+    data2->GetBounds(bounds2);
+
+    double intersection = 1.0;
+    double volume1 = 1.0;
+    double volume2 = 1.0;
+    for (int i = 0; i < 3; ++i) {
+        const double low = std::max(bounds1[2 * i], bounds2[2 * i]);
+        const double high = std::min(bounds1[2 * i + 1], bounds2[2 * i + 1]);
+        intersection *= std::max(0.0, high - low);
+        volume1 *= bounds1[2 * i + 1] - bounds1[2 * i];
+        volume2 *= bounds2[2 * i + 1] - bounds2[2 * i];
+    }
+
+    const double unionVolume = volume1 + volume2 - intersection;
+    return unionVolume > 0.0 ? intersection / unionVolume : 0.0;
+}
+
+// ========== 私有方法 ==========
+
+void MultiResolutionNiftiProcessor::extractSpatialInfo(vtkImageData* data, SpatialInfo& info)
+{
+    if (!data) return;
+
+    // 原点归一化到范围的第一个体素，之后按从0开始的索引处理
+    int extent[6];
+    data->GetSpacing(info.spacing);
+    data->GetOrigin(info.origin);
+    data->GetDimensions(info.dimensions);
+    data->GetBounds(info.bounds);
+    data->GetExtent(extent);
+    for (int i = 0; i < 3; ++i) {
+        info.origin[i] += extent[2 * i] * info.spacing[i];
+    }
+}
+
+bool MultiResolutionNiftiProcessor::sameVoxelGrid(const SpatialInfo& a, const SpatialInfo& b)
+{
+    for (int i = 0; i < 3; ++i) {
+        const double spacingTolerance = kSpatialTolerance * std::max(a.spacing[i], b.spacing[i]);
+        if (a.dimensions[i] != b.dimensions[i] ||
+            std::fabs(a.spacing[i] - b.spacing[i]) > spacingTolerance ||
+            std::fabs(a.origin[i] - b.origin[i]) > spacingTolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+vtkSmartPointer<vtkImageReslice> MultiResolutionNiftiProcessor::createResliceFilter(
+    vtkImageData* sourceData,
+    const SpatialInfo& targetInfo,
+    InterpolationMethod interpolationMethod)
+{
+    auto reslice = vtkSmartPointer<vtkImageReslice>::New();
+    reslice->SetInputData(sourceData);
+    reslice->SetOutputSpacing(targetInfo.spacing[0], targetInfo.spacing[1], targetInfo.spacing[2]);
+    reslice->SetOutputOrigin(targetInfo.origin[0], targetInfo.origin[1], targetInfo.origin[2]);
+    reslice->SetOutputExtent(0, targetInfo.dimensions[0] - 1,
+                             0, targetInfo.dimensions[1] - 1,
+                             0, targetInfo.dimensions[2] - 1);
+    reslice->SetBackgroundLevel(0.0);
+    setupInterpolation(reslice, interpolationMethod);
+    return reslice;
+}
+
+bool MultiResolutionNiftiProcessor::loadNiftiFile(const QString& filePath, vtkSmartPointer<vtkImageData>& output)
+{
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists()) {
+        emit errorOccurred("NIFTI文件不存在: " + filePath);
+        return false;
+    }
+
+    try {
+        vtkSmartPointer<vtkImageData> image = NiftiVolumeLoader::load(filePath);
+        if (!image) {
+            emit errorOccurred("无法读取NIFTI文件: " + filePath);
+            return false;
+        }
+        output = image;
+        return true;
+    }
+    catch (const std::exception& e) {
+        emit errorOccurred("加载NIFTI文件时发生错误: " + QString(e.what()));
+        return false;
+    }
+}
+
+void MultiResolutionNiftiProcessor::setupInterpolation(vtkImageReslice* reslice, InterpolationMethod method)
+{
+    switch (method) {
+    case NEAREST_NEIGHBOR:
+        reslice->SetInterpolationModeToNearestNeighbor();
+        break;
+    case CUBIC:
+        reslice->SetInterpolationModeToCubic();
+        break;
+    default:
+        reslice->SetInterpolationModeToLinear();
+        break;
+    }
+}
+
+QList<int> MultiResolutionNiftiProcessor::extractUniqueLabels(vtkImageData* labelData)
+{
+    QList<int> labels;
+    if (!labelData) return labels;
+    vtkDataArray* scalars = labelData->GetPointData()->GetScalars();
+    if (!scalars) return labels;
+
+    QSet<int> labelSet;
+    const vtkIdType numPoints = labelData->GetNumberOfPoints();
+    const int stride = scalars->GetNumberOfComponents();
+    void* scalarPointer = scalars->GetVoidPointer(0);
+    switch (scalars->GetDataType()) {
+        vtkTemplateMacro(collectLabels(static_cast<const VTK_TT*>(scalarPointer), numPoints, stride, labelSet));
+    default:
+        qDebug() << "不支持的标签标量类型:" << scalars->GetDataType();
+        return labels;
+    }
+
+    labels = labelSet.toList();
+    std::sort(labels.begin(), labels.end());
+    return labels;
+}
+
+void MultiResolutionNiftiProcessor::validateResampledLabels(vtkImageData* original, vtkImageData* resampled)
+{
+    if (validateLabelIntegrity(original, resampled)) {
+        qDebug() << "重采样后标签完整";
+    } else {
+        qDebug() << "重采样后标签集合发生变化，请检查空间配准或目标分辨率";
+    }
+}
+
+vtkSmartPointer<vtkImageData> MultiResolutionNiftiProcessor::resampleToGrid(
+    vtkImageData* sourceData,
+    const SpatialInfo& targetInfo,
+    InterpolationMethod interpolationMethod,
+    vtkMatrix4x4* targetToSource)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    vtkDataArray* scalars = sourceData->GetPointData()->GetScalars();
+    if (!scalars) return nullptr;
+
+    if (scalars->GetNumberOfComponents() != 1) {
+        // 多分量数据交给vtkImageReslice
+        vtkSmartPointer<vtkImageReslice> reslice = createResliceFilter(sourceData, targetInfo, interpolationMethod);
+        if (targetToSource) reslice->SetResliceAxes(targetToSource);
+        reslice->Update();
+        qDebug() << "重采样（vtkImageReslice）完成，耗时:" << timer.elapsed() << "ms";
+        return reslice->GetOutput();
+    }
+
+    SpatialInfo sourceInfo;
+    extractSpatialInfo(sourceData, sourceInfo);
+
+    // 输出体素索引 → 输出世界坐标 → 源世界坐标 → 源连续体素索引，合成一个仿射映射
+    double worldMatrix[3][4];
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            worldMatrix[r][c] = targetToSource ? targetToSource->GetElement(r, c) : (r == c ? 1.0 : 0.0);
+        }
+    }
+    ResampleKernel::AffineMap map;
+    for (int r = 0; r < 3; ++r) {
+        double offset = worldMatrix[r][3] - sourceInfo.origin[r];
+        for (int c = 0; c < 3; ++c) {
+            map.m[r][c] = worldMatrix[r][c] * targetInfo.spacing[c] / sourceInfo.spacing[r];
+            offset += worldMatrix[r][c] * targetInfo.origin[c];
+        }
+        map.m[r][3] = offset / sourceInfo.spacing[r];
+    }
+
+    auto result = vtkSmartPointer<vtkImageData>::New();
+    result->SetDimensions(targetInfo.dimensions[0], targetInfo.dimensions[1], targetInfo.dimensions[2]);
+    result->SetSpacing(targetInfo.spacing[0], targetInfo.spacing[1], targetInfo.spacing[2]);
+    result->SetOrigin(targetInfo.origin[0], targetInfo.origin[1], targetInfo.origin[2]);
+    result->AllocateScalars(scalars->GetDataType(), 1);
+    emit processingProgress(10);
+
+    const ResampleKernel::Method method = toKernelMethod(interpolationMethod);
+    void* target = result->GetPointData()->GetScalars()->GetVoidPointer(0);
+    switch (scalars->GetDataType()) {
+        vtkTemplateMacro(ResampleKernel::resample(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)),
+                                                  sourceInfo.dimensions, static_cast<VTK_TT*>(target),
+                                                  targetInfo.dimensions, map, method));
+    default:
+        qDebug() << "重采样: 不支持的标量类型" << scalars->GetDataType();
+        return nullptr;
+    }
+
+    qDebug() << "重采样完成（" << methodName(interpolationMethod) << "，"
+             << (map.isAxisAligned() ? "轴对齐" : "一般仿射") << "），输出尺寸:"
+             << targetInfo.dimensions[0] << "x" << targetInfo.dimensions[1] << "x" << targetInfo.dimensions[2]
+             << "耗时:" << timer.elapsed() << "ms";
+    return result;
+}
@@ -17,6 +17,8 @@
 #include <vtkImageThreshold.h>
 #include <vtkImageMathematics.h>
 
+#include "labelconfusionmatrix.h"
+
 /**
  * @brief 多分辨率NIFTI处理器
  * 
@@ -114,7 +116,7 @@ public:
     /**
      * @brief 设置自定义变换矩阵
      * @param matrix 4x4变换矩阵
-     * @note 用于需要特殊空间配准的情况
+     * @note 用于需要特殊空间配准的情况；矩阵把MRI世界坐标映射到标签世界坐标
      */
     void setCustomTransform(vtkMatrix4x4* matrix);
     
@@ -143,9 +145,16 @@ public:
      * @param originalLabels 原始标签数据
      * @param resampledLabels 重采样后标签数据
      * @return 标签保持完整返回true
+     * @note 两者网格不同时把重采样结果最近邻映射回原始网格后比较；
+     *       每个标签的Dice/Jaccard/体素数漂移见getLastLabelComparison()
      */
     bool validateLabelIntegrity(vtkImageData* originalLabels, 
                                vtkImageData* resampledLabels);
+    
+    /**
+     * @brief 最近一次标签完整性检查的混淆矩阵
+     */
+    const LabelConfusionMatrix& getLastLabelComparison() const { return lastLabelComparison; }
 
     // ========== 数据获取 ==========
     
@@ -194,6 +203,8 @@ public:
      * @param data1 数据集1
      * @param data2 数据集2
      * @return 重叠度（0-1）
+     * @note 体素网格一致（尺寸、间距、原点）时为前景体素（值大于0）的Jaccard系数，
+     *       否则为边界框的Jaccard系数。只比较前景掩码，MRI灰度不会被当作标签
      */
     static double calculateSpatialOverlap(vtkImageData* data1, vtkImageData* data2);
 
@@ -215,6 +226,9 @@ private:
     // 变换矩阵
     vtkSmartPointer<vtkMatrix4x4> customTransform;
     
+    // 最近一次标签完整性检查结果
+    LabelConfusionMatrix lastLabelComparison;
+    
     // 空间信息
     struct SpatialInfo {
         double spacing[3];
@@ -236,7 +250,9 @@ private:
     SpatialInfo labelSpatialInfo;
     
     // 私有方法
-    void extractSpatialInfo(vtkImageData* data, SpatialInfo& info);
+    static void extractSpatialInfo(vtkImageData* data, SpatialInfo& info);
+    // 尺寸相同，间距和原点在相对容差内一致（体素一一对应）
+    static bool sameVoxelGrid(const SpatialInfo& a, const SpatialInfo& b);
     vtkSmartPointer<vtkImageReslice> createResliceFilter(
         vtkImageData* sourceData, 
         const SpatialInfo& targetInfo,
@@ -245,6 +261,13 @@ private:
     void setupInterpolation(vtkImageReslice* reslice, InterpolationMethod method);
     QList<int> extractUniqueLabels(vtkImageData* labelData);
     void validateResampledLabels(vtkImageData* original, vtkImageData* resampled);
+    // 把sourceData重采样到targetInfo网格；targetToSource为输出世界坐标到源世界坐标的变换（空为恒等）。
+    // 单分量数据使用按标量类型特化的并行内核，多分量数据使用vtkImageReslice
+    vtkSmartPointer<vtkImageData> resampleToGrid(
+        vtkImageData* sourceData,
+        const SpatialInfo& targetInfo,
+        InterpolationMethod interpolationMethod,
+        vtkMatrix4x4* targetToSource);
 };
 
 #endif // MULTIRESOLUTIONNIFTIPROCESSOR_H
\ No newline at end of file
@@ -1,16 +1,28 @@
 #include "../api/NiftiVisualizationAPI.h"
 #include "niftimanager.h"
 #include "brainregionvolume.h"
+#include "isosurfaceextractor.h"
+#include "intensityhistogram.h"
+#include "activecellestimator.h"
+#include "mripyramid.h"
+#include "niftiheader.h"
+#include "niftivolumeloader.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QTimer>
 #include <QFile>
+#include <QFileInfo>
 #include <QTextStream>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <vtkRenderer.h>
 #include <vtkRenderWindow.h>
 #include <vtkCamera.h>
 #include <vtkImageData.h>
-#include <vtkMarchingCubes.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkActor.h>
 #include <vtkProperty.h>
@@ -18,6 +30,66 @@
 #include <vtkPolyData.h>
 #include <vtkActorCollection.h>
 
+namespace {
+
+// 异步处理时两次刷新渲染的最小间隔（毫秒），避免区块很多时逐个渲染拖慢GUI线程
+const qint64 kStreamingRenderIntervalMs = 50;
+
+// MRI预览默认的三角形预算
+const int kDefaultMriPreviewTriangleBudget = 200000;
+
+// 交互期间单次更新的默认延迟目标（毫秒）
+const double kDefaultInteractiveLatencyMs = 100.0;
+
+// 停止调整灰度值限制多久后回到原始分辨率（毫秒）
+const int kRefineIdleDelayMs = 300;
+
+// 判断两个文件网格一致时允许的间距误差（毫米）
+const double kGridSpacingTolerance = 1.0e-4;
+
+template <typename T>
+void markForeground(const T* values, int stride, vtkIdType count, unsigned char* mask)
+{
+    for (vtkIdType i = 0; i < count; ++i) {
+        mask[i] = values[i * stride] > 0 ? 1 : 0;
+    }
+}
+
+// 标签前景（值>0）的uint8掩码。逐层通过getLabelSlice()读取，游程编码保存时只解压当前一层
+vtkSmartPointer<vtkImageData> createLabelForegroundMask(NiftiManager* manager)
+{
+    vtkImageData* geometry = manager->getLabelGeometry();
+    if (!geometry) return nullptr;
+
+    int dims[3];
+    geometry->GetDimensions(dims);
+    auto mask = vtkSmartPointer<vtkImageData>::New();
+    mask->SetOrigin(geometry->GetOrigin());
+    mask->SetSpacing(geometry->GetSpacing());
+    mask->SetExtent(geometry->GetExtent());
+    mask->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+
+    const vtkIdType sliceSize = static_cast<vtkIdType>(dims[0]) * dims[1];
+    unsigned char* maskValues = static_cast<unsigned char*>(mask->GetScalarPointer());
+    for (int z = 0; z < dims[2]; ++z) {
+        vtkSmartPointer<vtkImageData> slice = manager->getLabelSlice(z);
+        vtkDataArray* scalars = slice ? slice->GetPointData()->GetScalars() : nullptr;
+        if (!scalars) return nullptr;
+
+        const int stride = scalars->GetNumberOfComponents();
+        void* sliceValues = scalars->GetVoidPointer(0);
+        switch (scalars->GetDataType()) {
+            vtkTemplateMacro(markForeground(static_cast<const VTK_TT*>(sliceValues), stride, sliceSize,
+                                            maskValues + z * sliceSize));
+        default:
+            return nullptr;
+        }
+    }
+    return mask;
+}
+
+} // namespace
+
 /**
  * @brief NiftiVisualizationAPI的私有实现类
  * 
@@ -33,6 +105,11 @@ public:
         , currentMinGrayValue(0.0)
         , currentMaxGrayValue(0.0)
         , useGrayValueLimits(false)
+        , mriPreviewTriangleBudget(kDefaultMriPreviewTriangleBudget)
+        , mriPreviewLevel(0)
+        , previewMsPerVoxel(-1.0)
+        , progressiveRefinementEnabled(true)
+        , interactiveLatencyMs(kDefaultInteractiveLatencyMs)
     {
         // 创建内部NIFTI管理器
         niftiManager = new NiftiManager(q);
@@ -44,6 +121,32 @@ public:
                         q, &NiftiVisualizationAPI::regionsProcessed);
         QObject::connect(niftiManager, &NiftiManager::regionVisibilityChanged,
                         q, &NiftiVisualizationAPI::regionVisibilityChanged);
+        QObject::connect(niftiManager, &NiftiManager::regionProcessed,
+                        q, &NiftiVisualizationAPI::regionProcessed);
+        QObject::connect(niftiManager, &NiftiManager::processingCancelled,
+                        q, &NiftiVisualizationAPI::processingCancelled);
+        QObject::connect(niftiManager, &NiftiManager::loadProgress,
+                        q, &NiftiVisualizationAPI::loadProgress);
+        QObject::connect(niftiManager, &NiftiManager::volumesLoaded,
+                        q, &NiftiVisualizationAPI::volumesLoaded);
+        QObject::connect(niftiManager, &NiftiManager::loadingCancelled,
+                        q, &NiftiVisualizationAPI::loadingCancelled);
+        
+        // 交互停止后回到原始分辨率
+        refineTimer.setSingleShot(true);
+        refineTimer.setInterval(kRefineIdleDelayMs);
+        QObject::connect(&refineTimer, &QTimer::timeout, q, [q]() { q->refineToFullResolution(); });
+        
+        // 异步处理时区块逐个加入渲染器，按固定间隔刷新，最后一个区块完成时一定刷新
+        QObject::connect(niftiManager, &NiftiManager::regionProcessed,
+                        q, [this](int, int completedCount, int totalCount) {
+            if (!renderer || !renderer->GetRenderWindow()) return;
+            if (completedCount == totalCount || !streamingRenderTimer.isValid() ||
+                streamingRenderTimer.elapsed() >= kStreamingRenderIntervalMs) {
+                renderer->GetRenderWindow()->Render();
+                streamingRenderTimer.start();
+            }
+        });
     }
     
     ~NiftiVisualizationAPIPrivate()
@@ -76,6 +179,22 @@ public:
     
     // MRI预览actor
     vtkSmartPointer<vtkActor> mriPreviewActor;
+    int mriPreviewTriangleBudget;
+    int mriPreviewLevel;          // 当前预览所用的金字塔层次
+    double previewMsPerVoxel;     // 上一次预览测得的每体素耗时，小于0表示尚未测量
+    
+    // 渐进细化
+    bool progressiveRefinementEnabled;
+    double interactiveLatencyMs;
+    QTimer refineTimer;
+    
+    // 异步处理时的渲染刷新计时
+    QElapsedTimer streamingRenderTimer;
+    std::function<void(int, int, int)> regionProcessedCallback;
+    
+    // 后台加载回调
+    std::function<void(int)> loadProgressCallback;
+    std::function<void()> volumesLoadedCallback;
     
     Q_DECLARE_PUBLIC(NiftiVisualizationAPI)
 };
@@ -107,6 +226,24 @@ NiftiVisualizationAPI::NiftiVisualizationAPI(QObject *parent)
         }
     });
     
+    connect(this, &NiftiVisualizationAPI::regionProcessed, [d](int label, int completedCount, int totalCount) {
+        if (d->regionProcessedCallback) {
+            d->regionProcessedCallback(label, completedCount, totalCount);
+        }
+    });
+    
+    connect(this, &NiftiVisualizationAPI::loadProgress, [d](int percent) {
+        if (d->loadProgressCallback) {
+            d->loadProgressCallback(percent);
+        }
+    });
+    
+    connect(this, &NiftiVisualizationAPI::volumesLoaded, [d]() {
+        if (d->volumesLoadedCallback) {
+            d->volumesLoadedCallback();
+        }
+    });
+    
     qDebug() << "NiftiVisualizationAPI 初始化";
 }
 
@@ -145,6 +282,104 @@ bool NiftiVisualizationAPI::loadLabelNifti(const QString& filePath)
     return d->niftiManager->loadLabelNifti(filePath);
 }
 
+bool NiftiVisualizationAPI::loadMriNiftiAsync(const QString& filePath)
+{
+    Q_D(NiftiVisualizationAPI);
+    return d->niftiManager->loadMriNiftiAsync(filePath);
+}
+
+bool NiftiVisualizationAPI::loadLabelNiftiAsync(const QString& filePath)
+{
+    Q_D(NiftiVisualizationAPI);
+    return d->niftiManager->loadLabelNiftiAsync(filePath);
+}
+
+bool NiftiVisualizationAPI::loadNiftiFilesAsync(const QString& mriFilePath, const QString& labelFilePath)
+{
+    Q_D(NiftiVisualizationAPI);
+    
+    // 完成通知排队回到GUI线程，两个任务都提交后才会处理，volumesLoaded只在两者都结束后发出
+    bool started = false;
+    if (!mriFilePath.isEmpty()) {
+        started = d->niftiManager->loadMriNiftiAsync(mriFilePath);
+    }
+    if (!labelFilePath.isEmpty()) {
+        started = d->niftiManager->loadLabelNiftiAsync(labelFilePath) || started;
+    }
+    return started;
+}
+
+void NiftiVisualizationAPI::cancelLoading()
+{
+    Q_D(NiftiVisualizationAPI);
+    d->niftiManager->cancelLoading();
+}
+
+bool NiftiVisualizationAPI::isLoading() const
+{
+    Q_D(const NiftiVisualizationAPI);
+    return d->niftiManager->isLoading();
+}
+
+NiftiVisualizationAPI::NiftiFileInfo::NiftiFileInfo()
+    : valid(false)
+    , version(0)
+    , compressed(false)
+    , componentCount(0)
+    , datatype(0)
+    , integerType(false)
+    , qformCode(0)
+    , sformCode(0)
+    , fileSize(0)
+    , dataSize(0)
+{
+    for (int i = 0; i < 3; ++i) {
+        dimensions[i] = 0;
+        spacing[i] = 0.0;
+    }
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            qform[i][j] = (i == j) ? 1.0 : 0.0;
+            sform[i][j] = (i == j) ? 1.0 : 0.0;
+        }
+    }
+}
+
+NiftiVisualizationAPI::NiftiFileInfo NiftiVisualizationAPI::probeNiftiFile(const QString& filePath)
+{
+    NiftiFileInfo info;
+    NiftiHeader header;
+    if (!NiftiVolumeLoader::readHeader(filePath, header, &info.compressed)) return info;
+
+    info.valid = true;
+    info.version = header.version;
+    for (int axis = 0; axis < 3; ++axis) {
+        info.dimensions[axis] = header.dimension(axis);
+        info.spacing[axis] = header.spacing(axis);
+    }
+    info.componentCount = header.extraComponentCount();
+    info.datatype = header.datatype;
+    info.datatypeName = QString::fromLatin1(header.datatypeName());
+    info.integerType = header.isIntegerType();
+    info.qformCode = header.qformCode;
+    info.sformCode = header.sformCode;
+    header.qformMatrix(info.qform);
+    header.sformMatrix(info.sform);
+    info.fileSize = QFileInfo(filePath).size();
+    info.dataSize = header.dataSize();
+    return info;
+}
+
+bool NiftiVisualizationAPI::haveMatchingGrids(const NiftiFileInfo& first, const NiftiFileInfo& second)
+{
+    if (!first.valid || !second.valid) return false;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (first.dimensions[axis] != second.dimensions[axis]) return false;
+        if (std::fabs(first.spacing[axis] - second.spacing[axis]) > kGridSpacingTolerance) return false;
+    }
+    return true;
+}
+
 // ========== 数据处理 ==========
 
 void NiftiVisualizationAPI::processRegions()
@@ -229,7 +464,8 @@ void NiftiVisualizationAPI::testSimpleVolumeRendering()
         // 测试标签数据
         if (d->niftiManager->hasLabelData()) {
             qDebug() << "开始渲染标签数据";
-            renderSingleVolume(d->niftiManager->getLabelImage(), QColor(255, 0, 0), "Label");
+            // 只需要前景：逐层读取标签生成掩码，游程编码保存时不解压整个体数据
+            renderSingleVolume(createLabelForegroundMask(d->niftiManager), QColor(255, 0, 0), "Label", true);
         }
         
         // 重置相机并渲染
@@ -264,9 +500,30 @@ void NiftiVisualizationAPI::previewMriVisualization()
     
     qDebug() << "开始MRI预览，使用灰度值限制: [" << d->currentMinGrayValue << ", " << d->currentMaxGrayValue << "]";
     
+    // 显式预览总是使用原始分辨率，尚未细化的区块一并细化
+    d->refineTimer.stop();
+    if (d->niftiManager->hasCoarseRegionSurfaces()) {
+        d->niftiManager->setGrayValueLimits(d->currentMinGrayValue, d->currentMaxGrayValue);
+    }
+    updateMriPreview(0, true);
+}
+
+bool NiftiVisualizationAPI::updateMriPreview(int level, bool resetCamera)
+{
+    Q_D(NiftiVisualizationAPI);
+    
+    vtkImageData* imageData = d->niftiManager->getMriPyramid().getLevel(level);
+    if (!imageData) {
+        level = 0;
+        imageData = d->niftiManager->getMriImage();
+    }
+    
+    bool success = false;
     try {
         // 清理之前的MRI预览actor
+        bool visible = true;
         if (d->mriPreviewActor) {
+            visible = d->mriPreviewActor->GetVisibility() != 0;
             d->renderer->RemoveActor(d->mriPreviewActor);
             d->mriPreviewActor = nullptr;
         }
@@ -274,21 +531,31 @@ void NiftiVisualizationAPI::previewMriVisualization()
         // 创建新的MRI预览actor（使用智能指针确保生命周期管理）
         d->mriPreviewActor = vtkSmartPointer<vtkActor>::New();
         
-        if (createMriPreviewActor(d->niftiManager->getMriImage(), d->mriPreviewActor)) {
+        QElapsedTimer timer;
+        timer.start();
+        if (createMriPreviewActor(imageData, d->mriPreviewActor)) {
+            // 记录每体素耗时，交互期间据此选择金字塔层次
+            d->previewMsPerVoxel = timer.nsecsElapsed() * 1e-6 / static_cast<double>(imageData->GetNumberOfPoints());
+            d->mriPreviewLevel = level;
+            d->mriPreviewActor->SetVisibility(visible);
+            
             // 添加到渲染器
             d->renderer->AddActor(d->mriPreviewActor);
+            success = true;
         } else {
             qDebug() << "MRI预览actor创建失败";
             d->mriPreviewActor = nullptr;
         }
         
         // 重置相机并渲染
-        d->renderer->ResetCamera();
+        if (resetCamera) {
+            d->renderer->ResetCamera();
+        }
         if (d->renderer->GetRenderWindow()) {
             d->renderer->GetRenderWindow()->Render();
         }
         
-        qDebug() << "MRI预览完成";
+        qDebug() << "MRI预览完成，金字塔层次:" << level;
     }
     catch (const std::exception& e) {
         qDebug() << "MRI预览失败:" << e.what();
@@ -296,9 +563,25 @@ void NiftiVisualizationAPI::previewMriVisualization()
     catch (...) {
         qDebug() << "MRI预览失败: 未知错误";
     }
+    return success;
 }
 
-void NiftiVisualizationAPI::renderSingleVolume(vtkImageData* imageData, const QColor& color, const QString& name)
+void NiftiVisualizationAPI::refineToFullResolution()
+{
+    Q_D(NiftiVisualizationAPI);
+    
+    // 区块表面和MRI预览回到原始分辨率
+    qDebug() << "灰度值调整结束，细化到原始分辨率";
+    const int rebuiltCount = d->niftiManager->setGrayValueLimits(d->currentMinGrayValue, d->currentMaxGrayValue);
+    if (d->mriPreviewActor && d->mriPreviewLevel > 0 && d->renderer) {
+        updateMriPreview(0, false);
+    } else if (rebuiltCount > 0 && d->renderer && d->renderer->GetRenderWindow()) {
+        d->renderer->GetRenderWindow()->Render();
+    }
+}
+
+void NiftiVisualizationAPI::renderSingleVolume(vtkImageData* imageData, const QColor& color, const QString& name,
+                                               bool labelData)
 {
     NiftiVisualizationAPIPrivate* d = d_func();
     
@@ -314,25 +597,24 @@ void NiftiVisualizationAPI::renderSingleVolume(vtkImageData* imageData, const QC
         double* range = imageData->GetScalarRange();
         qDebug() << name << "数据范围: [" << range[0] << ", " << range[1] << "]";
         
-        // 应用灰度值限制
+        // 应用灰度值限制（标签值是编号而不是灰度，不限制）
         double effectiveMinValue = range[0];
         double effectiveMaxValue = range[1];
         
-        if (d->useGrayValueLimits) {
+        if (d->useGrayValueLimits && !labelData) {
             effectiveMinValue = std::max(range[0], d->currentMinGrayValue);
             effectiveMaxValue = std::min(range[1], d->currentMaxGrayValue);
             qDebug() << name << "应用灰度值限制: [" << effectiveMinValue << ", " << effectiveMaxValue << "]";
         }
         
-        // 使用Marching Cubes算法生成等值面
-        auto marchingCubes = vtkSmartPointer<vtkMarchingCubes>::New();
-        marchingCubes->SetInputData(imageData);
-        
         // 改进的阈值算法，类似于BrainRegionVolume中的实现
         double threshold;
         double dataRange = effectiveMaxValue - effectiveMinValue;
         
-        if (dataRange > 0) {
+        if (labelData) {
+            // 标签：背景为0，所有标签（或紧凑编号1..N）都是前景，按范围百分比取阈值会丢掉编号小的区块
+            threshold = 0.5;
+        } else if (dataRange > 0) {
             // 根据数据范围选择合适的阈值百分比
             if (dataRange > 1000) {
                 // 高动态范围数据，使用中等阈值
@@ -349,14 +631,17 @@ void NiftiVisualizationAPI::renderSingleVolume(vtkImageData* imageData, const QC
             threshold = effectiveMinValue + 0.1;
         }
         
-        marchingCubes->SetValue(0, threshold);
         qDebug() << name << "使用阈值: " << threshold << "(数据范围: " << dataRange << ")";
         
-        marchingCubes->Update();
+        // 使用当前选择的引擎生成等值面
+        IsosurfaceExtractor::Backend backend = d->niftiManager->getIsosurfaceBackend();
+        vtkSmartPointer<vtkPolyData> polyData = IsosurfaceExtractor::extract(imageData, threshold, backend);
+        qDebug() << name << IsosurfaceExtractor::backendName(backend) << "生成了"
+                 << (polyData ? polyData->GetNumberOfPoints() : 0) << "个点";
         
         // 创建mapper
         auto mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
-        mapper->SetInputConnection(marchingCubes->GetOutputPort());
+        mapper->SetInputData(polyData);
         
         // 创建actor
         auto actor = vtkSmartPointer<vtkActor>::New();
@@ -407,15 +692,15 @@ bool NiftiVisualizationAPI::createMriPreviewActor(vtkImageData* imageData, vtkSm
             qDebug() << "MRI预览应用灰度值限制: [" << effectiveMinValue << ", " << effectiveMaxValue << "]";
         }
         
-        // 使用Marching Cubes算法生成等值面
-        auto marchingCubes = vtkSmartPointer<vtkMarchingCubes>::New();
-        marchingCubes->SetInputData(imageData);
-        
-        // 改进的阈值算法
+        // 改进的阈值算法：有灰度直方图时直接使用Otsu阈值，不再按范围比例猜测
         double threshold;
         double dataRange = effectiveMaxValue - effectiveMinValue;
+        const IntensityHistogram* histogram = d->niftiManager->getIntensityHistogram(0);
         
-        if (dataRange > 0) {
+        if (histogram && dataRange > 0) {
+            threshold = std::min(std::max(histogram->otsuThreshold(), effectiveMinValue), effectiveMaxValue);
+            qDebug() << "MRI预览使用直方图Otsu阈值:" << threshold;
+        } else if (dataRange > 0) {
             // 根据数据范围选择合适的阈值百分比
             if (dataRange > 1000) {
                 threshold = effectiveMinValue + dataRange * 0.35;
@@ -428,81 +713,41 @@ bool NiftiVisualizationAPI::createMriPreviewActor(vtkImageData* imageData, vtkSm
             threshold = effectiveMinValue + 0.1;
         }
         
-        marchingCubes->SetValue(0, threshold);
-        qDebug() << "MRI预览使用阈值: " << threshold << "(数据范围: " << dataRange << ")";
+        // 按三角形预算一次选定等值：先在抽样子网格上估计各等值的活动体元数，
+        // 初始阈值超出预算时向高灰度方向调整，为空表面时向低灰度方向调整，之后只提取一次
+        if (dataRange > 0) {
+            ActiveCellEstimator estimator;
+            if (estimator.build(imageData, effectiveMinValue, effectiveMaxValue, d->niftiManager->getMriBrickIndex())) {
+                const vtkIdType budget = d->mriPreviewTriangleBudget > 0 ? d->mriPreviewTriangleBudget
+                                                                         : std::numeric_limits<vtkIdType>::max();
+                const double budgetThreshold = estimator.selectIsoValue(threshold, budget);
+                qDebug() << "MRI预览三角形预算:" << d->mriPreviewTriangleBudget
+                         << "初始阈值估计:" << estimator.estimateTriangles(threshold)
+                         << "选定阈值:" << budgetThreshold
+                         << "估计三角形数:" << estimator.estimateTriangles(budgetThreshold);
+                threshold = budgetThreshold;
+            }
+        }
+        
+        // 使用当前选择的引擎生成等值面
+        IsosurfaceExtractor::Backend backend = d->niftiManager->getIsosurfaceBackend();
+        qDebug() << "MRI预览使用阈值: " << threshold << "(数据范围: " << dataRange << ")"
+                 << "引擎:" << IsosurfaceExtractor::backendName(backend);
         
+        vtkSmartPointer<vtkPolyData> polyData;
         try {
-            marchingCubes->Update();
+            polyData = IsosurfaceExtractor::extract(imageData, threshold, backend);
             
-            // 检查Marching Cubes输出
-            vtkPolyData* polyData = marchingCubes->GetOutput();
-            if (!polyData) {
-                qDebug() << "MRI预览Marching Cubes输出为空";
+            // 检查等值面输出
+            if (!polyData || polyData->GetNumberOfPoints() == 0 || polyData->GetNumberOfCells() == 0) {
+                qDebug() << "MRI预览等值面没有生成有效几何体";
                 return false;
             }
             
-            int numPoints = polyData->GetNumberOfPoints();
-            int numCells = polyData->GetNumberOfCells();
-            qDebug() << "MRI预览Marching Cubes生成了" << numPoints << "个点和" << numCells << "个面";
-            
-            if (numPoints == 0 || numCells == 0) {
-                qDebug() << "MRI预览Marching Cubes没有生成有效几何体，尝试调整阈值";
-                
-                // 尝试更低的阈值
-                double lowerThreshold = effectiveMinValue + dataRange * 0.01;
-                marchingCubes->SetValue(0, lowerThreshold);
-                qDebug() << "MRI预览尝试更低阈值: " << lowerThreshold;
-                
-                marchingCubes->Update();
-                polyData = marchingCubes->GetOutput();
-                
-                if (!polyData || polyData->GetNumberOfPoints() == 0) {
-                    qDebug() << "MRI预览即使使用更低阈值也无法生成有效几何体";
-                    return false;
-                }
-                
-                qDebug() << "MRI预览使用更低阈值生成了" << polyData->GetNumberOfPoints() << "个点";
-            }
-            
-            // 检查几何体是否过于复杂，如果是则调整阈值
-            if (numPoints > 100000 || numCells > 200000) {
-                qDebug() << "MRI预览几何体过于复杂，尝试提高阈值";
-                
-                // 提高阈值以减少几何体复杂度
-                double higherThreshold = effectiveMinValue + dataRange * 0.8; // 使用80%的阈值
-                marchingCubes->SetValue(0, higherThreshold);
-                qDebug() << "MRI预览尝试更高阈值: " << higherThreshold;
-                
-                marchingCubes->Update();
-                polyData = marchingCubes->GetOutput();
-                
-                if (polyData && polyData->GetNumberOfPoints() > 0) {
-                    int newNumPoints = polyData->GetNumberOfPoints();
-                    int newNumCells = polyData->GetNumberOfCells();
-                    qDebug() << "MRI预览使用更高阈值生成了" << newNumPoints << "个点和" << newNumCells << "个面";
-                    
-                    // 如果仍然太复杂，再次提高阈值
-                    if (newNumPoints > 50000 || newNumCells > 100000) {
-                        double veryHighThreshold = effectiveMinValue + dataRange * 0.9; // 使用90%的阈值
-                        marchingCubes->SetValue(0, veryHighThreshold);
-                        qDebug() << "MRI预览尝试非常高的阈值: " << veryHighThreshold;
-                        
-                        marchingCubes->Update();
-                        polyData = marchingCubes->GetOutput();
-                        
-                        if (polyData && polyData->GetNumberOfPoints() > 0) {
-                            qDebug() << "MRI预览最终生成了" << polyData->GetNumberOfPoints() << "个点和" << polyData->GetNumberOfCells() << "个面";
-                        }
-                    }
-                } else {
-                    qDebug() << "MRI预览更高阈值无法生成有效几何体，回退到原始阈值";
-                    marchingCubes->SetValue(0, threshold);
-                    marchingCubes->Update();
-                }
-            }
-            
+            qDebug() << "MRI预览等值面生成了" << polyData->GetNumberOfPoints() << "个点和"
+                     << polyData->GetNumberOfCells() << "个面";
         } catch (const std::exception& e) {
-            qDebug() << "MRI预览Marching Cubes处理异常:" << e.what();
+            qDebug() << "MRI预览等值面处理异常:" << e.what();
             return false;
         }
         
@@ -514,7 +759,7 @@ bool NiftiVisualizationAPI::createMriPreviewActor(vtkImageData* imageData, vtkSm
         }
         
         try {
-            mapper->SetInputConnection(marchingCubes->GetOutputPort());
+            mapper->SetInputData(polyData);
             mapper->Update();
         } catch (const std::exception& e) {
             qDebug() << "MRI预览mapper设置失败:" << e.what();
@@ -570,6 +815,89 @@ void NiftiVisualizationAPI::setMriPreviewVisible(bool visible)
     }
 }
 
+void NiftiVisualizationAPI::setProgressiveRefinementEnabled(bool enabled)
+{
+    Q_D(NiftiVisualizationAPI);
+    d->progressiveRefinementEnabled = enabled;
+    if (!enabled && d->refineTimer.isActive()) {
+        d->refineTimer.stop();
+        refineToFullResolution();
+    }
+    qDebug() << "渐进细化:" << (enabled ? "启用" : "禁用");
+}
+
+bool NiftiVisualizationAPI::isProgressiveRefinementEnabled() const
+{
+    Q_D(const NiftiVisualizationAPI);
+    return d->progressiveRefinementEnabled;
+}
+
+void NiftiVisualizationAPI::setInteractiveLatencyTarget(double milliseconds)
+{
+    Q_D(NiftiVisualizationAPI);
+    d->interactiveLatencyMs = std::max(1.0, milliseconds);
+}
+
+double NiftiVisualizationAPI::getInteractiveLatencyTarget() const
+{
+    Q_D(const NiftiVisualizationAPI);
+    return d->interactiveLatencyMs;
+}
+
+void NiftiVisualizationAPI::setMriPreviewTriangleBudget(int triangleBudget)
+{
+    Q_D(NiftiVisualizationAPI);
+    d->mriPreviewTriangleBudget = std::max(0, triangleBudget);
+    qDebug() << "MRI预览三角形预算:" << d->mriPreviewTriangleBudget;
+}
+
+int NiftiVisualizationAPI::getMriPreviewTriangleBudget() const
+{
+    Q_D(const NiftiVisualizationAPI);
+    return d->mriPreviewTriangleBudget;
+}
+
+void NiftiVisualizationAPI::processRegionsAsync()
+{
+    Q_D(NiftiVisualizationAPI);
+    processRegionsAsync(d->currentMinGrayValue, d->currentMaxGrayValue);
+}
+
+void NiftiVisualizationAPI::processRegionsAsync(double minGrayValue, double maxGrayValue)
+{
+    Q_D(NiftiVisualizationAPI);
+    
+    d->currentMinGrayValue = minGrayValue;
+    d->currentMaxGrayValue = maxGrayValue;
+    d->useGrayValueLimits = (minGrayValue < maxGrayValue);
+    
+    d->niftiManager->processRegionsAsync(minGrayValue, maxGrayValue);
+    
+    // 区块尚未生成，按标签图像的范围摆放相机，后续区块逐个出现时视角不再跳动
+    vtkImageData* labelGeometry = d->niftiManager->getLabelGeometry();
+    if (d->renderer && labelGeometry) {
+        d->renderer->ResetCamera(labelGeometry->GetBounds());
+        d->streamingRenderTimer.invalidate();
+        if (d->renderer->GetRenderWindow()) {
+            d->renderer->GetRenderWindow()->Render();
+        }
+    }
+    
+    qDebug() << "区块开始后台处理";
+}
+
+void NiftiVisualizationAPI::cancelProcessing()
+{
+    Q_D(NiftiVisualizationAPI);
+    d->niftiManager->cancelProcessing();
+}
+
+bool NiftiVisualizationAPI::isProcessing() const
+{
+    Q_D(const NiftiVisualizationAPI);
+    return d->niftiManager->isProcessing();
+}
+
 void NiftiVisualizationAPI::clearRegions()
 {
     Q_D(NiftiVisualizationAPI);
@@ -630,10 +958,174 @@ void NiftiVisualizationAPI::setGrayValueLimits(double minGrayValue, double maxGr
     
     qDebug() << "API设置灰度值限制: [" << minGrayValue << ", " << maxGrayValue << "]";
     
-    // 同时更新NiftiManager（如果已经有区块的话）
-    if (d->niftiManager) {
-        d->niftiManager->setGrayValueLimits(minGrayValue, maxGrayValue);
+    if (!d->niftiManager) return;
+    
+    // 同时更新NiftiManager（如果已经有区块的话），受影响的区块会重新提取表面；
+    // 渐进细化时先在满足延迟目标的最粗分辨率上更新，停止调整后再细化
+    int sampleFactor = 1;
+    if (d->progressiveRefinementEnabled) {
+        sampleFactor = d->niftiManager->chooseRemeshSampleFactor(minGrayValue, maxGrayValue,
+                                                                 d->interactiveLatencyMs);
+    }
+    const int rebuiltCount = d->niftiManager->setGrayValueLimits(minGrayValue, maxGrayValue, sampleFactor);
+    
+    // 已有MRI预览时在满足延迟目标的金字塔层次上随灰度值限制一起更新
+    int previewLevel = 0;
+    if (d->mriPreviewActor && d->renderer && d->progressiveRefinementEnabled) {
+        const MriPyramid& pyramid = d->niftiManager->getMriPyramid();
+        previewLevel = std::max(0, pyramid.getLevelCount() - 1);
+        if (d->previewMsPerVoxel > 0.0) {
+            for (int level = 0; level < pyramid.getLevelCount(); ++level) {
+                const double voxels = static_cast<double>(pyramid.getLevel(level)->GetNumberOfPoints());
+                if (voxels * d->previewMsPerVoxel <= d->interactiveLatencyMs) {
+                    previewLevel = level;
+                    break;
+                }
+            }
+        }
+        updateMriPreview(previewLevel, false);
+    } else if (rebuiltCount > 0 && d->renderer && d->renderer->GetRenderWindow()) {
+        d->renderer->GetRenderWindow()->Render();
+    }
+    
+    if (sampleFactor > 1 || previewLevel > 0) {
+        d->refineTimer.start();
+    } else {
+        d->refineTimer.stop();
+    }
+}
+
+void NiftiVisualizationAPI::setRegionMeshingMode(RegionMeshingMode mode)
+{
+    Q_D(NiftiVisualizationAPI);
+    
+    switch (mode) {
+    case SHARED_LABEL_INTERFACES:
+        d->niftiManager->setRegionMeshingMode(NiftiManager::SHARED_LABEL_INTERFACES);
+        break;
+    case LABEL_SURFACE_NETS:
+        d->niftiManager->setRegionMeshingMode(NiftiManager::LABEL_SURFACE_NETS);
+        break;
+    case INTENSITY_ISOSURFACE:
+    default:
+        d->niftiManager->setRegionMeshingMode(NiftiManager::INTENSITY_ISOSURFACE);
+        break;
+    }
+}
+
+NiftiVisualizationAPI::RegionMeshingMode NiftiVisualizationAPI::getRegionMeshingMode() const
+{
+    Q_D(const NiftiVisualizationAPI);
+    
+    switch (d->niftiManager->getRegionMeshingMode()) {
+    case NiftiManager::SHARED_LABEL_INTERFACES:
+        return SHARED_LABEL_INTERFACES;
+    case NiftiManager::LABEL_SURFACE_NETS:
+        return LABEL_SURFACE_NETS;
+    case NiftiManager::INTENSITY_ISOSURFACE:
+    default:
+        return INTENSITY_ISOSURFACE;
+    }
+}
+
+void NiftiVisualizationAPI::setIsosurfaceBackend(IsosurfaceBackend backend)
+{
+    Q_D(NiftiVisualizationAPI);
+    
+    switch (backend) {
+    case MARCHING_CUBES_BACKEND:
+        d->niftiManager->setIsosurfaceBackend(IsosurfaceExtractor::MARCHING_CUBES);
+        break;
+    case SIMD_MARCHING_CUBES_BACKEND:
+        d->niftiManager->setIsosurfaceBackend(IsosurfaceExtractor::SIMD_MARCHING_CUBES);
+        break;
+    case FLYING_EDGES_BACKEND:
+    default:
+        d->niftiManager->setIsosurfaceBackend(IsosurfaceExtractor::FLYING_EDGES);
+        break;
+    }
+}
+
+NiftiVisualizationAPI::IsosurfaceBackend NiftiVisualizationAPI::getIsosurfaceBackend() const
+{
+    Q_D(const NiftiVisualizationAPI);
+    
+    switch (d->niftiManager->getIsosurfaceBackend()) {
+    case IsosurfaceExtractor::MARCHING_CUBES:
+        return MARCHING_CUBES_BACKEND;
+    case IsosurfaceExtractor::SIMD_MARCHING_CUBES:
+        return SIMD_MARCHING_CUBES_BACKEND;
+    case IsosurfaceExtractor::FLYING_EDGES:
+    default:
+        return FLYING_EDGES_BACKEND;
+    }
+}
+
+void NiftiVisualizationAPI::setSurfaceSmoothingMethod(SurfaceSmoothingMethod method)
+{
+    Q_D(NiftiVisualizationAPI);
+    
+    switch (method) {
+    case TAUBIN_SMOOTHING:
+        d->niftiManager->setSmoothingMethod(MeshSmoother::TAUBIN);
+        break;
+    case LAPLACIAN_SMOOTHING:
+    default:
+        d->niftiManager->setSmoothingMethod(MeshSmoother::LAPLACIAN);
+        break;
+    }
+}
+
+NiftiVisualizationAPI::SurfaceSmoothingMethod NiftiVisualizationAPI::getSurfaceSmoothingMethod() const
+{
+    Q_D(const NiftiVisualizationAPI);
+    
+    if (d->niftiManager->getSmoothingMethod() == MeshSmoother::TAUBIN) {
+        return TAUBIN_SMOOTHING;
     }
+    return LAPLACIAN_SMOOTHING;
+}
+
+void NiftiVisualizationAPI::setLevelOfDetailEnabled(bool enabled)
+{
+    Q_D(NiftiVisualizationAPI);
+    d->niftiManager->setLevelOfDetailEnabled(enabled);
+}
+
+bool NiftiVisualizationAPI::isLevelOfDetailEnabled() const
+{
+    Q_D(const NiftiVisualizationAPI);
+    return d->niftiManager->isLevelOfDetailEnabled();
+}
+
+void NiftiVisualizationAPI::setMeshCacheEnabled(bool enabled)
+{
+    Q_D(NiftiVisualizationAPI);
+    d->niftiManager->setMeshCacheEnabled(enabled);
+}
+
+bool NiftiVisualizationAPI::isMeshCacheEnabled() const
+{
+    Q_D(const NiftiVisualizationAPI);
+    return d->niftiManager->isMeshCacheEnabled();
+}
+
+void NiftiVisualizationAPI::setMeshCacheDirectory(const QString& directory)
+{
+    Q_D(NiftiVisualizationAPI);
+    d->niftiManager->setMeshCacheDirectory(directory);
+}
+
+QString NiftiVisualizationAPI::getMeshCacheDirectory() const
+{
+    Q_D(const NiftiVisualizationAPI);
+    return d->niftiManager->getMeshCacheDirectory();
+}
+
+bool NiftiVisualizationAPI::clearMeshCache()
+{
+    Q_D(NiftiVisualizationAPI);
+    return d->niftiManager->clearMeshCache();
 }
 
 // ========== 信息获取 ==========
@@ -666,6 +1158,42 @@ double NiftiVisualizationAPI::getRegionOpacity(int label) const
     return volume ? 0.8 : 0.0; // 临时返回默认值
 }
 
+bool NiftiVisualizationAPI::getIntensityHistogram(int label, QVector<qint64>& counts,
+                                                  double& minValue, double& maxValue) const
+{
+    Q_D(const NiftiVisualizationAPI);
+    const IntensityHistogram* histogram = d->niftiManager->getIntensityHistogram(label);
+    if (!histogram) return false;
+    
+    const std::vector<vtkIdType>& binCounts = histogram->getCounts();
+    counts.resize(static_cast<int>(binCounts.size()));
+    std::copy(binCounts.begin(), binCounts.end(), counts.begin());
+    minValue = histogram->getMinimum();
+    maxValue = histogram->getMaximum();
+    return true;
+}
+
+double NiftiVisualizationAPI::getIntensityPercentile(int label, double percent) const
+{
+    Q_D(const NiftiVisualizationAPI);
+    const IntensityHistogram* histogram = d->niftiManager->getIntensityHistogram(label);
+    return histogram ? histogram->percentile(percent) : 0.0;
+}
+
+double NiftiVisualizationAPI::getOtsuThreshold(int label) const
+{
+    Q_D(const NiftiVisualizationAPI);
+    const IntensityHistogram* histogram = d->niftiManager->getIntensityHistogram(label);
+    return histogram ? histogram->otsuThreshold() : 0.0;
+}
+
+double NiftiVisualizationAPI::getIntensityFraction(int label, double minValue, double maxValue) const
+{
+    Q_D(const NiftiVisualizationAPI);
+    const IntensityHistogram* histogram = d->niftiManager->getIntensityHistogram(label);
+    return histogram ? histogram->fractionInRange(minValue, maxValue) : 0.0;
+}
+
 // ========== 状态查询 ==========
 
 bool NiftiVisualizationAPI::hasMriData() const
@@ -680,6 +1208,12 @@ bool NiftiVisualizationAPI::hasLabelData() const
     return d->niftiManager->hasLabelData();
 }
 
+bool NiftiVisualizationAPI::hasIntensityHistogram() const
+{
+    Q_D(const NiftiVisualizationAPI);
+    return d->niftiManager->hasIntensityHistograms();
+}
+
 int NiftiVisualizationAPI::getRegionCount() const
 {
     Q_D(const NiftiVisualizationAPI);
@@ -712,6 +1246,24 @@ void NiftiVisualizationAPI::setRegionVisibilityCallback(std::function<void(int,
     d->regionVisibilityCallback = callback;
 }
 
+void NiftiVisualizationAPI::setRegionProcessedCallback(std::function<void(int, int, int)> callback)
+{
+    Q_D(NiftiVisualizationAPI);
+    d->regionProcessedCallback = callback;
+}
+
+void NiftiVisualizationAPI::setLoadProgressCallback(std::function<void(int)> callback)
+{
+    Q_D(NiftiVisualizationAPI);
+    d->loadProgressCallback = callback;
+}
+
+void NiftiVisualizationAPI::setVolumesLoadedCallback(std::function<void()> callback)
+{
+    Q_D(NiftiVisualizationAPI);
+    d->volumesLoadedCallback = callback;
+}
+
 // ========== 高级功能 ==========
 
 void NiftiVisualizationAPI::resetCamera()
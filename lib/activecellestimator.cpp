@@ -0,0 +1,209 @@
+#include "activecellestimator.h"
+#include "brickindex.h"
+#include "parallelfor.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+// VTK头文件
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+
+namespace {
+
+// 移动立方体每个活动体元平均生成的三角形数（光滑表面的经验值）
+const double kTrianglesPerActiveCell = 2.0;
+
+// 抽样子网格上统计体元取值跨度；每块写入自己的差分数组，最后合并。
+// bricks不为空时，8个角点都在同一个常数块内的体元不读取体素（必然不活动）
+template <typename T>
+void accumulateCellSpans(const T* data, int numComponents, const int dims[3], int stride,
+                         double minValue, double bucketWidth, int bucketCount, const BrickIndex* bricks,
+                         std::vector<vtkIdType>& difference, vtkIdType& sampledCells)
+{
+    const int brickLast = BrickIndex::kBrickSize - 1;
+    const vtkIdType sliceSize = static_cast<vtkIdType>(dims[0]) * dims[1];
+    const int sampledSlices = (dims[2] - 2) / stride + 1;
+    const int chunks = ParallelFor::chunkCount(0, sampledSlices, 4);
+    std::vector<std::vector<vtkIdType>> chunkDifferences(static_cast<size_t>(chunks));
+    std::vector<vtkIdType> chunkCells(static_cast<size_t>(chunks), 0);
+
+    ParallelFor::parallelForChunks(0, sampledSlices, chunks, [&](int chunk, int sliceBegin, int sliceEnd) {
+        std::vector<vtkIdType>& localDifference = chunkDifferences[chunk];
+        localDifference.assign(static_cast<size_t>(bucketCount) + 1, 0);
+        vtkIdType localCells = 0;
+
+        // 等值e落在(最小值, 最大值]内时体元被穿过；分桶b的等值取其下边界
+        auto firstBucketAbove = [&](double value) {
+            const double position = std::floor((value - minValue) / bucketWidth) + 1.0;
+            if (position <= 0.0) return 0;
+            if (position >= bucketCount) return bucketCount;
+            return static_cast<int>(position);
+        };
+
+        for (int s = sliceBegin; s < sliceEnd; ++s) {
+            const int z = s * stride;
+            for (int y = 0; y + 1 < dims[1]; y += stride) {
+                for (int x = 0; x + 1 < dims[0]; x += stride) {
+                    if (bricks && (x & brickLast) != brickLast && (y & brickLast) != brickLast &&
+                        (z & brickLast) != brickLast && bricks->isFlat(bricks->brickAt(x, y, z))) {
+                        ++localCells;
+                        continue;
+                    }
+                    const vtkIdType base = static_cast<vtkIdType>(z) * sliceSize +
+                                           static_cast<vtkIdType>(y) * dims[0] + x;
+                    const vtkIdType corners[8] = {
+                        base, base + 1, base + dims[0], base + dims[0] + 1,
+                        base + sliceSize, base + sliceSize + 1,
+                        base + sliceSize + dims[0], base + sliceSize + dims[0] + 1
+                    };
+                    double low = static_cast<double>(data[corners[0] * numComponents]);
+                    double high = low;
+                    for (int c = 1; c < 8; ++c) {
+                        const double value = static_cast<double>(data[corners[c] * numComponents]);
+                        low = std::min(low, value);
+                        high = std::max(high, value);
+                    }
+                    ++localCells;
+                    if (!(low < high)) continue;
+
+                    const int first = firstBucketAbove(low);
+                    const int last = firstBucketAbove(high);
+                    if (first < last) {
+                        ++localDifference[first];
+                        --localDifference[last];
+                    }
+                }
+            }
+        }
+        chunkCells[chunk] = localCells;
+    });
+
+    difference.assign(static_cast<size_t>(bucketCount) + 1, 0);
+    sampledCells = 0;
+    for (int chunk = 0; chunk < chunks; ++chunk) {
+        for (int b = 0; b <= bucketCount; ++b) {
+            difference[b] += chunkDifferences[chunk][b];
+        }
+        sampledCells += chunkCells[chunk];
+    }
+}
+
+} // namespace
+
+ActiveCellEstimator::ActiveCellEstimator()
+    : minValue(0.0)
+    , bucketWidth(1.0)
+    , sampleScale(1.0)
+{
+}
+
+bool ActiveCellEstimator::build(vtkImageData* imageData, double minValue, double maxValue,
+                                const BrickIndex* bricks, int bucketCount, vtkIdType maxSampledCells)
+{
+    activeCells.clear();
+    if (!imageData || bucketCount <= 0 || !(minValue < maxValue)) return false;
+
+    vtkDataArray* scalars = imageData->GetPointData()->GetScalars();
+    if (!scalars) return false;
+
+    int dims[3];
+    imageData->GetDimensions(dims);
+    if (dims[0] < 2 || dims[1] < 2 || dims[2] < 2) return false;
+
+    // 按立方根确定各轴抽样步长，使抽样体元数不超过上限
+    const double totalCells = static_cast<double>(dims[0] - 1) * (dims[1] - 1) * (dims[2] - 1);
+    int stride = 1;
+    if (maxSampledCells > 0 && totalCells > maxSampledCells) {
+        stride = static_cast<int>(std::ceil(std::cbrt(totalCells / static_cast<double>(maxSampledCells))));
+    }
+
+    this->minValue = minValue;
+    bucketWidth = (maxValue - minValue) / bucketCount;
+
+    std::vector<vtkIdType> difference;
+    vtkIdType sampledCells = 0;
+    const int numComponents = scalars->GetNumberOfComponents();
+    void* scalarPointer = scalars->GetVoidPointer(0);
+    if (bricks && (!bricks->hasRanges() || !bricks->matches(imageData))) bricks = nullptr;
+    switch (scalars->GetDataType()) {
+        vtkTemplateMacro(accumulateCellSpans(static_cast<const VTK_TT*>(scalarPointer), numComponents, dims,
+                                             stride, minValue, bucketWidth, bucketCount, bricks,
+                                             difference, sampledCells));
+    default:
+        qDebug() << "活动体元估计: 不支持的标量类型" << scalars->GetDataType();
+        return false;
+    }
+    if (sampledCells == 0) return false;
+
+    activeCells.resize(static_cast<size_t>(bucketCount));
+    vtkIdType running = 0;
+    for (int b = 0; b < bucketCount; ++b) {
+        running += difference[b];
+        activeCells[b] = running;
+    }
+    sampleScale = totalCells / static_cast<double>(sampledCells);
+
+    qDebug() << "活动体元估计: 抽样步长" << stride << "，抽样体元" << sampledCells << "/"
+             << static_cast<qint64>(totalCells);
+    return true;
+}
+
+int ActiveCellEstimator::bucketForValue(double value) const
+{
+    const double position = std::floor((value - minValue) / bucketWidth + 0.5);
+    if (position <= 0.0) return 0;
+    const int last = static_cast<int>(activeCells.size()) - 1;
+    return position >= last ? last : static_cast<int>(position);
+}
+
+double ActiveCellEstimator::valueForBucket(int bucket) const
+{
+    return minValue + bucket * bucketWidth;
+}
+
+vtkIdType ActiveCellEstimator::trianglesInBucket(int bucket) const
+{
+    return static_cast<vtkIdType>(activeCells[bucket] * sampleScale * kTrianglesPerActiveCell);
+}
+
+vtkIdType ActiveCellEstimator::estimateTriangles(double isoValue) const
+{
+    if (activeCells.empty()) return 0;
+    return trianglesInBucket(bucketForValue(isoValue));
+}
+
+double ActiveCellEstimator::selectIsoValue(double preferred, vtkIdType budget) const
+{
+    if (activeCells.empty() || budget <= 0) return preferred;
+
+    const int bucketCount = static_cast<int>(activeCells.size());
+    const int start = bucketForValue(preferred);
+    const vtkIdType startTriangles = trianglesInBucket(start);
+    if (startTriangles > 0 && startTriangles <= budget) return preferred;
+
+    if (startTriangles > budget) {
+        // 表面过于复杂：提高等值直到进入预算；都超出时取其中最简单的非空表面
+        int fallback = start;
+        for (int b = start + 1; b < bucketCount; ++b) {
+            const vtkIdType triangles = trianglesInBucket(b);
+            if (triangles <= 0) continue;
+            if (triangles <= budget) return valueForBucket(b);
+            if (triangles < trianglesInBucket(fallback)) fallback = b;
+        }
+        return valueForBucket(fallback);
+    }
+
+    // 空表面：先向低灰度方向，再向高灰度方向寻找最近的预算内非空等值
+    for (int b = start - 1; b >= 0; --b) {
+        const vtkIdType triangles = trianglesInBucket(b);
+        if (triangles > 0 && triangles <= budget) return valueForBucket(b);
+    }
+    for (int b = start + 1; b < bucketCount; ++b) {
+        const vtkIdType triangles = trianglesInBucket(b);
+        if (triangles > 0 && triangles <= budget) return valueForBucket(b);
+    }
+    return preferred;
+}
@@ -0,0 +1,48 @@
+#ifndef ACTIVECELLESTIMATOR_H
+#define ACTIVECELLESTIMATOR_H
+
+#include <vector>
+
+// VTK头文件
+#include <vtkType.h>
+
+class vtkImageData;
+class BrickIndex;
+
+/**
+ * @brief 按等值估计移动立方体输出规模
+ *
+ * 在均匀抽样的子网格上统计每个体元的[最小值, 最大值]，用差分数组一次得到
+ * 每个等值分桶上的活动体元（被等值面穿过的体元）数，再按抽样比例和每个
+ * 活动体元的平均三角形数换算成三角形数。不提取任何几何，代价约为一次抽样读取。
+ */
+class ActiveCellEstimator
+{
+public:
+    ActiveCellEstimator();
+
+    // 在[minValue, maxValue]范围内按bucketCount个分桶统计，最多抽样maxSampledCells个体元；
+    // bricks为imageData的灰度块索引时跳过常数块内的体元
+    bool build(vtkImageData* imageData, double minValue, double maxValue, const BrickIndex* bricks = nullptr,
+               int bucketCount = 512, vtkIdType maxSampledCells = 2000000);
+    bool isValid() const { return !activeCells.empty(); }
+
+    // 估计等值isoValue对应的三角形数
+    vtkIdType estimateTriangles(double isoValue) const;
+
+    // 选择三角形数不超过budget、且离preferred最近的非空等值：
+    // preferred超出预算时向高灰度方向寻找，preferred为空表面时向低灰度方向寻找
+    double selectIsoValue(double preferred, vtkIdType budget) const;
+
+private:
+    int bucketForValue(double value) const;
+    double valueForBucket(int bucket) const;
+    vtkIdType trianglesInBucket(int bucket) const;
+
+    std::vector<vtkIdType> activeCells;   // 每个分桶下边界处的抽样活动体元数
+    double minValue;
+    double bucketWidth;
+    double sampleScale;                   // 总体元数 / 抽样体元数
+};
+
+#endif // ACTIVECELLESTIMATOR_H
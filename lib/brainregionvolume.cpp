@@ -1,6 +1,11 @@
 #include "brainregionvolume.h"
+#include "mripyramid.h"
+#include "labelpartitioner.h"
+#include "surfacenetsmesher.h"
+#include "meshsmoother.h"
 
 #include <QDebug>
+#include <QMutexLocker>
 #include <cmath>
 #include <algorithm>
 
@@ -10,17 +15,19 @@
 #include <vtkDataArray.h>
 #include <vtkCamera.h>
 #include <vtkSphereSource.h>
+#include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkActor.h>
 #include <vtkProperty.h>
-#include <vtkImageThreshold.h>
-#include <vtkImageMathematics.h>
-#include <vtkMarchingCubes.h>
 #include <vtkImageReslice.h>
 #include <vtkAlgorithmOutput.h>
-#include <vtkSmoothPolyDataFilter.h>
-#include <vtkImageCast.h>
 #include <vtkImageMask.h>
+#include <vtkRenderer.h>
+#include <vtkMath.h>
+#include <vtkCellArray.h>
+#include <vtkTriangleFilter.h>
+#include <vtkQuadricDecimation.h>
+#include <vtkPolyDataNormals.h>
 
 BrainRegionVolume::BrainRegionVolume(int label, QObject *parent)
     : QObject(parent)
@@ -31,7 +38,19 @@ BrainRegionVolume::BrainRegionVolume(int label, QObject *parent)
     , minGrayValue(0.0)
     , maxGrayValue(0.0)
     , useGrayValueLimits(false)
+    , isosurfaceBackend(IsosurfaceExtractor::FLYING_EDGES)
+    , labelMeshingMethod(LABEL_MARCHING_CUBES)
+    , smoothingMethod(MeshSmoother::LAPLACIAN)
+    , surfaceRevision(0)
+    , pendingLevelsRevision(-1)
+    , levelOfDetail(0)
+    , intensityHasBackground(false)
+    , coarseSampleFactor(1)
+    , surfaceSampleFactor(1)
+    , surfaceThreshold(0.0)
 {
+    intensityRange[0] = intensityRange[1] = 0.0;
+    voxelIntensityRange[0] = voxelIntensityRange[1] = 0.0;
     initializeSurfaceActor();
     initializeCentroidSphere();
     qDebug() << "BrainRegionVolume" << label << "初始化，默认颜色:" << color.name();
@@ -42,16 +61,135 @@ BrainRegionVolume::~BrainRegionVolume()
     qDebug() << "BrainRegionVolume" << label << "析构";
 }
 
-void BrainRegionVolume::setVolumeData(vtkImageData* mriData, vtkImageData* maskData)
+void BrainRegionVolume::setVolumeData(vtkImageData* mriData, const LabelRegionInfo& region)
 {
-    setVolumeData(mriData, maskData, 0.0, 0.0);
+    setVolumeData(mriData, region, 0.0, 0.0);
 }
 
-void BrainRegionVolume::setVolumeData(vtkImageData* mriData, vtkImageData* maskData, double minGrayValue, double maxGrayValue)
+namespace {
+
+// 裁剪子体积在包围盒外额外保留的体素层数，保证等值面在裁剪边界处闭合
+const int kCropPadding = 1;
+
+// 全局体素索引转换为裁剪子体积内的局部索引
+inline vtkIdType toCroppedIndex(vtkIdType id, const int dims[3], const int cropExtent[6])
 {
-    if (!mriData || !maskData) {
-        qDebug() << "警告: MRI数据或掩码数据为空";
-        return;
+    const vtkIdType sliceSize = static_cast<vtkIdType>(dims[0]) * dims[1];
+    const vtkIdType z = id / sliceSize;
+    const vtkIdType rest = id - z * sliceSize;
+    const vtkIdType y = rest / dims[0];
+    const vtkIdType x = rest - y * dims[0];
+
+    const vtkIdType cropX = cropExtent[1] - cropExtent[0] + 1;
+    const vtkIdType cropY = cropExtent[3] - cropExtent[2] + 1;
+    return ((z - cropExtent[4]) * cropY + (y - cropExtent[2])) * cropX + (x - cropExtent[0]);
+}
+
+// 只访问区块自身体素：把MRI值散射到全零的裁剪子体积中，同时统计区块内灰度范围
+template <typename T>
+void scatterRegionVoxels(const T* source, T* target, const std::vector<vtkIdType>& voxelIds,
+                         const int dims[3], const int cropExtent[6], double range[2])
+{
+    T minValue = voxelIds.empty() ? T(0) : source[voxelIds.front()];
+    T maxValue = minValue;
+    for (vtkIdType id : voxelIds) {
+        const T value = source[id];
+        target[toCroppedIndex(id, dims, cropExtent)] = value;
+        if (value < minValue) minValue = value;
+        if (value > maxValue) maxValue = value;
+    }
+    range[0] = static_cast<double>(minValue);
+    range[1] = static_cast<double>(maxValue);
+}
+
+// 各细节层次相对完整网格保留的三角形比例，逐级在上一层次的基础上继续抽取
+const double kLevelOfDetailFractions[] = { 0.5, 0.25, 0.1 };
+
+// 三角形数少于该值的区块不生成细节层次，简化带来的收益不足以抵消切换开销
+const vtkIdType kMinLevelOfDetailTriangles = 2000;
+
+// 多边形按扇形三角化后的三角形数（VTK 8.2单元数组：每个单元占n+1个条目）
+inline vtkIdType countTriangles(vtkPolyData* polyData)
+{
+    vtkCellArray* polys = polyData ? polyData->GetPolys() : nullptr;
+    if (!polys) return 0;
+    return polys->GetNumberOfConnectivityEntries() - 3 * polys->GetNumberOfCells();
+}
+
+} // namespace
+
+void BrainRegionVolume::computeCropExtent(const LabelRegionInfo& region, const int dims[3], int cropExtent[6]) const
+{
+    for (int axis = 0; axis < 3; ++axis) {
+        cropExtent[2 * axis] = std::max(region.extent[2 * axis] - kCropPadding, 0);
+        cropExtent[2 * axis + 1] = std::min(region.extent[2 * axis + 1] + kCropPadding, dims[axis] - 1);
+    }
+}
+
+vtkSmartPointer<vtkImageData> BrainRegionVolume::createCroppedImage(vtkImageData* referenceData,
+                                                                    const int cropExtent[6],
+                                                                    int scalarType) const
+{
+    // 子体积索引从0开始，通过平移原点保持世界坐标不变
+    // （vtkMarchingCubes等滤波器只使用原点和间距计算点坐标）
+    double origin[3];
+    double spacing[3];
+    int referenceExtent[6];
+    referenceData->GetOrigin(origin);
+    referenceData->GetSpacing(spacing);
+    referenceData->GetExtent(referenceExtent);
+
+    auto croppedImage = vtkSmartPointer<vtkImageData>::New();
+    croppedImage->SetSpacing(spacing);
+    croppedImage->SetOrigin(origin[0] + (referenceExtent[0] + cropExtent[0]) * spacing[0],
+                            origin[1] + (referenceExtent[2] + cropExtent[2]) * spacing[1],
+                            origin[2] + (referenceExtent[4] + cropExtent[4]) * spacing[2]);
+    croppedImage->SetDimensions(cropExtent[1] - cropExtent[0] + 1,
+                                cropExtent[3] - cropExtent[2] + 1,
+                                cropExtent[5] - cropExtent[4] + 1);
+    croppedImage->AllocateScalars(scalarType, 1);
+
+    vtkDataArray* scalars = croppedImage->GetPointData()->GetScalars();
+    char* scalarPointer = static_cast<char*>(scalars->GetVoidPointer(0));
+    std::fill(scalarPointer, scalarPointer + scalars->GetNumberOfValues() * scalars->GetDataTypeSize(),
+              static_cast<char>(0));
+    return croppedImage;
+}
+
+vtkSmartPointer<vtkImageData> BrainRegionVolume::createLabelMask(vtkImageData* referenceData,
+                                                                 const LabelRegionInfo& region,
+                                                                 const int cropExtent[6]) const
+{
+    auto labelMask = createCroppedImage(referenceData, cropExtent, VTK_UNSIGNED_CHAR);
+
+    int dims[3];
+    referenceData->GetDimensions(dims);
+    unsigned char* maskPointer = static_cast<unsigned char*>(labelMask->GetScalarPointer());
+    for (vtkIdType id : region.voxelIds) {
+        maskPointer[toCroppedIndex(id, dims, cropExtent)] = 1;
+    }
+    return labelMask;
+}
+
+void BrainRegionVolume::setVolumeData(vtkImageData* mriData, const LabelRegionInfo& region, double minGrayValue, double maxGrayValue)
+{
+    if (buildSurface(mriData, region, minGrayValue, maxGrayValue)) {
+        applySurface();
+    }
+}
+
+bool BrainRegionVolume::buildSurface(vtkImageData* mriData, const LabelRegionInfo& region, double minGrayValue, double maxGrayValue)
+{
+    // 注意：此函数可能在工作线程中执行，只能读取共享的MRI数据，不能修改渲染对象
+    surfaceData = nullptr;
+    intensityData = nullptr;
+    coarseIntensityData = nullptr;
+    coarseSampleFactor = 1;
+    surfaceSampleFactor = 1;
+    
+    if (!mriData || region.voxelIds.empty()) {
+        qDebug() << "警告: MRI数据或区块体素为空";
+        return false;
     }
     
     // 设置灰度值限制
@@ -60,191 +198,516 @@ void BrainRegionVolume::setVolumeData(vtkImageData* mriData, vtkImageData* maskD
     this->useGrayValueLimits = (minGrayValue < maxGrayValue);
 
     try {
-        qDebug() << "开始处理区块" << label << "的surface数据（新的填充算法）";
-        
-        // 步骤1: 创建二值化的标签掩码
-        auto labelThreshold = vtkSmartPointer<vtkImageThreshold>::New();
-        labelThreshold->SetInputData(maskData);
-        labelThreshold->ThresholdBetween(label, label);
-        labelThreshold->SetInValue(1.0);
-        labelThreshold->SetOutValue(0.0);
-        labelThreshold->ReplaceInOn();
-        labelThreshold->ReplaceOutOn();
-        labelThreshold->Update();
-
-        // 检查标签掩码
-        vtkImageData* labelMask = labelThreshold->GetOutput();
-        if (!labelMask) {
-            qDebug() << "区块" << label << "标签掩码创建失败";
-            return;
+        qDebug() << "开始处理区块" << label << "的surface数据（包围盒裁剪子体积）";
+        
+        vtkDataArray* mriScalars = mriData->GetPointData()->GetScalars();
+        if (!mriScalars || mriScalars->GetNumberOfComponents() != 1) {
+            qDebug() << "区块" << label << "MRI数据必须是单分量标量";
+            return false;
         }
-
+        
         // 获取数据维度和类型信息
-        int* dims = mriData->GetDimensions();
-        qDebug() << "区块" << label << "数据维度:" << dims[0] << "x" << dims[1] << "x" << dims[2];
-        qDebug() << "区块" << label << "MRI数据类型:" << mriData->GetScalarType() 
-                 << "标签掩码类型:" << labelMask->GetScalarType();
-
-        // 步骤2: 确保数据类型匹配后再进行乘法操作
-        // 将标签掩码转换为与MRI数据相同的类型
-        auto castFilter = vtkSmartPointer<vtkImageCast>::New();
-        castFilter->SetInputData(labelMask);
-        castFilter->SetOutputScalarType(mriData->GetScalarType());
-        castFilter->Update();
-        
-        vtkImageData* castedMask = castFilter->GetOutput();
-        
-        // 现在可以安全地进行乘法操作
-        auto maskedRegion = vtkSmartPointer<vtkImageMathematics>::New();
-        maskedRegion->SetOperationToMultiply();
-        maskedRegion->SetInput1Data(mriData);
-        maskedRegion->SetInput2Data(castedMask);
-        maskedRegion->Update();
-        
-        vtkImageData* regionData = maskedRegion->GetOutput();
-        
-        // 获取掩码后的数据范围
-        double* regionRange = regionData->GetScalarRange();
+        int dims[3];
+        mriData->GetDimensions(dims);
+        if (region.voxelIds.back() >= mriData->GetNumberOfPoints()) {
+            qDebug() << "区块" << label << "标签体素超出MRI数据范围，MRI与标签尺寸不一致";
+            return false;
+        }
+
+        // 步骤1: 计算带填充的包围盒裁剪范围
+        int cropExtent[6];
+        computeCropExtent(region, dims, cropExtent);
+        qDebug() << "区块" << label << "数据维度:" << dims[0] << "x" << dims[1] << "x" << dims[2]
+                 << "裁剪子体积:" << (cropExtent[1] - cropExtent[0] + 1)
+                 << "x" << (cropExtent[3] - cropExtent[2] + 1)
+                 << "x" << (cropExtent[5] - cropExtent[4] + 1)
+                 << "体素数:" << region.voxelCount;
+
+        // 步骤2: 只把区块自身的体素写入裁剪后的MRI子体积（不再对整幅体数据阈值/转换/相乘）
+        auto regionData = createCroppedImage(mriData, cropExtent, mriScalars->GetDataType());
+        vtkDataArray* regionScalars = regionData->GetPointData()->GetScalars();
+
+        double voxelRange[2] = {0.0, 0.0};
+        switch (mriScalars->GetDataType()) {
+            vtkTemplateMacro(scatterRegionVoxels(static_cast<const VTK_TT*>(mriScalars->GetVoidPointer(0)),
+                                                 static_cast<VTK_TT*>(regionScalars->GetVoidPointer(0)),
+                                                 region.voxelIds, dims, cropExtent, voxelRange));
+        default:
+            qDebug() << "区块" << label << "不支持的MRI标量类型:" << mriScalars->GetDataType();
+            return false;
+        }
+
+        // 子体积中区块外的体素为0，与原先乘法掩码得到的数据范围一致
+        double regionRange[2] = {voxelRange[0], voxelRange[1]};
+        if (region.voxelCount < regionData->GetNumberOfPoints()) {
+            regionRange[0] = std::min(regionRange[0], 0.0);
+            regionRange[1] = std::max(regionRange[1], 0.0);
+        }
         qDebug() << "区块" << label << "标签区域内MRI数据范围: [" << regionRange[0] << ", " << regionRange[1] << "]";
         
-        // 步骤3: 直接使用标签区域内的MRI数据，不额外过滤
-        vtkImageData* processedData = regionData;
+        // 步骤3: 缓存裁剪后的子体积，灰度值限制改变时只需重新执行阈值/网格阶段
+        intensityData = regionData;
+        intensityRange[0] = regionRange[0];
+        intensityRange[1] = regionRange[1];
+        voxelIntensityRange[0] = voxelRange[0];
+        voxelIntensityRange[1] = voxelRange[1];
+        intensityHasBackground = (region.voxelCount < regionData->GetNumberOfPoints());
         
         // 记录是否使用了灰度值限制，但不在这里应用
-        // 灰度值限制将在Marching Cubes阈值选择时考虑
+        // 灰度值限制将在等值面阈值选择时考虑
         if (useGrayValueLimits) {
-            qDebug() << "区块" << label << "将在Marching Cubes时考虑灰度值限制: [" 
+            qDebug() << "区块" << label << "将在等值面提取时考虑灰度值限制: [" 
                      << minGrayValue << ", " << maxGrayValue << "]";
         }
         
         // 步骤4: 生成表面（使用改进的多级阈值策略）
-        double* finalRange = processedData->GetScalarRange();
-        double dataRange = finalRange[1] - finalRange[0];
-        
-        if (dataRange <= 0) {
+        if (intensityRange[1] - intensityRange[0] <= 0) {
             qDebug() << "区块" << label << "处理后数据无效范围，尝试使用标签掩码";
             
             // 回退策略：使用标签掩码生成简单表面
-            auto marchingCubes = vtkSmartPointer<vtkMarchingCubes>::New();
-            marchingCubes->SetInputData(labelMask);
-            marchingCubes->SetValue(0, 0.5);
-            marchingCubes->ComputeNormalsOn();
-            marchingCubes->Update();
-            
-            vtkPolyData* polyData = marchingCubes->GetOutput();
+            vtkSmartPointer<vtkImageData> labelMask = createLabelMask(mriData, region, cropExtent);
+            vtkSmartPointer<vtkPolyData> polyData = extractLabelMaskSurface(labelMask);
             if (polyData && polyData->GetNumberOfPoints() > 0) {
                 qDebug() << "区块" << label << "使用标签掩码生成了" << polyData->GetNumberOfPoints() << "个点";
-                surfaceMapper->SetInputConnection(marchingCubes->GetOutputPort());
+                surfaceData = polyData;
             } else {
                 qDebug() << "区块" << label << "无法生成有效表面";
-                return;
+                return false;
             }
         } else {
-            qDebug() << "区块" << label << "使用MRI数据生成详细表面";
-            
-            // 创建Marching Cubes
-            auto marchingCubes = vtkSmartPointer<vtkMarchingCubes>::New();
-            marchingCubes->SetInputData(processedData);
-            marchingCubes->ComputeNormalsOn();
-            marchingCubes->ComputeGradientsOff();
-            
-            // 使用非常低的阈值来确保生成完整表面
-            double threshold;
-            
-            if (useGrayValueLimits) {
-                // 使用最小灰度值作为基准，稍微降低以确保包含所有有效数据
-                threshold = minGrayValue * 0.5;  // 使用50%的最小灰度值
-                if (threshold < finalRange[0] + 1.0) {
-                    threshold = finalRange[0] + 1.0;  // 确保阈值略高于最小值
-                }
-                qDebug() << "区块" << label << "使用灰度值阈值:" << threshold 
-                         << "(minGray=" << minGrayValue << ")";
-            } else {
-                // 不使用灰度值限制时，使用非常低的阈值
-                // 只略高于背景值，以包含所有非零数据
-                threshold = finalRange[0] + dataRange * 0.01;  // 只使用1%的范围
-                if (threshold <= finalRange[0]) {
-                    threshold = finalRange[0] + 1.0;
-                }
-                qDebug() << "区块" << label << "使用低阈值:" << threshold 
-                         << "(范围:" << finalRange[0] << "-" << finalRange[1] << ")";
+            double threshold = 0.0;
+            surfaceData = extractIntensitySurface(intensityData, minGrayValue, maxGrayValue, threshold);
+            if (!surfaceData) {
+                return false;
             }
-            
-            // 设置单一阈值
-            marchingCubes->SetValue(0, threshold);
-            marchingCubes->SetNumberOfContours(1);
-            
-            marchingCubes->Update();
-            
-            // 检查生成的表面
-            vtkPolyData* polyData = marchingCubes->GetOutput();
-            if (!polyData || polyData->GetNumberOfPoints() == 0) {
-                qDebug() << "区块" << label << "Marching Cubes未生成有效数据，尝试更低阈值";
-                
-                // 使用非常低的阈值重试
-                double minThreshold = finalRange[0] + (finalRange[1] - finalRange[0]) * 0.01;
-                marchingCubes->SetValue(0, minThreshold);
-                marchingCubes->SetNumberOfContours(1);
-                marchingCubes->Update();
-                
-                polyData = marchingCubes->GetOutput();
-                if (!polyData || polyData->GetNumberOfPoints() == 0) {
-                    qDebug() << "区块" << label << "仍无法生成表面";
-                    return;
+            surfaceThreshold = threshold;
+        }
+        
+        // 预先计算包围盒，质心在GUI线程中直接读取缓存结果
+        double bounds[6];
+        surfaceData->GetBounds(bounds);
+        
+        qDebug() << "区块" << label << "改进的MRI融合surface数据计算完成";
+        return true;
+    }
+    catch (const std::exception& e) {
+        qDebug() << "设置区块" << label << "体数据时发生错误:" << e.what();
+    }
+    catch (...) {
+        qDebug() << "设置区块" << label << "体数据时发生未知错误";
+    }
+    surfaceData = nullptr;
+    return false;
+}
+
+bool BrainRegionVolume::buildLabelSurface(vtkImageData* referenceData, const LabelRegionInfo& region)
+{
+    // 注意：此函数可能在工作线程中执行，只能读取共享的标签数据，不能修改渲染对象
+    surfaceData = nullptr;
+    
+    if (!referenceData || region.voxelIds.empty()) {
+        qDebug() << "警告: 标签数据或区块体素为空";
+        return false;
+    }
+    
+    try {
+        int dims[3];
+        referenceData->GetDimensions(dims);
+        if (region.voxelIds.back() >= referenceData->GetNumberOfPoints()) {
+            qDebug() << "区块" << label << "标签体素超出数据范围";
+            return false;
+        }
+        
+        int cropExtent[6];
+        computeCropExtent(region, dims, cropExtent);
+        vtkSmartPointer<vtkImageData> labelMask = createLabelMask(referenceData, region, cropExtent);
+        
+        vtkSmartPointer<vtkPolyData> polyData = extractLabelMaskSurface(labelMask);
+        if (!polyData || polyData->GetNumberOfPoints() == 0) {
+            qDebug() << "区块" << label << "无法从标签掩码生成有效表面";
+            return false;
+        }
+        
+        // 离散移动立方体的结果呈阶梯状，仍需要平滑
+        if (labelMeshingMethod == LABEL_MARCHING_CUBES) {
+            polyData = smoothSurface(polyData);
+        }
+        return setSurfaceData(polyData);
+    }
+    catch (const std::exception& e) {
+        qDebug() << "生成区块" << label << "标签表面时发生错误:" << e.what();
+    }
+    catch (...) {
+        qDebug() << "生成区块" << label << "标签表面时发生未知错误";
+    }
+    surfaceData = nullptr;
+    return false;
+}
+
+vtkSmartPointer<vtkPolyData> BrainRegionVolume::extractLabelMaskSurface(vtkImageData* labelMask) const
+{
+    if (labelMeshingMethod == LABEL_SURFACE_NETS) {
+        // 表面网格已在单元内做过约束松弛，不再需要多次迭代的拉普拉斯平滑
+        vtkSmartPointer<vtkPolyData> polyData = SurfaceNetsMesher::extract(labelMask, 1.0);
+        if (polyData) {
+            qDebug() << "区块" << label << "表面网格生成了" << polyData->GetNumberOfPoints() << "个点，"
+                     << polyData->GetNumberOfCells() << "个四边形";
+        }
+        return polyData;
+    }
+    
+    return IsosurfaceExtractor::extractLabel(labelMask, 1.0, isosurfaceBackend);
+}
+
+vtkSmartPointer<vtkPolyData> BrainRegionVolume::smoothSurface(vtkPolyData* polyData) const
+{
+    int iterations;
+    double relaxationFactor;
+    
+    // 根据点数调整平滑参数
+    if (polyData->GetNumberOfPoints() < 10000) {
+        // 小模型：更多迭代，更强平滑
+        iterations = 50;
+        relaxationFactor = 0.15;
+        qDebug() << "区块" << label << "应用强平滑（小模型）";
+    } else if (polyData->GetNumberOfPoints() < 50000) {
+        // 中等模型：适度平滑
+        iterations = 30;
+        relaxationFactor = 0.1;
+        qDebug() << "区块" << label << "应用中等平滑";
+    } else {
+        // 大模型：轻微平滑以保持性能
+        iterations = 15;
+        relaxationFactor = 0.05;
+        qDebug() << "区块" << label << "应用轻微平滑（大模型）";
+    }
+    
+    // 库内平滑器：边界只沿边界平滑，结束时重新计算法向（提取时的法向在平滑后已失效）
+    return MeshSmoother::smooth(polyData, iterations, relaxationFactor, smoothingMethod);
+}
+
+bool BrainRegionVolume::setSurfaceData(vtkPolyData* polyData)
+{
+    if (!polyData || polyData->GetNumberOfPoints() == 0) {
+        qDebug() << "区块" << label << "无法生成有效表面";
+        surfaceData = nullptr;
+        return false;
+    }
+    
+    surfaceData = polyData;
+    
+    // 预先计算包围盒，质心在GUI线程中直接读取缓存结果
+    double bounds[6];
+    surfaceData->GetBounds(bounds);
+    
+    qDebug() << "区块" << label << "表面包含" << polyData->GetNumberOfPoints() << "个点，"
+             << polyData->GetNumberOfCells() << "个面";
+    return true;
+}
+
+double BrainRegionVolume::computeSurfaceThreshold(double minGrayValue, double maxGrayValue) const
+{
+    const double dataRange = intensityRange[1] - intensityRange[0];
+    double threshold;
+    
+    if (minGrayValue < maxGrayValue) {
+        // 使用最小灰度值作为基准，稍微降低以确保包含所有有效数据
+        threshold = minGrayValue * 0.5;  // 使用50%的最小灰度值
+        if (threshold < intensityRange[0] + 1.0) {
+            threshold = intensityRange[0] + 1.0;  // 确保阈值略高于最小值
+        }
+    } else {
+        // 不使用灰度值限制时，使用非常低的阈值
+        // 只略高于背景值，以包含所有非零数据
+        threshold = intensityRange[0] + dataRange * 0.01;  // 只使用1%的范围
+        if (threshold <= intensityRange[0]) {
+            threshold = intensityRange[0] + 1.0;
+        }
+    }
+    return threshold;
+}
+
+vtkSmartPointer<vtkPolyData> BrainRegionVolume::extractIntensitySurface(vtkImageData* source, double minGrayValue,
+                                                                      double maxGrayValue, double& usedThreshold) const
+{
+    qDebug() << "区块" << label << "使用MRI数据生成详细表面";
+    
+    // 使用非常低的阈值来确保生成完整表面
+    const double threshold = computeSurfaceThreshold(minGrayValue, maxGrayValue);
+    usedThreshold = threshold;
+    if (minGrayValue < maxGrayValue) {
+        qDebug() << "区块" << label << "使用灰度值阈值:" << threshold 
+                 << "(minGray=" << minGrayValue << ")";
+    } else {
+        qDebug() << "区块" << label << "使用低阈值:" << threshold 
+                 << "(范围:" << intensityRange[0] << "-" << intensityRange[1] << ")";
+    }
+    
+    // 使用单一阈值提取等值面
+    vtkSmartPointer<vtkPolyData> polyData =
+        IsosurfaceExtractor::extract(source, threshold, isosurfaceBackend);
+    
+    // 检查生成的表面
+    if (!polyData || polyData->GetNumberOfPoints() == 0) {
+        qDebug() << "区块" << label << "等值面未生成有效数据，尝试更低阈值";
+        
+        // 使用非常低的阈值重试
+        double minThreshold = intensityRange[0] + (intensityRange[1] - intensityRange[0]) * 0.01;
+        polyData = IsosurfaceExtractor::extract(source, minThreshold, isosurfaceBackend);
+        if (!polyData || polyData->GetNumberOfPoints() == 0) {
+            qDebug() << "区块" << label << "仍无法生成表面";
+            return nullptr;
+        }
+        usedThreshold = minThreshold;
+    }
+    
+    qDebug() << "区块" << label << IsosurfaceExtractor::backendName(isosurfaceBackend) << "生成了" 
+             << polyData->GetNumberOfPoints() << "个点，"
+             << polyData->GetNumberOfCells() << "个面";
+    
+    // 应用平滑处理来填充小孔并改善表面质量
+    return smoothSurface(polyData);
+}
+
+bool BrainRegionVolume::isSurfaceAffectedByGrayValueLimits(double minGrayValue, double maxGrayValue,
+                                                           int sampleFactor) const
+{
+    // 没有缓存（标签网格模式）或数据无有效范围（使用标签掩码回退）时，表面与灰度值限制无关
+    if (!intensityData || intensityRange[1] - intensityRange[0] <= 0) return false;
+    
+    // 分辨率不同（交互期间的粗网格需要细化）时一定重新提取
+    if (sampleFactor != surfaceSampleFactor) return true;
+    
+    // 与当前表面实际使用的等值比较，而不是上一次记录的限制
+    const double currentThreshold = surfaceThreshold;
+    const double newThreshold = computeSurfaceThreshold(minGrayValue, maxGrayValue);
+    if (currentThreshold == newThreshold) return false;
+    
+    // 阈值从一侧移到另一侧时，只有取值落在两者之间的体素会改变内外分类；
+    // 子体积中的取值只有区块体素的范围和（包围盒内区块外的）背景0。
+    // 分类不变时插值顶点的移动被忽略（近似），见头文件说明
+    const double low = std::min(currentThreshold, newThreshold);
+    const double high = std::max(currentThreshold, newThreshold);
+    const bool crossesRegionVoxels = (low <= voxelIntensityRange[1] && high > voxelIntensityRange[0]);
+    const bool crossesBackground = (intensityHasBackground && low <= 0.0 && high > 0.0);
+    return crossesRegionVoxels || crossesBackground;
+}
+
+bool BrainRegionVolume::rebuildSurface(double minGrayValue, double maxGrayValue, int sampleFactor)
+{
+    // 注意：此函数在工作线程中执行，只读取缓存的子体积；GUI线程等待期间不会访问surfaceData。
+    // 新的限制只在提取成功后记录，失败时保留与现有表面一致的限制
+    if (!intensityData) return false;
+    
+    try {
+        // 粗分辨率子体积按需逐级降采样并缓存，连续拖动滑块时重复使用
+        vtkImageData* source = intensityData;
+        if (sampleFactor > 1) {
+            if (!coarseIntensityData || coarseSampleFactor != sampleFactor) {
+                vtkSmartPointer<vtkImageData> coarse = intensityData;
+                int factor = 1;
+                while (factor < sampleFactor && coarse) {
+                    coarse = MriPyramid::downsample(coarse);
+                    factor *= 2;
                 }
+                coarseIntensityData = coarse;
+                coarseSampleFactor = sampleFactor;
             }
-            
-            qDebug() << "区块" << label << "Marching Cubes生成了" 
-                     << polyData->GetNumberOfPoints() << "个点，"
-                     << polyData->GetNumberOfCells() << "个面";
-            
-            // 应用平滑处理来填充小孔并改善表面质量
-            auto smoother = vtkSmartPointer<vtkSmoothPolyDataFilter>::New();
-            smoother->SetInputConnection(marchingCubes->GetOutputPort());
-            
-            // 根据点数调整平滑参数
-            if (polyData->GetNumberOfPoints() < 10000) {
-                // 小模型：更多迭代，更强平滑
-                smoother->SetNumberOfIterations(50);
-                smoother->SetRelaxationFactor(0.15);
-                qDebug() << "区块" << label << "应用强平滑（小模型）";
-            } else if (polyData->GetNumberOfPoints() < 50000) {
-                // 中等模型：适度平滑
-                smoother->SetNumberOfIterations(30);
-                smoother->SetRelaxationFactor(0.1);
-                qDebug() << "区块" << label << "应用中等平滑";
+            if (coarseIntensityData) {
+                source = coarseIntensityData;
             } else {
-                // 大模型：轻微平滑以保持性能
-                smoother->SetNumberOfIterations(15);
-                smoother->SetRelaxationFactor(0.05);
-                qDebug() << "区块" << label << "应用轻微平滑（大模型）";
+                sampleFactor = 1;
             }
-            
-            smoother->FeatureEdgeSmoothingOff();  // 关闭特征边平滑，让表面更连续
-            smoother->BoundarySmoothingOn();      // 平滑边界
-            smoother->Update();
-            
-            surfaceMapper->SetInputConnection(smoother->GetOutputPort());
         }
         
-        // 计算质心（安全检查）
-        try {
-            calculateCentroid();
-            qDebug() << "区块" << label << "质心计算完成";
-        } catch (const std::exception& e) {
-            qDebug() << "区块" << label << "质心计算失败:" << e.what();
-            centroid = QVector3D(0, 0, 0); // 设置默认质心
+        double threshold = 0.0;
+        vtkSmartPointer<vtkPolyData> polyData = extractIntensitySurface(source, minGrayValue, maxGrayValue,
+                                                                        threshold);
+        if (!polyData) {
+            // 新阈值下无法生成表面时保留原有几何
+            return false;
         }
+        surfaceData = polyData;
+        surfaceSampleFactor = sampleFactor;
+        surfaceThreshold = threshold;
+        setGrayValueLimits(minGrayValue, maxGrayValue);
         
-        qDebug() << "区块" << label << "改进的MRI融合surface数据设置完成";
+        // 预先计算包围盒，质心在GUI线程中直接读取缓存结果
+        double bounds[6];
+        surfaceData->GetBounds(bounds);
+        return true;
+    }
+    catch (const std::exception& e) {
+        qDebug() << "重新生成区块" << label << "表面时发生错误:" << e.what();
+    }
+    catch (...) {
+        qDebug() << "重新生成区块" << label << "表面时发生未知错误";
+    }
+    return false;
+}
 
+void BrainRegionVolume::applySurface()
+{
+    if (!surfaceData) {
+        qDebug() << "区块" << label << "没有可用的surface数据";
+        return;
+    }
+    
+    surfaceMapper->SetInputData(surfaceData);
+    
+    // 表面重建后旧的细节层次失效
+    ++surfaceRevision;
+    lodMappers.clear();
+    triangleCounts.assign(1, countTriangles(surfaceData));
+    levelOfDetail = 0;
+    surfaceActor->SetMapper(surfaceMapper);
+    
+    // 计算质心（安全检查）
+    try {
+        calculateCentroid();
+        qDebug() << "区块" << label << "质心计算完成";
+    } catch (const std::exception& e) {
+        qDebug() << "区块" << label << "质心计算失败:" << e.what();
+        centroid = QVector3D(0, 0, 0); // 设置默认质心
+    }
+    
+    qDebug() << "区块" << label << "surface数据设置完成";
+}
+
+void BrainRegionVolume::buildLevelsOfDetail(vtkPolyData* source, int revision)
+{
+    // 注意：此函数在工作线程中执行，结果在锁内交给pendingLevels，GUI线程在applyLevelsOfDetail中读取
+    if (!source || source->GetNumberOfPolys() == 0) return;
+    
+    std::vector<vtkSmartPointer<vtkPolyData>> levels;
+    
+    try {
+        // 二次误差抽取只接受三角形（表面网格输出的是四边形）
+        vtkSmartPointer<vtkPolyData> current = source;
+        if (countTriangles(source) != source->GetNumberOfPolys()) {
+            auto triangleFilter = vtkSmartPointer<vtkTriangleFilter>::New();
+            triangleFilter->SetInputData(source);
+            triangleFilter->PassVertsOff();
+            triangleFilter->PassLinesOff();
+            triangleFilter->Update();
+            current = triangleFilter->GetOutput();
+        }
+        
+        if (countTriangles(current) < kMinLevelOfDetailTriangles) {
+            return;
+        }
+        
+        double previousFraction = 1.0;
+        for (double fraction : kLevelOfDetailFractions) {
+            auto decimation = vtkSmartPointer<vtkQuadricDecimation>::New();
+            decimation->SetInputData(current);
+            decimation->SetTargetReduction(1.0 - fraction / previousFraction);
+            
+            // 抽取后顶点位置改变，重新计算法向（区块表面方向一致，不需要一致性检查）
+            auto normals = vtkSmartPointer<vtkPolyDataNormals>::New();
+            normals->SetInputConnection(decimation->GetOutputPort());
+            normals->SplittingOff();
+            normals->ConsistencyOff();
+            normals->ComputeCellNormalsOff();
+            normals->Update();
+            
+            vtkSmartPointer<vtkPolyData> level = normals->GetOutput();
+            if (!level || level->GetNumberOfPolys() == 0) break;
+            
+            levels.push_back(level);
+            current = level;
+            previousFraction = fraction;
+        }
     }
     catch (const std::exception& e) {
-        qDebug() << "设置区块" << label << "体数据时发生错误:" << e.what();
+        qDebug() << "生成区块" << label << "细节层次时发生错误:" << e.what();
+        return;
     }
     catch (...) {
-        qDebug() << "设置区块" << label << "体数据时发生未知错误";
+        qDebug() << "生成区块" << label << "细节层次时发生未知错误";
+        return;
+    }
+    
+    QMutexLocker locker(&pendingLevelsMutex);
+    pendingLevels.swap(levels);
+    pendingLevelsRevision = revision;
+}
+
+void BrainRegionVolume::applyLevelsOfDetail()
+{
+    std::vector<vtkSmartPointer<vtkPolyData>> levels;
+    {
+        QMutexLocker locker(&pendingLevelsMutex);
+        // 生成期间表面已被替换（例如灰度值限制改变后重新提取）时丢弃过期的层次
+        if (pendingLevelsRevision != surfaceRevision) return;
+        levels.swap(pendingLevels);
+    }
+    if (levels.empty()) return;
+    
+    setLevelOfDetail(0);
+    lodMappers.clear();
+    triangleCounts.resize(1);
+    for (const auto& level : levels) {
+        auto mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+        mapper->SetInputData(level);
+        mapper->SetScalarVisibility(false); // 与surfaceMapper一致，只使用actor颜色
+        lodMappers.push_back(mapper);
+        triangleCounts.push_back(countTriangles(level));
+    }
+    
+    qDebug() << "区块" << label << "细节层次生成完成，各层三角形数:" << triangleCounts;
+}
+
+void BrainRegionVolume::setLevelOfDetail(int level)
+{
+    level = std::max(0, std::min(level, static_cast<int>(lodMappers.size())));
+    if (level == levelOfDetail) return;
+    
+    levelOfDetail = level;
+    surfaceActor->SetMapper(level == 0 ? surfaceMapper.GetPointer() : lodMappers[level - 1].GetPointer());
+}
+
+vtkIdType BrainRegionVolume::getTriangleCount(int level) const
+{
+    if (level < 0 || level >= static_cast<int>(triangleCounts.size())) return 0;
+    return triangleCounts[level];
+}
+
+double BrainRegionVolume::projectedScreenSize(vtkRenderer* renderer) const
+{
+    if (!renderer || !surfaceData) return 0.0;
+    
+    double bounds[6];
+    surfaceData->GetBounds(bounds);
+    const double center[3] = { (bounds[0] + bounds[1]) / 2.0,
+                               (bounds[2] + bounds[3]) / 2.0,
+                               (bounds[4] + bounds[5]) / 2.0 };
+    const double dx = bounds[1] - bounds[0];
+    const double dy = bounds[3] - bounds[2];
+    const double dz = bounds[5] - bounds[4];
+    const double radius = 0.5 * std::sqrt(dx * dx + dy * dy + dz * dz);
+    
+    const int* viewportSize = renderer->GetSize();
+    const double viewportHeight = viewportSize[1];
+    vtkCamera* camera = renderer->GetActiveCamera();
+    
+    double visibleHeight;
+    if (camera->GetParallelProjection()) {
+        visibleHeight = 2.0 * camera->GetParallelScale();
+    } else {
+        const double* position = camera->GetPosition();
+        const double distance = std::sqrt((center[0] - position[0]) * (center[0] - position[0]) +
+                                          (center[1] - position[1]) * (center[1] - position[1]) +
+                                          (center[2] - position[2]) * (center[2] - position[2]));
+        if (distance <= radius) {
+            // 相机在包围球内，按铺满视口处理
+            return viewportHeight;
+        }
+        visibleHeight = 2.0 * distance * std::tan(vtkMath::RadiansFromDegrees(camera->GetViewAngle()) / 2.0);
     }
+    if (visibleHeight <= 0.0) return viewportHeight;
+    
+    return 2.0 * radius / visibleHeight * viewportHeight;
 }
 
 void BrainRegionVolume::calculateCentroid()
@@ -342,6 +805,21 @@ void BrainRegionVolume::setSampleDistance(double distance)
     qDebug() << "Surface渲染不支持setSampleDistance";
 }
 
+void BrainRegionVolume::setIsosurfaceBackend(IsosurfaceExtractor::Backend backend)
+{
+    isosurfaceBackend = backend;
+}
+
+void BrainRegionVolume::setLabelMeshingMethod(LabelMeshingMethod method)
+{
+    labelMeshingMethod = method;
+}
+
+void BrainRegionVolume::setSmoothingMethod(MeshSmoother::Method method)
+{
+    smoothingMethod = method;
+}
+
 void BrainRegionVolume::setGrayValueLimits(double minGrayValue, double maxGrayValue)
 {
     this->minGrayValue = minGrayValue;
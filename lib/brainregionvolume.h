@@ -4,20 +4,37 @@
 #include <QObject>
 #include <QColor>
 #include <QVector3D>
+#include <QMutex>
 
 // VTK头文件
 #include <vtkSmartPointer.h>
 #include <vtkActor.h>
 #include <vtkImageData.h>
+#include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkProperty.h>
 #include <vtkCamera.h>
 
+#include <vector>
+
+#include "isosurfaceextractor.h"
+#include "meshsmoother.h"
+
+// 前向声明
+struct LabelRegionInfo;
+class vtkRenderer;
+
 class BrainRegionVolume : public QObject
 {
     Q_OBJECT
 
 public:
+    // 标签掩码的网格生成方法
+    enum LabelMeshingMethod {
+        LABEL_MARCHING_CUBES,   // 离散移动立方体 + 网格平滑
+        LABEL_SURFACE_NETS      // 表面网格（surface nets），内置约束松弛，不再额外平滑
+    };
+
     explicit BrainRegionVolume(int label, QObject *parent = nullptr);
     ~BrainRegionVolume();
 
@@ -32,10 +49,34 @@ public:
     vtkActor* getCentroidSphere() const { return centroidSphere; }
 
     // 数据设置
-    void setVolumeData(vtkImageData* mriData, vtkImageData* maskData);
-    void setVolumeData(vtkImageData* mriData, vtkImageData* maskData, double minGrayValue, double maxGrayValue);
+    void setVolumeData(vtkImageData* mriData, const LabelRegionInfo& region);
+    void setVolumeData(vtkImageData* mriData, const LabelRegionInfo& region, double minGrayValue, double maxGrayValue);
     void calculateCentroid();
 
+    // 分阶段构建：buildSurface只计算几何（掩码、网格、平滑、包围盒），可在工作线程中并行执行；
+    // applySurface把结果交给surfaceMapper并更新质心，必须在GUI线程中调用
+    bool buildSurface(vtkImageData* mriData, const LabelRegionInfo& region, double minGrayValue, double maxGrayValue);
+    void applySurface();
+    // 只根据标签掩码生成表面（不需要MRI），referenceData提供维度、原点和间距，同样可在工作线程中执行
+    bool buildLabelSurface(vtkImageData* referenceData, const LabelRegionInfo& region);
+    // 直接设置已生成的表面（例如多标签共享交界面网格），同样可在工作线程中调用
+    bool setSurfaceData(vtkPolyData* polyData);
+    vtkPolyData* getSurfaceData() const { return surfaceData; }
+
+    // 细节层次：buildLevelsOfDetail在工作线程中用二次误差抽取逐级简化source；
+    // applyLevelsOfDetail回到GUI线程为每个层次创建mapper。层次0始终是surfaceMapper（完整网格），
+    // 切换层次只替换surfaceActor的mapper，已上传的显存缓冲不会重建
+    // revision为生成时的表面版本，表面在此期间被替换时结果会被丢弃
+    void buildLevelsOfDetail(vtkPolyData* source, int revision);
+    int getSurfaceRevision() const { return surfaceRevision; }
+    Q_INVOKABLE void applyLevelsOfDetail();
+    int getLevelOfDetailCount() const { return static_cast<int>(triangleCounts.size()); }
+    int getLevelOfDetail() const { return levelOfDetail; }
+    void setLevelOfDetail(int level);
+    vtkIdType getTriangleCount(int level) const;
+    // 包围球在视口中的投影直径（像素）
+    double projectedScreenSize(vtkRenderer* renderer) const;
+
     // 显示控制
     void updateVisibility(bool visible);
     void updateColor(const QColor& color);
@@ -49,6 +90,30 @@ public:
     
     // 灰度值限制参数
     void setGrayValueLimits(double minGrayValue, double maxGrayValue);
+    
+    // 增量更新：buildSurface缓存了区块的裁剪MRI子体积，灰度值限制改变时只重新执行阈值/网格阶段。
+    // isSurfaceAffectedByGrayValueLimits判断新限制是否会改变体素的内外分类。这是近似判断：
+    // 分类不变时被等值面穿过的棱上的插值顶点仍会随阈值移动（不超过一个体素），跳过重新提取时
+    // 这些顶点保持旧阈值下的位置。rebuildSurface可在工作线程中执行，成功后才记录新的限制，
+    // 之后在GUI线程中调用applySurface替换到现有actor。
+    // sampleFactor大于1时在缩小sampleFactor倍的子体积上提取（交互期间的粗网格），之后再以1细化
+    bool hasIntensityData() const { return intensityData != nullptr; }
+    vtkIdType getIntensityVoxelCount() const { return intensityData ? intensityData->GetNumberOfPoints() : 0; }
+    bool isSurfaceAffectedByGrayValueLimits(double minGrayValue, double maxGrayValue, int sampleFactor = 1) const;
+    bool rebuildSurface(double minGrayValue, double maxGrayValue, int sampleFactor = 1);
+    int getSurfaceSampleFactor() const { return surfaceSampleFactor; }
+    
+    // 等值面提取后端
+    void setIsosurfaceBackend(IsosurfaceExtractor::Backend backend);
+    IsosurfaceExtractor::Backend getIsosurfaceBackend() const { return isosurfaceBackend; }
+    
+    // 标签掩码网格生成方法
+    void setLabelMeshingMethod(LabelMeshingMethod method);
+    LabelMeshingMethod getLabelMeshingMethod() const { return labelMeshingMethod; }
+    
+    // 表面平滑方法
+    void setSmoothingMethod(MeshSmoother::Method method);
+    MeshSmoother::Method getSmoothingMethod() const { return smoothingMethod; }
 
 signals:
     void visibilityChanged(int label, bool visible);
@@ -65,11 +130,34 @@ private:
     vtkSmartPointer<vtkActor> surfaceActor;
     vtkSmartPointer<vtkPolyDataMapper> surfaceMapper;
     vtkSmartPointer<vtkActor> centroidSphere;
+    vtkSmartPointer<vtkPolyData> surfaceData;
     
     // 灰度值限制参数
     double minGrayValue;
     double maxGrayValue;
     bool useGrayValueLimits;
+    IsosurfaceExtractor::Backend isosurfaceBackend;
+    LabelMeshingMethod labelMeshingMethod;
+    MeshSmoother::Method smoothingMethod;
+    
+    // 细节层次
+    std::vector<vtkSmartPointer<vtkPolyData>> pendingLevels;       // 工作线程生成、尚未交给mapper的层次
+    QMutex pendingLevelsMutex;
+    int surfaceRevision;                                           // applySurface时递增
+    int pendingLevelsRevision;
+    std::vector<vtkSmartPointer<vtkPolyDataMapper>> lodMappers;    // 层次1..n的mapper
+    std::vector<vtkIdType> triangleCounts;                         // 各层次三角形数，下标0为完整网格
+    int levelOfDetail;
+    
+    // 缓存的区块裁剪MRI子体积（区块外为0）及其取值范围
+    vtkSmartPointer<vtkImageData> intensityData;
+    double intensityRange[2];          // 包含背景0的子体积范围
+    double voxelIntensityRange[2];     // 只统计区块自身体素的范围
+    bool intensityHasBackground;       // 子体积中是否存在区块外的背景体素
+    vtkSmartPointer<vtkImageData> coarseIntensityData;   // 交互期间使用的降采样子体积
+    int coarseSampleFactor;
+    int surfaceSampleFactor;           // 当前表面所用子体积的缩小倍数，1为原始分辨率
+    double surfaceThreshold;           // 当前表面实际使用的等值，提取成功后才更新
 
     // 私有方法
     void initializeSurfaceActor();
@@ -77,6 +165,18 @@ private:
     void setupSurfaceProperty();
     void updateSurfaceColor();
     void updateSurfaceOpacity();
+    void computeCropExtent(const LabelRegionInfo& region, const int dims[3], int cropExtent[6]) const;
+    vtkSmartPointer<vtkImageData> createCroppedImage(vtkImageData* referenceData,
+                                                     const int cropExtent[6], int scalarType) const;
+    vtkSmartPointer<vtkImageData> createLabelMask(vtkImageData* referenceData,
+                                                  const LabelRegionInfo& region,
+                                                  const int cropExtent[6]) const;
+    vtkSmartPointer<vtkPolyData> extractLabelMaskSurface(vtkImageData* labelMask) const;
+    vtkSmartPointer<vtkPolyData> smoothSurface(vtkPolyData* polyData) const;
+    double computeSurfaceThreshold(double minGrayValue, double maxGrayValue) const;
+    // 按给定限制提取灰度等值面，usedThreshold返回实际使用的等值（可能回退到更低的阈值）
+    vtkSmartPointer<vtkPolyData> extractIntensitySurface(vtkImageData* source, double minGrayValue,
+                                                         double maxGrayValue, double& usedThreshold) const;
 };
 
 #endif // BRAINREGIONVOLUME_H 
\ No newline at end of file
@@ -0,0 +1,349 @@
+#include "brickindex.h"
+#include "parallelfor.h"
+#include "runlengthlabelvolume.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <limits>
+
+// VTK头文件
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+
+namespace {
+
+const int kBrickShift = BrickIndex::kBrickShift;
+
+// 块内出现的值通常只有1～3个，线性查找
+inline void addValue(std::vector<int>& values, int value)
+{
+    if (std::find(values.begin(), values.end(), value) == values.end()) values.push_back(value);
+}
+
+// 按块编号顺序写出一层块的标签列表，并清空以便下一层使用
+void flushBrickLayer(std::vector<std::vector<int>>& layer, std::vector<int>& counts, std::vector<int>& labels)
+{
+    for (auto& values : layer) {
+        std::sort(values.begin(), values.end());
+        counts.push_back(static_cast<int>(values.size()));
+        labels.insert(labels.end(), values.begin(), values.end());
+        values.clear();
+    }
+}
+
+// 统计块层[bzBegin, bzEnd)的标签；块内相同值的连续段只登记一次
+template <typename T>
+void collectBrickLabels(const T* data, int numComponents, const int dims[3], const int brickDims[3],
+                        int bzBegin, int bzEnd, std::vector<int>& counts, std::vector<int>& labels)
+{
+    std::vector<std::vector<int>> layer(static_cast<size_t>(brickDims[0]) * brickDims[1]);
+    for (int bz = bzBegin; bz < bzEnd; ++bz) {
+        const int zEnd = std::min(dims[2], (bz + 1) << kBrickShift);
+        for (int z = bz << kBrickShift; z < zEnd; ++z) {
+            for (int y = 0; y < dims[1]; ++y) {
+                const T* row = data + (static_cast<vtkIdType>(z) * dims[1] + y) * dims[0] * numComponents;
+                std::vector<int>* rowBricks = &layer[static_cast<size_t>(y >> kBrickShift) * brickDims[0]];
+                int x = 0;
+                while (x < dims[0]) {
+                    const int value = std::max(0, static_cast<int>(row[static_cast<vtkIdType>(x) * numComponents]));
+                    const int brickEnd = std::min(dims[0], ((x >> kBrickShift) + 1) << kBrickShift);
+                    int runEnd = x + 1;
+                    while (runEnd < brickEnd &&
+                           std::max(0, static_cast<int>(row[static_cast<vtkIdType>(runEnd) * numComponents])) == value) {
+                        ++runEnd;
+                    }
+                    addValue(rowBricks[x >> kBrickShift], value);
+                    x = runEnd;
+                }
+            }
+        }
+        flushBrickLayer(layer, counts, labels);
+    }
+}
+
+// 游程编码的版本：游程按块边界切开；块内未被正值游程覆盖的体素为背景
+void collectRunBrickLabels(const RunLengthLabelVolume& volume, const int brickDims[3], int bzBegin, int bzEnd,
+                           std::vector<int>& counts, std::vector<int>& labels)
+{
+    const int* dims = volume.getDimensions();
+    const size_t layerSize = static_cast<size_t>(brickDims[0]) * brickDims[1];
+    std::vector<std::vector<int>> layer(layerSize);
+    std::vector<vtkIdType> covered(layerSize);
+
+    for (int bz = bzBegin; bz < bzEnd; ++bz) {
+        std::fill(covered.begin(), covered.end(), 0);
+        const int zBegin = bz << kBrickShift;
+        const int zEnd = std::min(dims[2], zBegin + BrickIndex::kBrickSize);
+        for (int z = zBegin; z < zEnd; ++z) {
+            for (int y = 0; y < dims[1]; ++y) {
+                const size_t rowBricks = static_cast<size_t>(y >> kBrickShift) * brickDims[0];
+                const LabelRun* last = volume.rowEnd(y, z);
+                for (const LabelRun* run = volume.rowBegin(y, z); run != last; ++run) {
+                    if (run->value <= 0) continue;
+                    const int runEnd = run->x + run->length;
+                    for (int x = run->x; x < runEnd;) {
+                        const int bx = x >> kBrickShift;
+                        const int segmentEnd = std::min(runEnd, (bx + 1) << kBrickShift);
+                        addValue(layer[rowBricks + bx], run->value);
+                        covered[rowBricks + bx] += segmentEnd - x;
+                        x = segmentEnd;
+                    }
+                }
+            }
+        }
+
+        for (int by = 0; by < brickDims[1]; ++by) {
+            for (int bx = 0; bx < brickDims[0]; ++bx) {
+                const vtkIdType width = std::min(dims[0], (bx + 1) << kBrickShift) - (bx << kBrickShift);
+                const vtkIdType height = std::min(dims[1], (by + 1) << kBrickShift) - (by << kBrickShift);
+                const size_t brick = static_cast<size_t>(by) * brickDims[0] + bx;
+                if (covered[brick] < width * height * (zEnd - zBegin)) addValue(layer[brick], 0);
+            }
+        }
+        flushBrickLayer(layer, counts, labels);
+    }
+}
+
+// 统计块层[bzBegin, bzEnd)的灰度范围，直接写入该层在输出数组中的位置
+template <typename T>
+void collectBrickRanges(const T* data, int numComponents, const int dims[3], const int brickDims[3],
+                        int bzBegin, int bzEnd, double* minValues, double* maxValues)
+{
+    const size_t layerSize = static_cast<size_t>(brickDims[0]) * brickDims[1];
+    for (int bz = bzBegin; bz < bzEnd; ++bz) {
+        double* layerMin = minValues + bz * layerSize;
+        double* layerMax = maxValues + bz * layerSize;
+        std::fill(layerMin, layerMin + layerSize, std::numeric_limits<double>::max());
+        std::fill(layerMax, layerMax + layerSize, std::numeric_limits<double>::lowest());
+
+        const int zEnd = std::min(dims[2], (bz + 1) << kBrickShift);
+        for (int z = bz << kBrickShift; z < zEnd; ++z) {
+            for (int y = 0; y < dims[1]; ++y) {
+                const T* row = data + (static_cast<vtkIdType>(z) * dims[1] + y) * dims[0] * numComponents;
+                const size_t rowBricks = static_cast<size_t>(y >> kBrickShift) * brickDims[0];
+                for (int bx = 0; bx < brickDims[0]; ++bx) {
+                    const int xEnd = std::min(dims[0], (bx + 1) << kBrickShift);
+                    T low = row[static_cast<vtkIdType>(bx << kBrickShift) * numComponents];
+                    T high = low;
+                    for (int x = (bx << kBrickShift) + 1; x < xEnd; ++x) {
+                        const T value = row[static_cast<vtkIdType>(x) * numComponents];
+                        low = std::min(low, value);
+                        high = std::max(high, value);
+                    }
+                    layerMin[rowBricks + bx] = std::min(layerMin[rowBricks + bx], static_cast<double>(low));
+                    layerMax[rowBricks + bx] = std::max(layerMax[rowBricks + bx], static_cast<double>(high));
+                }
+            }
+        }
+    }
+}
+
+// 按块层并行统计标签，各块的结果按块编号顺序拼接为CSR列表
+template <typename Collect>
+void buildLabelLists(const int brickDims[3], std::vector<int>& offsets, std::vector<int>& labels, Collect collect)
+{
+    const int chunks = ParallelFor::chunkCount(0, brickDims[2], 1);
+    std::vector<std::vector<int>> chunkCounts(chunks);
+    std::vector<std::vector<int>> chunkLabels(chunks);
+    ParallelFor::parallelForChunks(0, brickDims[2], chunks, [&](int chunk, int bzBegin, int bzEnd) {
+        collect(bzBegin, bzEnd, chunkCounts[chunk], chunkLabels[chunk]);
+    });
+
+    offsets.assign(1, 0);
+    labels.clear();
+    for (int chunk = 0; chunk < chunks; ++chunk) {
+        for (int count : chunkCounts[chunk]) {
+            offsets.push_back(offsets.back() + count);
+        }
+        labels.insert(labels.end(), chunkLabels[chunk].begin(), chunkLabels[chunk].end());
+    }
+}
+
+} // namespace
+
+BrickIndex::BrickIndex()
+{
+    dimensions[0] = dimensions[1] = dimensions[2] = 0;
+    brickDimensions[0] = brickDimensions[1] = brickDimensions[2] = 0;
+}
+
+void BrickIndex::setDimensions(const int dims[3])
+{
+    for (int axis = 0; axis < 3; ++axis) {
+        dimensions[axis] = dims[axis];
+        brickDimensions[axis] = (dims[axis] + kBrickSize - 1) >> kBrickShift;
+    }
+}
+
+bool BrickIndex::buildLabels(vtkImageData* labelImage)
+{
+    clear();
+    if (!labelImage) return false;
+    vtkDataArray* scalars = labelImage->GetPointData()->GetScalars();
+    if (!scalars) return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    int dims[3];
+    labelImage->GetDimensions(dims);
+    setDimensions(dims);
+    const int numComponents = scalars->GetNumberOfComponents();
+    const void* scalarPointer = scalars->GetVoidPointer(0);
+
+    switch (scalars->GetDataType()) {
+        vtkTemplateMacro(
+            buildLabelLists(brickDimensions, labelOffsets, brickLabels,
+                            [&](int bzBegin, int bzEnd, std::vector<int>& counts, std::vector<int>& labels) {
+                                collectBrickLabels(static_cast<const VTK_TT*>(scalarPointer), numComponents, dims,
+                                                   brickDimensions, bzBegin, bzEnd, counts, labels);
+                            }));
+    default:
+        qDebug() << "块索引: 不支持的标签标量类型" << scalars->GetDataType();
+        clear();
+        return false;
+    }
+
+    qDebug() << "标签块索引:" << getBrickCount() << "个块，平均每块"
+             << static_cast<double>(brickLabels.size()) / std::max(1, getBrickCount()) << "个值，耗时:"
+             << timer.elapsed() << "ms";
+    return true;
+}
+
+bool BrickIndex::buildLabels(const RunLengthLabelVolume& labelVolume)
+{
+    clear();
+    if (!labelVolume.isValid()) return false;
+
+    setDimensions(labelVolume.getDimensions());
+    buildLabelLists(brickDimensions, labelOffsets, brickLabels,
+                    [&](int bzBegin, int bzEnd, std::vector<int>& counts, std::vector<int>& labels) {
+                        collectRunBrickLabels(labelVolume, brickDimensions, bzBegin, bzEnd, counts, labels);
+                    });
+    return true;
+}
+
+bool BrickIndex::buildRanges(vtkImageData* image)
+{
+    clear();
+    if (!image) return false;
+    vtkDataArray* scalars = image->GetPointData()->GetScalars();
+    if (!scalars) return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    int dims[3];
+    image->GetDimensions(dims);
+    setDimensions(dims);
+    minValues.resize(static_cast<size_t>(getBrickCount()));
+    maxValues.resize(static_cast<size_t>(getBrickCount()));
+    const int numComponents = scalars->GetNumberOfComponents();
+    const void* scalarPointer = scalars->GetVoidPointer(0);
+
+    switch (scalars->GetDataType()) {
+        vtkTemplateMacro(
+            ParallelFor::parallelFor(0, brickDimensions[2], 1, [&](int bzBegin, int bzEnd) {
+                collectBrickRanges(static_cast<const VTK_TT*>(scalarPointer), numComponents, dims, brickDimensions,
+                                   bzBegin, bzEnd, minValues.data(), maxValues.data());
+            }));
+    default:
+        qDebug() << "块索引: 不支持的灰度标量类型" << scalars->GetDataType();
+        clear();
+        return false;
+    }
+
+    qDebug() << "灰度块索引:" << getBrickCount() << "个块，耗时:" << timer.elapsed() << "ms";
+    return true;
+}
+
+void BrickIndex::clear()
+{
+    dimensions[0] = dimensions[1] = dimensions[2] = 0;
+    brickDimensions[0] = brickDimensions[1] = brickDimensions[2] = 0;
+    labelOffsets.clear();
+    brickLabels.clear();
+    minValues.clear();
+    maxValues.clear();
+}
+
+bool BrickIndex::matches(vtkImageData* image) const
+{
+    if (!image) return false;
+    int dims[3];
+    image->GetDimensions(dims);
+    return dims[0] == dimensions[0] && dims[1] == dimensions[1] && dims[2] == dimensions[2];
+}
+
+void BrickIndex::getBrickExtent(int brick, int extent[6]) const
+{
+    const int brickXY = brickDimensions[0] * brickDimensions[1];
+    const int coordinates[3] = {brick % brickDimensions[0], (brick % brickXY) / brickDimensions[0], brick / brickXY};
+    for (int axis = 0; axis < 3; ++axis) {
+        extent[2 * axis] = coordinates[axis] << kBrickShift;
+        extent[2 * axis + 1] = std::min(dimensions[axis], (coordinates[axis] + 1) << kBrickShift) - 1;
+    }
+}
+
+bool BrickIndex::containsLabel(int brick, int value) const
+{
+    return std::binary_search(labelsBegin(brick), labelsEnd(brick), value);
+}
+
+bool BrickIndex::isBackgroundOnly(int brick) const
+{
+    return labelsEnd(brick) - labelsBegin(brick) == 1 && *labelsBegin(brick) == 0;
+}
+
+bool BrickIndex::isUniform(int brick, int* value) const
+{
+    if (labelsEnd(brick) - labelsBegin(brick) != 1) return false;
+    if (value) *value = *labelsBegin(brick);
+    return true;
+}
+
+std::vector<int> BrickIndex::bricksContaining(int value) const
+{
+    std::vector<int> bricks;
+    if (!hasLabels()) return bricks;
+    const int brickCount = getBrickCount();
+    for (int brick = 0; brick < brickCount; ++brick) {
+        if (containsLabel(brick, value)) bricks.push_back(brick);
+    }
+    return bricks;
+}
+
+std::vector<char> BrickIndex::boundaryFreeBricks() const
+{
+    std::vector<char> flags;
+    if (!hasLabels()) return flags;
+
+    flags.assign(static_cast<size_t>(getBrickCount()), 0);
+    const int strides[3] = {1, brickDimensions[0], brickDimensions[0] * brickDimensions[1]};
+    for (int bz = 0; bz < brickDimensions[2]; ++bz) {
+        for (int by = 0; by < brickDimensions[1]; ++by) {
+            for (int bx = 0; bx < brickDimensions[0]; ++bx) {
+                const int brick = (bz * brickDimensions[1] + by) * brickDimensions[0] + bx;
+                int value = 0;
+                if (!isUniform(brick, &value)) continue;
+
+                // 块的-x/-y/-z面与相邻块（或体数据外的背景）比较
+                const int coordinates[3] = {bx, by, bz};
+                bool free = true;
+                for (int axis = 0; axis < 3 && free; ++axis) {
+                    int neighbourValue = 0;
+                    if (coordinates[axis] == 0) {
+                        free = (value == 0);
+                    } else {
+                        free = isUniform(brick - strides[axis], &neighbourValue) && neighbourValue == value;
+                    }
+                }
+                flags[brick] = free ? 1 : 0;
+            }
+        }
+    }
+    return flags;
+}
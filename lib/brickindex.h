@@ -0,0 +1,85 @@
+#ifndef BRICKINDEX_H
+#define BRICKINDEX_H
+
+#include <vector>
+
+// VTK头文件
+#include <vtkType.h>
+
+class vtkImageData;
+class RunLengthLabelVolume;
+
+/**
+ * @brief 8³体素块索引，用于跳过空区域
+ *
+ * 把体数据按8×8×8体素分块（边缘块可能不满），加载时记录每块出现的标签值（排序的小列表，
+ * 值≤0记为背景0）或灰度最小/最大值。逐体素扫描整幅体数据的算法先查块：只有背景的块、
+ * 内部和相邻面都是同一标签的块、灰度为常数的块可以整块跳过。稀疏图谱的大部分块只有背景。
+ * 标签值与建立索引的图像相同（可以是紧凑编号）。
+ */
+class BrickIndex
+{
+public:
+    static const int kBrickShift = 3;
+    static const int kBrickSize = 1 << kBrickShift;
+
+    BrickIndex();
+
+    // 从标签图像（稠密或游程编码）统计每块的标签列表
+    bool buildLabels(vtkImageData* labelImage);
+    bool buildLabels(const RunLengthLabelVolume& labelVolume);
+    // 从灰度图像统计每块的最小/最大值（只取第一个分量）
+    bool buildRanges(vtkImageData* image);
+    void clear();
+
+    bool hasLabels() const { return !labelOffsets.empty(); }
+    bool hasRanges() const { return !minValues.empty(); }
+    // 索引是否按image的尺寸建立
+    bool matches(vtkImageData* image) const;
+
+    const int* getDimensions() const { return dimensions; }
+    const int* getBrickDimensions() const { return brickDimensions; }
+    int getBrickCount() const { return brickDimensions[0] * brickDimensions[1] * brickDimensions[2]; }
+
+    int brickAt(int x, int y, int z) const
+    {
+        return ((z >> kBrickShift) * brickDimensions[1] + (y >> kBrickShift)) * brickDimensions[0] +
+               (x >> kBrickShift);
+    }
+    // 块覆盖的体素范围 [xmin, xmax, ymin, ymax, zmin, zmax]（含端点）
+    void getBrickExtent(int brick, int extent[6]) const;
+
+    // 标签：块内出现的值按升序排列
+    const int* labelsBegin(int brick) const { return brickLabels.data() + labelOffsets[brick]; }
+    const int* labelsEnd(int brick) const { return brickLabels.data() + labelOffsets[brick + 1]; }
+    bool containsLabel(int brick, int value) const;
+    bool isBackgroundOnly(int brick) const;
+    // 块内所有体素同值时返回true，value返回该值
+    bool isUniform(int brick, int* value = nullptr) const;
+    // 包含value的块，按块编号递增
+    std::vector<int> bricksContaining(int value) const;
+    // 每块是否不存在标签分界面：块内及其-x/-y/-z相邻体素全部同值（体数据外视为背景0）
+    std::vector<char> boundaryFreeBricks() const;
+
+    // 灰度：块内体素的取值范围
+    double getMinValue(int brick) const { return minValues[brick]; }
+    double getMaxValue(int brick) const { return maxValues[brick]; }
+    bool isFlat(int brick) const { return minValues[brick] == maxValues[brick]; }
+    // 块内同时有 >= isoValue 和 < isoValue 的体素
+    bool straddles(int brick, double isoValue) const
+    {
+        return minValues[brick] < isoValue && maxValues[brick] >= isoValue;
+    }
+
+private:
+    void setDimensions(const int dims[3]);
+
+    int dimensions[3];
+    int brickDimensions[3];
+    std::vector<int> labelOffsets;   // 块b的标签为brickLabels[labelOffsets[b], labelOffsets[b + 1])
+    std::vector<int> brickLabels;
+    std::vector<double> minValues;
+    std::vector<double> maxValues;
+};
+
+#endif // BRICKINDEX_H
@@ -0,0 +1,216 @@
+#include "compactlabelvolume.h"
+#include "parallelfor.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+// VTK头文件
+#include <vtkDataArray.h>
+#include <vtkPointData.h>
+
+namespace {
+
+// 每块至少的切片数
+const int kSliceGrain = 4;
+// 标签跨度不超过该值时使用稠密查找表（16MB），否则使用哈希表
+const int64_t kMaxDenseLookupRange = 1 << 22;
+
+// 原标签→紧凑编号；原值≤0或不存在的标签为背景0
+struct LabelLookup
+{
+    int minLabel;
+    std::vector<uint32_t> dense;
+    std::unordered_map<int, uint32_t> sparse;
+
+    uint32_t find(int label) const
+    {
+        if (label <= 0) return 0;
+        if (!dense.empty()) {
+            const int64_t offset = static_cast<int64_t>(label) - minLabel;
+            return offset >= 0 && offset < static_cast<int64_t>(dense.size()) ? dense[offset] : 0;
+        }
+        auto it = sparse.find(label);
+        return it == sparse.end() ? 0 : it->second;
+    }
+};
+
+// 收集[begin, end)中出现的正标签；相同值的连续段只查一次集合
+template <typename T>
+void collectLabels(const T* data, int numComponents, vtkIdType begin, vtkIdType end,
+                   std::unordered_set<int>& labels)
+{
+    int previous = 0;
+    for (vtkIdType i = begin; i < end; ++i) {
+        const int label = static_cast<int>(data[i * numComponents]);
+        if (label == previous) continue;
+        previous = label;
+        if (label > 0) labels.insert(label);
+    }
+}
+
+// 写出[begin, end)的紧凑编号，同时按编号统计体素数
+template <typename T, typename U>
+void writeCompactIds(const T* data, int numComponents, U* output, vtkIdType begin, vtkIdType end,
+                     const LabelLookup& lookup, std::vector<vtkIdType>& counts)
+{
+    int previousLabel = 0;
+    U previousId = 0;
+    for (vtkIdType i = begin; i < end; ++i) {
+        const int label = static_cast<int>(data[i * numComponents]);
+        if (label != previousLabel) {
+            previousLabel = label;
+            previousId = static_cast<U>(lookup.find(label));
+        }
+        output[i] = previousId;
+        ++counts[previousId];
+    }
+}
+
+template <typename T, typename U>
+void writeCompactImage(const T* data, int numComponents, U* output, const int dims[3], const LabelLookup& lookup,
+                       int labelCount, std::vector<vtkIdType>& idCounts)
+{
+    const vtkIdType sliceSize = static_cast<vtkIdType>(dims[0]) * dims[1];
+    const int chunks = ParallelFor::chunkCount(0, dims[2], kSliceGrain);
+    std::vector<std::vector<vtkIdType>> chunkCounts(chunks, std::vector<vtkIdType>(labelCount + 1, 0));
+    ParallelFor::parallelForChunks(0, dims[2], chunks, [&](int chunk, int zBegin, int zEnd) {
+        writeCompactIds(data, numComponents, output, zBegin * sliceSize, zEnd * sliceSize, lookup,
+                        chunkCounts[chunk]);
+    });
+
+    idCounts.assign(labelCount + 1, 0);
+    for (const auto& counts : chunkCounts) {
+        for (int id = 0; id <= labelCount; ++id) {
+            idCounts[id] += counts[id];
+        }
+    }
+}
+
+// 两次扫描生成紧凑编号数组；输入已是最窄类型时返回空
+template <typename T>
+vtkSmartPointer<vtkDataArray> compactLabels(const T* data, int numComponents, const int dims[3],
+                                            std::vector<int>& idToLabel, std::vector<vtkIdType>& idCounts)
+{
+    const vtkIdType sliceSize = static_cast<vtkIdType>(dims[0]) * dims[1];
+
+    // 第一次扫描：每块收集自己的标签集合，再合并排序
+    const int chunks = ParallelFor::chunkCount(0, dims[2], kSliceGrain);
+    std::vector<std::unordered_set<int>> chunkLabels(chunks);
+    ParallelFor::parallelForChunks(0, dims[2], chunks, [&](int chunk, int zBegin, int zEnd) {
+        collectLabels(data, numComponents, zBegin * sliceSize, zEnd * sliceSize, chunkLabels[chunk]);
+    });
+
+    std::unordered_set<int> labels;
+    for (const auto& set : chunkLabels) {
+        labels.insert(set.begin(), set.end());
+    }
+    idToLabel.assign(1, 0);
+    idToLabel.insert(idToLabel.end(), labels.begin(), labels.end());
+    std::sort(idToLabel.begin() + 1, idToLabel.end());
+
+    const int labelCount = static_cast<int>(idToLabel.size()) - 1;
+    const int scalarType = CompactLabelVolume::compactScalarType(labelCount);
+    if (numComponents == 1 && vtkDataArray::GetDataTypeSize(scalarType) >= static_cast<int>(sizeof(T))) {
+        idToLabel.clear();
+        return nullptr;
+    }
+
+    LabelLookup lookup;
+    lookup.minLabel = labelCount > 0 ? idToLabel[1] : 1;
+    const int64_t range = labelCount > 0 ? static_cast<int64_t>(idToLabel.back()) - lookup.minLabel + 1 : 0;
+    if (range > 0 && range <= kMaxDenseLookupRange) {
+        lookup.dense.assign(static_cast<size_t>(range), 0);
+        for (int id = 1; id <= labelCount; ++id) {
+            lookup.dense[idToLabel[id] - lookup.minLabel] = static_cast<uint32_t>(id);
+        }
+    } else {
+        lookup.sparse.reserve(labelCount);
+        for (int id = 1; id <= labelCount; ++id) {
+            lookup.sparse[idToLabel[id]] = static_cast<uint32_t>(id);
+        }
+    }
+
+    // 第二次扫描：查表写出编号
+    vtkSmartPointer<vtkDataArray> ids;
+    ids.TakeReference(vtkDataArray::CreateDataArray(scalarType));
+    ids->SetNumberOfComponents(1);
+    ids->SetNumberOfTuples(sliceSize * dims[2]);
+    void* output = ids->GetVoidPointer(0);
+    switch (scalarType) {
+    case VTK_UNSIGNED_CHAR:
+        writeCompactImage(data, numComponents, static_cast<uint8_t*>(output), dims, lookup, labelCount, idCounts);
+        break;
+    case VTK_UNSIGNED_SHORT:
+        writeCompactImage(data, numComponents, static_cast<uint16_t*>(output), dims, lookup, labelCount, idCounts);
+        break;
+    default:
+        writeCompactImage(data, numComponents, static_cast<uint32_t*>(output), dims, lookup, labelCount, idCounts);
+        break;
+    }
+    return ids;
+}
+
+} // namespace
+
+int CompactLabelVolume::compactScalarType(int labelCount)
+{
+    if (labelCount <= VTK_UNSIGNED_CHAR_MAX) return VTK_UNSIGNED_CHAR;
+    if (labelCount <= VTK_UNSIGNED_SHORT_MAX) return VTK_UNSIGNED_SHORT;
+    return VTK_UNSIGNED_INT;
+}
+
+bool CompactLabelVolume::build(vtkImageData* labelImage)
+{
+    clear();
+
+    if (!labelImage) return false;
+    vtkDataArray* scalars = labelImage->GetPointData()->GetScalars();
+    if (!scalars) return false;
+    // uint8单分量已是最窄类型，不必扫描
+    if (scalars->GetDataType() == VTK_UNSIGNED_CHAR && scalars->GetNumberOfComponents() == 1) return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    int dims[3];
+    labelImage->GetDimensions(dims);
+    const int numComponents = scalars->GetNumberOfComponents();
+    const void* scalarPointer = scalars->GetVoidPointer(0);
+
+    std::vector<vtkIdType> idCounts;
+    vtkSmartPointer<vtkDataArray> ids;
+    switch (scalars->GetDataType()) {
+        vtkTemplateMacro(ids = compactLabels(static_cast<const VTK_TT*>(scalarPointer), numComponents, dims,
+                                             idToLabel, idCounts));
+    default:
+        qDebug() << "紧凑标签: 不支持的标量类型" << scalars->GetDataType();
+        return false;
+    }
+    if (!ids) return false;
+
+    ids->SetName(scalars->GetName());
+    image = vtkSmartPointer<vtkImageData>::New();
+    image->CopyStructure(labelImage);
+    image->GetPointData()->SetScalars(ids);
+
+    for (int id = 1; id < static_cast<int>(idToLabel.size()); ++id) {
+        voxelCounts.insert(idToLabel[id], idCounts[id]);
+    }
+
+    qDebug() << "紧凑标签:" << getLabelCount() << "个标签，"
+             << vtkDataArray::GetDataTypeSize(scalars->GetDataType()) * numComponents << "字节/体素 →"
+             << ids->GetDataTypeSize() << "字节/体素，耗时:" << timer.elapsed() << "ms";
+    return true;
+}
+
+void CompactLabelVolume::clear()
+{
+    image = nullptr;
+    idToLabel.clear();
+    voxelCounts.clear();
+}
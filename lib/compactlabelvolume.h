@@ -0,0 +1,46 @@
+#ifndef COMPACTLABELVOLUME_H
+#define COMPACTLABELVOLUME_H
+
+#include <QHash>
+
+#include <vector>
+
+// VTK头文件
+#include <vtkSmartPointer.h>
+#include <vtkImageData.h>
+
+/**
+ * @brief 紧凑编号的标签体数据
+ *
+ * 图谱常以float32/int32保存，但不同标签通常少于256或65536个。build()把标签图像转换为
+ * 能容纳标签数的最窄无符号类型（uint8/uint16/uint32），体素值为紧凑编号：0为背景（原值≤0），
+ * 1..N按原标签升序编号，getLabel(id)查回原标签。编号与原标签的顺序一致，按编号排序即按标签排序。
+ * 两次按切片并行的扫描：先收集出现的标签，再查表写出编号，写出时同时统计每个标签的体素数。
+ */
+class CompactLabelVolume
+{
+public:
+    // 转换labelImage；已是最窄类型（转换不能减少内存）或标量类型不支持时返回false，不生成图像
+    bool build(vtkImageData* labelImage);
+    void clear();
+
+    // 紧凑编号图像（几何与原图像相同，单分量）
+    vtkImageData* getImage() const { return image; }
+    // 非背景标签数N，编号为1..N
+    int getLabelCount() const { return idToLabel.empty() ? 0 : static_cast<int>(idToLabel.size()) - 1; }
+    int getLabel(int id) const { return idToLabel[id]; }
+    // 编号→原标签表，下标0为背景
+    const std::vector<int>& getIdToLabel() const { return idToLabel; }
+    // 原标签→体素数
+    const QHash<int, vtkIdType>& getVoxelCounts() const { return voxelCounts; }
+
+    // 容纳labelCount个标签（加背景）的最窄无符号VTK标量类型
+    static int compactScalarType(int labelCount);
+
+private:
+    vtkSmartPointer<vtkImageData> image;
+    std::vector<int> idToLabel;
+    QHash<int, vtkIdType> voxelCounts;
+};
+
+#endif // COMPACTLABELVOLUME_H
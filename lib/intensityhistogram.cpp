@@ -0,0 +1,123 @@
+#include "intensityhistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+IntensityHistogram::IntensityHistogram()
+    : totalCount(0)
+    , minimum(0.0)
+    , maximum(0.0)
+    , binWidth(1.0)
+    , scale(1.0)
+    , integerBins(false)
+{
+}
+
+void IntensityHistogram::reset(double minimum, double maximum, int maxBinCount, bool integerValues)
+{
+    if (maximum < minimum) std::swap(minimum, maximum);
+    maxBinCount = std::max(1, maxBinCount);
+
+    this->minimum = minimum;
+    this->maximum = maximum;
+    totalCount = 0;
+
+    const double span = maximum - minimum;
+    int binCount;
+    integerBins = integerValues && span + 1.0 <= maxBinCount;
+    if (integerBins) {
+        // 每个整数值一个分箱：[v, v + 1)
+        binCount = static_cast<int>(span) + 1;
+        binWidth = 1.0;
+    } else if (span > 0.0) {
+        binCount = maxBinCount;
+        binWidth = span / binCount;
+    } else {
+        binCount = 1;
+        binWidth = 1.0;
+    }
+    scale = 1.0 / binWidth;
+    counts.assign(static_cast<size_t>(binCount), 0);
+}
+
+void IntensityHistogram::merge(const IntensityHistogram& other)
+{
+    if (other.counts.size() != counts.size()) return;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        counts[i] += other.counts[i];
+    }
+    totalCount += other.totalCount;
+}
+
+double IntensityHistogram::percentile(double percent) const
+{
+    if (totalCount == 0) return minimum;
+
+    const double target = std::min(std::max(percent, 0.0), 100.0) * 0.01 * static_cast<double>(totalCount);
+    double cumulative = 0.0;
+    for (size_t bin = 0; bin < counts.size(); ++bin) {
+        const double count = static_cast<double>(counts[bin]);
+        if (count > 0.0 && cumulative + count >= target) {
+            // 假设分箱内均匀分布，线性插值
+            const double fraction = (target - cumulative) / count;
+            return minimum + (bin + fraction) * binWidth;
+        }
+        cumulative += count;
+    }
+    return minimum + counts.size() * binWidth;
+}
+
+double IntensityHistogram::otsuThreshold() const
+{
+    if (totalCount == 0 || counts.size() < 2) return minimum;
+
+    // 以分箱序号计算类间方差，结果换算回灰度值
+    double totalSum = 0.0;
+    for (size_t bin = 0; bin < counts.size(); ++bin) {
+        totalSum += static_cast<double>(bin) * static_cast<double>(counts[bin]);
+    }
+
+    const double total = static_cast<double>(totalCount);
+    double backgroundWeight = 0.0;
+    double backgroundSum = 0.0;
+    double bestVariance = -1.0;
+    size_t bestBin = 0;
+    for (size_t bin = 0; bin + 1 < counts.size(); ++bin) {
+        backgroundWeight += static_cast<double>(counts[bin]);
+        backgroundSum += static_cast<double>(bin) * static_cast<double>(counts[bin]);
+        const double foregroundWeight = total - backgroundWeight;
+        if (backgroundWeight <= 0.0) continue;
+        if (foregroundWeight <= 0.0) break;
+
+        const double meanDifference = backgroundSum / backgroundWeight -
+                                      (totalSum - backgroundSum) / foregroundWeight;
+        const double variance = backgroundWeight * foregroundWeight * meanDifference * meanDifference;
+        if (variance > bestVariance) {
+            bestVariance = variance;
+            bestBin = bin;
+        }
+    }
+
+    // 前景从下一个分箱的下边界开始
+    return minimum + (bestBin + 1) * binWidth;
+}
+
+double IntensityHistogram::fractionInRange(double low, double high) const
+{
+    if (totalCount == 0 || high < low) return 0.0;
+
+    // 整数分箱[v, v + 1)包含值v本身：下端取不小于low的第一个整数，上端扩展到分箱上边界
+    const double lower = integerBins ? std::ceil(low) : low;
+    const double upper = integerBins ? std::floor(high) + 1.0 : high;
+
+    double count = 0.0;
+    for (size_t bin = 0; bin < counts.size(); ++bin) {
+        if (counts[bin] == 0) continue;
+        const double binLow = minimum + bin * binWidth;
+        const double binHigh = binLow + binWidth;
+        const double overlap = std::min(binHigh, upper) - std::max(binLow, lower);
+        if (overlap <= 0.0) continue;
+        count += static_cast<double>(counts[bin]) * std::min(1.0, overlap / binWidth);
+    }
+    return count / static_cast<double>(totalCount);
+}
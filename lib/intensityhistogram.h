@@ -0,0 +1,67 @@
+#ifndef INTENSITYHISTOGRAM_H
+#define INTENSITYHISTOGRAM_H
+
+#include <vector>
+
+// VTK头文件
+#include <vtkType.h>
+
+/**
+ * @brief 固定范围、等宽分箱的灰度直方图
+ *
+ * 在标签划分的同一次扫描中为整幅MRI和每个标签区块统计，之后的阈值选择
+ * （百分位、Otsu、区间内体素比例）只访问分箱计数，不再读取体素。
+ * 整数类型且取值范围小于分箱上限时每个整数值独占一个分箱，结果是精确的。
+ */
+class IntensityHistogram
+{
+public:
+    // 默认分箱上限
+    static const int kDefaultBinCount = 1024;
+
+    IntensityHistogram();
+
+    // 清空并设置范围和分箱数；integerValues为true时按整数值分箱
+    void reset(double minimum, double maximum, int maxBinCount = kDefaultBinCount, bool integerValues = false);
+    bool isValid() const { return !counts.empty(); }
+
+    // 统计单个值（超出范围的值归入两端分箱，NaN被忽略）
+    void add(double value)
+    {
+        if (!(value == value)) return;
+        double position = (value - minimum) * scale;
+        int bin = position <= 0.0 ? 0 : static_cast<int>(position);
+        if (bin >= static_cast<int>(counts.size())) bin = static_cast<int>(counts.size()) - 1;
+        ++counts[bin];
+        ++totalCount;
+    }
+
+    // 合并范围和分箱相同的直方图
+    void merge(const IntensityHistogram& other);
+
+    // 基本信息
+    int getBinCount() const { return static_cast<int>(counts.size()); }
+    vtkIdType getCount(int bin) const { return counts[bin]; }
+    const std::vector<vtkIdType>& getCounts() const { return counts; }
+    vtkIdType getTotalCount() const { return totalCount; }
+    double getMinimum() const { return minimum; }
+    double getMaximum() const { return maximum; }
+    double getBinWidth() const { return binWidth; }
+    double getBinCenter(int bin) const { return minimum + (bin + 0.5) * binWidth; }
+
+    // 派生阈值：百分位（0~100，分箱内线性插值）、Otsu类间方差最大阈值、区间[low, high]内的体素比例
+    double percentile(double percent) const;
+    double otsuThreshold() const;
+    double fractionInRange(double low, double high) const;
+
+private:
+    std::vector<vtkIdType> counts;
+    vtkIdType totalCount;
+    double minimum;
+    double maximum;
+    double binWidth;
+    double scale;       // 1 / binWidth
+    bool integerBins;   // 每个整数值独占一个分箱
+};
+
+#endif // INTENSITYHISTOGRAM_H
@@ -0,0 +1,189 @@
+#include "isosurfaceextractor.h"
+#include "marchingcubeskernel.h"
+
+#include <QDebug>
+#include <cstring>
+
+// VTK头文件
+#include <vtkMarchingCubes.h>
+#include <vtkFlyingEdges3D.h>
+#include <vtkDiscreteMarchingCubes.h>
+#include <vtkDiscreteFlyingEdges3D.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+
+namespace {
+
+// 运行滤波器并把输出从管线中分离出来，调用方可以安全地跨线程持有结果
+vtkSmartPointer<vtkPolyData> detachOutput(vtkPolyDataAlgorithm* filter)
+{
+    filter->Update();
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->ShallowCopy(filter->GetOutput());
+    return polyData;
+}
+
+// 把内核输出的紧凑缓冲直接拷贝进vtkPoints/vtkCellArray
+vtkSmartPointer<vtkPolyData> createPolyData(const IsosurfaceMesh& mesh)
+{
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+
+    const vtkIdType numPoints = mesh.getNumberOfPoints();
+    auto coordinates = vtkSmartPointer<vtkFloatArray>::New();
+    coordinates->SetNumberOfComponents(3);
+    coordinates->SetNumberOfTuples(numPoints);
+    if (numPoints > 0) {
+        std::memcpy(coordinates->GetPointer(0), mesh.points.data(), mesh.points.size() * sizeof(float));
+    }
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(coordinates);
+    polyData->SetPoints(points);
+
+    // VTK 8.2的单元数组格式：每个三角形为 [3, a, b, c]
+    const vtkIdType numTriangles = mesh.getNumberOfTriangles();
+    auto connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    connectivity->SetNumberOfValues(numTriangles * 4);
+    vtkIdType* cell = connectivity->GetPointer(0);
+    for (vtkIdType t = 0; t < numTriangles; ++t) {
+        *cell++ = 3;
+        *cell++ = mesh.triangles[t * 3];
+        *cell++ = mesh.triangles[t * 3 + 1];
+        *cell++ = mesh.triangles[t * 3 + 2];
+    }
+    auto triangles = vtkSmartPointer<vtkCellArray>::New();
+    triangles->SetCells(numTriangles, connectivity);
+    polyData->SetPolys(triangles);
+
+    if (!mesh.normals.empty()) {
+        auto normals = vtkSmartPointer<vtkFloatArray>::New();
+        normals->SetName("Normals");
+        normals->SetNumberOfComponents(3);
+        normals->SetNumberOfTuples(numPoints);
+        std::memcpy(normals->GetPointer(0), mesh.normals.data(), mesh.normals.size() * sizeof(float));
+        polyData->GetPointData()->SetNormals(normals);
+    }
+
+    return polyData;
+}
+
+template <typename T>
+void runKernel(const T* scalars, int stride, const int dims[3], const double origin[3], const double spacing[3],
+               double value, bool labelMode, bool computeNormals, IsosurfaceMesh& mesh)
+{
+    if (labelMode) {
+        extractMarchingCubesLabelSurface(scalars, stride, dims, origin, spacing, value, computeNormals, mesh);
+    } else {
+        extractMarchingCubesSurface(scalars, stride, dims, origin, spacing, value, computeNormals, mesh);
+    }
+}
+
+// 使用库内内核提取；labelMode为true时提取离散标签表面
+vtkSmartPointer<vtkPolyData> extractWithKernel(vtkImageData* imageData, double value, bool labelMode,
+                                               bool computeNormals)
+{
+    vtkDataArray* scalars = imageData->GetPointData()->GetScalars();
+    if (!scalars) return nullptr;
+
+    int dims[3];
+    double origin[3];
+    double spacing[3];
+    int extent[6];
+    imageData->GetDimensions(dims);
+    imageData->GetSpacing(spacing);
+    imageData->GetOrigin(origin);
+    imageData->GetExtent(extent);
+
+    // 范围起点不为0时，第一个体素的世界坐标为 origin + extent起点 * spacing
+    for (int i = 0; i < 3; ++i) {
+        origin[i] += extent[i * 2] * spacing[i];
+    }
+
+    const int stride = scalars->GetNumberOfComponents();
+    void* scalarPointer = scalars->GetVoidPointer(0);
+
+    IsosurfaceMesh mesh;
+    switch (scalars->GetDataType()) {
+        vtkTemplateMacro(runKernel(static_cast<const VTK_TT*>(scalarPointer), stride, dims, origin, spacing,
+                                   value, labelMode, computeNormals, mesh));
+    default:
+        qDebug() << "移动立方体内核: 不支持的标量类型" << scalars->GetDataType();
+        return nullptr;
+    }
+
+    return createPolyData(mesh);
+}
+
+} // namespace
+
+vtkSmartPointer<vtkPolyData> IsosurfaceExtractor::extract(vtkImageData* imageData, double isoValue,
+                                                          Backend backend, bool computeNormals)
+{
+    if (!imageData) return nullptr;
+
+    if (backend == SIMD_MARCHING_CUBES) {
+        return extractWithKernel(imageData, isoValue, false, computeNormals);
+    }
+
+    if (backend == FLYING_EDGES) {
+        auto flyingEdges = vtkSmartPointer<vtkFlyingEdges3D>::New();
+        flyingEdges->SetInputData(imageData);
+        flyingEdges->SetValue(0, isoValue);
+        flyingEdges->SetComputeNormals(computeNormals);
+        flyingEdges->ComputeGradientsOff();
+        flyingEdges->ComputeScalarsOff();
+        return detachOutput(flyingEdges);
+    }
+
+    auto marchingCubes = vtkSmartPointer<vtkMarchingCubes>::New();
+    marchingCubes->SetInputData(imageData);
+    marchingCubes->SetValue(0, isoValue);
+    marchingCubes->SetComputeNormals(computeNormals);
+    marchingCubes->ComputeGradientsOff();
+    marchingCubes->ComputeScalarsOff();
+    return detachOutput(marchingCubes);
+}
+
+vtkSmartPointer<vtkPolyData> IsosurfaceExtractor::extractLabel(vtkImageData* labelData, double labelValue,
+                                                               Backend backend, bool computeNormals)
+{
+    if (!labelData) return nullptr;
+
+    if (backend == SIMD_MARCHING_CUBES) {
+        return extractWithKernel(labelData, labelValue, true, computeNormals);
+    }
+
+    if (backend == FLYING_EDGES) {
+        auto flyingEdges = vtkSmartPointer<vtkDiscreteFlyingEdges3D>::New();
+        flyingEdges->SetInputData(labelData);
+        flyingEdges->SetValue(0, labelValue);
+        flyingEdges->SetComputeNormals(computeNormals);
+        flyingEdges->ComputeGradientsOff();
+        flyingEdges->ComputeScalarsOff();
+        return detachOutput(flyingEdges);
+    }
+
+    auto marchingCubes = vtkSmartPointer<vtkDiscreteMarchingCubes>::New();
+    marchingCubes->SetInputData(labelData);
+    marchingCubes->SetValue(0, labelValue);
+    marchingCubes->SetComputeNormals(computeNormals);
+    marchingCubes->ComputeGradientsOff();
+    marchingCubes->ComputeScalarsOff();
+    return detachOutput(marchingCubes);
+}
+
+const char* IsosurfaceExtractor::backendName(Backend backend)
+{
+    switch (backend) {
+    case FLYING_EDGES:
+        return "FlyingEdges3D";
+    case SIMD_MARCHING_CUBES:
+        return "SimdMarchingCubes";
+    case MARCHING_CUBES:
+    default:
+        return "MarchingCubes";
+    }
+}
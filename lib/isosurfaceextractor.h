@@ -0,0 +1,35 @@
+#ifndef ISOSURFACEEXTRACTOR_H
+#define ISOSURFACEEXTRACTOR_H
+
+// VTK头文件
+#include <vtkSmartPointer.h>
+#include <vtkImageData.h>
+#include <vtkPolyData.h>
+
+/**
+ * @brief 等值面提取引擎选择
+ *
+ * 所有提取等值面的调用点（区块网格、简单体绘制测试、MRI预览）都通过
+ * 这里选择具体的VTK滤波器或库内的移动立方体内核，便于统一切换后端。
+ */
+class IsosurfaceExtractor
+{
+public:
+    enum Backend {
+        MARCHING_CUBES,  // vtkMarchingCubes / vtkDiscreteMarchingCubes（串行）
+        FLYING_EDGES,    // vtkFlyingEdges3D / vtkDiscreteFlyingEdges3D（通过vtkSMPTools并行）
+        SIMD_MARCHING_CUBES // 库内移动立方体内核（按标量类型特化、SIMD分类、切片并行）
+    };
+
+    // 提取灰度等值面
+    static vtkSmartPointer<vtkPolyData> extract(vtkImageData* imageData, double isoValue,
+                                                Backend backend, bool computeNormals = true);
+
+    // 提取离散标签值的表面（用于二值/标签掩码）
+    static vtkSmartPointer<vtkPolyData> extractLabel(vtkImageData* labelData, double labelValue,
+                                                     Backend backend, bool computeNormals = true);
+
+    static const char* backendName(Backend backend);
+};
+
+#endif // ISOSURFACEEXTRACTOR_H
@@ -0,0 +1,274 @@
+#include "labelconfusionmatrix.h"
+#include "parallelfor.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+
+// VTK头文件
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+
+LabelAgreement::LabelAgreement()
+    : label(0)
+    , referenceCount(0)
+    , comparedCount(0)
+    , overlapCount(0)
+{
+}
+
+double LabelAgreement::dice() const
+{
+    const vtkIdType total = referenceCount + comparedCount;
+    return total > 0 ? 2.0 * overlapCount / total : 0.0;
+}
+
+double LabelAgreement::jaccard() const
+{
+    const vtkIdType unionCount = referenceCount + comparedCount - overlapCount;
+    return unionCount > 0 ? static_cast<double>(overlapCount) / unionCount : 0.0;
+}
+
+double LabelAgreement::countDrift() const
+{
+    if (referenceCount == 0) return 0.0;
+    return static_cast<double>(comparedCount - referenceCount) / referenceCount;
+}
+
+namespace {
+
+// 每次类型转换的体素块大小
+const int kBlockSize = 4096;
+
+// 每个并行块至少包含的切片数
+const int kSlicesPerChunk = 4;
+
+// 把一段连续体素的标签转换为int；按标量类型特化，每块只经过一次函数指针调用
+typedef void (*LabelBlockReader)(const void* data, vtkIdType start, int count, int numComponents, int* out);
+
+template <typename T>
+void readLabelBlock(const void* data, vtkIdType start, int count, int numComponents, int* out)
+{
+    const T* values = static_cast<const T*>(data) + start * numComponents;
+    for (int i = 0; i < count; ++i) {
+        out[i] = static_cast<int>(values[static_cast<vtkIdType>(i) * numComponents]);
+    }
+}
+
+LabelBlockReader selectReader(int dataType)
+{
+    switch (dataType) {
+        vtkTemplateMacro(return &readLabelBlock<VTK_TT>);
+    default:
+        return nullptr;
+    }
+}
+
+struct LabelVolume
+{
+    LabelBlockReader read;
+    const void* data;
+    int numComponents;
+};
+
+bool describeVolume(vtkImageData* image, LabelVolume& volume)
+{
+    vtkDataArray* scalars = image->GetPointData()->GetScalars();
+    if (!scalars) return false;
+    volume.read = selectReader(scalars->GetDataType());
+    volume.data = scalars->GetVoidPointer(0);
+    volume.numComponents = scalars->GetNumberOfComponents();
+    if (!volume.read) {
+        qDebug() << "混淆矩阵: 不支持的标签标量类型" << scalars->GetDataType();
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+LabelConfusionMatrix::LabelConfusionMatrix()
+    : voxelCount(0)
+    , referenceForeground(0)
+    , comparedForeground(0)
+    , foregroundOverlap(0)
+{
+}
+
+void LabelConfusionMatrix::clear()
+{
+    cells.clear();
+    agreements.clear();
+    labelToIndex.clear();
+    voxelCount = 0;
+    referenceForeground = 0;
+    comparedForeground = 0;
+    foregroundOverlap = 0;
+}
+
+bool LabelConfusionMatrix::compute(vtkImageData* reference, vtkImageData* compared)
+{
+    clear();
+    if (!reference || !compared) return false;
+
+    int dims[3];
+    int comparedDims[3];
+    reference->GetDimensions(dims);
+    compared->GetDimensions(comparedDims);
+    if (dims[0] != comparedDims[0] || dims[1] != comparedDims[1] || dims[2] != comparedDims[2]) {
+        qDebug() << "混淆矩阵: 两幅标签图像尺寸不一致";
+        return false;
+    }
+
+    LabelVolume referenceVolume;
+    LabelVolume comparedVolume;
+    if (!describeVolume(reference, referenceVolume) || !describeVolume(compared, comparedVolume)) return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const vtkIdType sliceSize = static_cast<vtkIdType>(dims[0]) * dims[1];
+    const int chunks = ParallelFor::chunkCount(0, dims[2], kSlicesPerChunk);
+    std::vector<std::unordered_map<uint64_t, vtkIdType>> chunkCells(static_cast<size_t>(chunks));
+
+    ParallelFor::parallelForChunks(0, dims[2], chunks, [&](int chunk, int zBegin, int zEnd) {
+        std::unordered_map<uint64_t, vtkIdType>& localCells = chunkCells[chunk];
+        std::vector<int> referenceBlock(kBlockSize);
+        std::vector<int> comparedBlock(kBlockSize);
+
+        // 相同组合的连续体素累计为一段，组合变化时才写入哈希表
+        bool hasRun = false;
+        int runReference = 0;
+        int runCompared = 0;
+        vtkIdType runLength = 0;
+
+        const vtkIdType end = zEnd * sliceSize;
+        for (vtkIdType start = zBegin * sliceSize; start < end; start += kBlockSize) {
+            const int count = static_cast<int>(std::min<vtkIdType>(kBlockSize, end - start));
+            referenceVolume.read(referenceVolume.data, start, count, referenceVolume.numComponents,
+                                 referenceBlock.data());
+            comparedVolume.read(comparedVolume.data, start, count, comparedVolume.numComponents,
+                                comparedBlock.data());
+
+            for (int i = 0; i < count; ++i) {
+                const int referenceLabel = referenceBlock[i];
+                const int comparedLabel = comparedBlock[i];
+                if (hasRun && referenceLabel == runReference && comparedLabel == runCompared) {
+                    ++runLength;
+                    continue;
+                }
+                if (hasRun) localCells[packKey(runReference, runCompared)] += runLength;
+                hasRun = true;
+                runReference = referenceLabel;
+                runCompared = comparedLabel;
+                runLength = 1;
+            }
+        }
+        if (hasRun) localCells[packKey(runReference, runCompared)] += runLength;
+    });
+
+    for (const auto& localCells : chunkCells) {
+        for (const auto& cell : localCells) {
+            cells[cell.first] += cell.second;
+        }
+    }
+    voxelCount = sliceSize * dims[2];
+    buildAgreements();
+
+    qDebug() << "混淆矩阵统计完成，非零组合:" << cells.size() << "标签数:" << agreements.size()
+             << "耗时:" << timer.elapsed() << "ms";
+    return true;
+}
+
+void LabelConfusionMatrix::buildAgreements()
+{
+    // 按矩阵元素累加每个标签的行和、列和与对角线
+    std::vector<int> labels;
+    for (const auto& cell : cells) {
+        const int referenceLabel = static_cast<int>(static_cast<uint32_t>(cell.first >> 32));
+        const int comparedLabel = static_cast<int>(static_cast<uint32_t>(cell.first));
+        if (referenceLabel != 0) labels.push_back(referenceLabel);
+        if (comparedLabel != 0) labels.push_back(comparedLabel);
+    }
+    std::sort(labels.begin(), labels.end());
+    labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+    agreements.resize(labels.size());
+    for (size_t i = 0; i < labels.size(); ++i) {
+        agreements[i].label = labels[i];
+        labelToIndex.insert(labels[i], static_cast<int>(i));
+    }
+
+    for (const auto& cell : cells) {
+        const int referenceLabel = static_cast<int>(static_cast<uint32_t>(cell.first >> 32));
+        const int comparedLabel = static_cast<int>(static_cast<uint32_t>(cell.first));
+        const vtkIdType count = cell.second;
+        if (referenceLabel != 0) {
+            agreements[labelToIndex.value(referenceLabel)].referenceCount += count;
+            referenceForeground += count;
+        }
+        if (comparedLabel != 0) {
+            agreements[labelToIndex.value(comparedLabel)].comparedCount += count;
+            comparedForeground += count;
+        }
+        if (referenceLabel != 0 && comparedLabel != 0) {
+            foregroundOverlap += count;
+            if (referenceLabel == comparedLabel) {
+                agreements[labelToIndex.value(referenceLabel)].overlapCount += count;
+            }
+        }
+    }
+}
+
+vtkIdType LabelConfusionMatrix::getCount(int referenceLabel, int comparedLabel) const
+{
+    auto it = cells.find(packKey(referenceLabel, comparedLabel));
+    return it != cells.end() ? it->second : 0;
+}
+
+const LabelAgreement* LabelConfusionMatrix::getAgreement(int label) const
+{
+    auto it = labelToIndex.constFind(label);
+    return it != labelToIndex.constEnd() ? &agreements[it.value()] : nullptr;
+}
+
+QList<int> LabelConfusionMatrix::getVanishedLabels() const
+{
+    QList<int> labels;
+    for (const LabelAgreement& agreement : agreements) {
+        if (agreement.vanished()) labels.append(agreement.label);
+    }
+    return labels;
+}
+
+QList<int> LabelConfusionMatrix::getIntroducedLabels() const
+{
+    QList<int> labels;
+    for (const LabelAgreement& agreement : agreements) {
+        if (agreement.introduced()) labels.append(agreement.label);
+    }
+    return labels;
+}
+
+double LabelConfusionMatrix::meanDice() const
+{
+    if (agreements.empty()) return 0.0;
+    double sum = 0.0;
+    for (const LabelAgreement& agreement : agreements) {
+        sum += agreement.dice();
+    }
+    return sum / agreements.size();
+}
+
+double LabelConfusionMatrix::foregroundDice() const
+{
+    const vtkIdType total = referenceForeground + comparedForeground;
+    return total > 0 ? 2.0 * foregroundOverlap / total : 0.0;
+}
+
+double LabelConfusionMatrix::foregroundJaccard() const
+{
+    const vtkIdType unionCount = referenceForeground + comparedForeground - foregroundOverlap;
+    return unionCount > 0 ? static_cast<double>(foregroundOverlap) / unionCount : 0.0;
+}
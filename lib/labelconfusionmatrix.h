@@ -0,0 +1,88 @@
+#ifndef LABELCONFUSIONMATRIX_H
+#define LABELCONFUSIONMATRIX_H
+
+#include <QList>
+#include <QHash>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// VTK头文件
+#include <vtkType.h>
+
+class vtkImageData;
+
+/**
+ * @brief 单个标签在两幅标签图像之间的一致性
+ */
+struct LabelAgreement
+{
+    int label;
+    vtkIdType referenceCount;   // 参考图像中的体素数
+    vtkIdType comparedCount;    // 比较图像中的体素数
+    vtkIdType overlapCount;     // 两幅图像中同一体素都为该标签的体素数
+
+    LabelAgreement();
+
+    double dice() const;
+    double jaccard() const;
+    // 体素数漂移 (比较 - 参考) / 参考；参考中不存在时为0
+    double countDrift() const;
+    bool vanished() const { return referenceCount > 0 && comparedCount == 0; }
+    bool introduced() const { return referenceCount == 0 && comparedCount > 0; }
+};
+
+/**
+ * @brief 两幅同尺寸标签图像的稀疏混淆矩阵
+ *
+ * 并行扫描一次，统计每个(参考标签, 比较标签)组合的体素数，只保存出现过的组合。
+ * 每个标签的Dice、Jaccard、体素数漂移以及消失/新出现的标签都由矩阵派生，
+ * 与标签数量无关。扫描按块把两幅图像的标签转换为int（每块一次类型分派），
+ * 相同组合的连续体素只做一次哈希表更新。
+ */
+class LabelConfusionMatrix
+{
+public:
+    LabelConfusionMatrix();
+
+    // 两幅图像尺寸必须一致；只使用第一个分量
+    bool compute(vtkImageData* reference, vtkImageData* compared);
+    void clear();
+    bool isValid() const { return voxelCount > 0; }
+
+    // 矩阵元素
+    vtkIdType getCount(int referenceLabel, int comparedLabel) const;
+    int getEntryCount() const { return static_cast<int>(cells.size()); }
+    vtkIdType getVoxelCount() const { return voxelCount; }
+
+    // 每个标签的一致性（不含背景0，按标签升序）
+    const std::vector<LabelAgreement>& getAgreements() const { return agreements; }
+    const LabelAgreement* getAgreement(int label) const;
+    QList<int> getVanishedLabels() const;
+    QList<int> getIntroducedLabels() const;
+    double meanDice() const;
+
+    // 前景（非0标签）整体重叠
+    double foregroundDice() const;
+    double foregroundJaccard() const;
+
+private:
+    static uint64_t packKey(int referenceLabel, int comparedLabel)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(referenceLabel)) << 32) |
+               static_cast<uint32_t>(comparedLabel);
+    }
+
+    void buildAgreements();
+
+    std::unordered_map<uint64_t, vtkIdType> cells;
+    std::vector<LabelAgreement> agreements;
+    QHash<int, int> labelToIndex;
+    vtkIdType voxelCount;
+    vtkIdType referenceForeground;
+    vtkIdType comparedForeground;
+    vtkIdType foregroundOverlap;   // 两幅图像都为前景的体素数（不要求标签相同）
+};
+
+#endif // LABELCONFUSIONMATRIX_H
@@ -0,0 +1,412 @@
+#include "labelpartitioner.h"
+#include "brickindex.h"
+#include "runlengthlabelvolume.h"
+
+#include <QDebug>
+#include <algorithm>
+
+// VTK头文件
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+
+LabelRegionInfo::LabelRegionInfo()
+    : label(0)
+    , voxelCount(0)
+{
+    extent[0] = extent[2] = extent[4] = VTK_INT_MAX;
+    extent[1] = extent[3] = extent[5] = VTK_INT_MIN;
+}
+
+namespace {
+
+// 把一段连续体素的灰度计入直方图；按MRI标量类型特化，每段只经过一次函数指针调用
+typedef void (*IntensityRunFunction)(const void* data, vtkIdType start, int count, int numComponents,
+                                     IntensityHistogram* regionHistogram, IntensityHistogram& globalHistogram);
+
+template <typename U>
+void addIntensityRun(const void* data, vtkIdType start, int count, int numComponents,
+                     IntensityHistogram* regionHistogram, IntensityHistogram& globalHistogram)
+{
+    const U* values = static_cast<const U*>(data) + start * numComponents;
+    for (int i = 0; i < count; ++i) {
+        const double value = static_cast<double>(values[static_cast<vtkIdType>(i) * numComponents]);
+        globalHistogram.add(value);
+        if (regionHistogram) regionHistogram->add(value);
+    }
+}
+
+// 按标签累积连续段：每段只做一次查表和包围盒更新。
+// idToLabel不为空时体素值为紧凑编号，区块按查回的原标签建立
+class RegionAccumulator
+{
+public:
+    RegionAccumulator(std::vector<LabelRegionInfo>& regions, QHash<int, int>& labelToIndex,
+                      const std::vector<int>* idToLabel)
+        : regions(regions)
+        , labelToIndex(labelToIndex)
+        , idToLabel(idToLabel)
+        , cachedValue(0)
+        , cachedIndex(-1)
+    {
+    }
+
+    // 第(y, z)行[x, runEnd)的体素值都为value；rowStart为该行第一个体素的线性索引
+    void addRun(int value, vtkIdType rowStart, int x, int runEnd, int y, int z)
+    {
+        if (value <= 0) return; // 背景
+
+        if (value != cachedValue || cachedIndex < 0) {
+            const int label = idToLabel ? (*idToLabel)[value] : value;
+            auto it = labelToIndex.constFind(label);
+            if (it == labelToIndex.constEnd()) {
+                cachedIndex = static_cast<int>(regions.size());
+                labelToIndex.insert(label, cachedIndex);
+                regions.push_back(LabelRegionInfo());
+                regions.back().label = label;
+            } else {
+                cachedIndex = it.value();
+            }
+            cachedValue = value;
+        }
+
+        LabelRegionInfo& region = regions[cachedIndex];
+        region.voxelCount += runEnd - x;
+        for (int i = x; i < runEnd; ++i) {
+            region.voxelIds.push_back(rowStart + i);
+        }
+        region.extent[0] = std::min(region.extent[0], x);
+        region.extent[1] = std::max(region.extent[1], runEnd - 1);
+        region.extent[2] = std::min(region.extent[2], y);
+        region.extent[3] = std::max(region.extent[3], y);
+        region.extent[4] = std::min(region.extent[4], z);
+        region.extent[5] = std::max(region.extent[5], z);
+    }
+
+private:
+    std::vector<LabelRegionInfo>& regions;
+    QHash<int, int>& labelToIndex;
+    const std::vector<int>* idToLabel;
+    int cachedValue;
+    int cachedIndex;
+};
+
+// 按标签累积连续段的灰度：背景只计入全局直方图，区块直方图与全局直方图范围和分箱相同
+class HistogramAccumulator
+{
+public:
+    HistogramAccumulator(std::vector<IntensityHistogram>& histograms, QHash<int, int>& labelToIndex,
+                         IntensityHistogram& globalHistogram, const IntensityHistogram& emptyHistogram,
+                         IntensityRunFunction addRun, const void* data, int numComponents,
+                         const std::vector<int>* idToLabel)
+        : histograms(histograms)
+        , labelToIndex(labelToIndex)
+        , globalHistogram(globalHistogram)
+        , emptyHistogram(emptyHistogram)
+        , addIntensity(addRun)
+        , data(data)
+        , numComponents(numComponents)
+        , idToLabel(idToLabel)
+        , cachedValue(0)
+        , cachedIndex(-1)
+    {
+    }
+
+    void addRun(int value, vtkIdType rowStart, int x, int runEnd, int, int)
+    {
+        if (value <= 0) {
+            addIntensity(data, rowStart + x, runEnd - x, numComponents, nullptr, globalHistogram);
+            return;
+        }
+
+        if (value != cachedValue || cachedIndex < 0) {
+            const int label = idToLabel ? (*idToLabel)[value] : value;
+            auto it = labelToIndex.constFind(label);
+            if (it == labelToIndex.constEnd()) {
+                cachedIndex = static_cast<int>(histograms.size());
+                labelToIndex.insert(label, cachedIndex);
+                histograms.push_back(emptyHistogram);
+            } else {
+                cachedIndex = it.value();
+            }
+            cachedValue = value;
+        }
+        addIntensity(data, rowStart + x, runEnd - x, numComponents, &histograms[cachedIndex], globalHistogram);
+    }
+
+private:
+    std::vector<IntensityHistogram>& histograms;
+    QHash<int, int>& labelToIndex;
+    IntensityHistogram& globalHistogram;
+    const IntensityHistogram& emptyHistogram;   // 新区块直方图的初始值（范围和分箱）
+    IntensityRunFunction addIntensity;
+    const void* data;
+    int numComponents;
+    const std::vector<int>* idToLabel;
+    int cachedValue;
+    int cachedIndex;
+};
+
+// 单次扫描稠密标签图像：按行查找相同标签的连续段。
+// bricks不为空时跳过只有背景的块（此时背景不参与任何统计）
+template <typename T, typename Accumulator>
+void partitionLabelImage(const T* data, int numComponents, const int dims[3], Accumulator& accumulator,
+                         const BrickIndex* bricks)
+{
+    for (int z = 0; z < dims[2]; ++z) {
+        for (int y = 0; y < dims[1]; ++y) {
+            const vtkIdType rowStart = (static_cast<vtkIdType>(z) * dims[1] + y) * dims[0];
+            const T* row = data + rowStart * numComponents;
+
+            int x = 0;
+            while (x < dims[0]) {
+                if (bricks && bricks->isBackgroundOnly(bricks->brickAt(x, y, z))) {
+                    x = std::min(dims[0], (x | (BrickIndex::kBrickSize - 1)) + 1);
+                    continue;
+                }
+                int label = static_cast<int>(row[static_cast<vtkIdType>(x) * numComponents]);
+                int runEnd = x + 1;
+                while (runEnd < dims[0] &&
+                       static_cast<int>(row[static_cast<vtkIdType>(runEnd) * numComponents]) == label) {
+                    ++runEnd;
+                }
+                accumulator.addRun(label, rowStart, x, runEnd, y, z);
+                x = runEnd;
+            }
+        }
+    }
+}
+
+// 游程编码的标签体数据直接按游程累积，游程之间的空隙为背景
+template <typename Accumulator>
+void partitionRunLengthVolume(const RunLengthLabelVolume& volume, Accumulator& accumulator)
+{
+    const int* dims = volume.getDimensions();
+    for (int z = 0; z < dims[2]; ++z) {
+        for (int y = 0; y < dims[1]; ++y) {
+            const vtkIdType rowStart = (static_cast<vtkIdType>(z) * dims[1] + y) * dims[0];
+            int x = 0;
+            const LabelRun* last = volume.rowEnd(y, z);
+            for (const LabelRun* run = volume.rowBegin(y, z); run != last; ++run) {
+                if (run->x > x) accumulator.addRun(0, rowStart, x, run->x, y, z);
+                accumulator.addRun(run->value, rowStart, run->x, run->x + run->length, y, z);
+                x = run->x + run->length;
+            }
+            if (x < dims[0]) accumulator.addRun(0, rowStart, x, dims[0], y, z);
+        }
+    }
+}
+
+} // namespace
+
+LabelPartitioner::LabelPartitioner()
+{
+    dimensions[0] = dimensions[1] = dimensions[2] = 0;
+}
+
+template <typename Scan>
+bool LabelPartitioner::runPartition(const QHash<int, vtkIdType>* expectedCounts, const std::vector<int>* idToLabel,
+                                    Scan scan)
+{
+    // 已知每个标签的体素数时预先建立区块并一次性分配索引列表
+    if (expectedCounts) {
+        QList<int> expectedLabels = expectedCounts->keys();
+        std::sort(expectedLabels.begin(), expectedLabels.end());
+        regions.reserve(expectedLabels.size());
+        for (int label : expectedLabels) {
+            labelToIndex.insert(label, static_cast<int>(regions.size()));
+            regions.push_back(LabelRegionInfo());
+            regions.back().label = label;
+            regions.back().voxelIds.reserve(static_cast<size_t>(expectedCounts->value(label)));
+        }
+    }
+
+    RegionAccumulator accumulator(regions, labelToIndex, idToLabel);
+    if (!scan(accumulator)) {
+        clear();
+        return false;
+    }
+
+    // 去掉预分配但实际不存在的标签，并按标签编号排序，保持与之前提取标签时相同的顺序
+    regions.erase(std::remove_if(regions.begin(), regions.end(),
+                                 [](const LabelRegionInfo& region) { return region.voxelCount == 0; }),
+                  regions.end());
+    std::sort(regions.begin(), regions.end(),
+              [](const LabelRegionInfo& a, const LabelRegionInfo& b) {
+                  return a.label < b.label;
+              });
+    labelToIndex.clear();
+    for (int i = 0; i < static_cast<int>(regions.size()); ++i) {
+        labelToIndex.insert(regions[i].label, i);
+    }
+
+    qDebug() << "标签划分完成，共" << regions.size() << "个区块";
+    return true;
+}
+
+bool LabelPartitioner::partition(vtkImageData* labelImage, const QHash<int, vtkIdType>* expectedCounts,
+                                 const std::vector<int>* idToLabel, const BrickIndex* bricks)
+{
+    clear();
+
+    if (!labelImage) return false;
+
+    vtkDataArray* scalars = labelImage->GetPointData()->GetScalars();
+    if (!scalars) return false;
+
+    labelImage->GetDimensions(dimensions);
+
+    int numComponents = scalars->GetNumberOfComponents();
+    void* scalarPointer = scalars->GetVoidPointer(0);
+
+    if (!bricks || !bricks->hasLabels() || !bricks->matches(labelImage)) bricks = nullptr;
+
+    return runPartition(expectedCounts, idToLabel, [&](RegionAccumulator& accumulator) -> bool {
+        switch (scalars->GetDataType()) {
+            vtkTemplateMacro(partitionLabelImage(static_cast<const VTK_TT*>(scalarPointer), numComponents,
+                                                 dimensions, accumulator, bricks));
+        default:
+            qDebug() << "标签划分: 不支持的标量类型" << scalars->GetDataType();
+            return false;
+        }
+        return true;
+    });
+}
+
+bool LabelPartitioner::partition(const RunLengthLabelVolume& labelVolume, const QHash<int, vtkIdType>* expectedCounts,
+                                 const std::vector<int>* idToLabel)
+{
+    clear();
+
+    if (!labelVolume.isValid()) return false;
+    std::copy(labelVolume.getDimensions(), labelVolume.getDimensions() + 3, dimensions);
+
+    return runPartition(expectedCounts, idToLabel, [&](RegionAccumulator& accumulator) -> bool {
+        partitionRunLengthVolume(labelVolume, accumulator);
+        return true;
+    });
+}
+
+void LabelPartitioner::clear()
+{
+    regions.clear();
+    labelToIndex.clear();
+    dimensions[0] = dimensions[1] = dimensions[2] = 0;
+}
+
+QList<int> LabelPartitioner::getLabels() const
+{
+    QList<int> labels;
+    for (const auto& region : regions) {
+        labels.append(region.label);
+    }
+    return labels;
+}
+
+const LabelRegionInfo* LabelPartitioner::getRegion(int label) const
+{
+    auto it = labelToIndex.constFind(label);
+    if (it == labelToIndex.constEnd()) return nullptr;
+    return &regions[it.value()];
+}
+
+template <typename Scan>
+bool LabelIntensityHistograms::runBuild(vtkImageData* intensityImage, const int labelDimensions[3],
+                                        const std::vector<int>* idToLabel, Scan scan)
+{
+    clear();
+
+    vtkDataArray* intensityScalars = intensityImage ? intensityImage->GetPointData()->GetScalars() : nullptr;
+    if (!intensityScalars) return false;
+
+    int intensityDimensions[3];
+    intensityImage->GetDimensions(intensityDimensions);
+    if (intensityDimensions[0] != labelDimensions[0] || intensityDimensions[1] != labelDimensions[1] ||
+        intensityDimensions[2] != labelDimensions[2]) {
+        qDebug() << "灰度直方图: MRI与标签尺寸不一致，不统计";
+        return false;
+    }
+
+    IntensityRunFunction addRun = nullptr;
+    switch (intensityScalars->GetDataType()) {
+        vtkTemplateMacro(addRun = &addIntensityRun<VTK_TT>);
+    default:
+        qDebug() << "灰度直方图: 不支持的MRI标量类型" << intensityScalars->GetDataType();
+        return false;
+    }
+
+    double range[2];
+    intensityScalars->GetRange(range, 0);
+    const int dataType = intensityScalars->GetDataType();
+    IntensityHistogram emptyHistogram;
+    emptyHistogram.reset(range[0], range[1], IntensityHistogram::kDefaultBinCount,
+                         dataType != VTK_FLOAT && dataType != VTK_DOUBLE);
+    globalHistogram = emptyHistogram;
+
+    HistogramAccumulator accumulator(regionHistograms, labelToIndex, globalHistogram, emptyHistogram, addRun,
+                                     intensityScalars->GetVoidPointer(0), intensityScalars->GetNumberOfComponents(),
+                                     idToLabel);
+    if (!scan(accumulator)) {
+        clear();
+        return false;
+    }
+
+    qDebug() << "灰度直方图统计完成，共" << regionHistograms.size() << "个区块";
+    return true;
+}
+
+bool LabelIntensityHistograms::build(vtkImageData* intensityImage, vtkImageData* labelImage,
+                                     const std::vector<int>* idToLabel)
+{
+    vtkDataArray* scalars = labelImage ? labelImage->GetPointData()->GetScalars() : nullptr;
+    if (!scalars) {
+        clear();
+        return false;
+    }
+
+    int dims[3];
+    labelImage->GetDimensions(dims);
+    const int numComponents = scalars->GetNumberOfComponents();
+    const void* scalarPointer = scalars->GetVoidPointer(0);
+
+    // 背景体素也计入全局直方图，不跳块
+    return runBuild(intensityImage, dims, idToLabel, [&](HistogramAccumulator& accumulator) -> bool {
+        switch (scalars->GetDataType()) {
+            vtkTemplateMacro(partitionLabelImage(static_cast<const VTK_TT*>(scalarPointer), numComponents,
+                                                 dims, accumulator, static_cast<const BrickIndex*>(nullptr)));
+        default:
+            qDebug() << "灰度直方图: 不支持的标签标量类型" << scalars->GetDataType();
+            return false;
+        }
+        return true;
+    });
+}
+
+bool LabelIntensityHistograms::build(vtkImageData* intensityImage, const RunLengthLabelVolume& labelVolume,
+                                     const std::vector<int>* idToLabel)
+{
+    if (!labelVolume.isValid()) {
+        clear();
+        return false;
+    }
+
+    return runBuild(intensityImage, labelVolume.getDimensions(), idToLabel,
+                    [&](HistogramAccumulator& accumulator) -> bool {
+                        partitionRunLengthVolume(labelVolume, accumulator);
+                        return true;
+                    });
+}
+
+void LabelIntensityHistograms::clear()
+{
+    globalHistogram = IntensityHistogram();
+    regionHistograms.clear();
+    labelToIndex.clear();
+}
+
+const IntensityHistogram* LabelIntensityHistograms::getRegionHistogram(int label) const
+{
+    auto it = labelToIndex.constFind(label);
+    if (it == labelToIndex.constEnd()) return nullptr;
+    return &regionHistograms[it.value()];
+}
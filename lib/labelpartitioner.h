@@ -0,0 +1,101 @@
+#ifndef LABELPARTITIONER_H
+#define LABELPARTITIONER_H
+
+#include <QList>
+#include <QHash>
+
+#include <vector>
+
+#include "intensityhistogram.h"
+
+// VTK头文件
+#include <vtkType.h>
+
+class vtkImageData;
+class BrickIndex;
+class RunLengthLabelVolume;
+
+/**
+ * @brief 单个标签区块的体素划分结果
+ */
+struct LabelRegionInfo
+{
+    int label;                          // 标签编号
+    vtkIdType voxelCount;               // 体素数量
+    int extent[6];                      // 紧包围盒 [xmin, xmax, ymin, ymax, zmin, zmax]（体素索引，含端点）
+    std::vector<vtkIdType> voxelIds;    // 区块内体素的线性索引（按扫描顺序递增）
+
+    LabelRegionInfo();
+};
+
+/**
+ * @brief 多标签单次扫描划分器
+ *
+ * 对标签图像只扫描一次，为每个标签同时得到体素数量、紧包围盒和
+ * 紧凑的体素索引列表。后续每个区块的处理只需访问自己的体素，
+ * 避免对每个标签都在整幅体数据上做阈值/类型转换/乘法。
+ * 只读取标签，不需要MRI；灰度直方图由LabelIntensityHistograms单独统计。
+ */
+class LabelPartitioner
+{
+public:
+    LabelPartitioner();
+
+    // 扫描标签图像，重建所有区块信息
+    // expectedCounts为加载时统计的每标签体素数，用于预分配索引列表；
+    // idToLabel不为空时labelImage为紧凑编号图像（见CompactLabelVolume），区块标签为查回的原标签；
+    // bricks为labelImage的块索引时跳过只有背景的块
+    bool partition(vtkImageData* labelImage, const QHash<int, vtkIdType>* expectedCounts = nullptr,
+                   const std::vector<int>* idToLabel = nullptr, const BrickIndex* bricks = nullptr);
+    // 直接遍历游程编码的标签体数据（不解压），参数含义同上
+    bool partition(const RunLengthLabelVolume& labelVolume, const QHash<int, vtkIdType>* expectedCounts = nullptr,
+                   const std::vector<int>* idToLabel = nullptr);
+    void clear();
+
+    // 获取信息
+    QList<int> getLabels() const;
+    const LabelRegionInfo* getRegion(int label) const;
+    int getRegionCount() const { return static_cast<int>(regions.size()); }
+    const int* getDimensions() const { return dimensions; }
+
+private:
+    // 两种输入共用：预分配区块，scan累积所有连续段后整理区块顺序
+    template <typename Scan>
+    bool runPartition(const QHash<int, vtkIdType>* expectedCounts, const std::vector<int>* idToLabel, Scan scan);
+
+    std::vector<LabelRegionInfo> regions;
+    QHash<int, int> labelToIndex;
+    int dimensions[3];
+};
+
+/**
+ * @brief 整幅MRI和每个标签区块的灰度直方图
+ *
+ * 与标签划分分开的一次扫描：按行遍历标签（稠密图像或游程编码）和同尺寸的MRI，
+ * 只有需要直方图时才读取MRI。只读取输入，可以在工作线程中执行。
+ */
+class LabelIntensityHistograms
+{
+public:
+    // 参数含义同LabelPartitioner::partition；MRI与标签尺寸不一致时返回false
+    bool build(vtkImageData* intensityImage, vtkImageData* labelImage, const std::vector<int>* idToLabel = nullptr);
+    bool build(vtkImageData* intensityImage, const RunLengthLabelVolume& labelVolume,
+               const std::vector<int>* idToLabel = nullptr);
+    void clear();
+
+    // 全局直方图包含背景在内的所有体素，区块直方图与其范围和分箱相同
+    bool isValid() const { return globalHistogram.isValid(); }
+    const IntensityHistogram& getGlobalHistogram() const { return globalHistogram; }
+    const IntensityHistogram* getRegionHistogram(int label) const;
+
+private:
+    template <typename Scan>
+    bool runBuild(vtkImageData* intensityImage, const int labelDimensions[3], const std::vector<int>* idToLabel,
+                  Scan scan);
+
+    IntensityHistogram globalHistogram;
+    std::vector<IntensityHistogram> regionHistograms;
+    QHash<int, int> labelToIndex;
+};
+
+#endif // LABELPARTITIONER_H
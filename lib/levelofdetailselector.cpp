@@ -0,0 +1,116 @@
+#include "levelofdetailselector.h"
+
+#include <algorithm>
+
+namespace {
+
+// 预算只取估计值的90%，给相机、状态切换等固定开销留出余量
+const double kBudgetHeadroom = 0.9;
+
+// 新估计与旧预算的混合比例，避免区块在两个层次之间逐帧来回切换
+const double kBudgetSmoothing = 0.5;
+
+// 每帧预算最多增长的倍数
+const double kMaxBudgetGrowth = 2.0;
+
+// 预算下限，保证极慢的帧也能看清大致轮廓
+const vtkIdType kMinTriangleBudget = 20000;
+
+// 投影直径小于该像素数的区块直接使用最粗层次
+const double kMinProjectedSize = 8.0;
+
+} // namespace
+
+RegionDetailCandidate::RegionDetailCandidate()
+    : projectedSize(0.0)
+{
+}
+
+LevelOfDetailSelector::LevelOfDetailSelector()
+    : triangleBudget(-1)
+    , lastFrameTriangles(0)
+{
+}
+
+void LevelOfDetailSelector::reset()
+{
+    triangleBudget = -1;
+    lastFrameTriangles = 0;
+}
+
+void LevelOfDetailSelector::updateBudget(double lastFrameTime, double targetFrameTime,
+                                         vtkIdType fullDetailTriangles)
+{
+    if (fullDetailTriangles <= 0 || targetFrameTime <= 0.0) return;
+
+    // 交互开始的第一帧沿用完整细节帧的耗时
+    const vtkIdType renderedTriangles = lastFrameTriangles > 0 ? lastFrameTriangles : fullDetailTriangles;
+    const double currentBudget = triangleBudget >= 0 ? static_cast<double>(triangleBudget)
+                                                     : static_cast<double>(fullDetailTriangles);
+    if (lastFrameTime <= 0.0) {
+        triangleBudget = static_cast<vtkIdType>(currentBudget);
+        return;
+    }
+
+    const double trianglesPerSecond = renderedTriangles / lastFrameTime;
+    const double estimate = trianglesPerSecond * targetFrameTime * kBudgetHeadroom;
+
+    double budget = currentBudget * (1.0 - kBudgetSmoothing) + estimate * kBudgetSmoothing;
+    budget = std::min(budget, currentBudget * kMaxBudgetGrowth);
+    budget = std::min(budget, static_cast<double>(fullDetailTriangles));
+    budget = std::max(budget, static_cast<double>(std::min(kMinTriangleBudget, fullDetailTriangles)));
+    triangleBudget = static_cast<vtkIdType>(budget);
+}
+
+void LevelOfDetailSelector::select(const std::vector<RegionDetailCandidate>& regions, std::vector<int>& levels)
+{
+    const size_t count = regions.size();
+    levels.assign(count, 0);
+
+    if (triangleBudget < 0) {
+        lastFrameTriangles = 0;
+        for (const auto& region : regions) {
+            if (!region.triangleCounts.empty()) lastFrameTriangles += region.triangleCounts.front();
+        }
+        return;
+    }
+
+    // 从小到大分配：小区块用不完的份额按面积比例留给后面更大的区块
+    std::vector<size_t> order(count);
+    double remainingArea = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        order[i] = i;
+        remainingArea += regions[i].projectedSize * regions[i].projectedSize;
+    }
+    std::sort(order.begin(), order.end(), [&regions](size_t a, size_t b) {
+        return regions[a].projectedSize < regions[b].projectedSize;
+    });
+
+    double remainingBudget = static_cast<double>(triangleBudget);
+    vtkIdType usedTriangles = 0;
+    for (size_t index : order) {
+        const RegionDetailCandidate& region = regions[index];
+        const double area = region.projectedSize * region.projectedSize;
+        if (region.triangleCounts.empty()) {
+            remainingArea -= area;
+            continue;
+        }
+
+        const double share = remainingArea > 0.0 ? remainingBudget * area / remainingArea : 0.0;
+        int level = static_cast<int>(region.triangleCounts.size()) - 1;
+        if (region.projectedSize >= kMinProjectedSize) {
+            for (int candidate = 0; candidate < level; ++candidate) {
+                if (static_cast<double>(region.triangleCounts[candidate]) <= share) {
+                    level = candidate;
+                    break;
+                }
+            }
+        }
+
+        levels[index] = level;
+        usedTriangles += region.triangleCounts[level];
+        remainingBudget -= static_cast<double>(region.triangleCounts[level]);
+        remainingArea -= area;
+    }
+    lastFrameTriangles = usedTriangles;
+}
@@ -0,0 +1,47 @@
+#ifndef LEVELOFDETAILSELECTOR_H
+#define LEVELOFDETAILSELECTOR_H
+
+#include <vector>
+
+// VTK头文件
+#include <vtkType.h>
+
+/**
+ * @brief 单个区块参与细节层次选择的信息
+ */
+struct RegionDetailCandidate
+{
+    double projectedSize;                   // 包围球在屏幕上的投影直径（像素）
+    std::vector<vtkIdType> triangleCounts;  // 各细节层次的三角形数，0为完整网格，随层次递减
+
+    RegionDetailCandidate();
+};
+
+/**
+ * @brief 按帧时间选择各区块的细节层次
+ *
+ * 交互期间根据上一帧的渲染耗时估计每帧可绘制的三角形数（三角形预算），
+ * 再按投影面积把预算分给各区块：投影越大的区块分到越多的三角形，
+ * 每个区块取预算内最精细的层次。小区块用不完的份额留给更大的区块。
+ */
+class LevelOfDetailSelector
+{
+public:
+    LevelOfDetailSelector();
+
+    // 交互结束后调用，下一次交互重新从完整细节开始估计
+    void reset();
+
+    // 根据上一帧耗时和目标帧时间（秒）更新三角形预算
+    void updateBudget(double lastFrameTime, double targetFrameTime, vtkIdType fullDetailTriangles);
+    vtkIdType getTriangleBudget() const { return triangleBudget; }
+
+    // 为每个区块选择层次，结果写入levels（与regions一一对应）
+    void select(const std::vector<RegionDetailCandidate>& regions, std::vector<int>& levels);
+
+private:
+    vtkIdType triangleBudget;        // 小于0表示尚未测量，使用完整细节
+    vtkIdType lastFrameTriangles;    // 上一次选择实际使用的三角形数
+};
+
+#endif // LEVELOFDETAILSELECTOR_H
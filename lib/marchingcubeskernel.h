@@ -0,0 +1,534 @@
+#ifndef MARCHINGCUBESKERNEL_H
+#define MARCHINGCUBESKERNEL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MC_KERNEL_USE_SSE2 1
+#define MC_KERNEL_USE_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MC_KERNEL_USE_SSE2 1
+#endif
+
+// VTK头文件
+#include <vtkType.h>
+
+#include "marchingcubestables.h"
+#include "parallelfor.h"
+
+/**
+ * @brief 等值面提取结果（紧凑的顶点/索引缓冲）
+ *
+ * 顶点在相邻单元之间共享（通过棱顶点缓存，不需要点定位器），
+ * 可以直接拷贝进vtkPoints/vtkCellArray交给vtkPolyDataMapper。
+ */
+struct IsosurfaceMesh
+{
+    std::vector<float> points;          // 顶点坐标 xyz（世界坐标）
+    std::vector<float> normals;         // 顶点法向 xyz（可选，指向数值较低的一侧）
+    std::vector<vtkIdType> triangles;   // 每3个顶点索引为一个三角形
+
+    vtkIdType getNumberOfPoints() const { return static_cast<vtkIdType>(points.size() / 3); }
+    vtkIdType getNumberOfTriangles() const { return static_cast<vtkIdType>(triangles.size() / 3); }
+    void clear()
+    {
+        points.clear();
+        normals.clear();
+        triangles.clear();
+    }
+};
+
+namespace MarchingCubesDetail {
+
+// 每个切片至少包含的体素数，小于此值的体数据（如裁剪后的区块）不拆分切片
+static const vtkIdType kMinVoxelsPerSlab = vtkIdType(1) << 18;
+
+#ifdef MC_KERNEL_USE_SSE2
+// 把16个0/0xFF掩码字节写成0/1，并返回其中1的个数
+inline vtkIdType storeMaskBytes(__m128i mask, unsigned char* out)
+{
+    const __m128i bits = _mm_and_si128(mask, _mm_set1_epi8(1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bits);
+    const __m128i sums = _mm_sad_epu8(bits, _mm_setzero_si128());
+    return _mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+}
+#endif
+
+/**
+ * @brief 连续数据的向量化阈值分类（value >= iso 记为1）
+ *
+ * 主模板表示该标量类型没有向量化实现；特化版本处理完整的向量块，
+ * 返回已处理的元素数，剩余部分由通用循环完成。
+ */
+template <typename T>
+struct SimdThreshold
+{
+    static vtkIdType classify(const T*, vtkIdType, double, unsigned char*, vtkIdType&) { return 0; }
+};
+
+#ifdef MC_KERNEL_USE_SSE2
+// float数据：value >= iso（按double比较）等价于 value >= 不小于iso的最小float。
+// 向量部分用这个阈值按float比较，与标量部分的double比较结果完全一致
+inline float floatThreshold(double iso)
+{
+    const float maxValue = std::numeric_limits<float>::max();
+    if (iso > maxValue) return std::numeric_limits<float>::infinity();
+    if (iso < -maxValue) return -maxValue;
+    float threshold = static_cast<float>(iso);
+    if (static_cast<double>(threshold) < iso) {
+        threshold = std::nextafter(threshold, std::numeric_limits<float>::infinity());
+    }
+    return threshold;
+}
+
+template <>
+struct SimdThreshold<float>
+{
+    static vtkIdType classify(const float* values, vtkIdType count, double iso, unsigned char* out,
+                              vtkIdType& insideCount)
+    {
+        vtkIdType i = 0;
+#ifdef MC_KERNEL_USE_AVX2
+        const __m256 threshold = _mm256_set1_ps(floatThreshold(iso));
+        for (; i + 16 <= count; i += 16) {
+            const __m256 a = _mm256_cmp_ps(_mm256_loadu_ps(values + i), threshold, _CMP_GE_OQ);
+            const __m256 b = _mm256_cmp_ps(_mm256_loadu_ps(values + i + 8), threshold, _CMP_GE_OQ);
+            const __m128i a16 = _mm_packs_epi32(_mm256_castsi256_si128(_mm256_castps_si256(a)),
+                                                _mm256_extractf128_si256(_mm256_castps_si256(a), 1));
+            const __m128i b16 = _mm_packs_epi32(_mm256_castsi256_si128(_mm256_castps_si256(b)),
+                                                _mm256_extractf128_si256(_mm256_castps_si256(b), 1));
+            insideCount += storeMaskBytes(_mm_packs_epi16(a16, b16), out + i);
+        }
+#else
+        const __m128 threshold = _mm_set1_ps(floatThreshold(iso));
+        for (; i + 16 <= count; i += 16) {
+            const __m128i m0 = _mm_castps_si128(_mm_cmpge_ps(_mm_loadu_ps(values + i), threshold));
+            const __m128i m1 = _mm_castps_si128(_mm_cmpge_ps(_mm_loadu_ps(values + i + 4), threshold));
+            const __m128i m2 = _mm_castps_si128(_mm_cmpge_ps(_mm_loadu_ps(values + i + 8), threshold));
+            const __m128i m3 = _mm_castps_si128(_mm_cmpge_ps(_mm_loadu_ps(values + i + 12), threshold));
+            insideCount += storeMaskBytes(_mm_packs_epi16(_mm_packs_epi32(m0, m1), _mm_packs_epi32(m2, m3)),
+                                          out + i);
+        }
+#endif
+        return i;
+    }
+};
+
+// 整数类型：value >= iso 等价于 value >= ceil(iso)，转成有符号比较 value > ceil(iso) - 1
+template <typename T>
+inline bool integerThreshold(double iso, int& thresholdMinusOne, bool& allInside, bool& noneInside)
+{
+    const double threshold = std::ceil(iso);
+    allInside = threshold <= static_cast<double>(std::numeric_limits<T>::min());
+    noneInside = threshold > static_cast<double>(std::numeric_limits<T>::max());
+    thresholdMinusOne = (allInside || noneInside) ? 0 : static_cast<int>(threshold) - 1;
+    return !allInside && !noneInside;
+}
+
+inline vtkIdType fillConstant(vtkIdType count, bool inside, unsigned char* out, vtkIdType& insideCount)
+{
+    std::memset(out, inside ? 1 : 0, static_cast<size_t>(count));
+    if (inside) insideCount += count;
+    return count;
+}
+
+template <>
+struct SimdThreshold<unsigned char>
+{
+    static vtkIdType classify(const unsigned char* values, vtkIdType count, double iso, unsigned char* out,
+                              vtkIdType& insideCount)
+    {
+        int thresholdMinusOne;
+        bool allInside, noneInside;
+        if (!integerThreshold<unsigned char>(iso, thresholdMinusOne, allInside, noneInside)) {
+            return fillConstant(count, allInside, out, insideCount);
+        }
+        const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80));
+        const __m128i threshold = _mm_set1_epi8(static_cast<char>(thresholdMinusOne ^ 0x80));
+        vtkIdType i = 0;
+        for (; i + 16 <= count; i += 16) {
+            const __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)), bias);
+            insideCount += storeMaskBytes(_mm_cmpgt_epi8(v, threshold), out + i);
+        }
+        return i;
+    }
+};
+
+template <typename T, int Bias>
+struct SimdThreshold16
+{
+    static vtkIdType classify(const T* values, vtkIdType count, double iso, unsigned char* out,
+                              vtkIdType& insideCount)
+    {
+        int thresholdMinusOne;
+        bool allInside, noneInside;
+        if (!integerThreshold<T>(iso, thresholdMinusOne, allInside, noneInside)) {
+            return fillConstant(count, allInside, out, insideCount);
+        }
+        const __m128i bias = _mm_set1_epi16(static_cast<short>(Bias));
+        const __m128i threshold = _mm_set1_epi16(static_cast<short>(thresholdMinusOne ^ Bias));
+        vtkIdType i = 0;
+        for (; i + 16 <= count; i += 16) {
+            const __m128i a = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)), bias);
+            const __m128i b = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i + 8)), bias);
+            insideCount += storeMaskBytes(_mm_packs_epi16(_mm_cmpgt_epi16(a, threshold),
+                                                          _mm_cmpgt_epi16(b, threshold)), out + i);
+        }
+        return i;
+    }
+};
+
+template <>
+struct SimdThreshold<short> : SimdThreshold16<short, 0> {};
+template <>
+struct SimdThreshold<unsigned short> : SimdThreshold16<unsigned short, 0x8000> {};
+#endif // MC_KERNEL_USE_SSE2
+
+// 灰度等值面：value >= iso 为内侧，顶点按线性插值放在棱上
+template <typename T>
+struct ThresholdClassifier
+{
+    explicit ThresholdClassifier(double isoValue) : iso(isoValue) {}
+
+    vtkIdType classify(const T* values, vtkIdType count, int stride, unsigned char* out) const
+    {
+        vtkIdType insideCount = 0;
+        vtkIdType i = 0;
+        if (stride == 1) {
+            i = SimdThreshold<T>::classify(values, count, iso, out, insideCount);
+        }
+        for (; i < count; ++i) {
+            const unsigned char inside = static_cast<double>(values[i * stride]) >= iso ? 1 : 0;
+            out[i] = inside;
+            insideCount += inside;
+        }
+        return insideCount;
+    }
+
+    double edgeParameter(T a, T b) const
+    {
+        const double da = static_cast<double>(a);
+        const double t = (iso - da) / (static_cast<double>(b) - da);
+        return std::min(1.0, std::max(0.0, t));
+    }
+
+    double iso;
+};
+
+// 离散标签表面：value == label 为内侧，顶点放在棱的中点（与vtkDiscreteMarchingCubes一致）
+template <typename T>
+struct LabelClassifier
+{
+    explicit LabelClassifier(double labelValue) : label(labelValue) {}
+
+    vtkIdType classify(const T* values, vtkIdType count, int stride, unsigned char* out) const
+    {
+        vtkIdType insideCount = 0;
+        for (vtkIdType i = 0; i < count; ++i) {
+            const unsigned char inside = static_cast<double>(values[i * stride]) == label ? 1 : 0;
+            out[i] = inside;
+            insideCount += inside;
+        }
+        return insideCount;
+    }
+
+    double edgeParameter(T, T) const { return 0.5; }
+
+    double label;
+};
+
+// 一个z切片的提取结果。非第一个切片不在底层点层上创建x/y棱顶点，
+// 而是写入占位编号 -(2 + key)，合并时从上一个切片的顶层棱缓存中取回
+struct SlabOutput
+{
+    std::vector<float> points;
+    std::vector<vtkIdType> triangles;
+    std::vector<vtkIdType> topXEdges;
+    std::vector<vtkIdType> topYEdges;
+};
+
+template <typename T, typename Classifier>
+class SlabMarcher
+{
+public:
+    SlabMarcher(const T* scalars, int stride, const int dims[3], const double origin[3],
+                const double spacing[3], const Classifier& classifier)
+        : scalars(scalars)
+        , stride(stride)
+        , classifier(classifier)
+    {
+        for (int i = 0; i < 3; ++i) {
+            this->dims[i] = dims[i];
+            this->origin[i] = origin[i];
+            this->spacing[i] = spacing[i];
+        }
+        sliceSize = static_cast<vtkIdType>(dims[0]) * dims[1];
+    }
+
+    // 处理单元层 [zBegin, zEnd)，即点层 zBegin .. zEnd
+    void march(int zBegin, int zEnd, bool borrowBottomLayer, SlabOutput& out)
+    {
+        using namespace MarchingCubesTables;
+
+        this->out = &out;
+        this->borrowBottom = borrowBottomLayer;
+        const int nx = dims[0];
+        const int ny = dims[1];
+
+        for (int s = 0; s < 2; ++s) {
+            inside[s].resize(static_cast<size_t>(sliceSize));
+            rowInside[s].resize(static_cast<size_t>(ny));
+            xEdges[s].resize(static_cast<size_t>(sliceSize));
+            yEdges[s].resize(static_cast<size_t>(sliceSize));
+        }
+        zEdges.resize(static_cast<size_t>(sliceSize));
+
+        classifyLayer(zBegin, 0);
+        std::fill(xEdges[0].begin(), xEdges[0].end(), -1);
+        std::fill(yEdges[0].begin(), yEdges[0].end(), -1);
+
+        vtkIdType edgeIds[12];
+        for (int z = zBegin; z < zEnd; ++z) {
+            currentZ = z;
+            classifyLayer(z + 1, 1);
+            std::fill(xEdges[1].begin(), xEdges[1].end(), -1);
+            std::fill(yEdges[1].begin(), yEdges[1].end(), -1);
+            std::fill(zEdges.begin(), zEdges.end(), -1);
+
+            const unsigned char* lower = inside[0].data();
+            const unsigned char* upper = inside[1].data();
+
+            for (int y = 0; y + 1 < ny; ++y) {
+                // 四行点全部在内侧或全部在外侧时整行单元都不与等值面相交
+                const vtkIdType rowSum = rowInside[0][y] + rowInside[0][y + 1] +
+                                         rowInside[1][y] + rowInside[1][y + 1];
+                if (rowSum == 0 || rowSum == 4 * static_cast<vtkIdType>(nx)) continue;
+
+                const vtkIdType row0 = static_cast<vtkIdType>(y) * nx;
+                const vtkIdType row1 = row0 + nx;
+                for (int x = 0; x + 1 < nx; ++x) {
+                    const int cubeCase = lower[row0 + x] | (lower[row0 + x + 1] << 1) |
+                                         (lower[row1 + x] << 2) | (lower[row1 + x + 1] << 3) |
+                                         (upper[row0 + x] << 4) | (upper[row0 + x + 1] << 5) |
+                                         (upper[row1 + x] << 6) | (upper[row1 + x + 1] << 7);
+                    const unsigned short edgeMask = kEdgeTable[cubeCase];
+                    if (edgeMask == 0) continue;
+
+                    for (int e = 0; e < 12; ++e) {
+                        if (edgeMask & (1 << e)) {
+                            edgeIds[e] = edgeVertex(e, x, y);
+                        }
+                    }
+                    const signed char* triangle = kTriangleTable[cubeCase];
+                    for (; *triangle >= 0; ++triangle) {
+                        out.triangles.push_back(edgeIds[*triangle]);
+                    }
+                }
+            }
+
+            std::swap(inside[0], inside[1]);
+            std::swap(rowInside[0], rowInside[1]);
+            std::swap(xEdges[0], xEdges[1]);
+            std::swap(yEdges[0], yEdges[1]);
+            borrowBottom = false;
+        }
+
+        out.topXEdges.swap(xEdges[0]);
+        out.topYEdges.swap(yEdges[0]);
+    }
+
+private:
+    const T* pointer(int x, int y, int z) const
+    {
+        return scalars + ((static_cast<vtkIdType>(z) * dims[1] + y) * dims[0] + x) * stride;
+    }
+
+    void classifyLayer(int z, int slot)
+    {
+        const int nx = dims[0];
+        for (int y = 0; y < dims[1]; ++y) {
+            rowInside[slot][y] = classifier.classify(pointer(0, y, z), nx, stride,
+                                                     inside[slot].data() + static_cast<vtkIdType>(y) * nx);
+        }
+    }
+
+    vtkIdType edgeVertex(int edge, int x, int y)
+    {
+        using namespace MarchingCubesTables;
+
+        const int axis = kEdgeAxis[edge];
+        const int px = x + kEdgeOffset[edge][0];
+        const int py = y + kEdgeOffset[edge][1];
+        const int layer = kEdgeOffset[edge][2];
+        const vtkIdType index = static_cast<vtkIdType>(py) * dims[0] + px;
+
+        vtkIdType* slot;
+        if (axis == 2) {
+            slot = &zEdges[index];
+        } else {
+            if (layer == 0 && borrowBottom) {
+                return -(2 + axis * sliceSize + index);
+            }
+            slot = axis == 0 ? &xEdges[layer][index] : &yEdges[layer][index];
+        }
+        if (*slot >= 0) return *slot;
+
+        const int pz = currentZ + layer;
+        const int step[3] = {axis == 0 ? 1 : 0, axis == 1 ? 1 : 0, axis == 2 ? 1 : 0};
+        const double t = classifier.edgeParameter(*pointer(px, py, pz),
+                                                  *pointer(px + step[0], py + step[1], pz + step[2]));
+        const int p[3] = {px, py, pz};
+
+        *slot = static_cast<vtkIdType>(out->points.size() / 3);
+        for (int i = 0; i < 3; ++i) {
+            out->points.push_back(static_cast<float>(origin[i] + (p[i] + t * step[i]) * spacing[i]));
+        }
+        return *slot;
+    }
+
+    const T* scalars;
+    int stride;
+    Classifier classifier;
+    int dims[3];
+    double origin[3];
+    double spacing[3];
+    vtkIdType sliceSize;
+
+    // 两个滚动点层：0为当前单元层的下层，1为上层
+    std::vector<unsigned char> inside[2];
+    std::vector<vtkIdType> rowInside[2];
+    std::vector<vtkIdType> xEdges[2];
+    std::vector<vtkIdType> yEdges[2];
+    std::vector<vtkIdType> zEdges;
+
+    SlabOutput* out = nullptr;
+    bool borrowBottom = false;
+    int currentZ = 0;
+};
+
+// 面积加权的顶点法向
+inline void computeVertexNormals(IsosurfaceMesh& mesh)
+{
+    mesh.normals.assign(mesh.points.size(), 0.0f);
+    const vtkIdType numTriangles = mesh.getNumberOfTriangles();
+    for (vtkIdType t = 0; t < numTriangles; ++t) {
+        const vtkIdType* ids = &mesh.triangles[static_cast<size_t>(t) * 3];
+        const float* a = &mesh.points[static_cast<size_t>(ids[0]) * 3];
+        const float* b = &mesh.points[static_cast<size_t>(ids[1]) * 3];
+        const float* c = &mesh.points[static_cast<size_t>(ids[2]) * 3];
+        const float u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        const float v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        const float n[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+        for (int k = 0; k < 3; ++k) {
+            float* normal = &mesh.normals[static_cast<size_t>(ids[k]) * 3];
+            normal[0] += n[0];
+            normal[1] += n[1];
+            normal[2] += n[2];
+        }
+    }
+    for (size_t i = 0; i < mesh.normals.size(); i += 3) {
+        float* normal = &mesh.normals[i];
+        const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (length > 0.0f) {
+            normal[0] /= length;
+            normal[1] /= length;
+            normal[2] /= length;
+        }
+    }
+}
+
+template <typename T, typename Classifier>
+void marchingCubes(const T* scalars, int stride, const int dims[3], const double origin[3],
+                   const double spacing[3], const Classifier& classifier, bool computeNormals,
+                   IsosurfaceMesh& mesh)
+{
+    mesh.clear();
+    if (!scalars || dims[0] < 2 || dims[1] < 2 || dims[2] < 2) return;
+
+    // 按z方向切片并行，小体数据只用一个切片
+    const vtkIdType sliceSize = static_cast<vtkIdType>(dims[0]) * dims[1];
+    const int cellLayers = dims[2] - 1;
+    const int grain = static_cast<int>(std::max<vtkIdType>(4, kMinVoxelsPerSlab / sliceSize));
+    const int numSlabs = ParallelFor::chunkCount(0, cellLayers, grain);
+    if (numSlabs <= 0) return;
+
+    std::vector<SlabOutput> slabs(static_cast<size_t>(numSlabs));
+    ParallelFor::parallelForChunks(0, cellLayers, numSlabs,
+        [&](int chunk, int zBegin, int zEnd) {
+            SlabMarcher<T, Classifier> marcher(scalars, stride, dims, origin, spacing, classifier);
+            marcher.march(zBegin, zEnd, chunk > 0, slabs[static_cast<size_t>(chunk)]);
+        });
+
+    // 拼接各切片，解析借用的底层顶点
+    size_t totalPoints = 0;
+    size_t totalTriangles = 0;
+    for (const auto& slab : slabs) {
+        totalPoints += slab.points.size();
+        totalTriangles += slab.triangles.size();
+    }
+    mesh.points.reserve(totalPoints);
+    mesh.triangles.reserve(totalTriangles);
+
+    vtkIdType previousOffset = 0;
+    for (size_t s = 0; s < slabs.size(); ++s) {
+        const vtkIdType offset = static_cast<vtkIdType>(mesh.points.size() / 3);
+        const SlabOutput& slab = slabs[s];
+        mesh.points.insert(mesh.points.end(), slab.points.begin(), slab.points.end());
+        for (vtkIdType id : slab.triangles) {
+            if (id >= 0) {
+                mesh.triangles.push_back(id + offset);
+            } else {
+                const vtkIdType key = -id - 2;
+                const SlabOutput& below = slabs[s - 1];
+                const vtkIdType index = key % sliceSize;
+                const vtkIdType sharedId = key < sliceSize ? below.topXEdges[static_cast<size_t>(index)]
+                                                           : below.topYEdges[static_cast<size_t>(index)];
+                mesh.triangles.push_back(sharedId + previousOffset);
+            }
+        }
+        previousOffset = offset;
+    }
+
+    if (computeNormals) {
+        computeVertexNormals(mesh);
+    }
+}
+
+} // namespace MarchingCubesDetail
+
+/**
+ * @brief 提取灰度等值面（value >= isoValue 的区域的边界）
+ *
+ * stride为每个体素的分量数，只使用第一个分量。float、uchar、short、ushort
+ * 在连续数据上使用SSE2/AVX2分类，其余类型走通用路径。
+ */
+template <typename T>
+void extractMarchingCubesSurface(const T* scalars, int stride, const int dims[3], const double origin[3],
+                                 const double spacing[3], double isoValue, bool computeNormals,
+                                 IsosurfaceMesh& mesh)
+{
+    MarchingCubesDetail::marchingCubes(scalars, stride, dims, origin, spacing,
+                                       MarchingCubesDetail::ThresholdClassifier<T>(isoValue),
+                                       computeNormals, mesh);
+}
+
+/**
+ * @brief 提取离散标签值的表面（value == labelValue 的区域的边界）
+ */
+template <typename T>
+void extractMarchingCubesLabelSurface(const T* scalars, int stride, const int dims[3], const double origin[3],
+                                      const double spacing[3], double labelValue, bool computeNormals,
+                                      IsosurfaceMesh& mesh)
+{
+    MarchingCubesDetail::marchingCubes(scalars, stride, dims, origin, spacing,
+                                       MarchingCubesDetail::LabelClassifier<T>(labelValue),
+                                       computeNormals, mesh);
+}
+
+#endif // MARCHINGCUBESKERNEL_H
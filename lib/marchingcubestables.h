@@ -0,0 +1,331 @@
+#ifndef MARCHINGCUBESTABLES_H
+#define MARCHINGCUBESTABLES_H
+
+/**
+ * @brief 移动立方体查找表
+ *
+ * 角点编号 c = x + 2y + 4z（x/y/z为0或1），情形编号第c位为1表示该角点
+ * 位于等值面内侧（值 >= 等值）。棱0-3沿x轴、4-7沿y轴、8-11沿z轴。
+ *
+ * 三角形表按面一致的规则生成：二义面上把内侧角点彼此分开，相邻单元对
+ * 同一个面总是得到相同的交线，因此拼接后的表面没有裂缝；每个环按
+ * 由内侧指向外侧的方向定向，三角形法向指向数值较低的一侧。
+ */
+namespace MarchingCubesTables {
+
+// 棱的两个端点（角点编号）
+static constexpr unsigned char kEdgeCorners[12][2] = {
+    {0, 1}, {2, 3}, {4, 5}, {6, 7},
+    {0, 2}, {1, 3}, {4, 6}, {5, 7},
+    {0, 4}, {1, 5}, {2, 6}, {3, 7},
+};
+
+// 棱的方向轴（0=x, 1=y, 2=z）以及起点相对单元原点的偏移
+static constexpr unsigned char kEdgeAxis[12] = {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2};
+static constexpr unsigned char kEdgeOffset[12][3] = {
+    {0, 0, 0}, {0, 1, 0}, {0, 0, 1}, {0, 1, 1},
+    {0, 0, 0}, {1, 0, 0}, {0, 0, 1}, {1, 0, 1},
+    {0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 1, 0},
+};
+
+static constexpr int kMaxTrianglesPerCell = 5;
+
+// 每种情形被等值面穿过的棱（位掩码）
+static constexpr unsigned short kEdgeTable[256] = {
+    0x000, 0x111, 0x221, 0x330, 0x412, 0x503, 0x633, 0x722,
+    0x822, 0x933, 0xa03, 0xb12, 0xc30, 0xd21, 0xe11, 0xf00,
+    0x144, 0x055, 0x365, 0x274, 0x556, 0x447, 0x777, 0x666,
+    0x966, 0x877, 0xb47, 0xa56, 0xd74, 0xc65, 0xf55, 0xe44,
+    0x284, 0x395, 0x0a5, 0x1b4, 0x696, 0x787, 0x4b7, 0x5a6,
+    0xaa6, 0xbb7, 0x887, 0x996, 0xeb4, 0xfa5, 0xc95, 0xd84,
+    0x3c0, 0x2d1, 0x1e1, 0x0f0, 0x7d2, 0x6c3, 0x5f3, 0x4e2,
+    0xbe2, 0xaf3, 0x9c3, 0x8d2, 0xff0, 0xee1, 0xdd1, 0xcc0,
+    0x448, 0x559, 0x669, 0x778, 0x05a, 0x14b, 0x27b, 0x36a,
+    0xc6a, 0xd7b, 0xe4b, 0xf5a, 0x878, 0x969, 0xa59, 0xb48,
+    0x50c, 0x41d, 0x72d, 0x63c, 0x11e, 0x00f, 0x33f, 0x22e,
+    0xd2e, 0xc3f, 0xf0f, 0xe1e, 0x93c, 0x82d, 0xb1d, 0xa0c,
+    0x6cc, 0x7dd, 0x4ed, 0x5fc, 0x2de, 0x3cf, 0x0ff, 0x1ee,
+    0xeee, 0xfff, 0xccf, 0xdde, 0xafc, 0xbed, 0x8dd, 0x9cc,
+    0x788, 0x699, 0x5a9, 0x4b8, 0x39a, 0x28b, 0x1bb, 0x0aa,
+    0xfaa, 0xebb, 0xd8b, 0xc9a, 0xbb8, 0xaa9, 0x999, 0x888,
+    0x888, 0x999, 0xaa9, 0xbb8, 0xc9a, 0xd8b, 0xebb, 0xfaa,
+    0x0aa, 0x1bb, 0x28b, 0x39a, 0x4b8, 0x5a9, 0x699, 0x788,
+    0x9cc, 0x8dd, 0xbed, 0xafc, 0xdde, 0xccf, 0xfff, 0xeee,
+    0x1ee, 0x0ff, 0x3cf, 0x2de, 0x5fc, 0x4ed, 0x7dd, 0x6cc,
+    0xa0c, 0xb1d, 0x82d, 0x93c, 0xe1e, 0xf0f, 0xc3f, 0xd2e,
+    0x22e, 0x33f, 0x00f, 0x11e, 0x63c, 0x72d, 0x41d, 0x50c,
+    0xb48, 0xa59, 0x969, 0x878, 0xf5a, 0xe4b, 0xd7b, 0xc6a,
+    0x36a, 0x27b, 0x14b, 0x05a, 0x778, 0x669, 0x559, 0x448,
+    0xcc0, 0xdd1, 0xee1, 0xff0, 0x8d2, 0x9c3, 0xaf3, 0xbe2,
+    0x4e2, 0x5f3, 0x6c3, 0x7d2, 0x0f0, 0x1e1, 0x2d1, 0x3c0,
+    0xd84, 0xc95, 0xfa5, 0xeb4, 0x996, 0x887, 0xbb7, 0xaa6,
+    0x5a6, 0x4b7, 0x787, 0x696, 0x1b4, 0x0a5, 0x395, 0x284,
+    0xe44, 0xf55, 0xc65, 0xd74, 0xa56, 0xb47, 0x877, 0x966,
+    0x666, 0x777, 0x447, 0x556, 0x274, 0x365, 0x055, 0x144,
+    0xf00, 0xe11, 0xd21, 0xc30, 0xb12, 0xa03, 0x933, 0x822,
+    0x722, 0x633, 0x503, 0x412, 0x330, 0x221, 0x111, 0x000,
+};
+
+// 每种情形的三角形（棱编号，每3个为一个三角形，-1结束）
+static constexpr signed char kTriangleTable[256][16] = {
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 9, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 8, 1, 8, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 5, 1, 10, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 8, 1, 8, 9, 1, 9, 5, -1, -1, -1, -1, -1, -1, -1},
+    {5, 11, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 0, 5, 11, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 11, 0, 11, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 9, 4, 9, 11, 4, 11, 1, -1, -1, -1, -1, -1, -1, -1},
+    {5, 11, 10, 5, 10, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {5, 11, 10, 5, 10, 8, 5, 8, 0, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 11, 0, 11, 10, 0, 10, 4, -1, -1, -1, -1, -1, -1, -1},
+    {9, 11, 10, 9, 10, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {2, 8, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 6, 2, 4, 2, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 5, 2, 8, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {2, 9, 5, 2, 5, 4, 2, 4, 6, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 4, 2, 8, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 6, 1, 6, 2, 1, 2, 0, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 5, 1, 10, 4, 2, 8, 6, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 6, 1, 6, 2, 1, 2, 9, 1, 9, 5, -1, -1, -1, -1},
+    {5, 11, 1, 2, 8, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 6, 2, 4, 2, 0, 5, 11, 1, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 11, 0, 11, 1, 2, 8, 6, -1, -1, -1, -1, -1, -1, -1},
+    {4, 6, 2, 4, 2, 9, 4, 9, 11, 4, 11, 1, -1, -1, -1, -1},
+    {2, 8, 6, 5, 11, 10, 5, 10, 4, -1, -1, -1, -1, -1, -1, -1},
+    {5, 11, 10, 5, 10, 6, 5, 6, 2, 5, 2, 0, -1, -1, -1, -1},
+    {0, 9, 11, 0, 11, 10, 0, 10, 4, 2, 8, 6, -1, -1, -1, -1},
+    {2, 9, 11, 2, 11, 10, 2, 10, 6, -1, -1, -1, -1, -1, -1, -1},
+    {7, 9, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 0, 7, 9, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {0, 2, 7, 0, 7, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {7, 5, 4, 7, 4, 8, 7, 8, 2, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 4, 7, 9, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 8, 1, 8, 0, 7, 9, 2, -1, -1, -1, -1, -1, -1, -1},
+    {0, 2, 7, 0, 7, 5, 1, 10, 4, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 8, 1, 8, 2, 1, 2, 7, 1, 7, 5, -1, -1, -1, -1},
+    {5, 11, 1, 7, 9, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 0, 5, 11, 1, 7, 9, 2, -1, -1, -1, -1, -1, -1, -1},
+    {0, 2, 7, 0, 7, 11, 0, 11, 1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 2, 4, 2, 7, 4, 7, 11, 4, 11, 1, -1, -1, -1, -1},
+    {7, 9, 2, 5, 11, 10, 5, 10, 4, -1, -1, -1, -1, -1, -1, -1},
+    {5, 11, 10, 5, 10, 8, 5, 8, 0, 7, 9, 2, -1, -1, -1, -1},
+    {0, 2, 7, 0, 7, 11, 0, 11, 10, 0, 10, 4, -1, -1, -1, -1},
+    {7, 11, 10, 7, 10, 8, 7, 8, 2, -1, -1, -1, -1, -1, -1, -1},
+    {7, 9, 8, 7, 8, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 6, 7, 4, 7, 9, 4, 9, 0, -1, -1, -1, -1, -1, -1, -1},
+    {0, 8, 6, 0, 6, 7, 0, 7, 5, -1, -1, -1, -1, -1, -1, -1},
+    {4, 6, 7, 4, 7, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 4, 7, 9, 8, 7, 8, 6, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 6, 1, 6, 7, 1, 7, 9, 1, 9, 0, -1, -1, -1, -1},
+    {0, 8, 6, 0, 6, 7, 0, 7, 5, 1, 10, 4, -1, -1, -1, -1},
+    {1, 10, 6, 1, 6, 7, 1, 7, 5, -1, -1, -1, -1, -1, -1, -1},
+    {5, 11, 1, 7, 9, 8, 7, 8, 6, -1, -1, -1, -1, -1, -1, -1},
+    {4, 6, 7, 4, 7, 9, 4, 9, 0, 5, 11, 1, -1, -1, -1, -1},
+    {0, 8, 6, 0, 6, 7, 0, 7, 11, 0, 11, 1, -1, -1, -1, -1},
+    {4, 6, 7, 4, 7, 11, 4, 11, 1, -1, -1, -1, -1, -1, -1, -1},
+    {5, 11, 10, 5, 10, 4, 7, 9, 8, 7, 8, 6, -1, -1, -1, -1},
+    {5, 11, 10, 5, 10, 6, 5, 6, 7, 5, 7, 9, 5, 9, 0, -1},
+    {0, 8, 6, 0, 6, 7, 0, 7, 11, 0, 11, 10, 0, 10, 4, -1},
+    {7, 11, 10, 7, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {6, 10, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 0, 6, 10, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 5, 6, 10, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {6, 10, 3, 4, 8, 9, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
+    {1, 3, 6, 1, 6, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {1, 3, 6, 1, 6, 8, 1, 8, 0, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 5, 1, 3, 6, 1, 6, 4, -1, -1, -1, -1, -1, -1, -1},
+    {1, 3, 6, 1, 6, 8, 1, 8, 9, 1, 9, 5, -1, -1, -1, -1},
+    {5, 11, 1, 6, 10, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 0, 5, 11, 1, 6, 10, 3, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 11, 0, 11, 1, 6, 10, 3, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 9, 4, 9, 11, 4, 11, 1, 6, 10, 3, -1, -1, -1, -1},
+    {6, 4, 5, 6, 5, 11, 6, 11, 3, -1, -1, -1, -1, -1, -1, -1},
+    {5, 11, 3, 5, 3, 6, 5, 6, 8, 5, 8, 0, -1, -1, -1, -1},
+    {0, 9, 11, 0, 11, 3, 0, 3, 6, 0, 6, 4, -1, -1, -1, -1},
+    {6, 8, 9, 6, 9, 11, 6, 11, 3, -1, -1, -1, -1, -1, -1, -1},
+    {2, 8, 10, 2, 10, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 10, 3, 4, 3, 2, 4, 2, 0, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 5, 2, 8, 10, 2, 10, 3, -1, -1, -1, -1, -1, -1, -1},
+    {2, 9, 5, 2, 5, 4, 2, 4, 10, 2, 10, 3, -1, -1, -1, -1},
+    {1, 3, 2, 1, 2, 8, 1, 8, 4, -1, -1, -1, -1, -1, -1, -1},
+    {1, 3, 2, 1, 2, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 5, 1, 3, 2, 1, 2, 8, 1, 8, 4, -1, -1, -1, -1},
+    {1, 3, 2, 1, 2, 9, 1, 9, 5, -1, -1, -1, -1, -1, -1, -1},
+    {5, 11, 1, 2, 8, 10, 2, 10, 3, -1, -1, -1, -1, -1, -1, -1},
+    {4, 10, 3, 4, 3, 2, 4, 2, 0, 5, 11, 1, -1, -1, -1, -1},
+    {0, 9, 11, 0, 11, 1, 2, 8, 10, 2, 10, 3, -1, -1, -1, -1},
+    {4, 10, 3, 4, 3, 2, 4, 2, 9, 4, 9, 11, 4, 11, 1, -1},
+    {2, 8, 4, 2, 4, 5, 2, 5, 11, 2, 11, 3, -1, -1, -1, -1},
+    {5, 11, 3, 5, 3, 2, 5, 2, 0, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 11, 0, 11, 3, 0, 3, 2, 0, 2, 8, 0, 8, 4, -1},
+    {2, 9, 11, 2, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {7, 9, 2, 6, 10, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 0, 7, 9, 2, 6, 10, 3, -1, -1, -1, -1, -1, -1, -1},
+    {0, 2, 7, 0, 7, 5, 6, 10, 3, -1, -1, -1, -1, -1, -1, -1},
+    {7, 5, 4, 7, 4, 8, 7, 8, 2, 6, 10, 3, -1, -1, -1, -1},
+    {1, 3, 6, 1, 6, 4, 7, 9, 2, -1, -1, -1, -1, -1, -1, -1},
+    {1, 3, 6, 1, 6, 8, 1, 8, 0, 7, 9, 2, -1, -1, -1, -1},
+    {0, 2, 7, 0, 7, 5, 1, 3, 6, 1, 6, 4, -1, -1, -1, -1},
+    {1, 3, 6, 1, 6, 8, 1, 8, 2, 1, 2, 7, 1, 7, 5, -1},
+    {5, 11, 1, 7, 9, 2, 6, 10, 3, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 0, 5, 11, 1, 7, 9, 2, 6, 10, 3, -1, -1, -1, -1},
+    {0, 2, 7, 0, 7, 11, 0, 11, 1, 6, 10, 3, -1, -1, -1, -1},
+    {4, 8, 2, 4, 2, 7, 4, 7, 11, 4, 11, 1, 6, 10, 3, -1},
+    {7, 9, 2, 6, 4, 5, 6, 5, 11, 6, 11, 3, -1, -1, -1, -1},
+    {5, 11, 3, 5, 3, 6, 5, 6, 8, 5, 8, 0, 7, 9, 2, -1},
+    {0, 2, 7, 0, 7, 11, 0, 11, 3, 0, 3, 6, 0, 6, 4, -1},
+    {7, 11, 3, 7, 3, 6, 7, 6, 8, 7, 8, 2, -1, -1, -1, -1},
+    {7, 9, 8, 7, 8, 10, 7, 10, 3, -1, -1, -1, -1, -1, -1, -1},
+    {4, 10, 3, 4, 3, 7, 4, 7, 9, 4, 9, 0, -1, -1, -1, -1},
+    {0, 8, 10, 0, 10, 3, 0, 3, 7, 0, 7, 5, -1, -1, -1, -1},
+    {7, 5, 4, 7, 4, 10, 7, 10, 3, -1, -1, -1, -1, -1, -1, -1},
+    {1, 3, 7, 1, 7, 9, 1, 9, 8, 1, 8, 4, -1, -1, -1, -1},
+    {1, 3, 7, 1, 7, 9, 1, 9, 0, -1, -1, -1, -1, -1, -1, -1},
+    {0, 8, 4, 0, 4, 1, 0, 1, 3, 0, 3, 7, 0, 7, 5, -1},
+    {1, 3, 7, 1, 7, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {5, 11, 1, 7, 9, 8, 7, 8, 10, 7, 10, 3, -1, -1, -1, -1},
+    {4, 10, 3, 4, 3, 7, 4, 7, 9, 4, 9, 0, 5, 11, 1, -1},
+    {0, 8, 10, 0, 10, 3, 0, 3, 7, 0, 7, 11, 0, 11, 1, -1},
+    {4, 10, 3, 4, 3, 7, 4, 7, 11, 4, 11, 1, -1, -1, -1, -1},
+    {7, 9, 8, 7, 8, 4, 7, 4, 5, 7, 5, 11, 7, 11, 3, -1},
+    {5, 11, 3, 5, 3, 7, 5, 7, 9, 5, 9, 0, -1, -1, -1, -1},
+    {0, 8, 4, 7, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {7, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {3, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 0, 3, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 5, 3, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {3, 11, 7, 4, 8, 9, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 4, 3, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 8, 1, 8, 0, 3, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 5, 1, 10, 4, 3, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 8, 1, 8, 9, 1, 9, 5, 3, 11, 7, -1, -1, -1, -1},
+    {5, 7, 3, 5, 3, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 0, 5, 7, 3, 5, 3, 1, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 7, 0, 7, 3, 0, 3, 1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 9, 4, 9, 7, 4, 7, 3, 4, 3, 1, -1, -1, -1, -1},
+    {3, 10, 4, 3, 4, 5, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1},
+    {5, 7, 3, 5, 3, 10, 5, 10, 8, 5, 8, 0, -1, -1, -1, -1},
+    {0, 9, 7, 0, 7, 3, 0, 3, 10, 0, 10, 4, -1, -1, -1, -1},
+    {3, 10, 8, 3, 8, 9, 3, 9, 7, -1, -1, -1, -1, -1, -1, -1},
+    {2, 8, 6, 3, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 6, 2, 4, 2, 0, 3, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 5, 2, 8, 6, 3, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+    {2, 9, 5, 2, 5, 4, 2, 4, 6, 3, 11, 7, -1, -1, -1, -1},
+    {1, 10, 4, 2, 8, 6, 3, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 6, 1, 6, 2, 1, 2, 0, 3, 11, 7, -1, -1, -1, -1},
+    {0, 9, 5, 1, 10, 4, 2, 8, 6, 3, 11, 7, -1, -1, -1, -1},
+    {1, 10, 6, 1, 6, 2, 1, 2, 9, 1, 9, 5, 3, 11, 7, -1},
+    {5, 7, 3, 5, 3, 1, 2, 8, 6, -1, -1, -1, -1, -1, -1, -1},
+    {4, 6, 2, 4, 2, 0, 5, 7, 3, 5, 3, 1, -1, -1, -1, -1},
+    {0, 9, 7, 0, 7, 3, 0, 3, 1, 2, 8, 6, -1, -1, -1, -1},
+    {4, 6, 2, 4, 2, 9, 4, 9, 7, 4, 7, 3, 4, 3, 1, -1},
+    {2, 8, 6, 3, 10, 4, 3, 4, 5, 3, 5, 7, -1, -1, -1, -1},
+    {5, 7, 3, 5, 3, 10, 5, 10, 6, 5, 6, 2, 5, 2, 0, -1},
+    {0, 9, 7, 0, 7, 3, 0, 3, 10, 0, 10, 4, 2, 8, 6, -1},
+    {2, 9, 7, 2, 7, 3, 2, 3, 10, 2, 10, 6, -1, -1, -1, -1},
+    {3, 11, 9, 3, 9, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 0, 3, 11, 9, 3, 9, 2, -1, -1, -1, -1, -1, -1, -1},
+    {0, 2, 3, 0, 3, 11, 0, 11, 5, -1, -1, -1, -1, -1, -1, -1},
+    {3, 11, 5, 3, 5, 4, 3, 4, 8, 3, 8, 2, -1, -1, -1, -1},
+    {1, 10, 4, 3, 11, 9, 3, 9, 2, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 8, 1, 8, 0, 3, 11, 9, 3, 9, 2, -1, -1, -1, -1},
+    {0, 2, 3, 0, 3, 11, 0, 11, 5, 1, 10, 4, -1, -1, -1, -1},
+    {1, 10, 8, 1, 8, 2, 1, 2, 3, 1, 3, 11, 1, 11, 5, -1},
+    {5, 9, 2, 5, 2, 3, 5, 3, 1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 0, 5, 9, 2, 5, 2, 3, 5, 3, 1, -1, -1, -1, -1},
+    {0, 2, 3, 0, 3, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 2, 4, 2, 3, 4, 3, 1, -1, -1, -1, -1, -1, -1, -1},
+    {3, 10, 4, 3, 4, 5, 3, 5, 9, 3, 9, 2, -1, -1, -1, -1},
+    {5, 9, 2, 5, 2, 3, 5, 3, 10, 5, 10, 8, 5, 8, 0, -1},
+    {0, 2, 3, 0, 3, 10, 0, 10, 4, -1, -1, -1, -1, -1, -1, -1},
+    {3, 10, 8, 3, 8, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {3, 11, 9, 3, 9, 8, 3, 8, 6, -1, -1, -1, -1, -1, -1, -1},
+    {4, 6, 3, 4, 3, 11, 4, 11, 9, 4, 9, 0, -1, -1, -1, -1},
+    {0, 8, 6, 0, 6, 3, 0, 3, 11, 0, 11, 5, -1, -1, -1, -1},
+    {3, 11, 5, 3, 5, 4, 3, 4, 6, -1, -1, -1, -1, -1, -1, -1},
+    {1, 10, 4, 3, 11, 9, 3, 9, 8, 3, 8, 6, -1, -1, -1, -1},
+    {1, 10, 6, 1, 6, 3, 1, 3, 11, 1, 11, 9, 1, 9, 0, -1},
+    {0, 8, 6, 0, 6, 3, 0, 3, 11, 0, 11, 5, 1, 10, 4, -1},
+    {1, 10, 6, 1, 6, 3, 1, 3, 11, 1, 11, 5, -1, -1, -1, -1},
+    {5, 9, 8, 5, 8, 6, 5, 6, 3, 5, 3, 1, -1, -1, -1, -1},
+    {4, 6, 3, 4, 3, 1, 4, 1, 5, 4, 5, 9, 4, 9, 0, -1},
+    {0, 8, 6, 0, 6, 3, 0, 3, 1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 6, 3, 4, 3, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {3, 10, 4, 3, 4, 5, 3, 5, 9, 3, 9, 8, 3, 8, 6, -1},
+    {5, 9, 0, 3, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {0, 8, 6, 0, 6, 3, 0, 3, 10, 0, 10, 4, -1, -1, -1, -1},
+    {3, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {6, 10, 11, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 0, 6, 10, 11, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 5, 6, 10, 11, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 9, 4, 9, 5, 6, 10, 11, 6, 11, 7, -1, -1, -1, -1},
+    {1, 11, 7, 1, 7, 6, 1, 6, 4, -1, -1, -1, -1, -1, -1, -1},
+    {1, 11, 7, 1, 7, 6, 1, 6, 8, 1, 8, 0, -1, -1, -1, -1},
+    {0, 9, 5, 1, 11, 7, 1, 7, 6, 1, 6, 4, -1, -1, -1, -1},
+    {1, 11, 7, 1, 7, 6, 1, 6, 8, 1, 8, 9, 1, 9, 5, -1},
+    {5, 7, 6, 5, 6, 10, 5, 10, 1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 0, 5, 7, 6, 5, 6, 10, 5, 10, 1, -1, -1, -1, -1},
+    {0, 9, 7, 0, 7, 6, 0, 6, 10, 0, 10, 1, -1, -1, -1, -1},
+    {4, 8, 9, 4, 9, 7, 4, 7, 6, 4, 6, 10, 4, 10, 1, -1},
+    {5, 7, 6, 5, 6, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {5, 7, 6, 5, 6, 8, 5, 8, 0, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 7, 0, 7, 6, 0, 6, 4, -1, -1, -1, -1, -1, -1, -1},
+    {6, 8, 9, 6, 9, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {2, 8, 10, 2, 10, 11, 2, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+    {4, 10, 11, 4, 11, 7, 4, 7, 2, 4, 2, 0, -1, -1, -1, -1},
+    {0, 9, 5, 2, 8, 10, 2, 10, 11, 2, 11, 7, -1, -1, -1, -1},
+    {2, 9, 5, 2, 5, 4, 2, 4, 10, 2, 10, 11, 2, 11, 7, -1},
+    {1, 11, 7, 1, 7, 2, 1, 2, 8, 1, 8, 4, -1, -1, -1, -1},
+    {1, 11, 7, 1, 7, 2, 1, 2, 0, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 5, 1, 11, 7, 1, 7, 2, 1, 2, 8, 1, 8, 4, -1},
+    {1, 11, 7, 1, 7, 2, 1, 2, 9, 1, 9, 5, -1, -1, -1, -1},
+    {5, 7, 2, 5, 2, 8, 5, 8, 10, 5, 10, 1, -1, -1, -1, -1},
+    {4, 10, 1, 4, 1, 5, 4, 5, 7, 4, 7, 2, 4, 2, 0, -1},
+    {0, 9, 7, 0, 7, 2, 0, 2, 8, 0, 8, 10, 0, 10, 1, -1},
+    {4, 10, 1, 2, 9, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {2, 8, 4, 2, 4, 5, 2, 5, 7, -1, -1, -1, -1, -1, -1, -1},
+    {5, 7, 2, 5, 2, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {0, 9, 7, 0, 7, 2, 0, 2, 8, 0, 8, 4, -1, -1, -1, -1},
+    {2, 9, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {6, 10, 11, 6, 11, 9, 6, 9, 2, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 0, 6, 10, 11, 6, 11, 9, 6, 9, 2, -1, -1, -1, -1},
+    {0, 2, 6, 0, 6, 10, 0, 10, 11, 0, 11, 5, -1, -1, -1, -1},
+    {6, 10, 11, 6, 11, 5, 6, 5, 4, 6, 4, 8, 6, 8, 2, -1},
+    {1, 11, 9, 1, 9, 2, 1, 2, 6, 1, 6, 4, -1, -1, -1, -1},
+    {1, 11, 9, 1, 9, 2, 1, 2, 6, 1, 6, 8, 1, 8, 0, -1},
+    {0, 2, 6, 0, 6, 4, 0, 4, 1, 0, 1, 11, 0, 11, 5, -1},
+    {1, 11, 5, 6, 8, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {5, 9, 2, 5, 2, 6, 5, 6, 10, 5, 10, 1, -1, -1, -1, -1},
+    {4, 8, 0, 5, 9, 2, 5, 2, 6, 5, 6, 10, 5, 10, 1, -1},
+    {0, 2, 6, 0, 6, 10, 0, 10, 1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 8, 2, 4, 2, 6, 4, 6, 10, 4, 10, 1, -1, -1, -1, -1},
+    {6, 4, 5, 6, 5, 9, 6, 9, 2, -1, -1, -1, -1, -1, -1, -1},
+    {5, 9, 2, 5, 2, 6, 5, 6, 8, 5, 8, 0, -1, -1, -1, -1},
+    {0, 2, 6, 0, 6, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {6, 8, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {8, 10, 11, 8, 11, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 10, 11, 4, 11, 9, 4, 9, 0, -1, -1, -1, -1, -1, -1, -1},
+    {0, 8, 10, 0, 10, 11, 0, 11, 5, -1, -1, -1, -1, -1, -1, -1},
+    {4, 10, 11, 4, 11, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {1, 11, 9, 1, 9, 8, 1, 8, 4, -1, -1, -1, -1, -1, -1, -1},
+    {1, 11, 9, 1, 9, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {0, 8, 4, 0, 4, 1, 0, 1, 11, 0, 11, 5, -1, -1, -1, -1},
+    {1, 11, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {5, 9, 8, 5, 8, 10, 5, 10, 1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 10, 1, 4, 1, 5, 4, 5, 9, 4, 9, 0, -1, -1, -1, -1},
+    {0, 8, 10, 0, 10, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {4, 10, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {5, 9, 8, 5, 8, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {5, 9, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {0, 8, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+};
+
+} // namespace MarchingCubesTables
+
+#endif // MARCHINGCUBESTABLES_H
@@ -0,0 +1,108 @@
+#include "meshsmoother.h"
+
+#include <QDebug>
+
+// VTK头文件
+#include <vtkPolyData.h>
+#include <vtkPoints.h>
+#include <vtkPointData.h>
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+
+namespace {
+
+// 从polydata读取坐标和多边形（VTK 8.2单元数组格式：[n, id0, id1, ...]）
+bool loadPolygonMesh(vtkPolyData* input, SoaPolygonMesh& mesh)
+{
+    vtkPoints* points = input->GetPoints();
+    vtkCellArray* polys = input->GetPolys();
+    if (!points || !polys) return false;
+
+    const vtkIdType numPoints = points->GetNumberOfPoints();
+    vtkFloatArray* floatPoints = vtkFloatArray::SafeDownCast(points->GetData());
+    if (floatPoints) {
+        mesh.setInterleavedPoints(floatPoints->GetPointer(0), numPoints);
+    } else {
+        mesh.x.resize(static_cast<size_t>(numPoints));
+        mesh.y.resize(static_cast<size_t>(numPoints));
+        mesh.z.resize(static_cast<size_t>(numPoints));
+        double point[3];
+        for (vtkIdType i = 0; i < numPoints; ++i) {
+            points->GetPoint(i, point);
+            mesh.x[i] = static_cast<float>(point[0]);
+            mesh.y[i] = static_cast<float>(point[1]);
+            mesh.z[i] = static_cast<float>(point[2]);
+        }
+    }
+
+    const vtkIdType numCells = polys->GetNumberOfCells();
+    const vtkIdType* cell = polys->GetData()->GetPointer(0);
+    mesh.cellOffsets.resize(static_cast<size_t>(numCells) + 1);
+    mesh.cellPoints.clear();
+    mesh.cellPoints.reserve(static_cast<size_t>(polys->GetNumberOfConnectivityEntries() - numCells));
+    mesh.cellOffsets[0] = 0;
+    for (vtkIdType c = 0; c < numCells; ++c) {
+        const vtkIdType size = *cell++;
+        mesh.cellPoints.insert(mesh.cellPoints.end(), cell, cell + size);
+        cell += size;
+        mesh.cellOffsets[c + 1] = static_cast<vtkIdType>(mesh.cellPoints.size());
+    }
+    return true;
+}
+
+} // namespace
+
+vtkSmartPointer<vtkPolyData> MeshSmoother::smooth(vtkPolyData* input, int iterations, double relaxationFactor,
+                                                  Method method)
+{
+    if (!input) return nullptr;
+
+    SoaPolygonMesh mesh;
+    if (!loadPolygonMesh(input, mesh)) {
+        qDebug() << "网格平滑: 输入没有多边形";
+        return input;
+    }
+
+    smoothSoaPolygonMesh(mesh, iterations, relaxationFactor, method, true);
+
+    const vtkIdType numPoints = mesh.getNumberOfPoints();
+    auto coordinates = vtkSmartPointer<vtkFloatArray>::New();
+    coordinates->SetNumberOfComponents(3);
+    coordinates->SetNumberOfTuples(numPoints);
+    mesh.getInterleavedPoints(coordinates->GetPointer(0));
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(coordinates);
+
+    auto normals = vtkSmartPointer<vtkFloatArray>::New();
+    normals->SetName("Normals");
+    normals->SetNumberOfComponents(3);
+    normals->SetNumberOfTuples(numPoints);
+    float* normal = normals->GetPointer(0);
+    for (vtkIdType i = 0; i < numPoints; ++i) {
+        normal[i * 3] = mesh.nx[i];
+        normal[i * 3 + 1] = mesh.ny[i];
+        normal[i * 3 + 2] = mesh.nz[i];
+    }
+
+    // 平滑不改变拓扑，单元数组直接共享
+    auto output = vtkSmartPointer<vtkPolyData>::New();
+    output->SetPoints(points);
+    output->SetVerts(input->GetVerts());
+    output->SetLines(input->GetLines());
+    output->SetPolys(input->GetPolys());
+    output->SetStrips(input->GetStrips());
+    output->GetPointData()->SetNormals(normals);
+    return output;
+}
+
+const char* MeshSmoother::methodName(Method method)
+{
+    switch (method) {
+    case TAUBIN:
+        return "Taubin";
+    case LAPLACIAN:
+    default:
+        return "Laplacian";
+    }
+}
@@ -0,0 +1,326 @@
+#ifndef MESHSMOOTHER_H
+#define MESHSMOOTHER_H
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MESH_SMOOTHER_USE_SSE2 1
+#endif
+
+// VTK头文件
+#include <vtkType.h>
+#include <vtkSmartPointer.h>
+
+#include "parallelfor.h"
+
+class vtkPolyData;
+
+/**
+ * @brief 库内网格平滑器（替代vtkSmoothPolyDataFilter）
+ *
+ * 顶点坐标以结构数组（x/y/z分开存放）保存，邻接关系为CSR格式。
+ * 每次迭代按顶点分块并行，先收集邻点平均位置，再用SIMD做混合；
+ * 最后一次迭代后在同一流程中重新计算顶点法向。
+ */
+class MeshSmoother
+{
+public:
+    enum Method {
+        LAPLACIAN,  // 拉普拉斯平滑（与vtkSmoothPolyDataFilter一致，会轻微收缩）
+        TAUBIN      // Taubin λ/μ交替平滑，基本保持体积
+    };
+
+    // 平滑polydata中的多边形，返回新的polydata（拓扑共享，坐标和法向为新数组）
+    static vtkSmartPointer<vtkPolyData> smooth(vtkPolyData* input, int iterations, double relaxationFactor,
+                                               Method method);
+
+    static const char* methodName(Method method);
+};
+
+/**
+ * @brief 结构数组形式的多边形网格
+ *
+ * 单元以CSR保存：第c个单元的顶点为 cellPoints[cellOffsets[c] .. cellOffsets[c+1])。
+ */
+struct SoaPolygonMesh
+{
+    std::vector<float> x, y, z;
+    std::vector<float> nx, ny, nz;
+    std::vector<vtkIdType> cellOffsets;
+    std::vector<vtkIdType> cellPoints;
+
+    vtkIdType getNumberOfPoints() const { return static_cast<vtkIdType>(x.size()); }
+    vtkIdType getNumberOfCells() const { return cellOffsets.empty() ? 0 : static_cast<vtkIdType>(cellOffsets.size() - 1); }
+
+    void setInterleavedPoints(const float* xyz, vtkIdType numPoints)
+    {
+        x.resize(static_cast<size_t>(numPoints));
+        y.resize(static_cast<size_t>(numPoints));
+        z.resize(static_cast<size_t>(numPoints));
+        for (vtkIdType i = 0; i < numPoints; ++i) {
+            x[i] = xyz[i * 3];
+            y[i] = xyz[i * 3 + 1];
+            z[i] = xyz[i * 3 + 2];
+        }
+    }
+
+    void getInterleavedPoints(float* xyz) const
+    {
+        const vtkIdType numPoints = getNumberOfPoints();
+        for (vtkIdType i = 0; i < numPoints; ++i) {
+            xyz[i * 3] = x[i];
+            xyz[i * 3 + 1] = y[i];
+            xyz[i * 3 + 2] = z[i];
+        }
+    }
+};
+
+namespace MeshSmootherDetail {
+
+// 每个并行块至少处理的顶点数
+static const int kVertexGrain = 4096;
+
+// Taubin通带频率，μ = 1 / (kPB - 1/λ)
+static const double kTaubinPassBand = 0.1;
+
+/**
+ * @brief 顶点邻接（CSR）
+ *
+ * 与vtkSmoothPolyDataFilter（关闭特征边平滑、开启边界平滑）一致：
+ * 只被一个多边形使用（或被两个以上使用）的棱视为边界棱；
+ * 恰有两条边界棱的顶点只沿边界平滑，其余边界顶点固定不动。
+ */
+struct VertexAdjacency
+{
+    std::vector<vtkIdType> offsets;
+    std::vector<vtkIdType> neighbors;
+
+    void build(const SoaPolygonMesh& mesh)
+    {
+        const vtkIdType numPoints = mesh.getNumberOfPoints();
+        const vtkIdType numCells = mesh.getNumberOfCells();
+
+        std::vector<std::pair<vtkIdType, vtkIdType>> edges;
+        edges.reserve(mesh.cellPoints.size());
+        for (vtkIdType c = 0; c < numCells; ++c) {
+            const vtkIdType begin = mesh.cellOffsets[c];
+            const vtkIdType size = mesh.cellOffsets[c + 1] - begin;
+            for (vtkIdType k = 0; k < size; ++k) {
+                const vtkIdType a = mesh.cellPoints[begin + k];
+                const vtkIdType b = mesh.cellPoints[begin + (k + 1) % size];
+                if (a != b) edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        // 合并重复棱并记录使用次数
+        std::vector<std::pair<vtkIdType, vtkIdType>> uniqueEdges;
+        std::vector<unsigned char> boundaryEdge;
+        uniqueEdges.reserve(edges.size() / 2 + 1);
+        boundaryEdge.reserve(edges.size() / 2 + 1);
+        for (size_t i = 0; i < edges.size();) {
+            size_t j = i + 1;
+            while (j < edges.size() && edges[j] == edges[i]) ++j;
+            uniqueEdges.push_back(edges[i]);
+            boundaryEdge.push_back(j - i != 2 ? 1 : 0);
+            i = j;
+        }
+        std::vector<std::pair<vtkIdType, vtkIdType>>().swap(edges);
+
+        std::vector<int> boundaryDegree(static_cast<size_t>(numPoints), 0);
+        for (size_t e = 0; e < uniqueEdges.size(); ++e) {
+            if (boundaryEdge[e]) {
+                ++boundaryDegree[uniqueEdges[e].first];
+                ++boundaryDegree[uniqueEdges[e].second];
+            }
+        }
+
+        // 内部顶点使用全部邻点；两条边界棱的顶点只使用边界邻点；其余边界顶点固定
+        auto accepts = [&](vtkIdType vertex, bool isBoundaryEdge) {
+            const int degree = boundaryDegree[vertex];
+            if (degree == 0) return true;
+            return degree == 2 && isBoundaryEdge;
+        };
+
+        offsets.assign(static_cast<size_t>(numPoints) + 1, 0);
+        for (size_t e = 0; e < uniqueEdges.size(); ++e) {
+            const bool isBoundaryEdge = boundaryEdge[e] != 0;
+            if (accepts(uniqueEdges[e].first, isBoundaryEdge)) ++offsets[uniqueEdges[e].first + 1];
+            if (accepts(uniqueEdges[e].second, isBoundaryEdge)) ++offsets[uniqueEdges[e].second + 1];
+        }
+        for (vtkIdType i = 0; i < numPoints; ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+        neighbors.resize(static_cast<size_t>(offsets[numPoints]));
+        std::vector<vtkIdType> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t e = 0; e < uniqueEdges.size(); ++e) {
+            const bool isBoundaryEdge = boundaryEdge[e] != 0;
+            const vtkIdType a = uniqueEdges[e].first;
+            const vtkIdType b = uniqueEdges[e].second;
+            if (accepts(a, isBoundaryEdge)) neighbors[static_cast<size_t>(cursor[a]++)] = b;
+            if (accepts(b, isBoundaryEdge)) neighbors[static_cast<size_t>(cursor[b]++)] = a;
+        }
+    }
+};
+
+// target[i] = current[i] + factor * (target[i] - current[i])，target中预先存放邻点平均位置
+inline void blendTowards(float* target, const float* current, vtkIdType count, float factor)
+{
+    vtkIdType i = 0;
+#ifdef MESH_SMOOTHER_USE_SSE2
+    const __m128 f = _mm_set1_ps(factor);
+    for (; i + 4 <= count; i += 4) {
+        const __m128 c = _mm_loadu_ps(current + i);
+        const __m128 t = _mm_loadu_ps(target + i);
+        _mm_storeu_ps(target + i, _mm_add_ps(c, _mm_mul_ps(f, _mm_sub_ps(t, c))));
+    }
+#endif
+    for (; i < count; ++i) {
+        target[i] = current[i] + factor * (target[i] - current[i]);
+    }
+}
+
+// 一次平滑迭代：从current读取，写入next
+inline void smoothingStep(const VertexAdjacency& adjacency, const std::vector<float>* current[3],
+                          std::vector<float>* next[3], double factor)
+{
+    const int numPoints = static_cast<int>(current[0]->size());
+    ParallelFor::parallelFor(0, numPoints, kVertexGrain, [&](int begin, int end) {
+        for (int axis = 0; axis < 3; ++axis) {
+            const float* source = current[axis]->data();
+            float* target = next[axis]->data();
+            for (int i = begin; i < end; ++i) {
+                const vtkIdType first = adjacency.offsets[i];
+                const vtkIdType last = adjacency.offsets[i + 1];
+                if (first == last) {
+                    target[i] = source[i];
+                    continue;
+                }
+                float sum = 0.0f;
+                for (vtkIdType n = first; n < last; ++n) {
+                    sum += source[adjacency.neighbors[static_cast<size_t>(n)]];
+                }
+                target[i] = sum / static_cast<float>(last - first);
+            }
+            blendTowards(target + begin, source + begin, end - begin, static_cast<float>(factor));
+        }
+    });
+}
+
+// 面法向（Newell方法，适用于三角形和四边形）累加到顶点，按顶点并行避免写冲突
+inline void computeVertexNormals(SoaPolygonMesh& mesh)
+{
+    const vtkIdType numPoints = mesh.getNumberOfPoints();
+    const vtkIdType numCells = mesh.getNumberOfCells();
+
+    std::vector<float> faceNormals(static_cast<size_t>(numCells) * 3);
+    ParallelFor::parallelFor(0, static_cast<int>(numCells), MeshSmootherDetail::kVertexGrain,
+        [&](int begin, int end) {
+            for (int c = begin; c < end; ++c) {
+                const vtkIdType first = mesh.cellOffsets[c];
+                const vtkIdType size = mesh.cellOffsets[c + 1] - first;
+                float n[3] = {0.0f, 0.0f, 0.0f};
+                for (vtkIdType k = 0; k < size; ++k) {
+                    const vtkIdType a = mesh.cellPoints[first + k];
+                    const vtkIdType b = mesh.cellPoints[first + (k + 1) % size];
+                    n[0] += (mesh.y[a] - mesh.y[b]) * (mesh.z[a] + mesh.z[b]);
+                    n[1] += (mesh.z[a] - mesh.z[b]) * (mesh.x[a] + mesh.x[b]);
+                    n[2] += (mesh.x[a] - mesh.x[b]) * (mesh.y[a] + mesh.y[b]);
+                }
+                faceNormals[static_cast<size_t>(c) * 3] = n[0];
+                faceNormals[static_cast<size_t>(c) * 3 + 1] = n[1];
+                faceNormals[static_cast<size_t>(c) * 3 + 2] = n[2];
+            }
+        });
+
+    // 顶点到单元的CSR
+    std::vector<vtkIdType> offsets(static_cast<size_t>(numPoints) + 1, 0);
+    for (vtkIdType id : mesh.cellPoints) {
+        ++offsets[static_cast<size_t>(id) + 1];
+    }
+    for (vtkIdType i = 0; i < numPoints; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    std::vector<vtkIdType> vertexCells(mesh.cellPoints.size());
+    std::vector<vtkIdType> cursor(offsets.begin(), offsets.end() - 1);
+    for (vtkIdType c = 0; c < numCells; ++c) {
+        for (vtkIdType k = mesh.cellOffsets[c]; k < mesh.cellOffsets[c + 1]; ++k) {
+            vertexCells[static_cast<size_t>(cursor[mesh.cellPoints[k]]++)] = c;
+        }
+    }
+
+    mesh.nx.assign(static_cast<size_t>(numPoints), 0.0f);
+    mesh.ny.assign(static_cast<size_t>(numPoints), 0.0f);
+    mesh.nz.assign(static_cast<size_t>(numPoints), 0.0f);
+    ParallelFor::parallelFor(0, static_cast<int>(numPoints), kVertexGrain, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            float n[3] = {0.0f, 0.0f, 0.0f};
+            for (vtkIdType k = offsets[i]; k < offsets[i + 1]; ++k) {
+                const float* faceNormal = &faceNormals[static_cast<size_t>(vertexCells[k]) * 3];
+                n[0] += faceNormal[0];
+                n[1] += faceNormal[1];
+                n[2] += faceNormal[2];
+            }
+            const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (length > 0.0f) {
+                mesh.nx[i] = n[0] / length;
+                mesh.ny[i] = n[1] / length;
+                mesh.nz[i] = n[2] / length;
+            }
+        }
+    });
+}
+
+} // namespace MeshSmootherDetail
+
+/**
+ * @brief 在结构数组网格上平滑并（可选）重新计算法向
+ *
+ * LAPLACIAN每次迭代使用relaxationFactor；TAUBIN交替使用λ=relaxationFactor和
+ * μ=1/(kPB-1/λ)（负值，抵消收缩）。迭代为双缓冲，结果与线程数无关。
+ */
+inline void smoothSoaPolygonMesh(SoaPolygonMesh& mesh, int iterations, double relaxationFactor,
+                                 MeshSmoother::Method method, bool computeNormals)
+{
+    using namespace MeshSmootherDetail;
+
+    if (mesh.getNumberOfPoints() == 0) return;
+
+    if (iterations > 0 && relaxationFactor != 0.0) {
+        VertexAdjacency adjacency;
+        adjacency.build(mesh);
+
+        std::vector<float> scratch[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            scratch[axis].resize(mesh.x.size());
+        }
+        std::vector<float>* current[3] = {&mesh.x, &mesh.y, &mesh.z};
+        std::vector<float>* next[3] = {&scratch[0], &scratch[1], &scratch[2]};
+
+        const double lambda = relaxationFactor;
+        const double mu = 1.0 / (kTaubinPassBand - 1.0 / lambda);
+        for (int iteration = 0; iteration < iterations; ++iteration) {
+            const double factor = (method == MeshSmoother::TAUBIN && (iteration % 2)) ? mu : lambda;
+            const std::vector<float>* source[3] = {current[0], current[1], current[2]};
+            smoothingStep(adjacency, source, next, factor);
+            std::swap(current, next);
+        }
+
+        // 奇数次迭代后结果在临时缓冲中
+        if (current[0] != &mesh.x) {
+            mesh.x.swap(*current[0]);
+            mesh.y.swap(*current[1]);
+            mesh.z.swap(*current[2]);
+        }
+    }
+
+    if (computeNormals) {
+        computeVertexNormals(mesh);
+    }
+}
+
+#endif // MESHSMOOTHER_H
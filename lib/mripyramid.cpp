@@ -0,0 +1,147 @@
+#include "mripyramid.h"
+#include "parallelfor.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+// VTK头文件
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+
+namespace {
+
+// 降采样停止的最小维度
+const int kMinLevelDimension = 8;
+
+template <typename T>
+inline T roundToScalar(double value, std::true_type)
+{
+    return static_cast<T>(std::floor(value + 0.5));
+}
+
+template <typename T>
+inline T roundToScalar(double value, std::false_type)
+{
+    return static_cast<T>(value);
+}
+
+// 每个输出体素取2×2×2源体素的平均值，按输出切片并行
+template <typename T>
+void downsampleVolume(const T* source, const int sourceDims[3], T* target, const int targetDims[3])
+{
+    const vtkIdType sourceSlice = static_cast<vtkIdType>(sourceDims[0]) * sourceDims[1];
+    const vtkIdType targetSlice = static_cast<vtkIdType>(targetDims[0]) * targetDims[1];
+    typedef std::integral_constant<bool, std::numeric_limits<T>::is_integer> IsInteger;
+
+    ParallelFor::parallelFor(0, targetDims[2], 4, [&](int zBegin, int zEnd) {
+        for (int z = zBegin; z < zEnd; ++z) {
+            const int z0 = 2 * z;
+            const int z1 = std::min(z0 + 1, sourceDims[2] - 1);
+            for (int y = 0; y < targetDims[1]; ++y) {
+                const int y0 = 2 * y;
+                const int y1 = std::min(y0 + 1, sourceDims[1] - 1);
+                const T* rows[4] = {
+                    source + z0 * sourceSlice + static_cast<vtkIdType>(y0) * sourceDims[0],
+                    source + z0 * sourceSlice + static_cast<vtkIdType>(y1) * sourceDims[0],
+                    source + z1 * sourceSlice + static_cast<vtkIdType>(y0) * sourceDims[0],
+                    source + z1 * sourceSlice + static_cast<vtkIdType>(y1) * sourceDims[0]
+                };
+                T* out = target + z * targetSlice + static_cast<vtkIdType>(y) * targetDims[0];
+                for (int x = 0; x < targetDims[0]; ++x) {
+                    const int x0 = 2 * x;
+                    const int x1 = std::min(x0 + 1, sourceDims[0] - 1);
+                    double sum = 0.0;
+                    for (const T* row : rows) {
+                        sum += static_cast<double>(row[x0]) + static_cast<double>(row[x1]);
+                    }
+                    out[x] = roundToScalar<T>(sum * 0.125, IsInteger());
+                }
+            }
+        }
+    });
+}
+
+} // namespace
+
+MriPyramid::MriPyramid()
+{
+}
+
+void MriPyramid::build(vtkImageData* image, int levelCount)
+{
+    clear();
+    if (!image) return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    levels.push_back(image);
+    while (static_cast<int>(levels.size()) < levelCount) {
+        int dims[3];
+        levels.back()->GetDimensions(dims);
+        if (dims[0] < kMinLevelDimension || dims[1] < kMinLevelDimension || dims[2] < kMinLevelDimension) break;
+
+        vtkSmartPointer<vtkImageData> next = downsample(levels.back());
+        if (!next) break;
+        levels.push_back(next);
+    }
+
+    qDebug() << "MRI金字塔生成完成，层数:" << levels.size() << "耗时:" << timer.elapsed() << "ms";
+}
+
+void MriPyramid::clear()
+{
+    levels.clear();
+}
+
+vtkImageData* MriPyramid::getLevel(int level) const
+{
+    if (level < 0 || level >= static_cast<int>(levels.size())) return nullptr;
+    return levels[level];
+}
+
+vtkSmartPointer<vtkImageData> MriPyramid::downsample(vtkImageData* image)
+{
+    if (!image) return nullptr;
+    vtkDataArray* scalars = image->GetPointData()->GetScalars();
+    if (!scalars || scalars->GetNumberOfComponents() != 1) return nullptr;
+
+    int sourceDims[3];
+    image->GetDimensions(sourceDims);
+    int targetDims[3];
+    for (int i = 0; i < 3; ++i) {
+        targetDims[i] = (sourceDims[i] + 1) / 2;
+    }
+
+    // 输出索引从0开始，体素位于2×2×2源体素的中心
+    double spacing[3];
+    double origin[3];
+    int extent[6];
+    image->GetSpacing(spacing);
+    image->GetOrigin(origin);
+    image->GetExtent(extent);
+    for (int i = 0; i < 3; ++i) {
+        origin[i] += (extent[2 * i] + 0.5) * spacing[i];
+        spacing[i] *= 2.0;
+    }
+
+    auto result = vtkSmartPointer<vtkImageData>::New();
+    result->SetDimensions(targetDims);
+    result->SetSpacing(spacing);
+    result->SetOrigin(origin);
+    result->AllocateScalars(scalars->GetDataType(), 1);
+
+    void* target = result->GetPointData()->GetScalars()->GetVoidPointer(0);
+    switch (scalars->GetDataType()) {
+        vtkTemplateMacro(downsampleVolume(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)), sourceDims,
+                                          static_cast<VTK_TT*>(target), targetDims));
+    default:
+        qDebug() << "MRI降采样: 不支持的标量类型" << scalars->GetDataType();
+        return nullptr;
+    }
+    return result;
+}
@@ -0,0 +1,41 @@
+#ifndef MRIPYRAMID_H
+#define MRIPYRAMID_H
+
+#include <vector>
+
+// VTK头文件
+#include <vtkSmartPointer.h>
+#include <vtkImageData.h>
+
+/**
+ * @brief MRI多分辨率金字塔
+ *
+ * 层次0为原始体数据，层次i在每个轴上缩小2^i倍（2×2×2盒式平均，标量类型不变）。
+ * 每一层由上一层生成，层内按切片并行。拖动灰度值滑块等交互期间在粗层次上预览，
+ * 空闲后再回到原始分辨率。
+ */
+class MriPyramid
+{
+public:
+    // 包含原始分辨率在内的层数：1×、2×、4×、8×
+    static const int kDefaultLevelCount = 4;
+
+    MriPyramid();
+
+    // 为image生成各层；维度过小时提前停止
+    void build(vtkImageData* image, int levelCount = kDefaultLevelCount);
+    void clear();
+
+    int getLevelCount() const { return static_cast<int>(levels.size()); }
+    vtkImageData* getLevel(int level) const;
+    // 层次level相对原始分辨率每个轴的缩小倍数
+    static int sampleFactor(int level) { return 1 << level; }
+
+    // 2×2×2盒式平均降采样，奇数维度的最后一层复制边界；只支持单分量标量
+    static vtkSmartPointer<vtkImageData> downsample(vtkImageData* image);
+
+private:
+    std::vector<vtkSmartPointer<vtkImageData>> levels;
+};
+
+#endif // MRIPYRAMID_H
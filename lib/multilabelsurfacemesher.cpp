@@ -0,0 +1,213 @@
+#include "multilabelsurfacemesher.h"
+#include "runlengthlabelvolume.h"
+
+#include <QDebug>
+#include <cstring>
+
+// VTK头文件
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataNormals.h>
+
+void MultiLabelSurface::clear()
+{
+    points.clear();
+    triangles.clear();
+    frontLabels.clear();
+    backLabels.clear();
+    labelTriangleRefs.clear();
+    interfaceTriangleCounts.clear();
+}
+
+namespace {
+
+vtkSmartPointer<vtkPoints> createPoints(const std::vector<float>& coordinates, vtkIdType numPoints)
+{
+    auto coordinateArray = vtkSmartPointer<vtkFloatArray>::New();
+    coordinateArray->SetNumberOfComponents(3);
+    coordinateArray->SetNumberOfTuples(numPoints);
+    if (numPoints > 0) {
+        std::memcpy(coordinateArray->GetPointer(0), coordinates.data(),
+                    static_cast<size_t>(numPoints) * 3 * sizeof(float));
+    }
+
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(coordinateArray);
+    return points;
+}
+
+// 游程编码标签按层读取：逐行展开游程，不解压整个体数据
+struct RunLengthLabelSlices
+{
+    const RunLengthLabelVolume* volume;
+
+    void read(int z, int* out) const
+    {
+        const int* dims = volume->getDimensions();
+        std::fill(out, out + static_cast<size_t>(dims[0]) * dims[1], 0);
+        for (int y = 0; y < dims[1]; ++y) {
+            int* row = out + static_cast<size_t>(y) * dims[0];
+            for (const LabelRun* run = volume->rowBegin(y, z); run != volume->rowEnd(y, z); ++run) {
+                if (run->value > 0) std::fill(row + run->x, row + run->x + run->length, run->value);
+            }
+        }
+    }
+};
+
+// 输出坐标以体数据第一个体素为索引0
+void getVoxelGeometry(vtkImageData* image, double origin[3], double spacing[3])
+{
+    int extent[6];
+    image->GetExtent(extent);
+    image->GetOrigin(origin);
+    image->GetSpacing(spacing);
+    for (int axis = 0; axis < 3; ++axis) {
+        origin[axis] += extent[2 * axis] * spacing[axis];
+    }
+}
+
+void logExtractedSurface(const MultiLabelSurface& surface)
+{
+    qDebug() << "多标签网格单次遍历完成:" << surface.getNumberOfPoints() << "个共享顶点,"
+             << surface.getNumberOfTriangles() << "个三角形,"
+             << surface.interfaceTriangleCounts.size() << "个交界面";
+}
+
+} // namespace
+
+bool MultiLabelSurfaceMesher::extract(vtkImageData* labelImage, const std::vector<int>* idToLabel,
+                                      const BrickIndex* bricks)
+{
+    clear();
+    if (!labelImage) return false;
+
+    vtkDataArray* scalars = labelImage->GetPointData()->GetScalars();
+    if (!scalars) return false;
+
+    int dims[3];
+    double origin[3];
+    double spacing[3];
+    labelImage->GetDimensions(dims);
+    getVoxelGeometry(labelImage, origin, spacing);
+
+    const int stride = scalars->GetNumberOfComponents();
+    void* scalarPointer = scalars->GetVoidPointer(0);
+
+    switch (scalars->GetDataType()) {
+        vtkTemplateMacro(extractMultiLabelSurface(static_cast<const VTK_TT*>(scalarPointer), stride,
+                                                  dims, origin, spacing, surface, idToLabel, bricks));
+    default:
+        qDebug() << "多标签网格: 不支持的标量类型" << scalars->GetDataType();
+        return false;
+    }
+
+    logExtractedSurface(surface);
+    return true;
+}
+
+bool MultiLabelSurfaceMesher::extract(const RunLengthLabelVolume& labelVolume, const std::vector<int>* idToLabel,
+                                      const BrickIndex* bricks)
+{
+    clear();
+    if (!labelVolume.isValid()) return false;
+
+    int dims[3];
+    double origin[3];
+    double spacing[3];
+    std::copy(labelVolume.getDimensions(), labelVolume.getDimensions() + 3, dims);
+    getVoxelGeometry(labelVolume.getGeometry(), origin, spacing);
+
+    const RunLengthLabelSlices slices = {&labelVolume};
+    extractMultiLabelSurfaceFromSlices(slices, dims, origin, spacing, surface, idToLabel, bricks);
+
+    logExtractedSurface(surface);
+    return true;
+}
+
+void MultiLabelSurfaceMesher::smooth(int iterations, double relaxationFactor, MeshSmoother::Method method)
+{
+    const vtkIdType numPoints = surface.getNumberOfPoints();
+    const vtkIdType numTriangles = surface.getNumberOfTriangles();
+    if (numPoints == 0 || numTriangles == 0 || iterations <= 0) return;
+
+    // 在共享顶点的整体网格上平滑，交界面两侧的区块得到完全相同的顶点位置
+    SoaPolygonMesh mesh;
+    mesh.setInterleavedPoints(surface.points.data(), numPoints);
+    mesh.cellOffsets.resize(static_cast<size_t>(numTriangles) + 1);
+    for (vtkIdType t = 0; t <= numTriangles; ++t) {
+        mesh.cellOffsets[t] = t * 3;
+    }
+    mesh.cellPoints = surface.triangles;
+
+    // 法向依赖各区块的绕序，在createRegionSurface中分别计算
+    smoothSoaPolygonMesh(mesh, iterations, relaxationFactor, method, false);
+    mesh.getInterleavedPoints(surface.points.data());
+}
+
+vtkSmartPointer<vtkPolyData> MultiLabelSurfaceMesher::createRegionSurface(int label) const
+{
+    auto refsIt = surface.labelTriangleRefs.find(label);
+    if (refsIt == surface.labelTriangleRefs.end() || refsIt->second.empty()) {
+        return nullptr;
+    }
+    const std::vector<vtkIdType>& triangleRefs = refsIt->second;
+
+    // 收集区块引用的共享顶点并压缩编号
+    std::vector<vtkIdType> usedPoints;
+    usedPoints.reserve(triangleRefs.size() * 3);
+    for (vtkIdType ref : triangleRefs) {
+        const vtkIdType* triangle = &surface.triangles[(ref / 2) * 3];
+        usedPoints.insert(usedPoints.end(), triangle, triangle + 3);
+    }
+    std::sort(usedPoints.begin(), usedPoints.end());
+    usedPoints.erase(std::unique(usedPoints.begin(), usedPoints.end()), usedPoints.end());
+
+    std::vector<float> localCoordinates(usedPoints.size() * 3);
+    for (size_t i = 0; i < usedPoints.size(); ++i) {
+        std::memcpy(&localCoordinates[i * 3], &surface.points[usedPoints[i] * 3], 3 * sizeof(float));
+    }
+
+    auto triangles = vtkSmartPointer<vtkCellArray>::New();
+    triangles->Allocate(triangles->EstimateSize(static_cast<vtkIdType>(triangleRefs.size()), 3));
+    for (vtkIdType ref : triangleRefs) {
+        const vtkIdType* triangle = &surface.triangles[(ref / 2) * 3];
+        vtkIdType localIds[3];
+        for (int i = 0; i < 3; ++i) {
+            localIds[i] = static_cast<vtkIdType>(
+                std::lower_bound(usedPoints.begin(), usedPoints.end(), triangle[i]) - usedPoints.begin());
+        }
+        if (ref % 2) {
+            // 交界面的背面一侧：反向绕序使法向指向本区块外侧
+            std::swap(localIds[1], localIds[2]);
+        }
+        triangles->InsertNextCell(3, localIds);
+    }
+
+    auto regionMesh = vtkSmartPointer<vtkPolyData>::New();
+    regionMesh->SetPoints(createPoints(localCoordinates, static_cast<vtkIdType>(usedPoints.size())));
+    regionMesh->SetPolys(triangles);
+
+    // 绕序已经一致，只需计算点法向
+    auto normals = vtkSmartPointer<vtkPolyDataNormals>::New();
+    normals->SetInputData(regionMesh);
+    normals->SplittingOff();
+    normals->ConsistencyOff();
+    normals->AutoOrientNormalsOff();
+    normals->ComputePointNormalsOn();
+    normals->ComputeCellNormalsOff();
+    normals->Update();
+
+    auto result = vtkSmartPointer<vtkPolyData>::New();
+    result->ShallowCopy(normals->GetOutput());
+    return result;
+}
+
+void MultiLabelSurfaceMesher::clear()
+{
+    surface.clear();
+}
@@ -0,0 +1,387 @@
+#ifndef MULTILABELSURFACEMESHER_H
+#define MULTILABELSURFACEMESHER_H
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+// VTK头文件
+#include <vtkType.h>
+#include <vtkSmartPointer.h>
+
+#include "brickindex.h"
+#include "meshsmoother.h"
+#include "parallelfor.h"
+
+class vtkImageData;
+class vtkPolyData;
+class RunLengthLabelVolume;
+
+/**
+ * @brief 多标签单次遍历提取的表面
+ *
+ * 所有区块共用一套顶点。每个三角形只生成一次，并带有标签对
+ * (frontLabel, backLabel)：法向指向frontLabel区块的外侧，
+ * backLabel为相邻区块（0表示背景）。两个区块的交界面因此只
+ * 三角化一次，由两个区块共同引用（backLabel一侧使用反向绕序）。
+ */
+struct MultiLabelSurface
+{
+    std::vector<float> points;                  // 顶点坐标 xyz（世界坐标）
+    std::vector<vtkIdType> triangles;           // 每3个顶点索引为一个三角形
+    std::vector<int> frontLabels;               // 每个三角形的正面标签
+    std::vector<int> backLabels;                // 每个三角形的背面标签（0为背景）
+
+    // 每个标签引用的三角形：triangleId * 2 + (是否需要反向绕序)
+    std::map<int, std::vector<vtkIdType>> labelTriangleRefs;
+    // 每个交界面（较小标签, 较大标签）的三角形数量
+    std::map<std::pair<int, int>, vtkIdType> interfaceTriangleCounts;
+
+    vtkIdType getNumberOfPoints() const { return static_cast<vtkIdType>(points.size() / 3); }
+    vtkIdType getNumberOfTriangles() const { return static_cast<vtkIdType>(frontLabels.size()); }
+    void clear();
+};
+
+namespace MultiLabelSurfaceDetail {
+
+// 每个并行切片至少包含的体素数，小体数据只用一个切片
+static const vtkIdType kMinVoxelsPerSlab = vtkIdType(1) << 18;
+
+// 滚动的角点层：只保存当前两层体素角点到顶点编号的映射，内存与单个切片同阶
+class CornerLayer
+{
+public:
+    void reset(int cornersX, int cornersY, int layerZ)
+    {
+        sizeX = cornersX;
+        z = layerZ;
+        ids.assign(static_cast<size_t>(cornersX) * cornersY, -1);
+    }
+
+    const std::vector<vtkIdType>& getIds() const { return ids; }
+
+    vtkIdType getOrCreate(int cx, int cy, const double origin[3], const double spacing[3],
+                          std::vector<float>& points)
+    {
+        vtkIdType& id = ids[static_cast<size_t>(cy) * sizeX + cx];
+        if (id < 0) {
+            id = static_cast<vtkIdType>(points.size() / 3);
+            // 角点位于体素中心偏移半个体素处
+            points.push_back(static_cast<float>(origin[0] + (cx - 0.5) * spacing[0]));
+            points.push_back(static_cast<float>(origin[1] + (cy - 0.5) * spacing[1]));
+            points.push_back(static_cast<float>(origin[2] + (z - 0.5) * spacing[2]));
+        }
+        return id;
+    }
+
+private:
+    std::vector<vtkIdType> ids;
+    int sizeX = 0;
+    int z = 0;
+};
+
+// 输出一个四边形面（两个三角形）。quad按法向为正方向的逆时针顺序给出
+inline void emitFace(const vtkIdType quad[4], bool flip, int frontLabel, int backLabel,
+                     MultiLabelSurface& surface)
+{
+    const vtkIdType a = quad[0];
+    const vtkIdType b = flip ? quad[3] : quad[1];
+    const vtkIdType c = quad[2];
+    const vtkIdType d = flip ? quad[1] : quad[3];
+
+    surface.triangles.push_back(a);
+    surface.triangles.push_back(b);
+    surface.triangles.push_back(c);
+    surface.triangles.push_back(a);
+    surface.triangles.push_back(c);
+    surface.triangles.push_back(d);
+    for (int i = 0; i < 2; ++i) {
+        surface.frontLabels.push_back(frontLabel);
+        surface.backLabels.push_back(backLabel);
+    }
+}
+
+// 处理体素lower与upper之间（沿坐标轴正方向）的面
+inline void handleFace(int lowerLabel, int upperLabel, const vtkIdType quad[4], MultiLabelSurface& surface)
+{
+    if (lowerLabel == upperLabel) return;
+    if (lowerLabel > 0) {
+        // 法向沿正方向，指向lower区块外侧
+        emitFace(quad, false, lowerLabel, upperLabel, surface);
+    } else {
+        // lower为背景：面属于upper区块，法向沿负方向
+        emitFace(quad, true, upperLabel, 0, surface);
+    }
+}
+
+// 稠密标签数组按层读取：每层展开为int，背景和负值记为0
+template <typename T>
+struct DenseLabelSlices
+{
+    const T* labels;
+    int stride;
+    vtkIdType sliceSize;
+
+    void read(int z, int* out) const
+    {
+        const T* slice = labels + static_cast<vtkIdType>(z) * sliceSize * stride;
+        for (vtkIdType i = 0; i < sliceSize; ++i) {
+            const int label = static_cast<int>(slice[i * stride]);
+            out[i] = label > 0 ? label : 0;
+        }
+    }
+};
+
+// 当前层中(x, y)处的标签，层外为背景
+inline int labelAt(const std::vector<int>& slice, const int dims[3], int x, int y)
+{
+    if (x < 0 || y < 0 || x >= dims[0] || y >= dims[1]) return 0;
+    return slice[static_cast<size_t>(y) * dims[0] + x];
+}
+
+// 一个z切片的提取结果。相邻切片共享边界角点层，两侧各自创建其上的顶点，合并时按角点去重
+struct SlabSurface
+{
+    MultiLabelSurface surface;               // 只使用顶点、三角形和标签
+    std::vector<vtkIdType> bottomCorners;    // 第一个角点层：角点 → 本切片的顶点编号（-1为没有）
+    std::vector<vtkIdType> topCorners;       // 最后一个角点层
+};
+
+// 处理体素层[zBegin, zEnd)，即角点层zBegin .. zEnd。体素层dims[2]在体数据之外，只产生-z方向的面。
+// 标签通过slices.read(z, out)逐层读取，只保留当前层和下一层
+template <typename Slices>
+void extractSlab(const Slices& slices, const int dims[3], const double origin[3], const double spacing[3],
+                 const BrickIndex* bricks, const std::vector<char>& freeBricks, int zBegin, int zEnd,
+                 SlabSurface& slab)
+{
+    MultiLabelSurface& surface = slab.surface;
+    const int cornersX = dims[0] + 1;
+    const int cornersY = dims[1] + 1;
+
+    CornerLayer lowerLayer;
+    CornerLayer upperLayer;
+    lowerLayer.reset(cornersX, cornersY, zBegin);
+
+    const size_t sliceSize = static_cast<size_t>(dims[0]) * dims[1];
+    std::vector<int> belowSlice(sliceSize, 0);
+    std::vector<int> currentSlice(sliceSize, 0);
+    if (zBegin > 0) slices.read(zBegin - 1, belowSlice.data());
+
+    for (int z = zBegin; z < zEnd; ++z) {
+        upperLayer.reset(cornersX, cornersY, z + 1);
+        if (z < dims[2]) {
+            slices.read(z, currentSlice.data());
+        } else {
+            std::fill(currentSlice.begin(), currentSlice.end(), 0);
+        }
+
+        for (int y = 0; y <= dims[1]; ++y) {
+            for (int x = 0; x <= dims[0]; ++x) {
+                if (!freeBricks.empty() && x < dims[0] && y < dims[1] && z < dims[2] &&
+                    freeBricks[bricks->brickAt(x, y, z)]) {
+                    // 跳到下一块的第一列
+                    x = std::min(dims[0], (x | (BrickIndex::kBrickSize - 1)) + 1) - 1;
+                    continue;
+                }
+                const int label = labelAt(currentSlice, dims, x, y);
+
+                // -z方向的面：位于角点层z
+                if (x < dims[0] && y < dims[1]) {
+                    const int below = labelAt(belowSlice, dims, x, y);
+                    if (below != label) {
+                        const vtkIdType quad[4] = {
+                            lowerLayer.getOrCreate(x, y, origin, spacing, surface.points),
+                            lowerLayer.getOrCreate(x + 1, y, origin, spacing, surface.points),
+                            lowerLayer.getOrCreate(x + 1, y + 1, origin, spacing, surface.points),
+                            lowerLayer.getOrCreate(x, y + 1, origin, spacing, surface.points)};
+                        handleFace(below, label, quad, surface);
+                    }
+                }
+
+                if (z >= dims[2]) continue;
+
+                // -x方向的面：位于x平面，跨越角点层z和z+1
+                if (y < dims[1]) {
+                    const int left = labelAt(currentSlice, dims, x - 1, y);
+                    if (left != label) {
+                        const vtkIdType quad[4] = {
+                            lowerLayer.getOrCreate(x, y, origin, spacing, surface.points),
+                            lowerLayer.getOrCreate(x, y + 1, origin, spacing, surface.points),
+                            upperLayer.getOrCreate(x, y + 1, origin, spacing, surface.points),
+                            upperLayer.getOrCreate(x, y, origin, spacing, surface.points)};
+                        handleFace(left, label, quad, surface);
+                    }
+                }
+
+                // -y方向的面：位于y平面，跨越角点层z和z+1
+                if (x < dims[0]) {
+                    const int front = labelAt(currentSlice, dims, x, y - 1);
+                    if (front != label) {
+                        const vtkIdType quad[4] = {
+                            lowerLayer.getOrCreate(x, y, origin, spacing, surface.points),
+                            upperLayer.getOrCreate(x, y, origin, spacing, surface.points),
+                            upperLayer.getOrCreate(x + 1, y, origin, spacing, surface.points),
+                            lowerLayer.getOrCreate(x + 1, y, origin, spacing, surface.points)};
+                        handleFace(front, label, quad, surface);
+                    }
+                }
+            }
+        }
+
+        // 角点层zBegin只由本切片的第一层体素和上一个切片的最后一层体素访问，此时已经完整
+        if (z == zBegin) slab.bottomCorners = lowerLayer.getIds();
+        std::swap(lowerLayer, upperLayer);
+        std::swap(belowSlice, currentSlice);
+    }
+    slab.topCorners = lowerLayer.getIds();
+}
+
+// 按切片顺序拼接，切片的第一个角点层上已由上一个切片创建的顶点使用其编号
+inline void mergeSlabs(std::vector<SlabSurface>& slabs, MultiLabelSurface& surface)
+{
+    if (slabs.size() == 1) {
+        surface = std::move(slabs[0].surface);
+        return;
+    }
+
+    size_t totalPoints = 0;
+    size_t totalTriangles = 0;
+    for (const auto& slab : slabs) {
+        totalPoints += slab.surface.points.size();
+        totalTriangles += slab.surface.frontLabels.size();
+    }
+    surface.points.reserve(totalPoints);
+    surface.triangles.reserve(totalTriangles * 3);
+    surface.frontLabels.reserve(totalTriangles);
+    surface.backLabels.reserve(totalTriangles);
+
+    std::vector<vtkIdType> previousTop;   // 上一个切片最后一个角点层的合并后编号
+    std::vector<vtkIdType> remap;
+    for (auto& slab : slabs) {
+        const MultiLabelSurface& part = slab.surface;
+        const vtkIdType numPoints = part.getNumberOfPoints();
+        remap.assign(static_cast<size_t>(numPoints), -1);
+        for (size_t c = 0; c < previousTop.size(); ++c) {
+            if (slab.bottomCorners[c] >= 0 && previousTop[c] >= 0) {
+                remap[slab.bottomCorners[c]] = previousTop[c];
+            }
+        }
+        for (vtkIdType p = 0; p < numPoints; ++p) {
+            if (remap[p] >= 0) continue;
+            remap[p] = surface.getNumberOfPoints();
+            surface.points.insert(surface.points.end(), &part.points[p * 3], &part.points[p * 3] + 3);
+        }
+        for (vtkIdType id : part.triangles) {
+            surface.triangles.push_back(remap[id]);
+        }
+        surface.frontLabels.insert(surface.frontLabels.end(), part.frontLabels.begin(), part.frontLabels.end());
+        surface.backLabels.insert(surface.backLabels.end(), part.backLabels.begin(), part.backLabels.end());
+
+        previousTop.resize(slab.topCorners.size());
+        for (size_t c = 0; c < previousTop.size(); ++c) {
+            previousTop[c] = slab.topCorners[c] >= 0 ? remap[slab.topCorners[c]] : -1;
+        }
+        slab.surface.clear();
+    }
+}
+
+} // namespace MultiLabelSurfaceDetail
+
+/**
+ * @brief 单次遍历标签体数据，提取所有标签的离散边界面
+ *
+ * 按z切片推进，每个体素与-x、-y、-z方向的邻居比较（体数据外视为背景），
+ * 标签不同处生成一个体素面。顶点在相邻面之间共享，不需要点定位器。
+ * 标签由slices.read(z, out)逐层读取为int（背景为0），因此稠密数组和游程编码可以共用同一个提取过程。
+ * 大体数据分成多个z切片并行提取，切片边界角点层上的顶点在合并时去重，结果仍是一个共享顶点的网格。
+ * idToLabel不为空时体素值为紧凑编号，输出的三角形标签查回原标签（编号与标签同序，交界面的大小关系不变）。
+ * bricks为同一体数据的标签块索引时，跳过内部及-x/-y/-z相邻面都是同一标签的块（这些体素不产生任何面）。
+ */
+template <typename Slices>
+void extractMultiLabelSurfaceFromSlices(const Slices& slices, const int dims[3],
+                                        const double origin[3], const double spacing[3],
+                                        MultiLabelSurface& surface, const std::vector<int>* idToLabel = nullptr,
+                                        const BrickIndex* bricks = nullptr)
+{
+    using namespace MultiLabelSurfaceDetail;
+
+    surface.clear();
+    std::vector<char> freeBricks;
+    if (bricks && bricks->hasLabels() && std::equal(dims, dims + 3, bricks->getDimensions())) {
+        freeBricks = bricks->boundaryFreeBricks();
+    }
+
+    // 体素层0 .. dims[2]，最后一层只有体数据顶面的-z方向面
+    const int layers = dims[2] + 1;
+    const vtkIdType sliceSize = std::max<vtkIdType>(1, static_cast<vtkIdType>(dims[0]) * dims[1]);
+    const int grain = static_cast<int>(std::max<vtkIdType>(4, kMinVoxelsPerSlab / sliceSize));
+    const int numSlabs = ParallelFor::chunkCount(0, layers, grain);
+    if (numSlabs <= 0) return;
+
+    std::vector<SlabSurface> slabs(static_cast<size_t>(numSlabs));
+    ParallelFor::parallelForChunks(0, layers, numSlabs,
+        [&](int chunk, int zBegin, int zEnd) {
+            extractSlab(slices, dims, origin, spacing, bricks, freeBricks, zBegin, zEnd,
+                        slabs[static_cast<size_t>(chunk)]);
+        });
+    mergeSlabs(slabs, surface);
+
+    // 建立每个标签对三角形的引用，以及交界面统计
+    const vtkIdType numTriangles = surface.getNumberOfTriangles();
+    for (vtkIdType t = 0; t < numTriangles; ++t) {
+        if (idToLabel) {
+            surface.frontLabels[t] = (*idToLabel)[surface.frontLabels[t]];
+            surface.backLabels[t] = (*idToLabel)[surface.backLabels[t]];
+        }
+        const int front = surface.frontLabels[t];
+        const int back = surface.backLabels[t];
+        surface.labelTriangleRefs[front].push_back(t * 2);
+        if (back > 0) {
+            surface.labelTriangleRefs[back].push_back(t * 2 + 1);
+        }
+        ++surface.interfaceTriangleCounts[std::make_pair(std::min(front, back), std::max(front, back))];
+    }
+}
+
+// 稠密标签数组（stride为每个体素的分量数，只使用第一个分量）
+template <typename T>
+void extractMultiLabelSurface(const T* labels, int stride, const int dims[3],
+                              const double origin[3], const double spacing[3],
+                              MultiLabelSurface& surface, const std::vector<int>* idToLabel = nullptr,
+                              const BrickIndex* bricks = nullptr)
+{
+    const MultiLabelSurfaceDetail::DenseLabelSlices<T> slices = {
+        labels, stride, static_cast<vtkIdType>(dims[0]) * dims[1]};
+    extractMultiLabelSurfaceFromSlices(slices, dims, origin, spacing, surface, idToLabel, bricks);
+}
+
+/**
+ * @brief 多标签表面网格生成器（VTK封装）
+ *
+ * extract()单次遍历标签图像；smooth()在共享顶点的整体网格上平滑，
+ * 交界面两侧的区块因此保持严格贴合；createRegionSurface()为单个区块
+ * 组装紧凑的vtkPolyData，可以在多个线程中并行调用。
+ */
+class MultiLabelSurfaceMesher
+{
+public:
+    // idToLabel不为空时labelImage为紧凑编号图像（见CompactLabelVolume）；
+    // bricks为labelImage的块索引时跳过没有分界面的块
+    bool extract(vtkImageData* labelImage, const std::vector<int>* idToLabel = nullptr,
+                 const BrickIndex* bricks = nullptr);
+    // 直接按行读取游程编码的标签体数据（每个并行切片只展开当前两层），参数含义同上
+    bool extract(const RunLengthLabelVolume& labelVolume, const std::vector<int>* idToLabel = nullptr,
+                 const BrickIndex* bricks = nullptr);
+    void smooth(int iterations, double relaxationFactor,
+                MeshSmoother::Method method = MeshSmoother::LAPLACIAN);
+    vtkSmartPointer<vtkPolyData> createRegionSurface(int label) const;
+    void clear();
+
+    const MultiLabelSurface& getSurface() const { return surface; }
+
+private:
+    MultiLabelSurface surface;
+};
+
+#endif // MULTILABELSURFACEMESHER_H
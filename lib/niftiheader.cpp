@@ -0,0 +1,280 @@
+#include "niftiheader.h"
+
+#include <QFile>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// VTK头文件
+#include <vtkType.h>
+
+namespace {
+
+// NIfTI数据类型编号
+enum NiftiDataType {
+    DT_UINT8 = 2,
+    DT_INT16 = 4,
+    DT_INT32 = 8,
+    DT_FLOAT32 = 16,
+    DT_FLOAT64 = 64,
+    DT_INT8 = 256,
+    DT_UINT16 = 512,
+    DT_UINT32 = 768,
+    DT_INT64 = 1024,
+    DT_UINT64 = 1280
+};
+
+// 按需交换字节序读取一个字段
+template <typename T>
+T readField(const char* data, int offset, bool swap)
+{
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, data + offset, sizeof(T));
+    if (swap) {
+        for (size_t i = 0; i < sizeof(T) / 2; ++i) {
+            std::swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+        }
+    }
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+int32_t byteSwapped32(int32_t value)
+{
+    return readField<int32_t>(reinterpret_cast<const char*>(&value), 0, true);
+}
+
+} // namespace
+
+NiftiHeader::NiftiHeader()
+    : version(0)
+    , singleFile(true)
+    , byteSwapped(false)
+    , datatype(0)
+    , bitpix(0)
+    , voxOffset(0)
+    , sclSlope(0.0)
+    , sclInter(0.0)
+    , qformCode(0)
+    , sformCode(0)
+{
+    for (int i = 0; i < 8; ++i) {
+        dim[i] = 0;
+        pixdim[i] = 0.0;
+    }
+    for (int i = 0; i < 3; ++i) {
+        quatern[i] = 0.0;
+        qoffset[i] = 0.0;
+        for (int j = 0; j < 4; ++j) {
+            srow[i][j] = 0.0;
+        }
+    }
+}
+
+bool NiftiHeader::parse(const char* data, int64_t size)
+{
+    if (!data || size < 4) return false;
+
+    // sizeof_hdr同时标识版本和字节序
+    const int32_t headerSize = readField<int32_t>(data, 0, false);
+    if (headerSize == kNifti1HeaderSize || byteSwapped32(headerSize) == kNifti1HeaderSize) {
+        version = 1;
+        byteSwapped = headerSize != kNifti1HeaderSize;
+    } else if (headerSize == kNifti2HeaderSize || byteSwapped32(headerSize) == kNifti2HeaderSize) {
+        version = 2;
+        byteSwapped = headerSize != kNifti2HeaderSize;
+    } else {
+        return false;
+    }
+    const bool swap = byteSwapped;
+
+    if (version == 1) {
+        if (size < kNifti1HeaderSize) return false;
+        const char* magic = data + 344;
+        if (std::memcmp(magic, "n+1\0", 4) == 0) {
+            singleFile = true;
+        } else if (std::memcmp(magic, "ni1\0", 4) == 0) {
+            singleFile = false;
+        } else {
+            return false;
+        }
+
+        for (int i = 0; i < 8; ++i) {
+            dim[i] = readField<int16_t>(data, 40 + 2 * i, swap);
+            pixdim[i] = readField<float>(data, 76 + 4 * i, swap);
+        }
+        datatype = readField<int16_t>(data, 70, swap);
+        bitpix = readField<int16_t>(data, 72, swap);
+        voxOffset = static_cast<int64_t>(readField<float>(data, 108, swap));
+        sclSlope = readField<float>(data, 112, swap);
+        sclInter = readField<float>(data, 116, swap);
+        qformCode = readField<int16_t>(data, 252, swap);
+        sformCode = readField<int16_t>(data, 254, swap);
+        for (int i = 0; i < 3; ++i) {
+            quatern[i] = readField<float>(data, 256 + 4 * i, swap);
+            qoffset[i] = readField<float>(data, 268 + 4 * i, swap);
+            for (int j = 0; j < 4; ++j) {
+                srow[i][j] = readField<float>(data, 280 + 16 * i + 4 * j, swap);
+            }
+        }
+    } else {
+        if (size < kNifti2HeaderSize) return false;
+        const char* magic = data + 4;
+        if (std::memcmp(magic, "n+2\0", 4) == 0) {
+            singleFile = true;
+        } else if (std::memcmp(magic, "ni2\0", 4) == 0) {
+            singleFile = false;
+        } else {
+            return false;
+        }
+
+        datatype = readField<int16_t>(data, 12, swap);
+        bitpix = readField<int16_t>(data, 14, swap);
+        for (int i = 0; i < 8; ++i) {
+            dim[i] = readField<int64_t>(data, 16 + 8 * i, swap);
+            pixdim[i] = readField<double>(data, 104 + 8 * i, swap);
+        }
+        voxOffset = readField<int64_t>(data, 168, swap);
+        sclSlope = readField<double>(data, 176, swap);
+        sclInter = readField<double>(data, 184, swap);
+        qformCode = readField<int32_t>(data, 344, swap);
+        sformCode = readField<int32_t>(data, 348, swap);
+        for (int i = 0; i < 3; ++i) {
+            quatern[i] = readField<double>(data, 352 + 8 * i, swap);
+            qoffset[i] = readField<double>(data, 376 + 8 * i, swap);
+            for (int j = 0; j < 4; ++j) {
+                srow[i][j] = readField<double>(data, 400 + 32 * i + 8 * j, swap);
+            }
+        }
+    }
+
+    // 基本合法性检查
+    if (dim[0] < 1 || dim[0] > 7 || bitpix <= 0 || bitpix % 8 != 0 || voxOffset < 0) return false;
+    for (int i = 1; i <= dim[0]; ++i) {
+        if (dim[i] < 0) return false;
+    }
+    return true;
+}
+
+bool NiftiHeader::read(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const QByteArray bytes = file.read(kNifti2HeaderSize);
+    return parse(bytes.constData(), bytes.size());
+}
+
+int64_t NiftiHeader::dimension(int axis) const
+{
+    const int index = axis + 1;
+    if (index > dim[0] || dim[index] <= 0) return 1;
+    return dim[index];
+}
+
+double NiftiHeader::spacing(int axis) const
+{
+    const double value = std::fabs(pixdim[axis + 1]);
+    return value > 0.0 ? value : 1.0;
+}
+
+int64_t NiftiHeader::extraComponentCount() const
+{
+    int64_t count = 1;
+    for (int i = 4; i <= dim[0]; ++i) {
+        if (dim[i] > 0) count *= dim[i];
+    }
+    return count;
+}
+
+int64_t NiftiHeader::voxelCount() const
+{
+    return dimension(0) * dimension(1) * dimension(2) * extraComponentCount();
+}
+
+int NiftiHeader::vtkScalarType() const
+{
+    switch (datatype) {
+    case DT_UINT8: return VTK_UNSIGNED_CHAR;
+    case DT_INT8: return VTK_SIGNED_CHAR;
+    case DT_INT16: return VTK_SHORT;
+    case DT_UINT16: return VTK_UNSIGNED_SHORT;
+    case DT_INT32: return VTK_INT;
+    case DT_UINT32: return VTK_UNSIGNED_INT;
+    case DT_INT64: return VTK_LONG_LONG;
+    case DT_UINT64: return VTK_UNSIGNED_LONG_LONG;
+    case DT_FLOAT32: return VTK_FLOAT;
+    case DT_FLOAT64: return VTK_DOUBLE;
+    default: return -1;
+    }
+}
+
+const char* NiftiHeader::datatypeName() const
+{
+    switch (datatype) {
+    case DT_UINT8: return "uint8";
+    case DT_INT8: return "int8";
+    case DT_INT16: return "int16";
+    case DT_UINT16: return "uint16";
+    case DT_INT32: return "int32";
+    case DT_UINT32: return "uint32";
+    case DT_INT64: return "int64";
+    case DT_UINT64: return "uint64";
+    case DT_FLOAT32: return "float32";
+    case DT_FLOAT64: return "float64";
+    default: return "unknown";
+    }
+}
+
+bool NiftiHeader::isIntegerType() const
+{
+    const int scalarType = vtkScalarType();
+    return scalarType >= 0 && scalarType != VTK_FLOAT && scalarType != VTK_DOUBLE;
+}
+
+void NiftiHeader::qformMatrix(double matrix[4][4]) const
+{
+    // 四元数(a, b, c, d)，a由单位长度约束求出；数值误差导致a²略小于0时按0处理并重新归一化
+    double b = quatern[0];
+    double c = quatern[1];
+    double d = quatern[2];
+    double a = 1.0 - (b * b + c * c + d * d);
+    if (a < 1.0e-7) {
+        const double norm = std::sqrt(b * b + c * c + d * d);
+        if (norm > 0.0) {
+            b /= norm;
+            c /= norm;
+            d /= norm;
+        }
+        a = 0.0;
+    } else {
+        a = std::sqrt(a);
+    }
+
+    const double rotation[3][3] = {
+        { a * a + b * b - c * c - d * d, 2.0 * (b * c - a * d), 2.0 * (b * d + a * c) },
+        { 2.0 * (b * c + a * d), a * a + c * c - b * b - d * d, 2.0 * (c * d - a * b) },
+        { 2.0 * (b * d - a * c), 2.0 * (c * d + a * b), a * a + d * d - c * c - b * b }
+    };
+    const double scale[3] = { spacing(0), spacing(1), spacing(2) * qfac() };
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            matrix[i][j] = rotation[i][j] * scale[j];
+        }
+        matrix[i][3] = qoffset[i];
+        matrix[3][i] = 0.0;
+    }
+    matrix[3][3] = 1.0;
+}
+
+void NiftiHeader::sformMatrix(double matrix[4][4]) const
+{
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            matrix[i][j] = srow[i][j];
+        }
+        matrix[3][i] = 0.0;
+    }
+    matrix[3][3] = 1.0;
+}
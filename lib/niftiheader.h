@@ -0,0 +1,66 @@
+#ifndef NIFTIHEADER_H
+#define NIFTIHEADER_H
+
+#include <QString>
+
+#include <cstdint>
+
+/**
+ * @brief NIfTI-1 / NIfTI-2头部信息
+ *
+ * 只解析头部（348或540字节），不读取体素。两种版本的字段统一为64位整数和double，
+ * 字节序与本机相反的文件会被转换并标记byteSwapped。
+ */
+struct NiftiHeader
+{
+    // NIfTI-1头部348字节，NIfTI-2头部540字节
+    static const int kNifti1HeaderSize = 348;
+    static const int kNifti2HeaderSize = 540;
+
+    int version;                // 1或2
+    bool singleFile;            // n+1/n+2（.nii）；ni1/ni2为.hdr/.img分离文件
+    bool byteSwapped;           // 文件字节序与本机相反
+    int64_t dim[8];             // dim[0]为维数，dim[1..7]为各维尺寸
+    double pixdim[8];           // pixdim[0]为qfac
+    int datatype;               // NIfTI数据类型编号
+    int bitpix;                 // 每个体素的位数
+    int64_t voxOffset;          // 体素数据在文件中的偏移
+    double sclSlope;
+    double sclInter;
+    int qformCode;
+    int sformCode;
+    double quatern[3];          // quatern_b, quatern_c, quatern_d
+    double qoffset[3];
+    double srow[3][4];          // sform矩阵的前三行
+
+    NiftiHeader();
+
+    // 从内存中的头部字节解析；size至少为对应版本的头部大小
+    bool parse(const char* data, int64_t size);
+    // 从文件开头读取并解析（只读取头部）
+    bool read(const QString& filePath);
+
+    // qfac：pixdim[0]为-1时切片方向反转
+    double qfac() const { return pixdim[0] < 0.0 ? -1.0 : 1.0; }
+    // 空间维度（缺失或为0的维度按1处理）
+    int64_t dimension(int axis) const;
+    // 体素间距（取绝对值，为0时按1处理）
+    double spacing(int axis) const;
+    // 时间及更高维度的乘积，单个三维体数据为1
+    int64_t extraComponentCount() const;
+    int64_t voxelCount() const;
+    int bytesPerVoxel() const { return bitpix / 8; }
+    int64_t dataSize() const { return voxelCount() * bytesPerVoxel(); }
+
+    // NIfTI数据类型对应的VTK标量类型，不支持时返回-1
+    int vtkScalarType() const;
+    // 数据类型名称（如"uint8"、"float32"），未知类型返回"unknown"
+    const char* datatypeName() const;
+    bool isIntegerType() const;
+
+    // 体素索引到世界坐标（毫米）的4×4矩阵：qform由四元数、间距和qfac构成，sform取srow
+    void qformMatrix(double matrix[4][4]) const;
+    void sformMatrix(double matrix[4][4]) const;
+};
+
+#endif // NIFTIHEADER_H
@@ -1,30 +1,403 @@
 #include "niftimanager.h"
 #include "brainregionvolume.h"
+#include "multilabelsurfacemesher.h"
+#include "parallelfor.h"
+#include "regionmeshcache.h"
+#include "mripyramid.h"
+#include "niftivolumeloader.h"
+#include "compactlabelvolume.h"
+#include "runlengthlabelvolume.h"
 
 #include <QDebug>
 #include <QFileInfo>
 #include <QRandomGenerator>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QElapsedTimer>
+#include <QCryptographicHash>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <vector>
 
 // VTK头文件
-#include <vtkNIFTIImageReader.h>
 #include <vtkImageData.h>
 #include <vtkPointData.h>
 #include <vtkDataArray.h>
+#include <vtkPolyData.h>
 #include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkCallbackCommand.h>
+#include <vtkCommand.h>
+
+namespace {
+
+// 共享交界面网格的平滑参数（体素面网格需要较强的平滑）
+const int kSharedInterfaceSmoothingIterations = 30;
+const double kSharedInterfaceRelaxationFactor = 0.1;
+
+// 异步处理时任务与NiftiManager之间的约定：开始前检查本轮是否已被取消，
+// 区块完成后排队回到GUI线程交给onRegionBuilt。manager为空表示同步处理
+struct RegionBuildNotifier
+{
+    NiftiManager* manager;
+    const QAtomicInt* currentGeneration;
+    int generation;
+
+    RegionBuildNotifier()
+        : manager(nullptr)
+        , currentGeneration(nullptr)
+        , generation(0)
+    {
+    }
+
+    bool isCancelled() const
+    {
+        return manager && currentGeneration->load() != generation;
+    }
+
+    void regionBuilt(int label) const
+    {
+        if (manager) {
+            QMetaObject::invokeMethod(manager, "onRegionBuilt", Qt::QueuedConnection,
+                                      Q_ARG(int, label), Q_ARG(int, generation));
+        }
+    }
+
+    void failed(const QString& message) const
+    {
+        if (manager) {
+            QMetaObject::invokeMethod(manager, "onRegionBuildFailed", Qt::QueuedConnection,
+                                      Q_ARG(QString, message), Q_ARG(int, generation));
+        }
+    }
+};
+
+// 单个区块的几何构建任务，在线程池中执行
+class RegionSurfaceTask : public QRunnable
+{
+public:
+    RegionSurfaceTask(BrainRegionVolume* volume, vtkImageData* mriData, const LabelRegionInfo* region,
+                      double minGrayValue, double maxGrayValue,
+                      const RegionBuildNotifier& notifier = RegionBuildNotifier())
+        : volume(volume)
+        , mriData(mriData)
+        , region(region)
+        , minGrayValue(minGrayValue)
+        , maxGrayValue(maxGrayValue)
+        , notifier(notifier)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        if (notifier.isCancelled()) return;
+        {
+            ParallelFor::SerialScope serialScope;
+            volume->buildSurface(mriData, *region, minGrayValue, maxGrayValue);
+        }
+        notifier.regionBuilt(volume->getLabel());
+    }
+
+private:
+    BrainRegionVolume* volume;
+    vtkImageData* mriData;
+    const LabelRegionInfo* region;
+    double minGrayValue;
+    double maxGrayValue;
+    RegionBuildNotifier notifier;
+};
+
+// 只使用标签掩码构建单个区块的表面，在线程池中执行
+class RegionLabelSurfaceTask : public QRunnable
+{
+public:
+    RegionLabelSurfaceTask(BrainRegionVolume* volume, vtkImageData* labelData, const LabelRegionInfo* region,
+                           const RegionBuildNotifier& notifier = RegionBuildNotifier())
+        : volume(volume)
+        , labelData(labelData)
+        , region(region)
+        , notifier(notifier)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        if (notifier.isCancelled()) return;
+        {
+            ParallelFor::SerialScope serialScope;
+            volume->buildLabelSurface(labelData, *region);
+        }
+        notifier.regionBuilt(volume->getLabel());
+    }
+
+private:
+    BrainRegionVolume* volume;
+    vtkImageData* labelData;
+    const LabelRegionInfo* region;
+    RegionBuildNotifier notifier;
+};
+
+// 从共享的多标签网格中组装单个区块的表面
+class RegionInterfaceTask : public QRunnable
+{
+public:
+    RegionInterfaceTask(BrainRegionVolume* volume, const MultiLabelSurfaceMesher* mesher)
+        : volume(volume)
+        , mesher(mesher)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        ParallelFor::SerialScope serialScope;
+        volume->setSurfaceData(mesher->createRegionSurface(volume->getLabel()));
+    }
+
+private:
+    BrainRegionVolume* volume;
+    const MultiLabelSurfaceMesher* mesher;
+};
+
+// 异步处理共享交界面模式：单次遍历生成整体网格后逐个组装区块，每完成一个就通知GUI线程。
+// 整体提取（按z切片并行）和平滑只在这一个任务中执行，不使用SerialScope，内部的并行可以使用全部线程
+class SharedInterfaceSurfaceTask : public QRunnable
+{
+public:
+    SharedInterfaceSurfaceTask(const QList<BrainRegionVolume*>& volumes, vtkImageData* labelData,
+                               const RunLengthLabelVolume* labelRuns, const std::vector<int>* idToLabel,
+                               const BrickIndex* bricks, MeshSmoother::Method smoothingMethod,
+                               const RegionBuildNotifier& notifier)
+        : volumes(volumes)
+        , labelData(labelData)
+        , labelRuns(labelRuns)
+        , idToLabel(idToLabel)
+        , bricks(bricks)
+        , smoothingMethod(smoothingMethod)
+        , notifier(notifier)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        if (notifier.isCancelled()) return;
+
+        MultiLabelSurfaceMesher mesher;
+        const bool extracted = labelData ? mesher.extract(labelData, idToLabel, bricks)
+                                         : mesher.extract(*labelRuns, idToLabel, bricks);
+        if (extracted) {
+            mesher.smooth(kSharedInterfaceSmoothingIterations, kSharedInterfaceRelaxationFactor, smoothingMethod);
+        } else {
+            notifier.failed("多标签表面提取失败");
+        }
+
+        for (auto* volume : volumes) {
+            if (notifier.isCancelled()) return;
+            if (extracted) {
+                volume->setSurfaceData(mesher.createRegionSurface(volume->getLabel()));
+            }
+            notifier.regionBuilt(volume->getLabel());
+        }
+    }
+
+private:
+    QList<BrainRegionVolume*> volumes;
+    vtkImageData* labelData;                  // 稠密标签图像，游程编码保存时为空
+    const RunLengthLabelVolume* labelRuns;    // labelData为空时逐行读取游程编码
+    const std::vector<int>* idToLabel;   // 标签图像为紧凑编号时的编号→标签表，否则为空
+    const BrickIndex* bricks;            // 标签块索引，跳过没有分界面的块
+    MeshSmoother::Method smoothingMethod;
+    RegionBuildNotifier notifier;
+};
+
+// 单个区块的细节层次生成任务，在后台执行，完成后回到GUI线程创建mapper
+class RegionLevelOfDetailTask : public QRunnable
+{
+public:
+    explicit RegionLevelOfDetailTask(BrainRegionVolume* volume)
+        : volume(volume)
+        , source(vtkSmartPointer<vtkPolyData>::New())
+        , revision(volume->getSurfaceRevision())
+    {
+        // 在GUI线程中浅拷贝，工作线程的抽取管线不会触碰正在渲染的数据对象
+        source->ShallowCopy(volume->getSurfaceData());
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        ParallelFor::SerialScope serialScope;
+        volume->buildLevelsOfDetail(source, revision);
+        QMetaObject::invokeMethod(volume, "applyLevelsOfDetail", Qt::QueuedConnection);
+    }
+
+private:
+    BrainRegionVolume* volume;
+    vtkSmartPointer<vtkPolyData> source;
+    int revision;
+};
+
+// 灰度值限制改变后，用缓存的子体积重新提取单个区块的表面；完成后释放信号量
+class RegionRemeshTask : public QRunnable
+{
+public:
+    RegionRemeshTask(BrainRegionVolume* volume, vtkImageData* mriData, const LabelRegionInfo* region,
+                     double minGrayValue, double maxGrayValue, int sampleFactor, QSemaphore* finished)
+        : volume(volume)
+        , mriData(mriData)
+        , region(region)
+        , minGrayValue(minGrayValue)
+        , maxGrayValue(maxGrayValue)
+        , sampleFactor(sampleFactor)
+        , finished(finished)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        {
+            ParallelFor::SerialScope serialScope;
+            if (volume->hasIntensityData()) {
+                volume->rebuildSurface(minGrayValue, maxGrayValue, sampleFactor);
+            } else if (mriData && region) {
+                // 表面来自网格缓存，没有裁剪子体积，需要完整构建一次
+                volume->buildSurface(mriData, *region, minGrayValue, maxGrayValue);
+            }
+        }
+        finished->release();
+    }
+
+private:
+    BrainRegionVolume* volume;
+    vtkImageData* mriData;
+    const LabelRegionInfo* region;
+    double minGrayValue;
+    double maxGrayValue;
+    int sampleFactor;
+    QSemaphore* finished;
+};
+
+// 在后台把区块表面写入网格缓存；持有polydata引用，写入期间区块被替换也不受影响
+class MeshCacheSaveTask : public QRunnable
+{
+public:
+    MeshCacheSaveTask(const RegionMeshCache& cache, const QByteArray& key,
+                      const QList<QPair<int, vtkSmartPointer<vtkPolyData>>>& surfaces)
+        : cache(cache)
+        , key(key)
+        , surfaces(surfaces)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        cache.save(key, surfaces);
+    }
+
+private:
+    RegionMeshCache cache;
+    QByteArray key;
+    QList<QPair<int, vtkSmartPointer<vtkPolyData>>> surfaces;
+};
+
+// 网格缓存键的版本，网格/平滑算法或其固定参数改变时递增
+const int kMeshCacheKeyVersion = 1;
+
+// 重新提取任务的线程池优先级，排在尚未开始的细节层次任务之前
+const int kRemeshTaskPriority = 1;
+
+// 交互器不存在时判定静止渲染的更新率（与vtkRenderWindowInteractor的默认值一致）
+const double kDefaultStillUpdateRate = 0.0001;
+
+// 后台加载时报告进度的间隔（毫秒）
+const int kLoadProgressIntervalMs = 100;
+
+} // namespace
 
 NiftiManager::NiftiManager(QObject *parent)
     : QObject(parent)
     , mriImage(nullptr)
     , labelImage(nullptr)
+    , mriDecodePending(false)
+    , labelDecodePending(false)
     , renderer(nullptr)
+    , labelPartitionValid(false)
+    , intensityHistogramsValid(false)
+    , histogramBuildId(0)
+    , histogramThreadPool(nullptr)
+    , regionThreadPool(nullptr)
+    , regionMeshingMode(INTENSITY_ISOSURFACE)
+    , isosurfaceBackend(IsosurfaceExtractor::FLYING_EDGES)
+    , smoothingMethod(MeshSmoother::LAPLACIAN)
+    , levelOfDetailEnabled(true)
+    , levelOfDetailReduced(false)
+    , renderStartObserverTag(0)
+    , processingGeneration(0)
+    , asyncProcessing(false)
+    , completedRegionCount(0)
+    , totalRegionCount(0)
+    , grayValueLimitsPending(false)
+    , pendingMinGrayValue(0.0)
+    , pendingMaxGrayValue(0.0)
+    , meshCache(new RegionMeshCache())
+    , meshCacheThreadPool(nullptr)
+    , meshCacheEnabled(true)
+    , regionsFromMeshCache(false)
+    , processedMeshingMode(INTENSITY_ISOSURFACE)
+    , processedIsosurfaceBackend(IsosurfaceExtractor::FLYING_EDGES)
+    , processedSmoothingMethod(MeshSmoother::LAPLACIAN)
+    , remeshMsPerVoxel(-1.0)
+    , loadThreadPool(nullptr)
+    , nextLoadId(0)
+    , loadTotalBytes(0)
+    , loadCompletedBytes(0)
+    , lastLoadProgress(-1)
 {
+    // 区块几何构建使用独立线程池，避免占用全局线程池
+    regionThreadPool = new QThreadPool(this);
+    regionThreadPool->setMaxThreadCount(QThread::idealThreadCount());
+    
+    // 后台加载每个文件一个任务，解码内部再按块并行
+    loadThreadPool = new QThreadPool(this);
+    loadThreadPool->setMaxThreadCount(2);
+    loadProgressTimer.setInterval(kLoadProgressIntervalMs);
+    connect(&loadProgressTimer, &QTimer::timeout, this, &NiftiManager::reportLoadProgress);
+    
+    // 缓存写入放在单独的单线程池中：区块线程池在取消处理时会被clear()，排队的写入不能随之丢失
+    meshCacheThreadPool = new QThreadPool(this);
+    meshCacheThreadPool->setMaxThreadCount(1);
+    
+    // 灰度直方图在后台单线程统计，不与区块处理争用线程
+    histogramThreadPool = new QThreadPool(this);
+    histogramThreadPool->setMaxThreadCount(1);
+    
+    renderStartCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+    renderStartCallback->SetCallback(&NiftiManager::onRenderStart);
+    renderStartCallback->SetClientData(this);
     qDebug() << "NiftiManager 初始化";
 }
 
 NiftiManager::~NiftiManager()
 {
+    // 正在执行的加载和直方图任务完成时会向本对象投递通知，析构前等待其结束
+    cancelLoading();
+    resetIntensityHistograms();
+    loadThreadPool->waitForDone();
+    histogramThreadPool->waitForDone();
+    setRenderer(nullptr);
     clearRegions();
+    // 写入任务引用meshCache，成员析构前等待其结束
+    meshCacheThreadPool->waitForDone();
     qDebug() << "NiftiManager 析构";
 }
 
@@ -32,72 +405,169 @@ bool NiftiManager::loadMriNifti(const QString& filePath)
 {
     qDebug() << "开始加载MRI NIFTI文件:" << filePath;
     
+    // 正在后台处理的任务仍引用旧图像，切换数据前先取消；尚未完成的MRI后台加载也不再需要
+    cancelProcessing();
+    cancelVolumeLoads(false);
+    
     QFileInfo fileInfo(filePath);
     if (!fileInfo.exists()) {
         emit errorOccurred("MRI文件不存在: " + filePath);
         return false;
     }
 
+    // 只解析头部，体素在第一次需要时解码
+    mriImage = nullptr;
+    mriPyramid.clear();
+    mriBricks.clear();
+    mriFilePath = filePath;
+    mriFingerprint.clear();
+    resetIntensityHistograms();
+    mriDecodePending = NiftiVolumeLoader::readHeader(filePath, mriHeader);
+    if (!mriDecodePending) {
+        emit errorOccurred("无法读取MRI NIFTI文件头部");
+        return false;
+    }
+
+    qDebug() << "MRI NIFTI头部读取成功，图像尺寸:" << mriHeader.dimension(0)
+             << "x" << mriHeader.dimension(1)
+             << "x" << mriHeader.dimension(2);
+    return true;
+}
+
+bool NiftiManager::loadLabelNifti(const QString& filePath)
+{
+    qDebug() << "开始加载标签NIFTI文件:" << filePath;
+    
+    // 正在后台处理的任务仍引用旧图像和标签划分，切换数据前先取消；尚未完成的标签后台加载也不再需要
+    cancelProcessing();
+    cancelVolumeLoads(true);
+    
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists()) {
+        emit errorOccurred("标签文件不存在: " + filePath);
+        return false;
+    }
+
+    // 只解析头部，体素在第一次需要时解码
+    labelImage = nullptr;
+    labelRuns.clear();
+    labelBricks.clear();
+    labelFilePath = filePath;
+    labelFingerprint.clear();
+    labelPartitioner.clear();
+    labelPartitionValid = false;
+    resetIntensityHistograms();
+    labelVoxelCounts.clear();
+    labelIdToValue.clear();
+    labelDecodePending = NiftiVolumeLoader::readHeader(filePath, labelHeader);
+    if (!labelDecodePending) {
+        emit errorOccurred("无法读取标签NIFTI文件头部");
+        return false;
+    }
+
+    qDebug() << "标签NIFTI头部读取成功，图像尺寸:" << labelHeader.dimension(0)
+             << "x" << labelHeader.dimension(1)
+             << "x" << labelHeader.dimension(2);
+    return true;
+}
+
+bool NiftiManager::ensureMriImage()
+{
+    if (!mriDecodePending) return mriImage != nullptr;
+    mriDecodePending = false;
+
     try {
-        // 使用VTK的NIFTI读取器
-        auto reader = vtkSmartPointer<vtkNIFTIImageReader>::New();
-        reader->SetFileName(filePath.toStdString().c_str());
-        reader->Update();
-        
-        mriImage = reader->GetOutput();
+        // 未压缩的.nii直接映射文件，.nii.gz并行解压，其他情况使用VTK的NIFTI读取器
+        mriImage = NiftiVolumeLoader::load(mriFilePath);
         if (!mriImage) {
             emit errorOccurred("无法读取MRI NIFTI文件");
             return false;
         }
-
-        qDebug() << "MRI NIFTI文件加载成功";
-        qDebug() << "MRI图像尺寸:" << mriImage->GetDimensions()[0] 
-                 << "x" << mriImage->GetDimensions()[1] 
-                 << "x" << mriImage->GetDimensions()[2];
         
+        // 交互预览使用的多分辨率金字塔，等值估计使用的块灰度范围
+        mriPyramid.build(mriImage);
+        mriBricks.buildRanges(mriImage);
+        qDebug() << "MRI NIFTI体素解码完成";
+        startIntensityHistogramBuild();
         return true;
     }
     catch (const std::exception& e) {
+        mriImage = nullptr;
         emit errorOccurred("加载MRI文件时发生错误: " + QString(e.what()));
         return false;
     }
 }
 
-bool NiftiManager::loadLabelNifti(const QString& filePath)
+bool NiftiManager::ensureLabelImage()
 {
-    qDebug() << "开始加载标签NIFTI文件:" << filePath;
-    
-    QFileInfo fileInfo(filePath);
-    if (!fileInfo.exists()) {
-        emit errorOccurred("标签文件不存在: " + filePath);
-        return false;
-    }
+    if (!labelDecodePending) return labelImage != nullptr || labelRuns.isValid();
+    labelDecodePending = false;
 
     try {
-        // 使用VTK的NIFTI读取器
-        auto reader = vtkSmartPointer<vtkNIFTIImageReader>::New();
-        reader->SetFileName(filePath.toStdString().c_str());
-        reader->Update();
-        
-        labelImage = reader->GetOutput();
+        labelImage = NiftiVolumeLoader::load(labelFilePath);
         if (!labelImage) {
             emit errorOccurred("无法读取标签NIFTI文件");
             return false;
         }
-
-        qDebug() << "标签NIFTI文件加载成功";
-        qDebug() << "标签图像尺寸:" << labelImage->GetDimensions()[0] 
-                 << "x" << labelImage->GetDimensions()[1] 
-                 << "x" << labelImage->GetDimensions()[2];
         
+        // 解码时转换为紧凑编号并统计标签及体素数（供后续划分预分配），稀疏时改为游程编码保存
+        QList<int> labels = extractLabelsFromImage();
+        qDebug() << "标签NIFTI体素解码完成，包含" << labels.size() << "个非背景标签";
+        startIntensityHistogramBuild();
         return true;
     }
     catch (const std::exception& e) {
+        labelImage = nullptr;
         emit errorOccurred("加载标签文件时发生错误: " + QString(e.what()));
         return false;
     }
 }
 
+vtkImageData* NiftiManager::getMriImage()
+{
+    ensureMriImage();
+    return mriImage;
+}
+
+vtkSmartPointer<vtkImageData> NiftiManager::getLabelImage()
+{
+    if (!ensureLabelImage()) return nullptr;
+    if (labelImage) return labelImage;
+    // 游程编码保存：解压一份交给调用方，游程编码保持不变
+    return labelRuns.isValid() ? labelRuns.toImage() : nullptr;
+}
+
+vtkSmartPointer<vtkImageData> NiftiManager::getLabelSlice(int z)
+{
+    if (!ensureLabelImage()) return nullptr;
+    if (!labelImage) return labelRuns.createSliceImage(z);
+
+    // 稠密图像的一层在内存中连续，直接复制
+    int dims[3];
+    int extent[6];
+    labelImage->GetDimensions(dims);
+    labelImage->GetExtent(extent);
+    vtkDataArray* scalars = labelImage->GetPointData()->GetScalars();
+    if (!scalars || z < 0 || z >= dims[2]) return nullptr;
+
+    auto slice = vtkSmartPointer<vtkImageData>::New();
+    slice->SetOrigin(labelImage->GetOrigin());
+    slice->SetSpacing(labelImage->GetSpacing());
+    slice->SetExtent(extent[0], extent[1], extent[2], extent[3], extent[4] + z, extent[4] + z);
+    slice->AllocateScalars(scalars->GetDataType(), scalars->GetNumberOfComponents());
+    const vtkIdType sliceValues = static_cast<vtkIdType>(dims[0]) * dims[1] * scalars->GetNumberOfComponents();
+    std::memcpy(slice->GetScalarPointer(),
+                static_cast<const char*>(scalars->GetVoidPointer(0)) + z * sliceValues * scalars->GetDataTypeSize(),
+                static_cast<size_t>(sliceValues) * scalars->GetDataTypeSize());
+    return slice;
+}
+
+const MriPyramid& NiftiManager::getMriPyramid()
+{
+    ensureMriImage();
+    return mriPyramid;
+}
+
 void NiftiManager::processRegions()
 {
     processRegions(0.0, 0.0);
@@ -105,28 +575,213 @@ void NiftiManager::processRegions()
 
 void NiftiManager::processRegions(double minGrayValue, double maxGrayValue)
 {
-    if (!mriImage || !labelImage) {
-        emit errorOccurred("需要同时加载MRI和标签数据才能处理区块");
+    QList<BrainRegionVolume*> pendingVolumes;
+    if (!prepareRegions(pendingVolumes)) return;
+    
+    // 网格缓存命中时直接使用缓存的表面，跳过整个网格阶段
+    const QByteArray cacheKey = meshCacheEnabled ? meshCacheKey(minGrayValue, maxGrayValue) : QByteArray();
+    regionsFromMeshCache = !cacheKey.isEmpty() && applyMeshCache(pendingVolumes, cacheKey, minGrayValue, maxGrayValue);
+    
+    // 步骤2: 在线程池中并行计算各区块几何（掩码、网格、平滑、质心），体素最多的先调度
+    if (regionsFromMeshCache) {
+        qDebug() << "使用网格缓存，跳过网格生成";
+    } else if (regionMeshingMode == SHARED_LABEL_INTERFACES) {
+        buildSharedInterfaceSurfaces(pendingVolumes);
+    } else if (regionMeshingMode == LABEL_SURFACE_NETS) {
+        buildLabelMaskSurfaces(pendingVolumes);
+    } else {
+        if (minGrayValue < maxGrayValue) {
+            qDebug() << "所有区块使用灰度值限制: [" << minGrayValue << ", " << maxGrayValue << "]";
+        }
+        buildRegionSurfaces(pendingVolumes, minGrayValue, maxGrayValue);
+    }
+    
+    // 步骤3: 回到GUI线程，把结果交给surface actor并添加到渲染器
+    for (auto* regionVolume : pendingVolumes) {
+        regionVolume->applySurface();
+        qDebug() << "区块" << regionVolume->getLabel() << "创建成功，最终颜色:" << regionVolume->getColor().name();
+        
+        if (renderer) {
+            addVolumeToRenderer(regionVolume);
+        }
+    }
+    
+    // 步骤4: 在后台为各区块生成细节层次、写入网格缓存，不阻塞首次显示
+    if (levelOfDetailEnabled) {
+        scheduleLevelsOfDetail(pendingVolumes);
+    }
+    if (!cacheKey.isEmpty() && !regionsFromMeshCache) {
+        storeMeshCache(pendingVolumes, cacheKey);
+    }
+    
+    qDebug() << "脑区块处理完成，共" << regionVolumes.size() << "个区块";
+    emit regionsProcessed();
+}
+
+void NiftiManager::processRegionsAsync()
+{
+    processRegionsAsync(0.0, 0.0);
+}
+
+void NiftiManager::processRegionsAsync(double minGrayValue, double maxGrayValue)
+{
+    QList<BrainRegionVolume*> pendingVolumes;
+    if (!prepareRegions(pendingVolumes)) return;
+    
+    completedRegionCount = 0;
+    totalRegionCount = pendingVolumes.size();
+    if (totalRegionCount == 0) {
+        emit regionsProcessed();
         return;
     }
+    asyncProcessing = true;
+    
+    // 网格缓存命中时不需要后台任务，但同样排队逐个交付，信号在本函数返回后才发出，与未命中时一致
+    pendingMeshCacheKey = meshCacheEnabled ? meshCacheKey(minGrayValue, maxGrayValue) : QByteArray();
+    regionsFromMeshCache = !pendingMeshCacheKey.isEmpty() &&
+                           applyMeshCache(pendingVolumes, pendingMeshCacheKey, minGrayValue, maxGrayValue);
+    if (regionsFromMeshCache) {
+        const int generation = processingGeneration.load();
+        for (auto* volume : pendingVolumes) {
+            QMetaObject::invokeMethod(this, "onRegionBuilt", Qt::QueuedConnection,
+                                      Q_ARG(int, volume->getLabel()), Q_ARG(int, generation));
+        }
+        return;
+    }
+    
+    RegionBuildNotifier notifier;
+    notifier.manager = this;
+    notifier.currentGeneration = &processingGeneration;
+    notifier.generation = processingGeneration.load();
+    
+    // 只提交任务，不等待：每个区块完成后由onRegionBuilt在GUI线程中逐个显示
+    QList<BrainRegionVolume*> scheduled = sortVolumesBySize(pendingVolumes);
+    if (regionMeshingMode == SHARED_LABEL_INTERFACES) {
+        regionThreadPool->start(new SharedInterfaceSurfaceTask(scheduled, labelImage, &labelRuns, labelIdTable(),
+                                                                    &labelBricks, smoothingMethod, notifier));
+    } else if (regionMeshingMode == LABEL_SURFACE_NETS) {
+        for (auto* volume : scheduled) {
+            regionThreadPool->start(new RegionLabelSurfaceTask(volume, labelGeometry(),
+                                                               labelPartitioner.getRegion(volume->getLabel()),
+                                                               notifier));
+        }
+    } else {
+        if (minGrayValue < maxGrayValue) {
+            qDebug() << "所有区块使用灰度值限制: [" << minGrayValue << ", " << maxGrayValue << "]";
+        }
+        for (auto* volume : scheduled) {
+            regionThreadPool->start(new RegionSurfaceTask(volume, mriImage,
+                                                          labelPartitioner.getRegion(volume->getLabel()),
+                                                          minGrayValue, maxGrayValue, notifier));
+        }
+    }
+    
+    qDebug() << "后台处理" << totalRegionCount << "个区块，线程数:" << regionThreadPool->maxThreadCount();
+}
+
+void NiftiManager::cancelProcessing()
+{
+    if (!asyncProcessing) return;
+    
+    // 递增轮次使已排队的任务和通知全部失效；正在执行的任务仍引用区块和图像数据，需要等待其结束
+    processingGeneration.fetchAndAddOrdered(1);
+    regionThreadPool->clear();
+    regionThreadPool->waitForDone();
+    asyncProcessing = false;
+    grayValueLimitsPending = false;
+    
+    qDebug() << "已取消区块处理，完成" << completedRegionCount << "/" << totalRegionCount << "个区块";
+    emit processingCancelled();
+}
+
+void NiftiManager::onRegionBuilt(int label, int generation)
+{
+    if (!asyncProcessing || generation != processingGeneration.load()) return;
+    
+    BrainRegionVolume* regionVolume = regionVolumes.value(label, nullptr);
+    if (regionVolume) {
+        regionVolume->applySurface();
+        if (renderer) {
+            addVolumeToRenderer(regionVolume);
+        }
+    }
+    
+    ++completedRegionCount;
+    emit regionProcessed(label, completedRegionCount, totalRegionCount);
+    
+    if (completedRegionCount < totalRegionCount) return;
+    
+    asyncProcessing = false;
+    if (!pendingMeshCacheKey.isEmpty() && !regionsFromMeshCache) {
+        storeMeshCache(regionVolumes.values(), pendingMeshCacheKey);
+    }
+    pendingMeshCacheKey.clear();
+    if (grayValueLimitsPending) {
+        grayValueLimitsPending = false;
+        setGrayValueLimits(pendingMinGrayValue, pendingMaxGrayValue);
+    }
+    if (levelOfDetailEnabled) {
+        scheduleLevelsOfDetail(regionVolumes.values());
+    }
+    
+    qDebug() << "脑区块后台处理完成，共" << regionVolumes.size() << "个区块";
+    emit regionsProcessed();
+}
+
+void NiftiManager::onRegionBuildFailed(const QString& message, int generation)
+{
+    if (!asyncProcessing || generation != processingGeneration.load()) return;
+    emit errorOccurred(message);
+}
+
+bool NiftiManager::prepareRegions(QList<BrainRegionVolume*>& pendingVolumes)
+{
+    const bool sharedInterfaces = (regionMeshingMode == SHARED_LABEL_INTERFACES);
+    const bool labelOnly = (regionMeshingMode != INTENSITY_ISOSURFACE);
+    if (labelOnly && !ensureLabelImage()) {
+        emit errorOccurred("需要加载标签数据才能处理区块");
+        return false;
+    }
+    if (!labelOnly && (!ensureMriImage() || !ensureLabelImage())) {
+        emit errorOccurred("需要同时加载MRI和标签数据才能处理区块");
+        return false;
+    }
 
     qDebug() << "开始处理脑区块...";
     
     // 清理旧的区块
     clearRegions();
+    processedMeshingMode = regionMeshingMode;
+    processedIsosurfaceBackend = isosurfaceBackend;
+    processedSmoothingMethod = smoothingMethod;
+    regionsFromMeshCache = false;
     
-    // 提取所有标签编号
-    QList<int> labels = extractLabelsFromImage();
+    QList<int> labels;
+    if (sharedInterfaces) {
+        // 共享交界面模式直接遍历标签图像，不需要每个区块的体素列表
+        labels = labelVoxelCounts.keys();
+        std::sort(labels.begin(), labels.end());
+    } else {
+        // 单次扫描标签图像，得到每个标签的体素数、包围盒和体素索引列表
+        if (!ensureLabelPartition()) {
+            emit errorOccurred("标签数据划分失败");
+            return false;
+        }
+        labels = labelPartitioner.getLabels();
+    }
     qDebug() << "发现" << labels.size() << "个标签区块:" << labels;
     
-    // 为每个标签创建BrainRegionVolume
+    // 步骤1: 在GUI线程中为每个标签创建BrainRegionVolume（QObject及VTK渲染对象）
     for (int label : labels) {
-        if (label == 0) continue; // 跳过背景标签
-        
         qDebug() << "正在创建区块" << label;
         
         try {
             auto* regionVolume = new BrainRegionVolume(label, this);
+            regionVolume->setIsosurfaceBackend(isosurfaceBackend);
+            regionVolume->setLabelMeshingMethod(regionMeshingMode == LABEL_SURFACE_NETS
+                                                ? BrainRegionVolume::LABEL_SURFACE_NETS
+                                                : BrainRegionVolume::LABEL_MARCHING_CUBES);
+            regionVolume->setSmoothingMethod(smoothingMethod);
             
             // 为每个区块生成独特的颜色
             QColor uniqueColor = generateColorForLabel(label);
@@ -135,26 +790,12 @@ void NiftiManager::processRegions(double minGrayValue, double maxGrayValue)
             qDebug() << "区块" << label << "分配颜色:" << uniqueColor.name() 
                      << "RGB(" << uniqueColor.redF() << "," << uniqueColor.greenF() << "," << uniqueColor.blueF() << ")";
             
-            // 设置体数据（MRI数据和标签掩码）
-            if (minGrayValue < maxGrayValue) {
-                regionVolume->setVolumeData(mriImage, labelImage, minGrayValue, maxGrayValue);
-                qDebug() << "区块" << label << "使用灰度值限制: [" << minGrayValue << ", " << maxGrayValue << "]";
-            } else {
-                regionVolume->setVolumeData(mriImage, labelImage);
-            }
-            
             // 连接信号
             connect(regionVolume, &BrainRegionVolume::visibilityChanged,
                     this, &NiftiManager::regionVisibilityChanged);
             
             regionVolumes[label] = regionVolume;
-            
-            qDebug() << "区块" << label << "创建成功，最终颜色:" << regionVolume->getColor().name();
-            
-            // 添加到渲染器
-            if (renderer) {
-                addVolumeToRenderer(regionVolume);
-            }
+            pendingVolumes.append(regionVolume);
         }
         catch (const std::exception& e) {
             qDebug() << "创建区块" << label << "时发生错误:" << e.what();
@@ -164,12 +805,312 @@ void NiftiManager::processRegions(double minGrayValue, double maxGrayValue)
         }
     }
     
-    qDebug() << "脑区块处理完成，共" << regionVolumes.size() << "个区块";
-    emit regionsProcessed();
+    return true;
+}
+
+QList<BrainRegionVolume*> NiftiManager::sortVolumesBySize(const QList<BrainRegionVolume*>& volumes) const
+{
+    // 大区块耗时最长，先调度可以减少线程池尾部的空闲
+    QList<BrainRegionVolume*> scheduled = volumes;
+    std::sort(scheduled.begin(), scheduled.end(),
+              [this](BrainRegionVolume* a, BrainRegionVolume* b) {
+                  return labelVoxelCounts.value(a->getLabel()) > labelVoxelCounts.value(b->getLabel());
+              });
+    return scheduled;
+}
+
+void NiftiManager::buildRegionSurfaces(const QList<BrainRegionVolume*>& volumes,
+                                       double minGrayValue, double maxGrayValue)
+{
+    QList<BrainRegionVolume*> scheduled = sortVolumesBySize(volumes);
+    
+    qDebug() << "并行构建" << scheduled.size() << "个区块，线程数:" << regionThreadPool->maxThreadCount();
+    
+    for (auto* volume : scheduled) {
+        regionThreadPool->start(new RegionSurfaceTask(volume, mriImage,
+                                                      labelPartitioner.getRegion(volume->getLabel()),
+                                                      minGrayValue, maxGrayValue));
+    }
+    regionThreadPool->waitForDone();
+}
+
+void NiftiManager::buildSharedInterfaceSurfaces(const QList<BrainRegionVolume*>& volumes)
+{
+    // 单次遍历标签图像生成所有区块的表面，相邻区块的交界面只三角化一次
+    MultiLabelSurfaceMesher mesher;
+    const bool extracted = labelImage ? mesher.extract(labelImage, labelIdTable(), &labelBricks)
+                                      : mesher.extract(labelRuns, labelIdTable(), &labelBricks);
+    if (!extracted) {
+        emit errorOccurred("多标签表面提取失败");
+        return;
+    }
+    
+    // 体素面网格呈阶梯状，在整体网格上平滑以保持交界面两侧贴合
+    mesher.smooth(kSharedInterfaceSmoothingIterations, kSharedInterfaceRelaxationFactor, smoothingMethod);
+    
+    // 各区块从共享网格中组装自己的polydata，互不依赖，可以并行
+    QList<BrainRegionVolume*> scheduled = sortVolumesBySize(volumes);
+    for (auto* volume : scheduled) {
+        regionThreadPool->start(new RegionInterfaceTask(volume, &mesher));
+    }
+    regionThreadPool->waitForDone();
+}
+
+void NiftiManager::buildLabelMaskSurfaces(const QList<BrainRegionVolume*>& volumes)
+{
+    QList<BrainRegionVolume*> scheduled = sortVolumesBySize(volumes);
+    
+    qDebug() << "并行构建" << scheduled.size() << "个区块的标签表面，线程数:" << regionThreadPool->maxThreadCount();
+    
+    for (auto* volume : scheduled) {
+        regionThreadPool->start(new RegionLabelSurfaceTask(volume, labelGeometry(),
+                                                           labelPartitioner.getRegion(volume->getLabel())));
+    }
+    regionThreadPool->waitForDone();
+}
+
+void NiftiManager::scheduleLevelsOfDetail(const QList<BrainRegionVolume*>& volumes)
+{
+    // 各区块的二次误差抽取互不依赖，在线程池中并行执行，大区块先调度
+    QList<BrainRegionVolume*> scheduled = sortVolumesBySize(volumes);
+    int taskCount = 0;
+    for (auto* volume : scheduled) {
+        if (volume->getSurfaceData()) {
+            regionThreadPool->start(new RegionLevelOfDetailTask(volume));
+            ++taskCount;
+        }
+    }
+    qDebug() << "后台生成" << taskCount << "个区块的细节层次";
+}
+
+void NiftiManager::setLevelOfDetailEnabled(bool enabled)
+{
+    levelOfDetailEnabled = enabled;
+    if (!enabled) {
+        restoreFullDetail();
+    }
+    qDebug() << "细节层次:" << (enabled ? "启用" : "禁用");
+}
+
+void NiftiManager::onRenderStart(vtkObject*, unsigned long, void* clientData, void*)
+{
+    static_cast<NiftiManager*>(clientData)->updateLevelsOfDetail();
+}
+
+void NiftiManager::updateLevelsOfDetail()
+{
+    if (!renderer || regionVolumes.isEmpty()) return;
+    
+    // 交互样式在拖动时把渲染窗口的期望更新率设为交互更新率，松开后设回静止更新率并重新渲染，
+    // 因此期望更新率高于静止更新率即表示正在交互，其倒数就是目标帧时间
+    vtkRenderWindow* window = renderer->GetRenderWindow();
+    const double desiredUpdateRate = window ? window->GetDesiredUpdateRate() : 0.0;
+    vtkRenderWindowInteractor* interactor = window ? window->GetInteractor() : nullptr;
+    const double stillUpdateRate = interactor ? interactor->GetStillUpdateRate() : kDefaultStillUpdateRate;
+    
+    if (!levelOfDetailEnabled || desiredUpdateRate <= stillUpdateRate) {
+        restoreFullDetail();
+        return;
+    }
+    
+    QList<BrainRegionVolume*> candidates;
+    std::vector<RegionDetailCandidate> regions;
+    vtkIdType fullDetailTriangles = 0;
+    for (auto* volume : regionVolumes.values()) {
+        if (!volume->isVisible() || volume->getLevelOfDetailCount() <= 1) continue;
+        
+        RegionDetailCandidate region;
+        region.projectedSize = volume->projectedScreenSize(renderer);
+        for (int level = 0; level < volume->getLevelOfDetailCount(); ++level) {
+            region.triangleCounts.push_back(volume->getTriangleCount(level));
+        }
+        fullDetailTriangles += region.triangleCounts.front();
+        regions.push_back(region);
+        candidates.append(volume);
+    }
+    if (candidates.isEmpty()) return;
+    
+    levelOfDetailSelector.updateBudget(renderer->GetLastRenderTimeInSeconds(), 1.0 / desiredUpdateRate,
+                                       fullDetailTriangles);
+    std::vector<int> levels;
+    levelOfDetailSelector.select(regions, levels);
+    for (int i = 0; i < candidates.size(); ++i) {
+        candidates[i]->setLevelOfDetail(levels[i]);
+    }
+    levelOfDetailReduced = true;
+}
+
+void NiftiManager::restoreFullDetail()
+{
+    if (!levelOfDetailReduced) return;
+    
+    for (auto* volume : regionVolumes.values()) {
+        volume->setLevelOfDetail(0);
+    }
+    levelOfDetailSelector.reset();
+    levelOfDetailReduced = false;
+}
+
+bool NiftiManager::ensureLabelPartition()
+{
+    if (labelPartitionValid) return true;
+    if (!ensureLabelImage()) return false;
+    
+    // 划分只需要标签，游程编码保存时直接遍历游程，不解压
+    labelPartitionValid = labelImage ?
+        labelPartitioner.partition(labelImage, &labelVoxelCounts, labelIdTable(), &labelBricks) :
+        labelPartitioner.partition(labelRuns, &labelVoxelCounts, labelIdTable());
+    return labelPartitionValid;
+}
+
+const IntensityHistogram* NiftiManager::getIntensityHistogram(int label)
+{
+    // 不在GUI线程中解码或统计：数据已解码但统计尚未开始时启动后台统计，完成前返回nullptr
+    if (!intensityHistogramsValid) {
+        startIntensityHistogramBuild();
+        return nullptr;
+    }
+    return label == 0 ? &intensityHistograms.getGlobalHistogram() : intensityHistograms.getRegionHistogram(label);
+}
+
+QByteArray NiftiManager::meshCacheKey(double minGrayValue, double maxGrayValue)
+{
+    // 文件指纹在首次使用缓存时计算，每个文件只计算一次
+    const bool needsMri = (processedMeshingMode == INTENSITY_ISOSURFACE);
+    if (labelFingerprint.isEmpty() && !labelFilePath.isEmpty()) {
+        labelFingerprint = RegionMeshCache::fingerprintFile(labelFilePath);
+    }
+    if (needsMri && mriFingerprint.isEmpty() && !mriFilePath.isEmpty()) {
+        mriFingerprint = RegionMeshCache::fingerprintFile(mriFilePath);
+    }
+    if (labelFingerprint.isEmpty() || (needsMri && mriFingerprint.isEmpty())) {
+        return QByteArray();
+    }
+    
+    // 键包含影响最终表面的全部输入：文件指纹、网格模式、后端、平滑方法和（灰度等值面模式的）灰度值限制；
+    // 参数取当前区块处理时的值，之后修改的设置要到下一次processRegions才生效
+    QByteArray parameters = QString("version=%1;mode=%2;backend=%3;smoothing=%4")
+                                .arg(kMeshCacheKeyVersion)
+                                .arg(static_cast<int>(processedMeshingMode))
+                                .arg(static_cast<int>(processedIsosurfaceBackend))
+                                .arg(static_cast<int>(processedSmoothingMethod))
+                                .toLatin1();
+    if (needsMri && minGrayValue < maxGrayValue) {
+        parameters += QString(";gray=%1,%2").arg(minGrayValue, 0, 'g', 17).arg(maxGrayValue, 0, 'g', 17).toLatin1();
+    }
+    
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(labelFingerprint);
+    if (needsMri) {
+        hash.addData(mriFingerprint);
+    }
+    hash.addData(parameters);
+    return hash.result();
+}
+
+bool NiftiManager::applyMeshCache(const QList<BrainRegionVolume*>& volumes, const QByteArray& key,
+                                  double minGrayValue, double maxGrayValue)
+{
+    QHash<int, vtkSmartPointer<vtkPolyData>> surfaces;
+    if (!meshCache->load(key, surfaces)) return false;
+    
+    // 标签集合必须完全一致，否则当作未命中
+    for (auto* volume : volumes) {
+        if (!surfaces.contains(volume->getLabel())) {
+            qDebug() << "网格缓存缺少区块" << volume->getLabel() << "，重新生成";
+            return false;
+        }
+    }
+    for (auto* volume : volumes) {
+        volume->setGrayValueLimits(minGrayValue, maxGrayValue);
+        volume->setSurfaceData(surfaces.value(volume->getLabel()));
+    }
+    return true;
+}
+
+void NiftiManager::storeMeshCache(const QList<BrainRegionVolume*>& volumes, const QByteArray& key)
+{
+    if (key.isEmpty()) return;
+    
+    QList<QPair<int, vtkSmartPointer<vtkPolyData>>> surfaces;
+    for (auto* volume : volumes) {
+        if (volume->getSurfaceData()) {
+            surfaces.append(qMakePair(volume->getLabel(), vtkSmartPointer<vtkPolyData>(volume->getSurfaceData())));
+        }
+    }
+    if (surfaces.size() != volumes.size()) {
+        // 有区块生成失败时不缓存，下次仍完整处理
+        qDebug() << "部分区块没有表面，不写入网格缓存";
+        return;
+    }
+    meshCacheThreadPool->start(new MeshCacheSaveTask(*meshCache, key, surfaces));
+}
+
+void NiftiManager::setMeshCacheEnabled(bool enabled)
+{
+    meshCacheEnabled = enabled;
+    qDebug() << "网格缓存:" << (enabled ? "启用" : "禁用");
+}
+
+void NiftiManager::setMeshCacheDirectory(const QString& directory)
+{
+    // 排队的写入仍写到原目录
+    meshCacheThreadPool->waitForDone();
+    meshCache->setDirectory(directory);
+    qDebug() << "网格缓存目录:" << directory;
+}
+
+QString NiftiManager::getMeshCacheDirectory() const
+{
+    return meshCache->getDirectory();
+}
+
+bool NiftiManager::clearMeshCache()
+{
+    // 等待正在写入的缓存任务结束
+    meshCacheThreadPool->waitForDone();
+    return meshCache->clear();
+}
+
+void NiftiManager::setIsosurfaceBackend(IsosurfaceExtractor::Backend backend)
+{
+    isosurfaceBackend = backend;
+    qDebug() << "等值面提取后端:" << IsosurfaceExtractor::backendName(backend);
+}
+
+void NiftiManager::setSmoothingMethod(MeshSmoother::Method method)
+{
+    smoothingMethod = method;
+    qDebug() << "表面平滑方法:" << MeshSmoother::methodName(method);
+}
+
+void NiftiManager::setRegionMeshingMode(RegionMeshingMode mode)
+{
+    regionMeshingMode = mode;
+    switch (mode) {
+    case SHARED_LABEL_INTERFACES:
+        qDebug() << "区块网格生成模式: 共享交界面";
+        break;
+    case LABEL_SURFACE_NETS:
+        qDebug() << "区块网格生成模式: 标签表面网格";
+        break;
+    case INTENSITY_ISOSURFACE:
+    default:
+        qDebug() << "区块网格生成模式: 灰度等值面";
+        break;
+    }
 }
 
 void NiftiManager::clearRegions()
 {
+    cancelProcessing();
+    
+    // 丢弃尚未开始的细节层次任务，并等待正在执行的任务结束后再释放区块
+    regionThreadPool->clear();
+    regionThreadPool->waitForDone();
+    levelOfDetailSelector.reset();
+    levelOfDetailReduced = false;
+    
     // 从渲染器中移除所有Volume
     for (auto* volume : regionVolumes.values()) {
         removeVolumeFromRenderer(volume);
@@ -224,29 +1165,446 @@ BrainRegionVolume* NiftiManager::getRegionVolume(int label)
 
 void NiftiManager::setRenderer(vtkRenderer* renderer)
 {
+    if (this->renderer == renderer) return;
+    
+    // 每次渲染开始前选择细节层次
+    if (observedRenderer) {
+        observedRenderer->RemoveObserver(renderStartObserverTag);
+        renderStartObserverTag = 0;
+    }
     this->renderer = renderer;
+    observedRenderer = renderer;
+    if (renderer) {
+        renderStartObserverTag = renderer->AddObserver(vtkCommand::StartEvent, renderStartCallback);
+    }
 }
 
-QList<int> NiftiManager::extractLabelsFromImage()
+namespace {
+
+// 稠密直方图允许的最大标签跨度，超过时退回哈希统计
+const vtkIdType kMaxDenseLabelRange = static_cast<vtkIdType>(1) << 24;
+
+// 游程编码至少比稠密标签图像小这么多倍时才替换稠密图像
+const int kRunLengthMinSavingFactor = 4;
+
+// 求正标签的取值范围；8/16位整数类型直接使用类型范围，省去一次扫描
+template <typename T>
+bool findPositiveLabelRange(const T* data, vtkIdType numPoints, int stride, int& minLabel, int& maxLabel)
+{
+    if (std::numeric_limits<T>::is_integer && sizeof(T) <= 2) {
+        minLabel = 1;
+        maxLabel = static_cast<int>(std::numeric_limits<T>::max());
+        return true;
+    }
+
+    minLabel = std::numeric_limits<int>::max();
+    maxLabel = 0;
+    for (vtkIdType i = 0; i < numPoints; ++i) {
+        const int label = static_cast<int>(data[i * stride]);
+        if (label > 0) {
+            if (label < minLabel) minLabel = label;
+            if (label > maxLabel) maxLabel = label;
+        }
+    }
+    return maxLabel > 0;
+}
+
+// 按原生标量类型统计每个正标签的体素数（64位计数与索引）
+template <typename T>
+void countLabelVoxels(const T* data, vtkIdType numPoints, int stride, QHash<int, vtkIdType>& voxelCounts)
+{
+    int minLabel = 0;
+    int maxLabel = 0;
+    if (!findPositiveLabelRange(data, numPoints, stride, minLabel, maxLabel)) return;
+
+    const vtkIdType labelRange = static_cast<vtkIdType>(maxLabel) - minLabel + 1;
+    if (labelRange <= kMaxDenseLabelRange) {
+        std::vector<vtkIdType> histogram(static_cast<size_t>(labelRange), 0);
+        for (vtkIdType i = 0; i < numPoints; ++i) {
+            const int label = static_cast<int>(data[i * stride]);
+            if (label >= minLabel && label <= maxLabel) {
+                ++histogram[label - minLabel];
+            }
+        }
+        for (vtkIdType offset = 0; offset < labelRange; ++offset) {
+            if (histogram[offset] > 0) {
+                voxelCounts.insert(static_cast<int>(minLabel + offset), histogram[offset]);
+            }
+        }
+    } else {
+        // 标签跨度过大（稀疏的大编号标签），按连续段累加到哈希表
+        int runLabel = 0;
+        vtkIdType runLength = 0;
+        for (vtkIdType i = 0; i < numPoints; ++i) {
+            const int label = static_cast<int>(data[i * stride]);
+            if (label != runLabel) {
+                if (runLabel > 0) voxelCounts[runLabel] += runLength;
+                runLabel = label;
+                runLength = 0;
+            }
+            ++runLength;
+        }
+        if (runLabel > 0) voxelCounts[runLabel] += runLength;
+    }
+}
+
+// 统计标签图像中每个正标签的体素数；标量类型不支持时返回false
+bool countImageLabelVoxels(vtkImageData* labelImage, QHash<int, vtkIdType>& voxelCounts)
 {
-    QList<int> labels;
-    if (!labelImage) return labels;
-    
     vtkDataArray* scalars = labelImage->GetPointData()->GetScalars();
-    if (!scalars) return labels;
+    if (!scalars) return false;
     
-    // 遍历所有像素，收集唯一的标签值
-    QSet<int> uniqueLabels;
-    int numPoints = labelImage->GetNumberOfPoints();
+    // 按原生标量类型分派一次，用稠密直方图代替逐体素虚函数调用和QSet插入
+    const vtkIdType numPoints = labelImage->GetNumberOfPoints();
+    const int stride = scalars->GetNumberOfComponents();
+    void* scalarPointer = scalars->GetVoidPointer(0);
     
-    for (int i = 0; i < numPoints; ++i) {
-        int label = static_cast<int>(scalars->GetTuple1(i));
-        if (label > 0) { // 跳过背景
-            uniqueLabels.insert(label);
+    switch (scalars->GetDataType()) {
+        vtkTemplateMacro(countLabelVoxels(static_cast<const VTK_TT*>(scalarPointer), numPoints, stride,
+                                          voxelCounts));
+    default:
+        qDebug() << "不支持的标签标量类型:" << scalars->GetDataType();
+        return false;
+    }
+    return true;
+}
+
+// 把解码后的标签图像转换为紧凑编号（见CompactLabelVolume）并统计各标签体素数；
+// 不能变窄时保留原图像，idToLabel为空
+bool compactLabelImage(vtkSmartPointer<vtkImageData>& labelImage, std::vector<int>& idToLabel,
+                       QHash<int, vtkIdType>& voxelCounts)
+{
+    idToLabel.clear();
+    voxelCounts.clear();
+
+    CompactLabelVolume compact;
+    if (compact.build(labelImage)) {
+        labelImage = compact.getImage();
+        idToLabel = compact.getIdToLabel();
+        voxelCounts = compact.getVoxelCounts();
+        return true;
+    }
+    return countImageLabelVoxels(labelImage, voxelCounts);
+}
+
+// 稀疏标签图像（大视野中的少量小区域）改为游程编码保存：编码结果不超过稠密图像的
+// 1/kRunLengthMinSavingFactor时返回true，调用方释放稠密图像；否则labelRuns为空
+bool encodeSparseLabelImage(vtkImageData* labelImage, RunLengthLabelVolume& labelRuns)
+{
+    labelRuns.clear();
+    vtkDataArray* scalars = labelImage ? labelImage->GetPointData()->GetScalars() : nullptr;
+    if (!scalars) return false;
+
+    const int64_t denseBytes = static_cast<int64_t>(scalars->GetNumberOfValues()) * scalars->GetDataTypeSize();
+    return labelRuns.build(labelImage, denseBytes / kRunLengthMinSavingFactor);
+}
+
+// 从保存下来的标签表示（稠密图像或游程编码）建立块索引
+void buildLabelBricks(vtkImageData* labelImage, const RunLengthLabelVolume& labelRuns, BrickIndex& bricks)
+{
+    if (labelImage) {
+        bricks.buildLabels(labelImage);
+    } else if (labelRuns.isValid()) {
+        bricks.buildLabels(labelRuns);
+    } else {
+        bricks.clear();
+    }
+}
+
+} // namespace
+
+// 后台加载的一个文件：任务在工作线程中写入结果和进度，完成通知回到GUI线程后由NiftiManager取走
+struct NiftiVolumeLoad
+{
+    bool isLabel;
+    QString filePath;
+    NiftiHeader header;
+    QAtomicInt cancelled;
+    std::atomic<int64_t> decodedBytes;
+    vtkSmartPointer<vtkImageData> image;
+    MriPyramid pyramid;                       // MRI：解码后生成的金字塔
+    QHash<int, vtkIdType> labelVoxelCounts;   // 标签：各标签体素数
+    std::vector<int> labelIdToValue;          // 标签：紧凑编号→标签表
+    RunLengthLabelVolume labelRuns;           // 标签：稀疏时的游程编码（此时image为空）
+    BrickIndex bricks;                        // 标签为每块出现的值，MRI为每块灰度范围
+
+    NiftiVolumeLoad()
+        : isLabel(false)
+        , cancelled(0)
+        , decodedBytes(0)
+    {
+    }
+};
+
+namespace {
+
+// 单个文件的后台加载任务：解码体素并完成加载后的预处理，再排队通知GUI线程
+class VolumeLoadTask : public QRunnable
+{
+public:
+    VolumeLoadTask(NiftiManager* manager, int loadId, const QSharedPointer<NiftiVolumeLoad>& load)
+        : manager(manager)
+        , loadId(loadId)
+        , load(load)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        if (!load->cancelled.load()) {
+            load->image = NiftiVolumeLoader::load(load->filePath, nullptr, &load->decodedBytes);
+            if (load->image && !load->cancelled.load()) {
+                if (load->isLabel) {
+                    compactLabelImage(load->image, load->labelIdToValue, load->labelVoxelCounts);
+                    if (encodeSparseLabelImage(load->image, load->labelRuns)) load->image = nullptr;
+                    buildLabelBricks(load->image, load->labelRuns, load->bricks);
+                } else {
+                    load->pyramid.build(load->image);
+                    load->bricks.buildRanges(load->image);
+                }
+            }
+        }
+        QMetaObject::invokeMethod(manager, "onVolumeLoaded", Qt::QueuedConnection, Q_ARG(int, loadId));
+    }
+
+private:
+    NiftiManager* manager;
+    int loadId;
+    QSharedPointer<NiftiVolumeLoad> load;
+};
+
+} // namespace
+
+// 后台灰度直方图统计：输入在GUI线程中准备好，任务只读取输入并写入histograms
+struct IntensityHistogramBuild
+{
+    QAtomicInt cancelled;
+    vtkSmartPointer<vtkImageData> mriImage;
+    vtkSmartPointer<vtkImageData> labelImage;
+    RunLengthLabelVolume labelRuns;           // labelImage为空时使用
+    std::vector<int> labelIdToValue;
+    LabelIntensityHistograms histograms;
+    bool valid;
+
+    IntensityHistogramBuild()
+        : cancelled(0)
+        , valid(false)
+    {
+    }
+};
+
+namespace {
+
+class IntensityHistogramTask : public QRunnable
+{
+public:
+    IntensityHistogramTask(NiftiManager* manager, int buildId, const QSharedPointer<IntensityHistogramBuild>& build)
+        : manager(manager)
+        , buildId(buildId)
+        , build(build)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        if (!build->cancelled.load()) {
+            const std::vector<int>* idToLabel = build->labelIdToValue.empty() ? nullptr : &build->labelIdToValue;
+            build->valid = build->labelImage ?
+                build->histograms.build(build->mriImage, build->labelImage, idToLabel) :
+                build->histograms.build(build->mriImage, build->labelRuns, idToLabel);
+        }
+        QMetaObject::invokeMethod(manager, "onIntensityHistogramsBuilt", Qt::QueuedConnection, Q_ARG(int, buildId));
+    }
+
+private:
+    NiftiManager* manager;
+    int buildId;
+    QSharedPointer<IntensityHistogramBuild> build;
+};
+
+} // namespace
+
+bool NiftiManager::loadMriNiftiAsync(const QString& filePath)
+{
+    return startVolumeLoad(filePath, false);
+}
+
+bool NiftiManager::loadLabelNiftiAsync(const QString& filePath)
+{
+    return startVolumeLoad(filePath, true);
+}
+
+bool NiftiManager::startVolumeLoad(const QString& filePath, bool isLabel)
+{
+    const QString kind = isLabel ? "标签" : "MRI";
+    qDebug() << "开始后台加载" << kind << "NIFTI文件:" << filePath;
+    cancelVolumeLoads(isLabel);
+    
+    if (!QFileInfo::exists(filePath)) {
+        emit errorOccurred(kind + "文件不存在: " + filePath);
+        return false;
+    }
+    
+    // 头部在GUI线程中读取（只有几百字节），格式错误立即报告
+    QSharedPointer<NiftiVolumeLoad> load(new NiftiVolumeLoad());
+    load->isLabel = isLabel;
+    load->filePath = filePath;
+    if (!NiftiVolumeLoader::readHeader(filePath, load->header)) {
+        emit errorOccurred("无法读取" + kind + "NIFTI文件头部");
+        return false;
+    }
+    
+    // 没有进行中的加载时开始新的一批进度
+    if (pendingLoads.isEmpty()) {
+        loadTotalBytes = 0;
+        loadCompletedBytes = 0;
+        lastLoadProgress = -1;
+        loadProgressTimer.start();
+    }
+    loadTotalBytes += load->header.dataSize();
+    
+    const int loadId = nextLoadId++;
+    pendingLoads.insert(loadId, load);
+    loadThreadPool->start(new VolumeLoadTask(this, loadId, load));
+    reportLoadProgress();
+    return true;
+}
+
+void NiftiManager::cancelVolumeLoads(bool isLabel)
+{
+    for (auto it = pendingLoads.begin(); it != pendingLoads.end();) {
+        if (it.value()->isLabel == isLabel) {
+            // 正在解码的任务无法中断，结果在完成通知时丢弃
+            it.value()->cancelled.store(1);
+            loadTotalBytes -= it.value()->header.dataSize();
+            it = pendingLoads.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (pendingLoads.isEmpty()) loadProgressTimer.stop();
+}
+
+void NiftiManager::cancelLoading()
+{
+    if (pendingLoads.isEmpty()) return;
+    
+    cancelVolumeLoads(false);
+    cancelVolumeLoads(true);
+    qDebug() << "已取消后台加载";
+    emit loadingCancelled();
+}
+
+void NiftiManager::reportLoadProgress()
+{
+    qint64 decoded = loadCompletedBytes;
+    for (const auto& load : pendingLoads) {
+        decoded += std::min<qint64>(load->decodedBytes.load(std::memory_order_relaxed), load->header.dataSize());
+    }
+    const int percent = loadTotalBytes > 0 ? static_cast<int>(100 * decoded / loadTotalBytes) : 100;
+    if (percent == lastLoadProgress) return;
+    lastLoadProgress = percent;
+    emit loadProgress(percent);
+}
+
+void NiftiManager::onVolumeLoaded(int loadId)
+{
+    // 已取消或被同类加载替换的结果直接丢弃
+    QSharedPointer<NiftiVolumeLoad> load = pendingLoads.take(loadId);
+    if (!load) return;
+    loadCompletedBytes += load->header.dataSize();
+    
+    if (!load->image && !load->labelRuns.isValid()) {
+        emit errorOccurred(load->isLabel ? "无法读取标签NIFTI文件" : "无法读取MRI NIFTI文件");
+    } else {
+        // 正在后台处理的区块仍引用旧图像，替换数据前先取消
+        cancelProcessing();
+        if (load->isLabel) {
+            labelImage = load->image;
+            labelRuns = std::move(load->labelRuns);
+            labelBricks = std::move(load->bricks);
+            labelHeader = load->header;
+            labelDecodePending = false;
+            labelFilePath = load->filePath;
+            labelFingerprint.clear();
+            labelPartitioner.clear();
+            labelPartitionValid = false;
+            resetIntensityHistograms();
+            labelVoxelCounts = load->labelVoxelCounts;
+            labelIdToValue = load->labelIdToValue;
+            qDebug() << "标签NIFTI后台加载完成，包含" << labelVoxelCounts.size() << "个非背景标签";
+        } else {
+            mriImage = load->image;
+            mriHeader = load->header;
+            mriDecodePending = false;
+            mriPyramid = load->pyramid;
+            mriBricks = std::move(load->bricks);
+            mriFilePath = load->filePath;
+            mriFingerprint.clear();
+            resetIntensityHistograms();
+            qDebug() << "MRI NIFTI后台加载完成";
         }
     }
     
-    labels = uniqueLabels.values();
+    reportLoadProgress();
+    if (pendingLoads.isEmpty()) {
+        loadProgressTimer.stop();
+        startIntensityHistogramBuild();
+        emit volumesLoaded();
+    }
+}
+
+void NiftiManager::startIntensityHistogramBuild()
+{
+    if (intensityHistogramsValid || pendingHistogramBuild || !pendingLoads.isEmpty()) return;
+    if (mriDecodePending || labelDecodePending || !mriImage || (!labelImage && !labelRuns.isValid())) return;
+    
+    // 任务持有图像引用和游程编码的副本，数据被替换后仍可安全读取
+    QSharedPointer<IntensityHistogramBuild> build(new IntensityHistogramBuild());
+    build->mriImage = mriImage;
+    build->labelImage = labelImage;
+    if (!labelImage) build->labelRuns = labelRuns;
+    build->labelIdToValue = labelIdToValue;
+    pendingHistogramBuild = build;
+    histogramThreadPool->start(new IntensityHistogramTask(this, ++histogramBuildId, build));
+}
+
+void NiftiManager::resetIntensityHistograms()
+{
+    // 正在执行的统计无法中断，结果在完成通知时丢弃
+    if (pendingHistogramBuild) {
+        pendingHistogramBuild->cancelled.store(1);
+        pendingHistogramBuild.reset();
+    }
+    intensityHistograms.clear();
+    intensityHistogramsValid = false;
+}
+
+void NiftiManager::onIntensityHistogramsBuilt(int buildId)
+{
+    if (!pendingHistogramBuild || buildId != histogramBuildId) return;
+    QSharedPointer<IntensityHistogramBuild> build = pendingHistogramBuild;
+    pendingHistogramBuild.reset();
+    
+    intensityHistogramsValid = build->valid;
+    if (intensityHistogramsValid) {
+        intensityHistograms = std::move(build->histograms);
+    }
+}
+
+QList<int> NiftiManager::extractLabelsFromImage()
+{
+    QList<int> labels;
+    labelVoxelCounts.clear();
+    labelIdToValue.clear();
+    labelBricks.clear();
+    if (!labelImage || !compactLabelImage(labelImage, labelIdToValue, labelVoxelCounts)) return labels;
+    if (encodeSparseLabelImage(labelImage, labelRuns)) labelImage = nullptr;
+    buildLabelBricks(labelImage, labelRuns, labelBricks);
+    
+    labels = labelVoxelCounts.keys();
     std::sort(labels.begin(), labels.end());
     return labels;
 }
@@ -305,13 +1663,114 @@ void NiftiManager::removeVolumeFromRenderer(BrainRegionVolume* volume)
     }
 }
 
-void NiftiManager::setGrayValueLimits(double minGrayValue, double maxGrayValue)
+int NiftiManager::setGrayValueLimits(double minGrayValue, double maxGrayValue, int sampleFactor)
 {
-    qDebug() << "为所有区块设置灰度值限制: [" << minGrayValue << ", " << maxGrayValue << "]";
+    qDebug() << "为所有区块设置灰度值限制: [" << minGrayValue << ", " << maxGrayValue << "]"
+             << "缩小倍数:" << sampleFactor;
     
+    // 后台处理尚未完成时，任务仍使用启动时的限制，完成后再增量更新
+    if (asyncProcessing) {
+        grayValueLimitsPending = true;
+        pendingMinGrayValue = minGrayValue;
+        pendingMaxGrayValue = maxGrayValue;
+        qDebug() << "区块仍在后台处理，新的灰度值限制将在处理完成后应用";
+        return 0;
+    }
+    
+    // 只有阈值移动跨过了区块体素取值的区块需要重新提取，其余区块只记录新的限制；
+    // 从网格缓存读取的灰度等值面没有子体积可供判断，限制改变时全部完整构建
+    const bool rebuildCachedSurfaces = regionsFromMeshCache && processedMeshingMode == INTENSITY_ISOSURFACE &&
+                                       mriImage && labelPartitionValid;
+    QList<BrainRegionVolume*> affectedVolumes;
     for (auto* volume : regionVolumes.values()) {
-        if (volume) {
+        if (!volume) continue;
+        if ((rebuildCachedSurfaces && !volume->hasIntensityData()) ||
+            volume->isSurfaceAffectedByGrayValueLimits(minGrayValue, maxGrayValue, sampleFactor)) {
+            affectedVolumes.append(volume);
+        } else {
             volume->setGrayValueLimits(minGrayValue, maxGrayValue);
         }
     }
-} 
\ No newline at end of file
+    
+    qDebug() << affectedVolumes.size() << "/" << regionVolumes.size() << "个区块需要重新提取表面";
+    if (!affectedVolumes.isEmpty()) {
+        rebuildRegionSurfaces(affectedVolumes, minGrayValue, maxGrayValue, sampleFactor);
+    }
+    return affectedVolumes.size();
+}
+
+int NiftiManager::chooseRemeshSampleFactor(double minGrayValue, double maxGrayValue, double latencyTargetMs) const
+{
+    if (asyncProcessing || latencyTargetMs <= 0.0) return 1;
+    
+    // 按上一次重新提取测得的每体素耗时，预测各缩小倍数下受影响区块的总耗时
+    vtkIdType affectedVoxels = 0;
+    for (auto* volume : regionVolumes.values()) {
+        if (volume && volume->isSurfaceAffectedByGrayValueLimits(minGrayValue, maxGrayValue, 1)) {
+            affectedVoxels += volume->getIntensityVoxelCount();
+        }
+    }
+    if (affectedVoxels == 0 || remeshMsPerVoxel <= 0.0) return 1;
+    
+    const double parallelism = std::max(1, regionThreadPool->maxThreadCount());
+    for (int level = 0; level < MriPyramid::kDefaultLevelCount; ++level) {
+        const int factor = MriPyramid::sampleFactor(level);
+        const double voxels = static_cast<double>(affectedVoxels) / (factor * factor * factor);
+        if (voxels * remeshMsPerVoxel / parallelism <= latencyTargetMs) {
+            return factor;
+        }
+    }
+    return MriPyramid::sampleFactor(MriPyramid::kDefaultLevelCount - 1);
+}
+
+bool NiftiManager::hasCoarseRegionSurfaces() const
+{
+    for (auto* volume : regionVolumes.values()) {
+        if (volume && volume->getSurfaceSampleFactor() > 1) return true;
+    }
+    return false;
+}
+
+void NiftiManager::rebuildRegionSurfaces(const QList<BrainRegionVolume*>& volumes,
+                                         double minGrayValue, double maxGrayValue, int sampleFactor)
+{
+    // 只等待本次提交的任务（线程池中可能还有细节层次任务），GUI线程等待期间区块不会被访问
+    QList<BrainRegionVolume*> scheduled = sortVolumesBySize(volumes);
+    QElapsedTimer timer;
+    timer.start();
+    double sampledVoxels = 0.0;
+    QSemaphore finished;
+    for (auto* volume : scheduled) {
+        const LabelRegionInfo* region = labelPartitionValid ? labelPartitioner.getRegion(volume->getLabel())
+                                                            : nullptr;
+        regionThreadPool->start(new RegionRemeshTask(volume, mriImage, region, minGrayValue, maxGrayValue,
+                                                     sampleFactor, &finished),
+                                kRemeshTaskPriority);
+        sampledVoxels += static_cast<double>(volume->getIntensityVoxelCount()) /
+                         (sampleFactor * sampleFactor * sampleFactor);
+    }
+    finished.acquire(scheduled.size());
+    
+    // 记录折算到单线程的每体素耗时，供交互期间选择缩小倍数
+    if (sampledVoxels > 0.0) {
+        const double parallelism = std::max(1, std::min(regionThreadPool->maxThreadCount(), scheduled.size()));
+        remeshMsPerVoxel = timer.nsecsElapsed() * 1e-6 * parallelism / sampledVoxels;
+    }
+    
+    // 新几何交给现有的surfaceMapper/actor，旧的细节层次作废后重新生成
+    for (auto* volume : scheduled) {
+        volume->applySurface();
+    }
+    regionsFromMeshCache = false;
+    
+    // 粗网格只在交互期间短暂显示，不生成细节层次也不写入缓存
+    if (hasCoarseRegionSurfaces()) return;
+    if (levelOfDetailEnabled) {
+        scheduleLevelsOfDetail(scheduled);
+    }
+    
+    // 灰度值限制是缓存键的一部分，更新后的整组表面按新键缓存
+    if (meshCacheEnabled) {
+        storeMeshCache(regionVolumes.values(), meshCacheKey(minGrayValue, maxGrayValue));
+    }
+}
@@ -3,9 +3,17 @@
 
 #include <QObject>
 #include <QMap>
+#include <QHash>
 #include <QList>
 #include <QString>
 #include <QColor>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QTimer>
+
+#include <vector>
 
 // VTK头文件
 #include <vtkSmartPointer.h>
@@ -13,40 +21,120 @@
 #include <vtkRenderer.h>
 #include <vtkCamera.h>
 
+#include "brickindex.h"
+#include "labelpartitioner.h"
+#include "isosurfaceextractor.h"
+#include "meshsmoother.h"
+#include "levelofdetailselector.h"
+#include "mripyramid.h"
+#include "niftiheader.h"
+#include "runlengthlabelvolume.h"
+
 // 前向声明
 class BrainRegionVolume;
+class QThreadPool;
+class RegionMeshCache;
+class vtkObject;
+class vtkCallbackCommand;
+struct NiftiVolumeLoad;
+struct IntensityHistogramBuild;
 
 class NiftiManager : public QObject
 {
     Q_OBJECT
 
 public:
+    // 区块网格生成模式
+    enum RegionMeshingMode {
+        INTENSITY_ISOSURFACE,    // 在每个区块的MRI灰度上单独提取等值面
+        SHARED_LABEL_INTERFACES, // 单次遍历标签图像，相邻区块共享交界面
+        LABEL_SURFACE_NETS       // 在每个区块的标签掩码上用表面网格（surface nets）提取
+    };
+
     explicit NiftiManager(QObject *parent = nullptr);
     ~NiftiManager();
 
-    // NIFTI文件读取
+    // NIFTI文件读取：只解析头部并记录路径，体素在第一次需要时解码
     bool loadMriNifti(const QString& filePath);
     bool loadLabelNifti(const QString& filePath);
+    // 后台加载：读取头部后立即返回，体素在工作线程中解码（MRI同时生成金字塔，标签同时统计体素数），
+    // MRI和标签可以同时加载；完成后在GUI线程中替换当前数据，全部完成后发出volumesLoaded。
+    // 再次加载同类文件会取消尚未完成的同类加载
+    bool loadMriNiftiAsync(const QString& filePath);
+    bool loadLabelNiftiAsync(const QString& filePath);
+    void cancelLoading();
+    bool isLoading() const { return !pendingLoads.isEmpty(); }
 
     // 数据处理与分区
     void processRegions();
     void processRegions(double minGrayValue, double maxGrayValue);
+    // 异步处理：立即返回，每个区块完成后发出regionProcessed并立即加入渲染器，全部完成后发出regionsProcessed
+    void processRegionsAsync();
+    void processRegionsAsync(double minGrayValue, double maxGrayValue);
+    void cancelProcessing();
+    bool isProcessing() const { return asyncProcessing; }
     void clearRegions();
 
     // 区块管理
     void updateRegionVisibility(int label, bool visible);
     void sortVolumesByCamera(vtkCamera* camera);
-    void setGrayValueLimits(double minGrayValue, double maxGrayValue);
+    // 只重新提取受新限制影响的区块并替换到现有actor，返回重新提取的区块数
+    int setGrayValueLimits(double minGrayValue, double maxGrayValue, int sampleFactor = 1);
+    // 交互期间按延迟目标选择重新提取的缩小倍数（1/2/4/8），依据上一次重新提取测得的耗时
+    int chooseRemeshSampleFactor(double minGrayValue, double maxGrayValue, double latencyTargetMs) const;
+    bool hasCoarseRegionSurfaces() const;
+    void setRegionMeshingMode(RegionMeshingMode mode);
+    RegionMeshingMode getRegionMeshingMode() const { return regionMeshingMode; }
+    void setIsosurfaceBackend(IsosurfaceExtractor::Backend backend);
+    IsosurfaceExtractor::Backend getIsosurfaceBackend() const { return isosurfaceBackend; }
+    void setSmoothingMethod(MeshSmoother::Method method);
+    MeshSmoother::Method getSmoothingMethod() const { return smoothingMethod; }
+    void setLevelOfDetailEnabled(bool enabled);
+    bool isLevelOfDetailEnabled() const { return levelOfDetailEnabled; }
+    
+    // 网格磁盘缓存：键为MRI/标签文件指纹与网格参数，命中时processRegions跳过网格生成
+    void setMeshCacheEnabled(bool enabled);
+    bool isMeshCacheEnabled() const { return meshCacheEnabled; }
+    void setMeshCacheDirectory(const QString& directory);
+    QString getMeshCacheDirectory() const;
+    bool clearMeshCache();
     
     // 获取信息
     QList<int> getAllLabels() const;
     BrainRegionVolume* getRegionVolume(int label);
-    bool hasMriData() const { return mriImage != nullptr; }
-    bool hasLabelData() const { return labelImage != nullptr; }
+    bool hasMriData() const { return mriImage != nullptr || mriDecodePending; }
+    bool hasLabelData() const { return labelImage != nullptr || labelRuns.isValid() || labelDecodePending; }
+    // 已加载文件的头部（不需要解码体素）
+    const NiftiHeader& getMriHeader() const { return mriHeader; }
+    const NiftiHeader& getLabelHeader() const { return labelHeader; }
+    
+    // 获取原始图像数据，尚未解码时先解码
+    vtkImageData* getMriImage();
+    // 标签图像可能已转换为紧凑编号，getLabelIdTable()非空时体素值v对应标签(*table)[v]；
+    // 稀疏标签以游程编码保存，此时每次调用都解压一份临时的稠密图像（游程编码保持不变），
+    // 只需要坐标或部分层时使用getLabelGeometry()/getLabelSlice()
+    vtkSmartPointer<vtkImageData> getLabelImage();
+    // 只需要标签的范围和坐标时使用，不会解压游程编码（可能不含标量）
+    vtkImageData* getLabelGeometry() { return ensureLabelImage() ? labelGeometry() : nullptr; }
+    // 标签第z层（输出范围的z为该层），游程编码保存时只解压这一层
+    vtkSmartPointer<vtkImageData> getLabelSlice(int z);
+    const std::vector<int>* getLabelIdTable() { return ensureLabelImage() ? labelIdTable() : nullptr; }
+    // MRI多分辨率金字塔（解码时生成），层次0为原始分辨率
+    const MriPyramid& getMriPyramid();
+    // 8³块索引（解码时生成）：MRI为每块灰度范围，标签为每块出现的值（与标签图像同为紧凑编号）
+    const BrickIndex* getMriBrickIndex()
+    {
+        return ensureMriImage() && mriBricks.hasRanges() ? &mriBricks : nullptr;
+    }
+    const BrickIndex* getLabelBrickIndex()
+    {
+        return ensureLabelImage() && labelBricks.hasLabels() ? &labelBricks : nullptr;
+    }
     
-    // 获取原始图像数据
-    vtkImageData* getMriImage() const { return mriImage; }
-    vtkImageData* getLabelImage() const { return labelImage; }
+    // 灰度直方图：MRI和标签都解码后在后台单独扫描一次统计（标签划分不读取MRI）。
+    // label为0时返回整幅MRI的直方图；尚未统计完成、数据未解码或尺寸不一致时返回nullptr，不会阻塞
+    const IntensityHistogram* getIntensityHistogram(int label);
+    bool hasIntensityHistograms() const { return intensityHistogramsValid; }
 
     // 渲染器设置
     void setRenderer(vtkRenderer* renderer);
@@ -54,19 +142,124 @@ public:
 
 signals:
     void regionsProcessed();
+    void regionProcessed(int label, int completedCount, int totalCount);
+    void processingCancelled();
     void regionVisibilityChanged(int label, bool visible);
     void errorOccurred(const QString& message);
+    void loadProgress(int percent);
+    void volumesLoaded();
+    void loadingCancelled();
 
 private:
     // 数据成员
     vtkSmartPointer<vtkImageData> mriImage;
     vtkSmartPointer<vtkImageData> labelImage;
+    // 延迟解码：加载时只读取头部，解码前Pending为true
+    NiftiHeader mriHeader;
+    NiftiHeader labelHeader;
+    bool mriDecodePending;
+    bool labelDecodePending;
     QMap<int, BrainRegionVolume*> regionVolumes;
     vtkRenderer* renderer;
+    LabelPartitioner labelPartitioner;
+    bool labelPartitionValid;
+    LabelIntensityHistograms intensityHistograms;
+    bool intensityHistogramsValid;
+    // 进行中的后台直方图统计，数据改变时丢弃；编号用于识别过期的完成通知
+    QSharedPointer<IntensityHistogramBuild> pendingHistogramBuild;
+    int histogramBuildId;
+    QThreadPool* histogramThreadPool;     // 直方图统计专用的单线程池，析构前等待
+    QHash<int, vtkIdType> labelVoxelCounts;
+    // 标签图像解码后转换为紧凑编号时的编号→标签表；为空时labelImage保存原标签值
+    std::vector<int> labelIdToValue;
+    // 稀疏标签的游程编码；有效时labelImage为空，划分直接遍历游程
+    RunLengthLabelVolume labelRuns;
+    // 块索引：网格提取、标签划分和等值估计据此跳过空块或常数块
+    BrickIndex labelBricks;
+    BrickIndex mriBricks;
+    QThreadPool* regionThreadPool;
+    RegionMeshingMode regionMeshingMode;
+    IsosurfaceExtractor::Backend isosurfaceBackend;
+    MeshSmoother::Method smoothingMethod;
+    
+    // 细节层次：交互时按帧时间为每个区块选择简化网格，交互结束后恢复完整网格
+    bool levelOfDetailEnabled;
+    bool levelOfDetailReduced;
+    LevelOfDetailSelector levelOfDetailSelector;
+    vtkSmartPointer<vtkCallbackCommand> renderStartCallback;
+    vtkSmartPointer<vtkRenderer> observedRenderer;   // 持有引用，保证析构时能安全移除观察者
+    unsigned long renderStartObserverTag;
+    
+    // 异步处理状态：轮次在取消时递增，过期任务和排队的通知据此丢弃
+    QAtomicInt processingGeneration;
+    bool asyncProcessing;
+    int completedRegionCount;
+    int totalRegionCount;
+    bool grayValueLimitsPending;
+    double pendingMinGrayValue;
+    double pendingMaxGrayValue;
+    
+    // 网格缓存
+    QScopedPointer<RegionMeshCache> meshCache;
+    QThreadPool* meshCacheThreadPool;     // 缓存写入任务专用，取消处理时不清空，析构前等待
+    bool meshCacheEnabled;
+    bool regionsFromMeshCache;            // 当前区块的表面来自缓存（灰度等值面没有裁剪子体积）
+    RegionMeshingMode processedMeshingMode;      // 当前区块处理时使用的参数，构成缓存键
+    IsosurfaceExtractor::Backend processedIsosurfaceBackend;
+    MeshSmoother::Method processedSmoothingMethod;
+    QString mriFilePath;
+    QString labelFilePath;
+    QByteArray mriFingerprint;
+    QByteArray labelFingerprint;
+    QByteArray pendingMeshCacheKey;       // 后台处理完成后写入缓存使用的键
+    
+    // 多分辨率：MRI金字塔和重新提取的单线程每体素耗时（毫秒，小于0表示尚未测量）
+    MriPyramid mriPyramid;
+    double remeshMsPerVoxel;
+    
+    // 后台加载：键为加载编号，取消或被同类加载替换时移除，过期的完成通知据此丢弃
+    QThreadPool* loadThreadPool;
+    QHash<int, QSharedPointer<NiftiVolumeLoad>> pendingLoads;
+    int nextLoadId;
+    qint64 loadTotalBytes;            // 本批加载的体素数据总长度，用于计算进度
+    qint64 loadCompletedBytes;
+    int lastLoadProgress;
+    QTimer loadProgressTimer;
 
     // 私有方法
+    bool ensureMriImage();
+    bool ensureLabelImage();
+    bool startVolumeLoad(const QString& filePath, bool isLabel);
+    void cancelVolumeLoads(bool isLabel);
+    void reportLoadProgress();
+    Q_INVOKABLE void onVolumeLoaded(int loadId);
+    void startIntensityHistogramBuild();
+    void resetIntensityHistograms();
+    Q_INVOKABLE void onIntensityHistogramsBuilt(int buildId);
+    bool prepareRegions(QList<BrainRegionVolume*>& pendingVolumes);
+    bool ensureLabelPartition();
+    Q_INVOKABLE void onRegionBuilt(int label, int generation);
+    Q_INVOKABLE void onRegionBuildFailed(const QString& message, int generation);
     QList<int> extractLabelsFromImage();
+    const std::vector<int>* labelIdTable() const { return labelIdToValue.empty() ? nullptr : &labelIdToValue; }
+    // 标签的几何（游程编码保存时不含标量），只需要尺寸和坐标时使用
+    vtkImageData* labelGeometry() const { return labelImage ? labelImage.Get() : labelRuns.getGeometry(); }
     QColor generateColorForLabel(int label);
+    QList<BrainRegionVolume*> sortVolumesBySize(const QList<BrainRegionVolume*>& volumes) const;
+    void buildRegionSurfaces(const QList<BrainRegionVolume*>& volumes,
+                             double minGrayValue, double maxGrayValue);
+    void buildSharedInterfaceSurfaces(const QList<BrainRegionVolume*>& volumes);
+    void buildLabelMaskSurfaces(const QList<BrainRegionVolume*>& volumes);
+    QByteArray meshCacheKey(double minGrayValue, double maxGrayValue);
+    bool applyMeshCache(const QList<BrainRegionVolume*>& volumes, const QByteArray& key,
+                        double minGrayValue, double maxGrayValue);
+    void storeMeshCache(const QList<BrainRegionVolume*>& volumes, const QByteArray& key);
+    void rebuildRegionSurfaces(const QList<BrainRegionVolume*>& volumes, double minGrayValue, double maxGrayValue,
+                               int sampleFactor);
+    void scheduleLevelsOfDetail(const QList<BrainRegionVolume*>& volumes);
+    void updateLevelsOfDetail();
+    void restoreFullDetail();
+    static void onRenderStart(vtkObject* caller, unsigned long eventId, void* clientData, void* callData);
     void addVolumeToRenderer(BrainRegionVolume* volume);
     void removeVolumeFromRenderer(BrainRegionVolume* volume);
 };
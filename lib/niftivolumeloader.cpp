@@ -0,0 +1,264 @@
+#include "niftivolumeloader.h"
+#include "parallelgzipreader.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QByteArray>
+#include <QMutex>
+#include <QMutexLocker>
+
+// VTK头文件
+#include <vtkDataArray.h>
+#include <vtkPointData.h>
+#include <vtkNIFTIImageReader.h>
+
+namespace {
+
+// 映射的体素区域 → 持有映射的文件对象；文件对象销毁时解除映射
+QMutex& mappedFilesMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+QHash<void*, QFile*>& mappedFiles()
+{
+    static QHash<void*, QFile*> files;
+    return files;
+}
+
+// vtkDataArray释放存储时调用
+void releaseMappedRegion(void* data)
+{
+    QFile* file = nullptr;
+    {
+        QMutexLocker locker(&mappedFilesMutex());
+        file = mappedFiles().take(data);
+    }
+    delete file;
+}
+
+// 几何与vtkNIFTIImageReader一致：原点为0，间距取pixdim，qform/sform不作用于图像
+vtkSmartPointer<vtkImageData> createImage(const NiftiHeader& header, vtkDataArray* scalars,
+                                          int firstSlice, int sliceCount)
+{
+    auto image = vtkSmartPointer<vtkImageData>::New();
+    image->SetExtent(0, static_cast<int>(header.dimension(0)) - 1,
+                     0, static_cast<int>(header.dimension(1)) - 1,
+                     firstSlice, firstSlice + sliceCount - 1);
+    image->SetSpacing(header.spacing(0), header.spacing(1), header.spacing(2));
+    image->SetOrigin(0.0, 0.0, 0.0);
+    image->GetPointData()->SetScalars(scalars);
+    return image;
+}
+
+// 分配count个体素的单分量标量数组
+vtkSmartPointer<vtkDataArray> allocateScalars(const NiftiHeader& header, vtkIdType count)
+{
+    vtkSmartPointer<vtkDataArray> scalars;
+    scalars.TakeReference(vtkDataArray::CreateDataArray(header.vtkScalarType()));
+    scalars->SetNumberOfComponents(1);
+    scalars->SetNumberOfTuples(count);
+    return scalars;
+}
+
+// 图像标量的字节数
+int64_t scalarBytes(vtkImageData* image)
+{
+    vtkDataArray* scalars = image->GetPointData()->GetScalars();
+    if (!scalars) return 0;
+    return static_cast<int64_t>(scalars->GetNumberOfValues()) * scalars->GetDataTypeSize();
+}
+
+vtkSmartPointer<vtkImageData> loadWithVtkReader(const QString& filePath)
+{
+    auto reader = vtkSmartPointer<vtkNIFTIImageReader>::New();
+    reader->SetFileName(filePath.toStdString().c_str());
+    reader->Update();
+
+    vtkImageData* image = reader->GetOutput();
+    if (!image || image->GetNumberOfPoints() == 0) return nullptr;
+    return image;
+}
+
+} // namespace
+
+vtkSmartPointer<vtkImageData> NiftiVolumeLoader::load(const QString& filePath, LoadPath* usedPath,
+                                                      std::atomic<int64_t>* decodedBytes)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QString reason;
+    vtkSmartPointer<vtkImageData> image;
+    if (ParallelGzipReader::isGzipFile(filePath)) {
+        image = loadCompressed(filePath, &reason, decodedBytes);
+        if (image) {
+            if (usedPath) *usedPath = PARALLEL_GZIP;
+            qDebug() << "NIFTI gzip解压完成，耗时:" << timer.elapsed() << "ms";
+            return image;
+        }
+    } else {
+        image = loadMapped(filePath, &reason);
+        if (image) {
+            if (usedPath) *usedPath = MEMORY_MAPPED;
+            if (decodedBytes) *decodedBytes += scalarBytes(image);
+            qDebug() << "NIFTI零拷贝映射完成，耗时:" << timer.elapsed() << "ms";
+            return image;
+        }
+    }
+
+    qDebug() << "NIFTI使用vtkNIFTIImageReader读取:" << reason;
+    image = loadWithVtkReader(filePath);
+    if (usedPath) *usedPath = VTK_READER;
+    if (image) {
+        if (decodedBytes) *decodedBytes += scalarBytes(image);
+        qDebug() << "NIFTI读取完成，耗时:" << timer.elapsed() << "ms";
+    }
+    return image;
+}
+
+bool NiftiVolumeLoader::readHeader(const QString& filePath, NiftiHeader& header, bool* compressed)
+{
+    const bool gzip = ParallelGzipReader::isGzipFile(filePath);
+    if (compressed) *compressed = gzip;
+    if (!gzip) return header.read(filePath);
+
+    const QByteArray bytes = ParallelGzipReader::readPrefix(filePath, NiftiHeader::kNifti2HeaderSize);
+    return header.parse(bytes.constData(), bytes.size());
+}
+
+bool NiftiVolumeLoader::isRawLayoutSupported(const NiftiHeader& header, QString* reason)
+{
+    auto reject = [reason](const QString& message) {
+        if (reason) *reason = message;
+        return false;
+    };
+
+    if (!header.singleFile) return reject("头部与数据分离（.hdr/.img）");
+    if (header.byteSwapped) return reject("文件字节序与本机不同");
+    if (header.qfac() < 0.0) return reject("qfac为-1，需要反转切片顺序");
+    if (header.extraComponentCount() != 1) return reject("包含时间或向量维度");
+
+    const int scalarType = header.vtkScalarType();
+    if (scalarType < 0) return reject(QString("不支持的数据类型 %1").arg(header.datatype));
+    if (header.bytesPerVoxel() != vtkDataArray::GetDataTypeSize(scalarType)) {
+        return reject("bitpix与数据类型不一致");
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        if (header.dimension(axis) > VTK_INT_MAX) return reject("图像尺寸超出范围");
+    }
+    return true;
+}
+
+vtkSmartPointer<vtkImageData> NiftiVolumeLoader::loadMapped(const QString& filePath, QString* reason)
+{
+    NiftiHeader header;
+    if (!header.read(filePath)) {
+        if (reason) *reason = "不是未压缩的NIFTI文件";
+        return nullptr;
+    }
+    if (!isRawLayoutSupported(header, reason)) return nullptr;
+    // 映射起点按页对齐，体素偏移需要满足元素对齐
+    if (header.voxOffset % header.bytesPerVoxel() != 0) {
+        if (reason) *reason = "体素数据未按元素大小对齐";
+        return nullptr;
+    }
+
+    QFile* file = new QFile(filePath);
+    if (!file->open(QIODevice::ReadOnly)) {
+        if (reason) *reason = "无法打开文件";
+        delete file;
+        return nullptr;
+    }
+    const int64_t dataSize = header.dataSize();
+    if (dataSize <= 0 || header.voxOffset + dataSize > file->size()) {
+        if (reason) *reason = "文件长度小于头部描述的数据大小";
+        delete file;
+        return nullptr;
+    }
+
+    // 私有映射：对数组的写入只影响本进程的副本，不会写回文件
+    uchar* data = file->map(header.voxOffset, dataSize, QFileDevice::MapPrivateOption);
+    if (!data) {
+        if (reason) *reason = "内存映射失败: " + file->errorString();
+        delete file;
+        return nullptr;
+    }
+    {
+        QMutexLocker locker(&mappedFilesMutex());
+        mappedFiles().insert(data, file);
+    }
+
+    vtkSmartPointer<vtkDataArray> scalars;
+    scalars.TakeReference(vtkDataArray::CreateDataArray(header.vtkScalarType()));
+    scalars->SetNumberOfComponents(1);
+    scalars->SetVoidArray(data, header.voxelCount(), 0, vtkAbstractArray::VTK_DATA_ARRAY_USER_DEFINED);
+    scalars->SetArrayFreeFunction(releaseMappedRegion);
+    return createImage(header, scalars, 0, static_cast<int>(header.dimension(2)));
+}
+
+vtkSmartPointer<vtkImageData> NiftiVolumeLoader::loadCompressed(const QString& filePath, QString* reason,
+                                                                std::atomic<int64_t>* decodedBytes)
+{
+    NiftiHeader header;
+    bool compressed = false;
+    if (!readHeader(filePath, header, &compressed) || !compressed) {
+        if (reason) *reason = "不是gzip压缩的NIFTI文件";
+        return nullptr;
+    }
+    if (!isRawLayoutSupported(header, reason)) return nullptr;
+
+    ParallelGzipReader reader;
+    if (!reader.open(filePath)) {
+        if (reason) *reason = "无法打开gzip文件";
+        return nullptr;
+    }
+    reader.setProgressCounter(decodedBytes);
+
+    // 直接解压到标量数组，不经过中间缓冲
+    vtkSmartPointer<vtkDataArray> scalars = allocateScalars(header, header.voxelCount());
+    if (reader.read(header.voxOffset, header.dataSize(), static_cast<char*>(scalars->GetVoidPointer(0))) !=
+        header.dataSize()) {
+        if (reason) *reason = "解压后的长度小于头部描述的数据大小";
+        return nullptr;
+    }
+    return createImage(header, scalars, 0, static_cast<int>(header.dimension(2)));
+}
+
+vtkSmartPointer<vtkImageData> NiftiVolumeLoader::loadSlices(const QString& filePath, int firstSlice, int sliceCount,
+                                                            QString* reason)
+{
+    auto fail = [reason](const QString& message) {
+        if (reason) *reason = message;
+        return vtkSmartPointer<vtkImageData>();
+    };
+
+    NiftiHeader header;
+    bool compressed = false;
+    if (!readHeader(filePath, header, &compressed)) return fail("无法读取NIFTI头部");
+    if (!isRawLayoutSupported(header, reason)) return nullptr;
+
+    const int sliceTotal = static_cast<int>(header.dimension(2));
+    if (firstSlice < 0 || sliceCount <= 0 || firstSlice + sliceCount > sliceTotal) return fail("切片范围无效");
+
+    const vtkIdType sliceVoxels = static_cast<vtkIdType>(header.dimension(0)) * header.dimension(1);
+    const int64_t sliceBytes = sliceVoxels * header.bytesPerVoxel();
+    const int64_t offset = header.voxOffset + firstSlice * sliceBytes;
+    const int64_t length = sliceCount * sliceBytes;
+
+    vtkSmartPointer<vtkDataArray> scalars = allocateScalars(header, sliceVoxels * sliceCount);
+    char* target = static_cast<char*>(scalars->GetVoidPointer(0));
+    if (compressed) {
+        ParallelGzipReader reader;
+        if (!reader.open(filePath) || reader.read(offset, length, target) != length) return fail("解压切片失败");
+    } else {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly) || !file.seek(offset) || file.read(target, length) != length) {
+            return fail("读取切片失败");
+        }
+    }
+    return createImage(header, scalars, firstSlice, sliceCount);
+}
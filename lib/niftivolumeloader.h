@@ -0,0 +1,58 @@
+#ifndef NIFTIVOLUMELOADER_H
+#define NIFTIVOLUMELOADER_H
+
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+
+// VTK头文件
+#include <vtkSmartPointer.h>
+#include <vtkImageData.h>
+
+#include "niftiheader.h"
+
+/**
+ * @brief NIFTI体数据读取
+ *
+ * 未压缩的单文件.nii在磁盘数据类型和字节序与本机一致时，直接把文件的体素区域
+ * 映射为vtkDataArray的存储（私有写时复制映射，不复制数据）：加载只需解析头部，
+ * 体素按需从页缓存调入，多个进程打开同一文件时共享页缓存。数组释放时解除映射。
+ * .nii.gz使用ParallelGzipReader直接解压到vtkDataArray（BGZF或已有检查点索引时并行）。
+ * 其他情况（字节序不同、qfac为-1需要反转切片、多分量等）使用vtkNIFTIImageReader，
+ * 各路径得到的图像几何一致。
+ */
+class NiftiVolumeLoader
+{
+public:
+    enum LoadPath {
+        MEMORY_MAPPED,  // 零拷贝映射
+        PARALLEL_GZIP,  // 并行gzip解压
+        VTK_READER      // vtkNIFTIImageReader读取
+    };
+
+    // 读取filePath；失败时返回空。usedPath返回实际使用的读取方式；
+    // decodedBytes累加已解码的体素字节数，可在其他线程中读取作为进度（映射和VTK读取器完成时一次累加）
+    static vtkSmartPointer<vtkImageData> load(const QString& filePath, LoadPath* usedPath = nullptr,
+                                              std::atomic<int64_t>* decodedBytes = nullptr);
+
+    // 只尝试零拷贝映射；不满足条件时返回空，reason说明原因
+    static vtkSmartPointer<vtkImageData> loadMapped(const QString& filePath, QString* reason = nullptr);
+
+    // 只尝试并行gzip解压；不是gzip文件或不满足条件时返回空
+    static vtkSmartPointer<vtkImageData> loadCompressed(const QString& filePath, QString* reason = nullptr,
+                                                        std::atomic<int64_t>* decodedBytes = nullptr);
+
+    // 只读取切片[firstSlice, firstSlice + sliceCount)，输出范围的z从firstSlice开始；
+    // .nii.gz有检查点索引或为BGZF时只解压覆盖这些切片的部分
+    static vtkSmartPointer<vtkImageData> loadSlices(const QString& filePath, int firstSlice, int sliceCount,
+                                                    QString* reason = nullptr);
+
+    // 只读取头部：.nii读取文件开头，.nii.gz只解压开头的头部字节；compressed返回是否为gzip文件
+    static bool readHeader(const QString& filePath, NiftiHeader& header, bool* compressed = nullptr);
+
+    // 判断头部描述的体素数据能否按原始布局直接作为VTK标量使用（不检查文件大小和对齐）
+    static bool isRawLayoutSupported(const NiftiHeader& header, QString* reason = nullptr);
+};
+
+#endif // NIFTIVOLUMELOADER_H
@@ -0,0 +1,172 @@
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+/**
+ * @brief 轻量的数据并行循环
+ *
+ * 把[begin, end)切成不超过线程数的连续块，每块调用一次func(chunkBegin, chunkEnd)。
+ * 块在一个常驻的QThreadPool上执行，不为每次调用创建线程；调用线程也领取块，
+ * 线程池繁忙时由调用线程执行剩余的块。嵌套调用（在工作线程内部再次调用）时直接串行执行，
+ * 避免区块线程池 × 内层切片并行造成的线程过量。func抛出的第一个异常在所有块结束后重新抛出。
+ */
+namespace ParallelFor {
+
+inline int& nestingDepth()
+{
+    thread_local int depth = 0;
+    return depth;
+}
+
+// 在已经并行的上下文中使内部的parallelFor串行执行。区块线程池的任务都使用它：
+// 线程池已按区块并行，区块内部的网格/平滑内核串行执行
+class SerialScope
+{
+public:
+    SerialScope() { ++nestingDepth(); }
+    ~SerialScope() { --nestingDepth(); }
+
+private:
+    SerialScope(const SerialScope&);
+    SerialScope& operator=(const SerialScope&);
+};
+
+inline int hardwareThreadCount()
+{
+    const int count = QThread::idealThreadCount();
+    return count > 0 ? count : 1;
+}
+
+// 所有parallelFor共用的常驻线程池（有意不析构，进程退出时不等待空闲线程）
+inline QThreadPool& workerPool()
+{
+    static QThreadPool* pool = []() {
+        QThreadPool* instance = new QThreadPool();
+        instance->setMaxThreadCount(hardwareThreadCount());
+        return instance;
+    }();
+    return *pool;
+}
+
+// 计算实际使用的块数：每块至少grain个元素
+inline int chunkCount(int begin, int end, int grain, int maxThreads = 0)
+{
+    const int length = end - begin;
+    if (length <= 0) return 0;
+    if (nestingDepth() > 0) return 1;
+
+    const int threads = maxThreads > 0 ? maxThreads : hardwareThreadCount();
+    const int byGrain = std::max(1, length / std::max(1, grain));
+    return std::max(1, std::min(threads, byGrain));
+}
+
+namespace Detail {
+
+// 一次调用的共享状态：线程池任务可能在调用返回后才开始执行，因此由shared_ptr持有
+struct ChunkBatch
+{
+    std::atomic<int> nextChunk;
+    int chunks;
+    int finishedChunks;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::function<void(int)> runChunk;   // 只在finishedChunks < chunks期间调用
+
+    explicit ChunkBatch(int chunks)
+        : nextChunk(0)
+        , chunks(chunks)
+        , finishedChunks(0)
+    {
+    }
+
+    // 领取并执行块，直到没有剩余的块
+    void drain()
+    {
+        for (int chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+            std::exception_ptr chunkError;
+            try {
+                SerialScope serial;
+                runChunk(chunk);
+            } catch (...) {
+                chunkError = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (chunkError && !error) error = chunkError;
+            if (++finishedChunks == chunks) finished.notify_all();
+        }
+    }
+};
+
+class ChunkTask : public QRunnable
+{
+public:
+    explicit ChunkTask(const std::shared_ptr<ChunkBatch>& batch)
+        : batch(batch)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override { batch->drain(); }
+
+private:
+    std::shared_ptr<ChunkBatch> batch;
+};
+
+} // namespace Detail
+
+// 按块调用func，chunkIndex从0开始连续编号，便于每块写入自己的输出
+template <typename Func>
+void parallelForChunks(int begin, int end, int chunks, Func func)
+{
+    const int length = end - begin;
+    if (length <= 0 || chunks <= 0) return;
+
+    if (chunks == 1) {
+        SerialScope serial;
+        func(0, begin, end);
+        return;
+    }
+
+    auto batch = std::make_shared<Detail::ChunkBatch>(chunks);
+    batch->runChunk = [&func, begin, length, chunks](int chunk) {
+        const int chunkBegin = begin + static_cast<int>(static_cast<long long>(length) * chunk / chunks);
+        const int chunkEnd = begin + static_cast<int>(static_cast<long long>(length) * (chunk + 1) / chunks);
+        func(chunk, chunkBegin, chunkEnd);
+    };
+
+    for (int worker = 1; worker < chunks; ++worker) {
+        workerPool().start(new Detail::ChunkTask(batch));
+    }
+    batch->drain();
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->finished.wait(lock, [&batch]() { return batch->finishedChunks == batch->chunks; });
+    // 之后才开始的任务领不到块，不会再调用func
+    batch->runChunk = nullptr;
+    if (batch->error) std::rethrow_exception(batch->error);
+}
+
+template <typename Func>
+void parallelFor(int begin, int end, int grain, Func func)
+{
+    const int chunks = chunkCount(begin, end, grain);
+    parallelForChunks(begin, end, chunks,
+                      [&func](int, int chunkBegin, int chunkEnd) { func(chunkBegin, chunkEnd); });
+}
+
+} // namespace ParallelFor
+
+#endif // PARALLELFOR_H
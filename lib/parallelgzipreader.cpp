@@ -0,0 +1,630 @@
+#include "parallelgzipreader.h"
+#include "parallelfor.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+
+// VTK自带的zlib
+#include <vtk_zlib.h>
+
+namespace {
+
+// deflate最大回溯距离
+const int kWindowSize = 32768;
+// zlib每次调用的输入/输出长度上限（uInt）
+const int64_t kMaxStreamChunk = static_cast<int64_t>(1) << 30;
+// BGZF成员解压后长度上限
+const int64_t kMaxBgzfBlockSize = 65536;
+// 只读取文件开头时每次读入的压缩数据长度
+const int kPrefixInputChunk = 16384;
+
+// 修改索引布局时递增，旧版本的索引文件会被重新生成
+const quint32 kIndexFormatVersion = 1;
+const char kIndexMagic[8] = { 'N', 'I', 'F', 'T', 'I', 'Z', 'I', 'X' };
+const quint32 kByteOrderMark = 0x01020304;
+const char* const kIndexSuffix = ".zidx";
+
+struct IndexFileHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 byteOrderMark;      // 按本机字节序写入，读取时不一致即视为无效
+    quint64 compressedSize;     // 建立索引时压缩文件的长度和修改时间
+    qint64 compressedModified;
+    quint64 uncompressedSize;
+    quint32 checkpointCount;
+    quint32 reserved;
+};
+
+struct IndexCheckpointEntry
+{
+    quint64 inOffset;
+    quint64 outOffset;
+    quint32 bits;
+    quint32 memberStart;
+    quint64 windowOffset;       // 压缩后的窗口在索引文件中的偏移
+    quint32 windowStoredSize;   // 压缩后的窗口长度，0表示没有窗口
+    quint32 reserved;
+};
+
+static_assert(sizeof(IndexFileHeader) == 48, "索引文件头布局必须固定");
+static_assert(sizeof(IndexCheckpointEntry) == 40, "索引检查点布局必须固定");
+
+inline int64_t readLittle16(const uchar* p)
+{
+    return static_cast<int64_t>(p[0]) | (static_cast<int64_t>(p[1]) << 8);
+}
+
+inline int64_t readLittle32(const uchar* p)
+{
+    return readLittle16(p) | (readLittle16(p + 2) << 16);
+}
+
+// 解析gzip成员头部，返回头部长度（无效时为0）；带BGZF的BC子字段时blockSize为整个成员的长度
+int64_t parseGzipHeader(const uchar* p, int64_t available, int64_t& blockSize)
+{
+    blockSize = 0;
+    if (available < 10 || p[0] != 0x1f || p[1] != 0x8b || p[2] != 8) return 0;
+
+    const int flags = p[3];
+    int64_t position = 10;
+    if (flags & 4) {
+        // FEXTRA：查找BC子字段
+        if (position + 2 > available) return 0;
+        const int64_t extraLength = readLittle16(p + position);
+        position += 2;
+        if (position + extraLength > available) return 0;
+        const int64_t extraEnd = position + extraLength;
+        for (int64_t sub = position; sub + 4 <= extraEnd;) {
+            const int64_t subLength = readLittle16(p + sub + 2);
+            if (p[sub] == 'B' && p[sub + 1] == 'C' && subLength == 2 && sub + 6 <= extraEnd) {
+                blockSize = readLittle16(p + sub + 4) + 1;
+            }
+            sub += 4 + subLength;
+        }
+        position = extraEnd;
+    }
+    // FNAME、FCOMMENT为0结尾的字符串，FHCRC为2字节
+    for (int mask : { 8, 16 }) {
+        if (!(flags & mask)) continue;
+        while (position < available && p[position] != 0) ++position;
+        ++position;
+    }
+    if (flags & 2) position += 2;
+    return position <= available ? position : 0;
+}
+
+// 从stream解压恰好count字节到dst；输入按块补充，提前结束或出错时返回false
+bool inflateExactly(z_stream& stream, const uchar* inputEnd, uchar* dst, int64_t count)
+{
+    while (count > 0) {
+        if (stream.avail_in == 0) {
+            const int64_t remaining = inputEnd - stream.next_in;
+            if (remaining <= 0) return false;
+            stream.avail_in = static_cast<uInt>(std::min(remaining, kMaxStreamChunk));
+        }
+        const uInt chunk = static_cast<uInt>(std::min(count, kMaxStreamChunk));
+        stream.next_out = dst;
+        stream.avail_out = chunk;
+        const int ret = inflate(&stream, Z_NO_FLUSH);
+        const uInt produced = chunk - stream.avail_out;
+        dst += produced;
+        count -= produced;
+        if (ret == Z_STREAM_END) return count == 0;
+        if (ret == Z_BUF_ERROR && stream.avail_in == 0) continue;
+        if (ret != Z_OK) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+ParallelGzipReader::ParallelGzipReader()
+    : data(nullptr)
+    , size(0)
+    , modifiedTime(0)
+    , indexComplete(false)
+    , totalOut(0)
+    , progressCounter(nullptr)
+{
+}
+
+ParallelGzipReader::~ParallelGzipReader()
+{
+    close();
+}
+
+bool ParallelGzipReader::isGzipFile(const QString& filePath)
+{
+    QFile probe(filePath);
+    if (!probe.open(QIODevice::ReadOnly)) return false;
+    const QByteArray magic = probe.read(2);
+    return magic.size() == 2 && static_cast<uchar>(magic[0]) == 0x1f && static_cast<uchar>(magic[1]) == 0x8b;
+}
+
+QByteArray ParallelGzipReader::readPrefix(const QString& filePath, int length)
+{
+    QFile input(filePath);
+    if (length <= 0 || !input.open(QIODevice::ReadOnly)) return QByteArray();
+
+    // 只按需读取开头的少量压缩数据，不映射整个文件也不查找索引
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) return QByteArray();
+
+    QByteArray output(length, '\0');
+    stream.next_out = reinterpret_cast<Bytef*>(output.data());
+    stream.avail_out = static_cast<uInt>(length);
+    QByteArray compressed;
+    int ret = Z_OK;
+    while (stream.avail_out > 0 && ret == Z_OK) {
+        if (stream.avail_in == 0) {
+            compressed = input.read(kPrefixInputChunk);
+            if (compressed.isEmpty()) break;
+            stream.next_in = reinterpret_cast<Bytef*>(compressed.data());
+            stream.avail_in = static_cast<uInt>(compressed.size());
+        }
+        ret = inflate(&stream, Z_NO_FLUSH);
+    }
+    const int produced = length - static_cast<int>(stream.avail_out);
+    inflateEnd(&stream);
+    if (ret != Z_OK && ret != Z_STREAM_END) return QByteArray();
+    output.truncate(produced);
+    return output;
+}
+
+QString ParallelGzipReader::indexPathFor(const QString& filePath)
+{
+    return filePath + kIndexSuffix;
+}
+
+bool ParallelGzipReader::open(const QString& path)
+{
+    close();
+    filePath = path;
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    size = file.size();
+    modifiedTime = QFileInfo(path).lastModified().toMSecsSinceEpoch();
+
+    // 整文件内存映射；映射失败时退回一次性读取
+    data = file.map(0, size);
+    if (!data) {
+        fileContents = file.readAll();
+        if (fileContents.size() != size) {
+            close();
+            return false;
+        }
+        data = reinterpret_cast<const uchar*>(fileContents.constData());
+    }
+    if (size < 18 || data[0] != 0x1f || data[1] != 0x8b) {
+        close();
+        return false;
+    }
+
+    if (scanBgzfBlocks()) {
+        qDebug() << "gzip读取: BGZF文件，" << blocks.size() << "个块";
+    } else if (loadIndex()) {
+        qDebug() << "gzip读取: 使用检查点索引，" << checkpoints.size() << "个检查点";
+    }
+    return true;
+}
+
+void ParallelGzipReader::close()
+{
+    if (file.isOpen()) file.close();
+    fileContents.clear();
+    data = nullptr;
+    size = 0;
+    blocks.clear();
+    checkpoints.clear();
+    indexComplete = false;
+    totalOut = 0;
+}
+
+int64_t ParallelGzipReader::uncompressedSize() const
+{
+    return (isBgzf() || indexComplete) ? totalOut : -1;
+}
+
+int64_t ParallelGzipReader::read(int64_t offset, int64_t length, char* out)
+{
+    if (!data || offset < 0 || length < 0 || !out) return -1;
+    if (length == 0) return 0;
+
+    if (isBgzf()) return readBgzf(offset, length, out);
+    if (indexComplete) return readIndexed(offset, length, out);
+    return readSequential(offset, length, out);
+}
+
+// ========== BGZF ==========
+
+bool ParallelGzipReader::scanBgzfBlocks()
+{
+    blocks.clear();
+    int64_t position = 0;
+    int64_t output = 0;
+    while (position < size) {
+        int64_t blockSize = 0;
+        const int64_t headerSize = parseGzipHeader(data + position, size - position, blockSize);
+        if (headerSize == 0 || blockSize < headerSize + 8 || position + blockSize > size) {
+            blocks.clear();
+            return false;
+        }
+
+        Block block;
+        block.inOffset = position + headerSize;
+        block.inSize = blockSize - headerSize - 8;
+        block.outOffset = output;
+        block.outSize = readLittle32(data + position + blockSize - 4);
+        if (block.outSize > kMaxBgzfBlockSize) {
+            blocks.clear();
+            return false;
+        }
+        blocks.push_back(block);
+        output += block.outSize;
+        position += blockSize;
+    }
+    totalOut = output;
+    return !blocks.empty();
+}
+
+bool ParallelGzipReader::inflateBlock(const Block& block, int64_t offset, int64_t end, char* out) const
+{
+    const int64_t begin = std::max(offset, block.outOffset);
+    const int64_t stop = std::min(end, block.outOffset + block.outSize);
+    if (begin >= stop) return true;
+
+    // 整块都在读取区间内时直接解压到输出，否则经过临时缓冲
+    const bool whole = begin == block.outOffset && stop == block.outOffset + block.outSize;
+    std::vector<uchar> buffer(whole ? 0 : static_cast<size_t>(block.outSize));
+    uchar* target = whole ? reinterpret_cast<uchar*>(out + (begin - offset)) : buffer.data();
+
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) return false;
+    stream.next_in = const_cast<Bytef*>(data + block.inOffset);
+    stream.avail_in = static_cast<uInt>(block.inSize);
+    stream.next_out = target;
+    stream.avail_out = static_cast<uInt>(block.outSize);
+    const bool ok = inflate(&stream, Z_FINISH) == Z_STREAM_END && stream.total_out == static_cast<uLong>(block.outSize);
+    inflateEnd(&stream);
+
+    if (ok && !whole) {
+        std::memcpy(out + (begin - offset), buffer.data() + (begin - block.outOffset), static_cast<size_t>(stop - begin));
+    }
+    if (ok) reportProgress(stop - begin);
+    return ok;
+}
+
+int64_t ParallelGzipReader::readBgzf(int64_t offset, int64_t length, char* out)
+{
+    const int64_t end = std::min(offset + length, totalOut);
+    if (offset >= end) return 0;
+
+    auto byOutput = [](const Block& block, int64_t value) { return block.outOffset + block.outSize <= value; };
+    const int first = static_cast<int>(std::lower_bound(blocks.begin(), blocks.end(), offset, byOutput) - blocks.begin());
+    const int last = static_cast<int>(std::lower_bound(blocks.begin(), blocks.end(), end - 1, byOutput) - blocks.begin()) + 1;
+
+    std::atomic<bool> failed(false);
+    ParallelFor::parallelFor(first, last, 16, [&](int begin, int stop) {
+        for (int i = begin; i < stop && !failed; ++i) {
+            if (!inflateBlock(blocks[i], offset, end, out)) failed = true;
+        }
+    });
+    return failed ? -1 : end - offset;
+}
+
+// ========== 普通gzip（检查点索引）==========
+
+bool ParallelGzipReader::inflateSegment(size_t index, int64_t offset, int64_t end, char* out) const
+{
+    const Checkpoint& checkpoint = checkpoints[index];
+    const int64_t segmentEnd = index + 1 < checkpoints.size() ? checkpoints[index + 1].outOffset : totalOut;
+    const int64_t begin = std::max(offset, checkpoint.outOffset);
+    const int64_t stop = std::min(end, segmentEnd);
+    if (begin >= stop) return true;
+
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    stream.next_in = const_cast<Bytef*>(data + checkpoint.inOffset);
+    if (checkpoint.memberStart) {
+        if (inflateInit2(&stream, MAX_WBITS + 16) != Z_OK) return false;
+    } else {
+        // 从块边界开始的原始deflate：补上前一字节的剩余位，再恢复32KB窗口
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) return false;
+        if (checkpoint.bits > 0) {
+            inflatePrime(&stream, checkpoint.bits, data[checkpoint.inOffset - 1] >> (8 - checkpoint.bits));
+        }
+        inflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(checkpoint.window.constData()),
+                             static_cast<uInt>(checkpoint.window.size()));
+    }
+
+    const uchar* inputEnd = data + size;
+    bool ok = true;
+    int64_t skip = begin - checkpoint.outOffset;
+    if (skip > 0) {
+        std::vector<uchar> discard(static_cast<size_t>(std::min<int64_t>(skip, kWindowSize)));
+        while (ok && skip > 0) {
+            const int64_t count = std::min<int64_t>(skip, static_cast<int64_t>(discard.size()));
+            ok = inflateExactly(stream, inputEnd, discard.data(), count);
+            skip -= count;
+        }
+    }
+    ok = ok && inflateExactly(stream, inputEnd, reinterpret_cast<uchar*>(out + (begin - offset)), stop - begin);
+    inflateEnd(&stream);
+    if (ok) reportProgress(stop - begin);
+    return ok;
+}
+
+int64_t ParallelGzipReader::readIndexed(int64_t offset, int64_t length, char* out)
+{
+    const int64_t end = std::min(offset + length, totalOut);
+    if (offset >= end) return 0;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 覆盖[offset, end)的检查点段
+    auto startsAfter = [](int64_t value, const Checkpoint& checkpoint) { return value < checkpoint.outOffset; };
+    auto startsBefore = [](const Checkpoint& checkpoint, int64_t value) { return checkpoint.outOffset < value; };
+    const int first = static_cast<int>(std::upper_bound(checkpoints.begin(), checkpoints.end(), offset, startsAfter) -
+                                       checkpoints.begin()) - 1;
+    const int last = static_cast<int>(std::lower_bound(checkpoints.begin(), checkpoints.end(), end, startsBefore) -
+                                      checkpoints.begin());
+
+    std::atomic<bool> failed(false);
+    ParallelFor::parallelFor(std::max(first, 0), last, 1, [&](int begin, int stop) {
+        for (int i = begin; i < stop && !failed; ++i) {
+            if (!inflateSegment(static_cast<size_t>(i), offset, end, out)) failed = true;
+        }
+    });
+    if (failed) return -1;
+
+    if (last - std::max(first, 0) > 1) {
+        qDebug() << "gzip读取: 并行解压" << (last - std::max(first, 0)) << "段，" << (end - offset) / (1024 * 1024)
+                 << "MB，耗时:" << timer.elapsed() << "ms";
+    }
+    return end - offset;
+}
+
+int64_t ParallelGzipReader::readSequential(int64_t offset, int64_t length, char* out)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, MAX_WBITS + 16) != Z_OK) return -1;
+    stream.next_in = const_cast<Bytef*>(data);
+    stream.avail_in = 0;
+
+    // 重新建立检查点；每个成员开头都是一个检查点
+    checkpoints.clear();
+    Checkpoint start;
+    start.inOffset = 0;
+    start.outOffset = 0;
+    start.bits = 0;
+    start.memberStart = true;
+    checkpoints.push_back(start);
+
+    // 单成员文件的尾部记录了解压后长度（模2^32），读取区间到达该长度时继续到流末尾以完成索引
+    const int64_t end = offset + length;
+    const bool finishStream = static_cast<uint32_t>(end) == static_cast<uint32_t>(readLittle32(data + size - 4));
+
+    const uchar* inputEnd = data + size;
+    std::vector<uchar> window(kWindowSize);
+    int64_t position = 0;
+    int64_t lastCheckpoint = 0;
+    bool ok = true;
+    bool reachedEnd = false;
+
+    for (;;) {
+        // 输出写入32KB循环窗口，再复制与读取区间重叠的部分
+        if (stream.avail_out == 0) {
+            stream.next_out = window.data();
+            stream.avail_out = kWindowSize;
+        }
+        if (stream.avail_in == 0) {
+            const int64_t remaining = inputEnd - stream.next_in;
+            if (remaining <= 0) {
+                ok = false;
+                break;
+            }
+            stream.avail_in = static_cast<uInt>(std::min(remaining, kMaxStreamChunk));
+        }
+
+        uchar* produceStart = stream.next_out;
+        const uInt before = stream.avail_out;
+        const int ret = inflate(&stream, Z_BLOCK);
+        const int64_t produced = before - stream.avail_out;
+
+        const int64_t copyBegin = std::max(offset, position);
+        const int64_t copyEnd = std::min(end, position + produced);
+        if (copyBegin < copyEnd) {
+            std::memcpy(out + (copyBegin - offset), produceStart + (copyBegin - position),
+                        static_cast<size_t>(copyEnd - copyBegin));
+            reportProgress(copyEnd - copyBegin);
+        }
+        position += produced;
+
+        if (ret == Z_STREAM_END) {
+            // 后面还有gzip成员时从其头部继续
+            const int64_t next = stream.next_in - data;
+            if (next + 2 <= size && data[next] == 0x1f && data[next + 1] == 0x8b) {
+                inflateReset(&stream);
+                Checkpoint member;
+                member.inOffset = next;
+                member.outOffset = position;
+                member.bits = 0;
+                member.memberStart = true;
+                checkpoints.push_back(member);
+                lastCheckpoint = position;
+                continue;
+            }
+            reachedEnd = true;
+            break;
+        }
+        if (ret == Z_BUF_ERROR && stream.avail_in == 0) continue;
+        if (ret != Z_OK) {
+            ok = false;
+            break;
+        }
+
+        // 在非最后一个deflate块的边界上记录检查点，窗口按时间顺序展开
+        if ((stream.data_type & 128) && !(stream.data_type & 64) && position - lastCheckpoint >= kCheckpointSpan) {
+            Checkpoint checkpoint;
+            checkpoint.inOffset = stream.next_in - data;
+            checkpoint.outOffset = position;
+            checkpoint.bits = stream.data_type & 7;
+            checkpoint.memberStart = false;
+            checkpoint.window.resize(kWindowSize);
+            const int older = static_cast<int>(stream.avail_out);
+            if (older > 0) {
+                std::memcpy(checkpoint.window.data(), window.data() + kWindowSize - older, older);
+            }
+            if (older < kWindowSize) {
+                std::memcpy(checkpoint.window.data() + older, window.data(), kWindowSize - older);
+            }
+            checkpoints.push_back(checkpoint);
+            lastCheckpoint = position;
+        }
+
+        if (position >= end && !finishStream) break;
+    }
+    inflateEnd(&stream);
+
+    if (!ok) {
+        checkpoints.clear();
+        qDebug() << "gzip读取: 解压失败或文件不完整" << filePath;
+        return -1;
+    }
+    if (reachedEnd) {
+        totalOut = position;
+        indexComplete = true;
+        qDebug() << "gzip读取: 顺序解压" << position / (1024 * 1024) << "MB，建立" << checkpoints.size()
+                 << "个检查点，耗时:" << timer.elapsed() << "ms";
+        if (!saveIndex()) {
+            qDebug() << "gzip读取: 无法保存检查点索引" << indexPathFor(filePath);
+        }
+    }
+    return std::max<int64_t>(0, std::min(end, position) - offset);
+}
+
+void ParallelGzipReader::reportProgress(int64_t bytes) const
+{
+    if (progressCounter) progressCounter->fetch_add(bytes, std::memory_order_relaxed);
+}
+
+// ========== 索引文件 ==========
+
+bool ParallelGzipReader::loadIndex()
+{
+    QFile indexFile(indexPathFor(filePath));
+    if (!indexFile.open(QIODevice::ReadOnly)) return false;
+    const QByteArray contents = indexFile.readAll();
+    const quint64 indexSize = static_cast<quint64>(contents.size());
+    if (indexSize < sizeof(IndexFileHeader)) return false;
+
+    IndexFileHeader header;
+    std::memcpy(&header, contents.constData(), sizeof(header));
+    if (std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) != 0 || header.version != kIndexFormatVersion ||
+        header.byteOrderMark != kByteOrderMark) {
+        return false;
+    }
+    // 压缩文件被修改过时索引作废
+    if (header.compressedSize != static_cast<quint64>(size) || header.compressedModified != modifiedTime) {
+        qDebug() << "gzip读取: 检查点索引已过期" << indexFile.fileName();
+        return false;
+    }
+    const quint64 entriesEnd = sizeof(IndexFileHeader) + static_cast<quint64>(header.checkpointCount) * sizeof(IndexCheckpointEntry);
+    if (header.checkpointCount == 0 || entriesEnd > indexSize) return false;
+
+    std::vector<Checkpoint> loaded(header.checkpointCount);
+    const char* entryData = contents.constData() + sizeof(IndexFileHeader);
+    for (quint32 i = 0; i < header.checkpointCount; ++i) {
+        IndexCheckpointEntry entry;
+        std::memcpy(&entry, entryData + i * sizeof(IndexCheckpointEntry), sizeof(entry));
+        const bool valid = entry.inOffset <= static_cast<quint64>(size) && entry.outOffset <= header.uncompressedSize &&
+                           entry.bits < 8 && (i == 0 || entry.outOffset >= static_cast<quint64>(loaded[i - 1].outOffset)) &&
+                           entry.windowOffset <= indexSize && entry.windowStoredSize <= indexSize - entry.windowOffset;
+        if (!valid) return false;
+
+        Checkpoint& checkpoint = loaded[i];
+        checkpoint.inOffset = static_cast<int64_t>(entry.inOffset);
+        checkpoint.outOffset = static_cast<int64_t>(entry.outOffset);
+        checkpoint.bits = static_cast<int>(entry.bits);
+        checkpoint.memberStart = entry.memberStart != 0;
+        if (!checkpoint.memberStart) {
+            if (entry.windowStoredSize == 0 || (checkpoint.bits > 0 && checkpoint.inOffset == 0)) return false;
+            checkpoint.window.resize(kWindowSize);
+            uLongf windowSize = kWindowSize;
+            if (uncompress(reinterpret_cast<Bytef*>(checkpoint.window.data()), &windowSize,
+                           reinterpret_cast<const Bytef*>(contents.constData() + entry.windowOffset),
+                           entry.windowStoredSize) != Z_OK || windowSize != static_cast<uLongf>(kWindowSize)) {
+                return false;
+            }
+        }
+    }
+
+    checkpoints.swap(loaded);
+    totalOut = static_cast<int64_t>(header.uncompressedSize);
+    indexComplete = true;
+    return true;
+}
+
+bool ParallelGzipReader::saveIndex() const
+{
+    // 窗口用zlib压缩后追加在检查点目录之后
+    std::vector<QByteArray> windows(checkpoints.size());
+    std::vector<IndexCheckpointEntry> entries(checkpoints.size());
+    quint64 windowOffset = sizeof(IndexFileHeader) + entries.size() * sizeof(IndexCheckpointEntry);
+    for (size_t i = 0; i < checkpoints.size(); ++i) {
+        const Checkpoint& checkpoint = checkpoints[i];
+        IndexCheckpointEntry& entry = entries[i];
+        std::memset(&entry, 0, sizeof(entry));
+        entry.inOffset = static_cast<quint64>(checkpoint.inOffset);
+        entry.outOffset = static_cast<quint64>(checkpoint.outOffset);
+        entry.bits = static_cast<quint32>(checkpoint.bits);
+        entry.memberStart = checkpoint.memberStart ? 1 : 0;
+        if (!checkpoint.window.isEmpty()) {
+            uLongf storedSize = compressBound(static_cast<uLong>(checkpoint.window.size()));
+            windows[i].resize(static_cast<int>(storedSize));
+            if (compress2(reinterpret_cast<Bytef*>(windows[i].data()), &storedSize,
+                          reinterpret_cast<const Bytef*>(checkpoint.window.constData()),
+                          static_cast<uLong>(checkpoint.window.size()), 1) != Z_OK) {
+                return false;
+            }
+            windows[i].resize(static_cast<int>(storedSize));
+        }
+        entry.windowOffset = windowOffset;
+        entry.windowStoredSize = static_cast<quint32>(windows[i].size());
+        windowOffset += windows[i].size();
+    }
+
+    IndexFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+    header.version = kIndexFormatVersion;
+    header.byteOrderMark = kByteOrderMark;
+    header.compressedSize = static_cast<quint64>(size);
+    header.compressedModified = modifiedTime;
+    header.uncompressedSize = static_cast<quint64>(totalOut);
+    header.checkpointCount = static_cast<quint32>(checkpoints.size());
+
+    QSaveFile indexFile(indexPathFor(filePath));
+    if (!indexFile.open(QIODevice::WriteOnly)) return false;
+    bool ok = indexFile.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+    const qint64 entryBytes = static_cast<qint64>(entries.size() * sizeof(IndexCheckpointEntry));
+    ok = ok && indexFile.write(reinterpret_cast<const char*>(entries.data()), entryBytes) == entryBytes;
+    for (const QByteArray& window : windows) {
+        ok = ok && indexFile.write(window) == window.size();
+    }
+    return ok && indexFile.commit();
+}
@@ -0,0 +1,99 @@
+#ifndef PARALLELGZIPREADER_H
+#define PARALLELGZIPREADER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 可随机访问、并行解压的gzip读取器
+ *
+ * 按解压后的偏移读取任意区间：
+ * - BGZF（bgzip生成，每个成员不超过64KB且头部记录了压缩长度）：打开时只扫描成员头部
+ *   建立块表，读取时各块并行解压
+ * - 普通gzip：第一次完整解压时按zran方式每隔约4MB记录一个检查点（输入位置、剩余位数、
+ *   前32KB输出窗口），保存为同目录下的"<文件名>.zidx"。之后的读取从检查点开始，
+ *   各段并行解压，只读取部分切片时也只解压覆盖该区间的段。
+ *   多成员文件在每个成员开头额外记录检查点，各段不会跨越成员边界。
+ * 压缩文件整体内存映射，检查点索引以文件长度和修改时间判断是否过期。
+ */
+class ParallelGzipReader
+{
+public:
+    // 普通gzip检查点之间的解压后距离
+    static const int64_t kCheckpointSpan = 4 << 20;
+
+    ParallelGzipReader();
+    ~ParallelGzipReader();
+
+    // 打开文件并识别BGZF；普通gzip时加载有效的检查点索引（如果有）
+    bool open(const QString& filePath);
+    void close();
+
+    // 文件是否以gzip头开始（不打开文件）
+    static bool isGzipFile(const QString& filePath);
+    // 只解压开头的length字节（读取文件头部用，不建立块表或索引）；失败返回空
+    static QByteArray readPrefix(const QString& filePath, int length);
+    // 检查点索引文件路径
+    static QString indexPathFor(const QString& filePath);
+
+    // 读取时把已写入输出的字节数累加到counter（可在其他线程中读取作为进度），为空时不统计
+    void setProgressCounter(std::atomic<int64_t>* counter) { progressCounter = counter; }
+
+    bool isBgzf() const { return !blocks.empty(); }
+    bool hasIndex() const { return indexComplete; }
+    // 解压后总长度；未知（普通gzip尚未完整解压过）时返回-1
+    int64_t uncompressedSize() const;
+
+    // 读取解压后[offset, offset + length)到out，返回实际读取的字节数（到达末尾时少于length），失败返回-1。
+    // 普通gzip没有索引时顺序解压，解压到末尾时顺带建立并保存索引
+    int64_t read(int64_t offset, int64_t length, char* out);
+
+private:
+    struct Block
+    {
+        int64_t inOffset;       // deflate数据在压缩文件中的偏移
+        int64_t inSize;         // deflate数据长度
+        int64_t outOffset;      // 解压后偏移
+        int64_t outSize;        // 解压后长度
+    };
+
+    struct Checkpoint
+    {
+        int64_t inOffset;       // 下一个要读取的输入字节
+        int64_t outOffset;      // 对应的解压后偏移
+        int bits;               // inOffset前一个字节中尚未使用的位数
+        bool memberStart;       // gzip成员开头（从成员头部开始解压，不需要窗口）
+        QByteArray window;      // 之前的32KB输出
+    };
+
+    bool scanBgzfBlocks();
+    int64_t readBgzf(int64_t offset, int64_t length, char* out);
+    int64_t readIndexed(int64_t offset, int64_t length, char* out);
+    int64_t readSequential(int64_t offset, int64_t length, char* out);
+    bool inflateBlock(const Block& block, int64_t offset, int64_t end, char* out) const;
+    bool inflateSegment(size_t index, int64_t offset, int64_t end, char* out) const;
+
+    bool loadIndex();
+    bool saveIndex() const;
+    void reportProgress(int64_t bytes) const;
+
+    QString filePath;
+    QFile file;
+    QByteArray fileContents;            // 映射失败时的整文件内容
+    const uchar* data;
+    int64_t size;
+    qint64 modifiedTime;
+
+    std::vector<Block> blocks;          // BGZF块表
+    std::vector<Checkpoint> checkpoints;
+    bool indexComplete;
+    int64_t totalOut;
+    std::atomic<int64_t>* progressCounter;
+};
+
+#endif // PARALLELGZIPREADER_H
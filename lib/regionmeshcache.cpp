@@ -0,0 +1,357 @@
+#include "regionmeshcache.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// VTK头文件
+#include <vtkPoints.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkCellArray.h>
+
+namespace {
+
+// 修改网格算法或文件布局时递增，旧版本的缓存文件会被当作未命中
+const quint32 kFormatVersion = 1;
+const char kMagic[8] = { 'N', 'I', 'F', 'T', 'I', 'M', 'C', '\0' };
+const quint32 kByteOrderMark = 0x01020304;
+const char* const kFileSuffix = ".meshcache";
+// 文件指纹读取开头和结尾各这么多字节
+const qint64 kFingerprintSampleBytes = 1 << 20;
+
+struct CacheFileHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 byteOrderMark;      // 按本机字节序写入，读取时不一致即视为未命中
+    quint32 regionCount;
+    quint32 reserved;
+};
+
+struct CacheRegionEntry
+{
+    qint32 label;
+    quint32 hasNormals;
+    quint64 pointCount;
+    quint64 polyCount;
+    quint64 connectivityCount;  // 单元数组条目数（VTK 8.2格式：[n, id0, id1, ...]）
+    quint64 pointsOffset;       // float[3 * pointCount]
+    quint64 normalsOffset;      // float[3 * pointCount]，hasNormals为0时无效
+    quint64 connectivityOffset; // qint64[connectivityCount]
+};
+
+static_assert(sizeof(CacheFileHeader) == 24, "缓存文件头布局必须固定");
+static_assert(sizeof(CacheRegionEntry) == 56, "缓存区块目录项布局必须固定");
+
+inline quint64 alignOffset(quint64 offset)
+{
+    return (offset + 7) & ~static_cast<quint64>(7);
+}
+
+// [offset, offset + bytes)是否在文件内；写成减法，损坏文件中的大偏移不会回绕
+inline bool rangeInFile(quint64 offset, quint64 bytes, quint64 fileSize)
+{
+    return offset <= fileSize && bytes <= fileSize - offset;
+}
+
+// 把任意类型的3分量数组转换为连续float
+void copyTuples(vtkDataArray* array, vtkIdType count, std::vector<float>& values)
+{
+    values.resize(static_cast<size_t>(count) * 3);
+    vtkFloatArray* floatArray = vtkFloatArray::SafeDownCast(array);
+    if (floatArray) {
+        std::memcpy(values.data(), floatArray->GetPointer(0), values.size() * sizeof(float));
+        return;
+    }
+    double tuple[3];
+    for (vtkIdType i = 0; i < count; ++i) {
+        array->GetTuple(i, tuple);
+        values[i * 3] = static_cast<float>(tuple[0]);
+        values[i * 3 + 1] = static_cast<float>(tuple[1]);
+        values[i * 3 + 2] = static_cast<float>(tuple[2]);
+    }
+}
+
+bool writePadding(QSaveFile& file, quint64 targetOffset)
+{
+    static const char zeros[8] = { 0 };
+    const qint64 padding = static_cast<qint64>(targetOffset) - file.pos();
+    return padding >= 0 && padding < 8 && file.write(zeros, padding) == padding;
+}
+
+// 单元数组中的点索引必须在范围内，避免损坏的缓存文件导致渲染时越界
+bool validateConnectivity(const qint64* connectivity, quint64 count, quint64 polyCount, quint64 pointCount)
+{
+    quint64 position = 0;
+    for (quint64 cell = 0; cell < polyCount; ++cell) {
+        if (position >= count) return false;
+        const qint64 size = connectivity[position++];
+        if (size < 0 || static_cast<quint64>(size) > count - position) return false;
+        for (qint64 k = 0; k < size; ++k) {
+            const qint64 id = connectivity[position++];
+            if (id < 0 || static_cast<quint64>(id) >= pointCount) return false;
+        }
+    }
+    return position == count;
+}
+
+vtkSmartPointer<vtkPolyData> createSurface(const uchar* data, const CacheRegionEntry& entry)
+{
+    const vtkIdType numPoints = static_cast<vtkIdType>(entry.pointCount);
+
+    auto coordinates = vtkSmartPointer<vtkFloatArray>::New();
+    coordinates->SetNumberOfComponents(3);
+    coordinates->SetNumberOfTuples(numPoints);
+    std::memcpy(coordinates->GetPointer(0), data + entry.pointsOffset, entry.pointCount * 3 * sizeof(float));
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(coordinates);
+
+    auto surface = vtkSmartPointer<vtkPolyData>::New();
+    surface->SetPoints(points);
+
+    if (entry.hasNormals) {
+        auto normals = vtkSmartPointer<vtkFloatArray>::New();
+        normals->SetName("Normals");
+        normals->SetNumberOfComponents(3);
+        normals->SetNumberOfTuples(numPoints);
+        std::memcpy(normals->GetPointer(0), data + entry.normalsOffset, entry.pointCount * 3 * sizeof(float));
+        surface->GetPointData()->SetNormals(normals);
+    }
+
+    const qint64* source = reinterpret_cast<const qint64*>(data + entry.connectivityOffset);
+    auto connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    connectivity->SetNumberOfValues(static_cast<vtkIdType>(entry.connectivityCount));
+    vtkIdType* target = connectivity->GetPointer(0);
+    if (sizeof(vtkIdType) == sizeof(qint64)) {
+        std::memcpy(target, source, entry.connectivityCount * sizeof(qint64));
+    } else {
+        for (quint64 i = 0; i < entry.connectivityCount; ++i) {
+            target[i] = static_cast<vtkIdType>(source[i]);
+        }
+    }
+    auto polys = vtkSmartPointer<vtkCellArray>::New();
+    polys->SetCells(static_cast<vtkIdType>(entry.polyCount), connectivity);
+    surface->SetPolys(polys);
+
+    return surface;
+}
+
+} // namespace
+
+RegionMeshCache::RegionMeshCache()
+    : directory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/meshcache")
+{
+}
+
+void RegionMeshCache::setDirectory(const QString& directory)
+{
+    this->directory = directory;
+}
+
+QByteArray RegionMeshCache::fingerprintFile(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "网格缓存: 无法读取文件计算指纹" << filePath;
+        return QByteArray();
+    }
+
+    const qint64 size = file.size();
+    const QDateTime modified = QFileInfo(file).lastModified();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QString("size=%1;mtime=%2;").arg(size).arg(modified.toMSecsSinceEpoch()).toLatin1());
+
+    // 开头（含NIfTI头部）和结尾的样本
+    hash.addData(file.read(kFingerprintSampleBytes));
+    if (size > kFingerprintSampleBytes) {
+        const qint64 tailStart = std::max(kFingerprintSampleBytes, size - kFingerprintSampleBytes);
+        if (!file.seek(tailStart)) return QByteArray();
+        hash.addData(file.read(size - tailStart));
+    }
+    return hash.result();
+}
+
+QString RegionMeshCache::filePathForKey(const QByteArray& key) const
+{
+    return directory + "/" + QString::fromLatin1(key.toHex()) + kFileSuffix;
+}
+
+bool RegionMeshCache::load(const QByteArray& key, QHash<int, vtkSmartPointer<vtkPolyData>>& surfaces) const
+{
+    surfaces.clear();
+    if (key.isEmpty()) return false;
+
+    QFile file(filePathForKey(key));
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) return false;
+
+    const quint64 fileSize = static_cast<quint64>(file.size());
+    if (fileSize < sizeof(CacheFileHeader)) return false;
+
+    // 整文件内存映射；映射失败时退回一次性读取
+    QByteArray fileContents;
+    const uchar* data = file.map(0, file.size());
+    if (!data) {
+        fileContents = file.readAll();
+        if (static_cast<quint64>(fileContents.size()) != fileSize) return false;
+        data = reinterpret_cast<const uchar*>(fileContents.constData());
+    }
+
+    CacheFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion ||
+        header.byteOrderMark != kByteOrderMark) {
+        qDebug() << "网格缓存: 文件版本不符，忽略" << file.fileName();
+        return false;
+    }
+
+    const quint64 directoryEnd = sizeof(CacheFileHeader) + static_cast<quint64>(header.regionCount) * sizeof(CacheRegionEntry);
+    if (directoryEnd > fileSize) return false;
+
+    const CacheRegionEntry* entries = reinterpret_cast<const CacheRegionEntry*>(data + sizeof(CacheFileHeader));
+    for (quint32 i = 0; i < header.regionCount; ++i) {
+        const CacheRegionEntry& entry = entries[i];
+        if (entry.pointCount > fileSize || entry.connectivityCount > fileSize) {
+            qDebug() << "网格缓存: 文件已损坏，忽略" << file.fileName();
+            surfaces.clear();
+            return false;
+        }
+        const quint64 pointBytes = entry.pointCount * 3 * sizeof(float);
+        const quint64 connectivityBytes = entry.connectivityCount * sizeof(qint64);
+        const bool inBounds = rangeInFile(entry.pointsOffset, pointBytes, fileSize) &&
+                              (!entry.hasNormals || rangeInFile(entry.normalsOffset, pointBytes, fileSize)) &&
+                              rangeInFile(entry.connectivityOffset, connectivityBytes, fileSize) &&
+                              entry.connectivityOffset % sizeof(qint64) == 0;
+        if (!inBounds ||
+            !validateConnectivity(reinterpret_cast<const qint64*>(data + entry.connectivityOffset),
+                                  entry.connectivityCount, entry.polyCount, entry.pointCount)) {
+            qDebug() << "网格缓存: 文件已损坏，忽略" << file.fileName();
+            surfaces.clear();
+            return false;
+        }
+        surfaces.insert(entry.label, createSurface(data, entry));
+    }
+
+    qDebug() << "网格缓存命中:" << file.fileName() << "区块数:" << surfaces.size();
+    return true;
+}
+
+bool RegionMeshCache::save(const QByteArray& key,
+                           const QList<QPair<int, vtkSmartPointer<vtkPolyData>>>& surfaces) const
+{
+    if (key.isEmpty() || surfaces.isEmpty()) return false;
+    if (!QDir().mkpath(directory)) {
+        qDebug() << "网格缓存: 无法创建目录" << directory;
+        return false;
+    }
+
+    // 先确定每个区块各数组的偏移，再顺序写出
+    std::vector<CacheRegionEntry> entries;
+    entries.reserve(surfaces.size());
+    quint64 offset = alignOffset(sizeof(CacheFileHeader) + surfaces.size() * sizeof(CacheRegionEntry));
+    for (const auto& surface : surfaces) {
+        vtkPolyData* polyData = surface.second;
+        CacheRegionEntry entry;
+        std::memset(&entry, 0, sizeof(entry));
+        entry.label = surface.first;
+        entry.pointCount = static_cast<quint64>(polyData->GetNumberOfPoints());
+        entry.polyCount = static_cast<quint64>(polyData->GetNumberOfPolys());
+        entry.connectivityCount = static_cast<quint64>(polyData->GetPolys()->GetNumberOfConnectivityEntries());
+        vtkDataArray* normals = polyData->GetPointData()->GetNormals();
+        entry.hasNormals = (normals && normals->GetNumberOfComponents() == 3 &&
+                            static_cast<quint64>(normals->GetNumberOfTuples()) == entry.pointCount) ? 1 : 0;
+
+        entry.pointsOffset = offset;
+        offset = alignOffset(offset + entry.pointCount * 3 * sizeof(float));
+        if (entry.hasNormals) {
+            entry.normalsOffset = offset;
+            offset = alignOffset(offset + entry.pointCount * 3 * sizeof(float));
+        }
+        entry.connectivityOffset = offset;
+        offset = alignOffset(offset + entry.connectivityCount * sizeof(qint64));
+        entries.push_back(entry);
+    }
+
+    QSaveFile file(filePathForKey(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "网格缓存: 无法写入" << file.fileName();
+        return false;
+    }
+
+    CacheFileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.byteOrderMark = kByteOrderMark;
+    header.regionCount = static_cast<quint32>(entries.size());
+    header.reserved = 0;
+    bool ok = file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+    const qint64 directoryBytes = static_cast<qint64>(entries.size() * sizeof(CacheRegionEntry));
+    ok = ok && file.write(reinterpret_cast<const char*>(entries.data()), directoryBytes) == directoryBytes;
+
+    std::vector<float> values;
+    std::vector<qint64> connectivity;
+    for (int i = 0; ok && i < surfaces.size(); ++i) {
+        vtkPolyData* polyData = surfaces[i].second;
+        const CacheRegionEntry& entry = entries[i];
+        const vtkIdType numPoints = static_cast<vtkIdType>(entry.pointCount);
+
+        copyTuples(polyData->GetPoints()->GetData(), numPoints, values);
+        ok = ok && writePadding(file, entry.pointsOffset);
+        ok = ok && file.write(reinterpret_cast<const char*>(values.data()),
+                              static_cast<qint64>(values.size() * sizeof(float))) ==
+                   static_cast<qint64>(values.size() * sizeof(float));
+
+        if (entry.hasNormals) {
+            copyTuples(polyData->GetPointData()->GetNormals(), numPoints, values);
+            ok = ok && writePadding(file, entry.normalsOffset);
+            ok = ok && file.write(reinterpret_cast<const char*>(values.data()),
+                                  static_cast<qint64>(values.size() * sizeof(float))) ==
+                       static_cast<qint64>(values.size() * sizeof(float));
+        }
+
+        const vtkIdType* cells = polyData->GetPolys()->GetData()->GetPointer(0);
+        connectivity.assign(cells, cells + entry.connectivityCount);
+        const qint64 connectivityBytes = static_cast<qint64>(connectivity.size() * sizeof(qint64));
+        ok = ok && writePadding(file, entry.connectivityOffset);
+        ok = ok && file.write(reinterpret_cast<const char*>(connectivity.data()), connectivityBytes) ==
+                   connectivityBytes;
+    }
+
+    if (!ok) {
+        file.cancelWriting();
+        qDebug() << "网格缓存: 写入失败" << file.fileName();
+        return false;
+    }
+    if (!file.commit()) {
+        qDebug() << "网格缓存: 提交失败" << file.fileName();
+        return false;
+    }
+
+    qDebug() << "网格缓存已写入:" << file.fileName() << "区块数:" << entries.size()
+             << "大小:" << offset / (1024 * 1024) << "MB";
+    return true;
+}
+
+bool RegionMeshCache::clear() const
+{
+    QDir cacheDir(directory);
+    if (!cacheDir.exists()) return true;
+
+    bool ok = true;
+    const QStringList files = cacheDir.entryList(QStringList() << (QString("*") + kFileSuffix), QDir::Files);
+    for (const QString& fileName : files) {
+        ok = cacheDir.remove(fileName) && ok;
+    }
+    qDebug() << "网格缓存已清理:" << files.size() << "个文件";
+    return ok;
+}
@@ -0,0 +1,49 @@
+#ifndef REGIONMESHCACHE_H
+#define REGIONMESHCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+// VTK头文件
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/**
+ * @brief 按内容寻址的区块网格磁盘缓存
+ *
+ * 每个缓存键（由MRI/标签文件指纹和网格参数计算）对应一个二进制文件，
+ * 保存所有区块最终的polydata（点坐标、点法向、多边形单元）。文件布局：
+ *   文件头 | 区块目录（每区块一项，记录各数组的偏移和长度）| 8字节对齐的原始数组
+ * 读取时整文件内存映射，按目录直接拷贝到VTK数组，不做任何解析或网格计算。
+ * 写入使用QSaveFile，中途失败不会留下不完整的缓存文件。
+ */
+class RegionMeshCache
+{
+public:
+    RegionMeshCache();
+
+    // 缓存目录，默认为系统缓存目录下的meshcache
+    void setDirectory(const QString& directory);
+    QString getDirectory() const { return directory; }
+
+    // 文件指纹：大小、修改时间和开头/结尾各1MB内容的哈希。只读取2MB，可以在GUI线程中调用；
+    // 同大小同修改时间且首尾不变、只改动中间内容的文件会被当作相同
+    static QByteArray fingerprintFile(const QString& filePath);
+
+    // 读取/写入键对应的全部区块表面；读取失败（不存在、版本不符、文件损坏）返回false
+    bool load(const QByteArray& key, QHash<int, vtkSmartPointer<vtkPolyData>>& surfaces) const;
+    bool save(const QByteArray& key, const QList<QPair<int, vtkSmartPointer<vtkPolyData>>>& surfaces) const;
+
+    // 删除目录中的所有缓存文件
+    bool clear() const;
+
+private:
+    QString filePathForKey(const QByteArray& key) const;
+
+    QString directory;
+};
+
+#endif // REGIONMESHCACHE_H
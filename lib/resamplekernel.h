@@ -0,0 +1,485 @@
+#ifndef RESAMPLEKERNEL_H
+#define RESAMPLEKERNEL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RESAMPLE_KERNEL_USE_SSE2 1
+#endif
+
+// VTK头文件
+#include <vtkType.h>
+
+#include "parallelfor.h"
+
+/**
+ * @brief 体数据重采样内核（纯C++模板，按标量类型特化）
+ *
+ * 输出体素索引(i, j, k)经仿射映射得到源数据的连续体素索引：
+ *   source = matrix * [i, j, k, 1]
+ * 三种插值方式：
+ * - NEAREST：标签数据使用。沿行方向用32位小数定点数增量步进，结果与逐点直接计算
+ *   一致且不会出现浮点累积误差导致的标签跳变
+ * - LINEAR / CUBIC：MRI数据使用。映射为轴对齐（没有旋转/剪切，不同分辨率的图谱与
+ *   T1的常见情况）时按轴预计算索引和权重表，先把y/z方向的若干源行合并成一行（连续访存，
+ *   float和16位整数使用SSE2），再沿x方向插值；一般仿射时逐点计算
+ * 输出按z切片分块并行。所有路径使用同一个范围判断：源索引在[-0.5, dim - 0.5)之外
+ * （即floor(position + 0.5)不在[0, dim)内）的输出体素取背景值，之内的邻域超出边界时复制边界体素。
+ */
+namespace ResampleKernel {
+
+enum Method {
+    NEAREST,
+    LINEAR,
+    CUBIC
+};
+
+// 源连续索引 = matrix * [i, j, k, 1]，matrix按行存储3x4
+struct AffineMap
+{
+    double m[3][4];
+
+    AffineMap()
+    {
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                m[r][c] = (r == c) ? 1.0 : 0.0;
+            }
+        }
+    }
+
+    bool isAxisAligned() const
+    {
+        return m[0][1] == 0.0 && m[0][2] == 0.0 && m[1][0] == 0.0 &&
+               m[1][2] == 0.0 && m[2][0] == 0.0 && m[2][1] == 0.0;
+    }
+};
+
+namespace Detail {
+
+// 每个输出分块至少包含的切片数
+static const int kSlicesPerChunk = 2;
+
+// 定点数小数位数（标签最近邻步进）
+static const int kFixedShift = 32;
+
+template <typename T>
+inline T convertResult(double value, std::true_type)
+{
+    const double low = static_cast<double>(std::numeric_limits<T>::lowest());
+    const double high = static_cast<double>(std::numeric_limits<T>::max());
+    const double rounded = std::floor(value + 0.5);
+    return static_cast<T>(std::min(std::max(rounded, low), high));
+}
+
+template <typename T>
+inline T convertResult(double value, std::false_type)
+{
+    return static_cast<T>(value);
+}
+
+// 插值结果转换为输出类型：整数类型四舍五入并截断到取值范围
+template <typename T>
+inline T convertResult(double value)
+{
+    return convertResult<T>(value, std::integral_constant<bool, std::numeric_limits<T>::is_integer>());
+}
+
+// 与最近邻的floor(position + 0.5) ∈ [0, dim)一致
+inline bool insideSource(double position, int dim)
+{
+    return position >= -0.5 && position < dim - 0.5;
+}
+
+inline int clampIndex(int index, int dim)
+{
+    return index < 0 ? 0 : (index >= dim ? dim - 1 : index);
+}
+
+// Catmull-Rom三次卷积权重（a = -0.5），t为到floor(position)的距离
+inline void cubicWeights(double t, double weights[4])
+{
+    const double t2 = t * t;
+    const double t3 = t2 * t;
+    weights[0] = -0.5 * t3 + t2 - 0.5 * t;
+    weights[1] = 1.5 * t3 - 2.5 * t2 + 1.0;
+    weights[2] = -1.5 * t3 + 2.0 * t2 + 0.5 * t;
+    weights[3] = 0.5 * t3 - 0.5 * t2;
+}
+
+// 单个轴上的插值抽头：taps个源索引（已截断到边界）和权重，outside表示取背景值
+struct AxisTaps
+{
+    int taps;
+    std::vector<int> index;
+    std::vector<double> weight;
+    std::vector<unsigned char> outside;
+};
+
+inline void buildAxisTaps(Method method, double scale, double offset, int outputDim, int sourceDim,
+                          AxisTaps& axis)
+{
+    axis.taps = (method == CUBIC) ? 4 : (method == LINEAR ? 2 : 1);
+    axis.index.assign(static_cast<size_t>(outputDim) * axis.taps, 0);
+    axis.weight.assign(static_cast<size_t>(outputDim) * axis.taps, 0.0);
+    axis.outside.assign(static_cast<size_t>(outputDim), 0);
+
+    for (int n = 0; n < outputDim; ++n) {
+        const double position = scale * n + offset;
+        if (!insideSource(position, sourceDim)) {
+            axis.outside[n] = 1;
+            continue;
+        }
+        int* index = &axis.index[static_cast<size_t>(n) * axis.taps];
+        double* weight = &axis.weight[static_cast<size_t>(n) * axis.taps];
+        if (method == NEAREST) {
+            index[0] = clampIndex(static_cast<int>(std::floor(position + 0.5)), sourceDim);
+            weight[0] = 1.0;
+        } else if (method == LINEAR) {
+            const int base = static_cast<int>(std::floor(position));
+            const double t = position - base;
+            index[0] = clampIndex(base, sourceDim);
+            index[1] = clampIndex(base + 1, sourceDim);
+            weight[0] = 1.0 - t;
+            weight[1] = t;
+        } else {
+            const int base = static_cast<int>(std::floor(position));
+            cubicWeights(position - base, weight);
+            for (int k = 0; k < 4; ++k) {
+                index[k] = clampIndex(base - 1 + k, sourceDim);
+            }
+        }
+    }
+}
+
+// 合并行的累加类型：float能精确表示所有取值的类型（8/16位整数、float）用float，
+// 32位及以上整数和double用double，避免合并时丢失有效位
+template <typename T>
+struct BlendAccumulator
+{
+    typedef typename std::conditional<(std::numeric_limits<T>::digits > std::numeric_limits<float>::digits),
+                                      double, float>::type type;
+};
+
+/**
+ * @brief 把若干源行按权重合并为一行（连续访存），累加类型见BlendAccumulator
+ *
+ * 主模板逐元素转换后累加；float和16位整数特化使用SSE2每次处理4/8个元素。
+ */
+template <typename T>
+struct RowBlend
+{
+    typedef typename BlendAccumulator<T>::type Accumulator;
+
+    static void accumulate(const T* row, Accumulator weight, int begin, int end, Accumulator* out)
+    {
+        for (int x = begin; x < end; ++x) {
+            out[x] += weight * static_cast<Accumulator>(row[x]);
+        }
+    }
+};
+
+#ifdef RESAMPLE_KERNEL_USE_SSE2
+template <>
+struct RowBlend<float>
+{
+    typedef float Accumulator;
+
+    static void accumulate(const float* row, float weight, int begin, int end, float* out)
+    {
+        const __m128 w = _mm_set1_ps(weight);
+        int x = begin;
+        for (; x + 4 <= end; x += 4) {
+            const __m128 values = _mm_loadu_ps(row + x);
+            _mm_storeu_ps(out + x, _mm_add_ps(_mm_loadu_ps(out + x), _mm_mul_ps(values, w)));
+        }
+        for (; x < end; ++x) {
+            out[x] += weight * row[x];
+        }
+    }
+};
+
+// 16位整数（常见的int16/uint16 MRI）：每次读取8个值，扩展为两组32位整数后转换为float累加
+template <bool IsSigned>
+struct RowBlend16
+{
+    static __m128i widenLow(__m128i values)
+    {
+        return IsSigned ? _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16)
+                        : _mm_unpacklo_epi16(values, _mm_setzero_si128());
+    }
+
+    static __m128i widenHigh(__m128i values)
+    {
+        return IsSigned ? _mm_srai_epi32(_mm_unpackhi_epi16(values, values), 16)
+                        : _mm_unpackhi_epi16(values, _mm_setzero_si128());
+    }
+
+    template <typename T>
+    static void accumulate(const T* row, float weight, int begin, int end, float* out)
+    {
+        const __m128 w = _mm_set1_ps(weight);
+        int x = begin;
+        for (; x + 8 <= end; x += 8) {
+            const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+            const __m128 low = _mm_cvtepi32_ps(widenLow(values));
+            const __m128 high = _mm_cvtepi32_ps(widenHigh(values));
+            _mm_storeu_ps(out + x, _mm_add_ps(_mm_loadu_ps(out + x), _mm_mul_ps(low, w)));
+            _mm_storeu_ps(out + x + 4, _mm_add_ps(_mm_loadu_ps(out + x + 4), _mm_mul_ps(high, w)));
+        }
+        for (; x < end; ++x) {
+            out[x] += weight * static_cast<float>(row[x]);
+        }
+    }
+};
+
+template <>
+struct RowBlend<short>
+{
+    typedef float Accumulator;
+
+    static void accumulate(const short* row, float weight, int begin, int end, float* out)
+    {
+        RowBlend16<true>::accumulate(row, weight, begin, end, out);
+    }
+};
+
+template <>
+struct RowBlend<unsigned short>
+{
+    typedef float Accumulator;
+
+    static void accumulate(const unsigned short* row, float weight, int begin, int end, float* out)
+    {
+        RowBlend16<false>::accumulate(row, weight, begin, end, out);
+    }
+};
+#endif
+
+// 轴对齐映射：按轴查表；y/z方向先合并源行，再沿x插值
+template <typename T>
+void resampleSeparable(const T* source, const int sourceDims[3], T* target, const int targetDims[3],
+                       const AffineMap& map, Method method, T background)
+{
+    AxisTaps axes[3];
+    for (int a = 0; a < 3; ++a) {
+        buildAxisTaps(method, map.m[a][a], map.m[a][3], targetDims[a], sourceDims[a], axes[a]);
+    }
+
+    // x方向实际用到的源索引范围，合并行时只处理这一段
+    int xBegin = sourceDims[0];
+    int xEnd = 0;
+    for (int n = 0; n < targetDims[0]; ++n) {
+        if (axes[0].outside[n]) continue;
+        for (int k = 0; k < axes[0].taps; ++k) {
+            const int index = axes[0].index[static_cast<size_t>(n) * axes[0].taps + k];
+            xBegin = std::min(xBegin, index);
+            xEnd = std::max(xEnd, index + 1);
+        }
+    }
+
+    const vtkIdType sourceSlice = static_cast<vtkIdType>(sourceDims[0]) * sourceDims[1];
+    const vtkIdType targetSlice = static_cast<vtkIdType>(targetDims[0]) * targetDims[1];
+    const AxisTaps& ax = axes[0];
+    const AxisTaps& ay = axes[1];
+    const AxisTaps& az = axes[2];
+
+    typedef typename RowBlend<T>::Accumulator Accumulator;
+    ParallelFor::parallelFor(0, targetDims[2], kSlicesPerChunk, [&](int zBegin, int zEnd) {
+        std::vector<Accumulator> blended(static_cast<size_t>(sourceDims[0]), Accumulator(0));
+        for (int z = zBegin; z < zEnd; ++z) {
+            T* outSlice = target + z * targetSlice;
+            for (int y = 0; y < targetDims[1]; ++y) {
+                T* out = outSlice + static_cast<vtkIdType>(y) * targetDims[0];
+                if (az.outside[z] || ay.outside[y] || xBegin >= xEnd) {
+                    std::fill(out, out + targetDims[0], background);
+                    continue;
+                }
+
+                if (method == NEAREST) {
+                    const T* row = source + az.index[z] * sourceSlice +
+                                   static_cast<vtkIdType>(ay.index[y]) * sourceDims[0];
+                    for (int x = 0; x < targetDims[0]; ++x) {
+                        out[x] = ax.outside[x] ? background : row[ax.index[x]];
+                    }
+                    continue;
+                }
+
+                // y/z方向：taps×taps个源行加权合并
+                std::fill(blended.begin() + xBegin, blended.begin() + xEnd, Accumulator(0));
+                for (int kz = 0; kz < az.taps; ++kz) {
+                    const double wz = az.weight[static_cast<size_t>(z) * az.taps + kz];
+                    if (wz == 0.0) continue;
+                    const T* sourceSliceRow = source + az.index[static_cast<size_t>(z) * az.taps + kz] * sourceSlice;
+                    for (int ky = 0; ky < ay.taps; ++ky) {
+                        const double w = wz * ay.weight[static_cast<size_t>(y) * ay.taps + ky];
+                        if (w == 0.0) continue;
+                        const T* row = sourceSliceRow +
+                                       static_cast<vtkIdType>(ay.index[static_cast<size_t>(y) * ay.taps + ky]) *
+                                       sourceDims[0];
+                        RowBlend<T>::accumulate(row, static_cast<Accumulator>(w), xBegin, xEnd, blended.data());
+                    }
+                }
+
+                // x方向
+                for (int x = 0; x < targetDims[0]; ++x) {
+                    if (ax.outside[x]) {
+                        out[x] = background;
+                        continue;
+                    }
+                    const int* index = &ax.index[static_cast<size_t>(x) * ax.taps];
+                    const double* weight = &ax.weight[static_cast<size_t>(x) * ax.taps];
+                    double value = 0.0;
+                    for (int k = 0; k < ax.taps; ++k) {
+                        value += weight[k] * static_cast<double>(blended[index[k]]);
+                    }
+                    out[x] = convertResult<T>(value);
+                }
+            }
+        }
+    });
+}
+
+// 一般仿射的最近邻：行内用定点数增量步进，逐点只做加法、移位和无符号比较
+template <typename T>
+void resampleNearestAffine(const T* source, const int sourceDims[3], T* target, const int targetDims[3],
+                           const AffineMap& map, T background)
+{
+    const double fixedScale = static_cast<double>(static_cast<int64_t>(1) << kFixedShift);
+    const int64_t half = static_cast<int64_t>(1) << (kFixedShift - 1);
+    int64_t step[3];
+    for (int a = 0; a < 3; ++a) {
+        step[a] = static_cast<int64_t>(std::llround(map.m[a][0] * fixedScale));
+    }
+
+    const vtkIdType sourceSlice = static_cast<vtkIdType>(sourceDims[0]) * sourceDims[1];
+    const vtkIdType targetSlice = static_cast<vtkIdType>(targetDims[0]) * targetDims[1];
+
+    ParallelFor::parallelFor(0, targetDims[2], kSlicesPerChunk, [&](int zBegin, int zEnd) {
+        for (int z = zBegin; z < zEnd; ++z) {
+            for (int y = 0; y < targetDims[1]; ++y) {
+                // 行起点直接计算，行内增量步进
+                int64_t position[3];
+                for (int a = 0; a < 3; ++a) {
+                    const double start = map.m[a][1] * y + map.m[a][2] * z + map.m[a][3];
+                    position[a] = static_cast<int64_t>(std::llround(start * fixedScale)) + half;
+                }
+
+                T* out = target + z * targetSlice + static_cast<vtkIdType>(y) * targetDims[0];
+                for (int x = 0; x < targetDims[0]; ++x) {
+                    // floor(p + 0.5)；负数右移为向下取整，转成无符号后一次比较同时排除负索引
+                    const int64_t ix = position[0] >> kFixedShift;
+                    const int64_t iy = position[1] >> kFixedShift;
+                    const int64_t iz = position[2] >> kFixedShift;
+                    if (static_cast<uint64_t>(ix) < static_cast<uint64_t>(sourceDims[0]) &&
+                        static_cast<uint64_t>(iy) < static_cast<uint64_t>(sourceDims[1]) &&
+                        static_cast<uint64_t>(iz) < static_cast<uint64_t>(sourceDims[2])) {
+                        out[x] = source[iz * sourceSlice + iy * sourceDims[0] + ix];
+                    } else {
+                        out[x] = background;
+                    }
+                    position[0] += step[0];
+                    position[1] += step[1];
+                    position[2] += step[2];
+                }
+            }
+        }
+    });
+}
+
+// 一般仿射的三线性/三次插值：逐点计算源位置和权重
+template <typename T>
+void resampleInterpolatedAffine(const T* source, const int sourceDims[3], T* target, const int targetDims[3],
+                                const AffineMap& map, Method method, T background)
+{
+    const vtkIdType sourceSlice = static_cast<vtkIdType>(sourceDims[0]) * sourceDims[1];
+    const vtkIdType targetSlice = static_cast<vtkIdType>(targetDims[0]) * targetDims[1];
+    const int taps = (method == CUBIC) ? 4 : 2;
+    const int firstTap = (method == CUBIC) ? -1 : 0;
+
+    ParallelFor::parallelFor(0, targetDims[2], kSlicesPerChunk, [&](int zBegin, int zEnd) {
+        for (int z = zBegin; z < zEnd; ++z) {
+            for (int y = 0; y < targetDims[1]; ++y) {
+                double rowStart[3];
+                for (int a = 0; a < 3; ++a) {
+                    rowStart[a] = map.m[a][1] * y + map.m[a][2] * z + map.m[a][3];
+                }
+
+                T* out = target + z * targetSlice + static_cast<vtkIdType>(y) * targetDims[0];
+                for (int x = 0; x < targetDims[0]; ++x) {
+                    // 逐点由行起点计算，避免累加误差改变边界处的取舍
+                    const double position[3] = {
+                        rowStart[0] + map.m[0][0] * x,
+                        rowStart[1] + map.m[1][0] * x,
+                        rowStart[2] + map.m[2][0] * x
+                    };
+                    if (!insideSource(position[0], sourceDims[0]) || !insideSource(position[1], sourceDims[1]) ||
+                        !insideSource(position[2], sourceDims[2])) {
+                        out[x] = background;
+                        continue;
+                    }
+
+                    int index[3][4];
+                    double weight[3][4];
+                    for (int a = 0; a < 3; ++a) {
+                        const int base = static_cast<int>(std::floor(position[a]));
+                        const double t = position[a] - base;
+                        if (method == CUBIC) {
+                            cubicWeights(t, weight[a]);
+                        } else {
+                            weight[a][0] = 1.0 - t;
+                            weight[a][1] = t;
+                        }
+                        for (int k = 0; k < taps; ++k) {
+                            index[a][k] = clampIndex(base + firstTap + k, sourceDims[a]);
+                        }
+                    }
+
+                    double value = 0.0;
+                    for (int kz = 0; kz < taps; ++kz) {
+                        const T* slice = source + index[2][kz] * sourceSlice;
+                        for (int ky = 0; ky < taps; ++ky) {
+                            const T* row = slice + static_cast<vtkIdType>(index[1][ky]) * sourceDims[0];
+                            double rowValue = 0.0;
+                            for (int kx = 0; kx < taps; ++kx) {
+                                rowValue += weight[0][kx] * static_cast<double>(row[index[0][kx]]);
+                            }
+                            value += weight[2][kz] * weight[1][ky] * rowValue;
+                        }
+                    }
+                    out[x] = convertResult<T>(value);
+                }
+            }
+        }
+    });
+}
+
+} // namespace Detail
+
+/**
+ * @brief 把source（sourceDims）按map重采样到target（targetDims，调用方分配）
+ * @param background 源数据范围外的输出值
+ */
+template <typename T>
+void resample(const T* source, const int sourceDims[3], T* target, const int targetDims[3],
+              const AffineMap& map, Method method, double background = 0.0)
+{
+    const T backgroundValue = Detail::convertResult<T>(background);
+    if (map.isAxisAligned()) {
+        Detail::resampleSeparable(source, sourceDims, target, targetDims, map, method, backgroundValue);
+    } else if (method == NEAREST) {
+        Detail::resampleNearestAffine(source, sourceDims, target, targetDims, map, backgroundValue);
+    } else {
+        Detail::resampleInterpolatedAffine(source, sourceDims, target, targetDims, map, method, backgroundValue);
+    }
+}
+
+} // namespace ResampleKernel
+
+#endif // RESAMPLEKERNEL_H
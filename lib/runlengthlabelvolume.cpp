@@ -0,0 +1,226 @@
+#include "runlengthlabelvolume.h"
+#include "parallelfor.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+// VTK头文件
+#include <vtkDataArray.h>
+#include <vtkPointData.h>
+
+namespace {
+
+// 每块至少的切片数
+const int kSliceGrain = 4;
+
+// 编码[zBegin, zEnd)的行：游程追加到runs，每行的游程数写入rowCounts[行号]。
+// runBudget不为空时为所有块共用的剩余游程数，用完即返回false
+template <typename T>
+bool encodeSlices(const T* data, int numComponents, const int dims[3], int zBegin, int zEnd,
+                  std::vector<LabelRun>& runs, vtkIdType* rowCounts, QHash<int, vtkIdType>& voxelCounts,
+                  std::atomic<int64_t>* runBudget)
+{
+    for (int z = zBegin; z < zEnd; ++z) {
+        for (int y = 0; y < dims[1]; ++y) {
+            const size_t row = static_cast<size_t>(z) * dims[1] + y;
+            const T* values = data + static_cast<vtkIdType>(row) * dims[0] * numComponents;
+            const size_t firstRun = runs.size();
+
+            int x = 0;
+            while (x < dims[0]) {
+                const int value = static_cast<int>(values[static_cast<vtkIdType>(x) * numComponents]);
+                int runEnd = x + 1;
+                while (runEnd < dims[0] &&
+                       static_cast<int>(values[static_cast<vtkIdType>(runEnd) * numComponents]) == value) {
+                    ++runEnd;
+                }
+                if (value != 0) {
+                    LabelRun run;
+                    run.x = x;
+                    run.length = runEnd - x;
+                    run.value = value;
+                    runs.push_back(run);
+                    if (value > 0) voxelCounts[value] += run.length;
+                }
+                x = runEnd;
+            }
+            const int64_t rowRuns = static_cast<int64_t>(runs.size() - firstRun);
+            rowCounts[row] = static_cast<vtkIdType>(rowRuns);
+            if (runBudget && runBudget->fetch_sub(rowRuns) < rowRuns) return false;
+        }
+    }
+    return true;
+}
+
+// 把切片[firstSlice, firstSlice + sliceCount)的游程写入已清零的输出
+template <typename T>
+void decodeRuns(const RunLengthLabelVolume& volume, int firstSlice, int sliceCount, T* output)
+{
+    const int* dims = volume.getDimensions();
+    ParallelFor::parallelFor(0, sliceCount, kSliceGrain, [&](int sliceBegin, int sliceEnd) {
+        for (int slice = sliceBegin; slice < sliceEnd; ++slice) {
+            for (int y = 0; y < dims[1]; ++y) {
+                T* row = output + (static_cast<vtkIdType>(slice) * dims[1] + y) * dims[0];
+                const LabelRun* last = volume.rowEnd(y, firstSlice + slice);
+                for (const LabelRun* run = volume.rowBegin(y, firstSlice + slice); run != last; ++run) {
+                    std::fill(row + run->x, row + run->x + run->length, static_cast<T>(run->value));
+                }
+            }
+        }
+    });
+}
+
+} // namespace
+
+RunLengthLabelVolume::RunLengthLabelVolume()
+    : scalarType(VTK_INT)
+{
+    dimensions[0] = dimensions[1] = dimensions[2] = 0;
+}
+
+bool RunLengthLabelVolume::build(vtkImageData* labelImage, int64_t maxMemorySize)
+{
+    clear();
+
+    if (!labelImage) return false;
+    vtkDataArray* scalars = labelImage->GetPointData()->GetScalars();
+    if (!scalars) return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    int dims[3];
+    labelImage->GetDimensions(dims);
+    const int numComponents = scalars->GetNumberOfComponents();
+    const void* scalarPointer = scalars->GetVoidPointer(0);
+
+    // 每块编码自己的切片，按z顺序拼接后即为整体的游程数组
+    const size_t rowCount = static_cast<size_t>(dims[1]) * dims[2];
+    std::vector<vtkIdType> offsets(rowCount + 1, 0);
+    const int chunks = ParallelFor::chunkCount(0, dims[2], kSliceGrain);
+    std::vector<std::vector<LabelRun>> chunkRuns(chunks);
+    std::vector<QHash<int, vtkIdType>> chunkCounts(chunks);
+    std::vector<char> chunkEncoded(chunks, 0);
+
+    std::atomic<int64_t> runBudget(0);
+    if (maxMemorySize > 0) {
+        runBudget = (maxMemorySize - static_cast<int64_t>(offsets.size() * sizeof(vtkIdType))) /
+                    static_cast<int64_t>(sizeof(LabelRun));
+        if (runBudget.load() < 0) return false;
+    }
+    std::atomic<int64_t>* budget = maxMemorySize > 0 ? &runBudget : nullptr;
+
+    switch (scalars->GetDataType()) {
+        vtkTemplateMacro(
+            ParallelFor::parallelForChunks(0, dims[2], chunks, [&](int chunk, int zBegin, int zEnd) {
+                chunkEncoded[chunk] = encodeSlices(static_cast<const VTK_TT*>(scalarPointer), numComponents, dims,
+                                                   zBegin, zEnd, chunkRuns[chunk], offsets.data() + 1,
+                                                   chunkCounts[chunk], budget);
+            }));
+    default:
+        qDebug() << "游程编码: 不支持的标量类型" << scalars->GetDataType();
+        return false;
+    }
+    if (std::find(chunkEncoded.begin(), chunkEncoded.end(), 0) != chunkEncoded.end()) {
+        qDebug() << "游程编码: 游程超过" << maxMemorySize / 1024 << "KB，放弃编码";
+        return false;
+    }
+
+    for (size_t row = 0; row < rowCount; ++row) {
+        offsets[row + 1] += offsets[row];
+    }
+    runs.reserve(static_cast<size_t>(offsets[rowCount]));
+    for (int chunk = 0; chunk < chunks; ++chunk) {
+        runs.insert(runs.end(), chunkRuns[chunk].begin(), chunkRuns[chunk].end());
+        std::vector<LabelRun>().swap(chunkRuns[chunk]);
+        for (auto it = chunkCounts[chunk].constBegin(); it != chunkCounts[chunk].constEnd(); ++it) {
+            voxelCounts[it.key()] += it.value();
+        }
+    }
+    rowOffsets.swap(offsets);
+
+    geometry = vtkSmartPointer<vtkImageData>::New();
+    geometry->CopyStructure(labelImage);
+    std::copy(dims, dims + 3, dimensions);
+    scalarType = scalars->GetDataType();
+
+    qDebug() << "游程编码完成:" << runs.size() << "个游程，"
+             << memorySize() / 1024 << "KB（稠密"
+             << labelImage->GetNumberOfPoints() * scalars->GetDataTypeSize() / 1024 << "KB），耗时:"
+             << timer.elapsed() << "ms";
+    return true;
+}
+
+void RunLengthLabelVolume::clear()
+{
+    std::vector<LabelRun>().swap(runs);
+    std::vector<vtkIdType>().swap(rowOffsets);
+    voxelCounts.clear();
+    geometry = nullptr;
+    dimensions[0] = dimensions[1] = dimensions[2] = 0;
+    scalarType = VTK_INT;
+}
+
+int RunLengthLabelVolume::valueAt(int x, int y, int z) const
+{
+    if (!isValid() || x < 0 || y < 0 || z < 0 || x >= dimensions[0] || y >= dimensions[1] || z >= dimensions[2]) {
+        return 0;
+    }
+
+    // 第一个起点大于x的游程之前的那一个可能包含x
+    const LabelRun* first = rowBegin(y, z);
+    const LabelRun* last = rowEnd(y, z);
+    const LabelRun* next = std::upper_bound(first, last, x,
+                                            [](int column, const LabelRun& run) { return column < run.x; });
+    if (next == first) return 0;
+    const LabelRun& run = *(next - 1);
+    return x < run.x + run.length ? run.value : 0;
+}
+
+int64_t RunLengthLabelVolume::memorySize() const
+{
+    return static_cast<int64_t>(runs.size()) * sizeof(LabelRun) +
+           static_cast<int64_t>(rowOffsets.size()) * sizeof(vtkIdType);
+}
+
+vtkSmartPointer<vtkImageData> RunLengthLabelVolume::toImage() const
+{
+    return decodeSlices(0, dimensions[2]);
+}
+
+vtkSmartPointer<vtkImageData> RunLengthLabelVolume::createSliceImage(int z) const
+{
+    if (z < 0 || z >= dimensions[2]) return nullptr;
+    return decodeSlices(z, 1);
+}
+
+vtkSmartPointer<vtkImageData> RunLengthLabelVolume::decodeSlices(int firstSlice, int sliceCount) const
+{
+    if (!isValid()) return nullptr;
+
+    int extent[6];
+    geometry->GetExtent(extent);
+    auto image = vtkSmartPointer<vtkImageData>::New();
+    image->SetOrigin(geometry->GetOrigin());
+    image->SetSpacing(geometry->GetSpacing());
+    image->SetExtent(extent[0], extent[1], extent[2], extent[3],
+                     extent[4] + firstSlice, extent[4] + firstSlice + sliceCount - 1);
+
+    vtkSmartPointer<vtkDataArray> scalars;
+    scalars.TakeReference(vtkDataArray::CreateDataArray(scalarType));
+    scalars->SetNumberOfComponents(1);
+    scalars->SetNumberOfTuples(static_cast<vtkIdType>(dimensions[0]) * dimensions[1] * sliceCount);
+    void* scalarPointer = scalars->GetVoidPointer(0);
+    std::memset(scalarPointer, 0, static_cast<size_t>(scalars->GetNumberOfValues()) * scalars->GetDataTypeSize());
+
+    switch (scalarType) {
+        vtkTemplateMacro(decodeRuns(*this, firstSlice, sliceCount, static_cast<VTK_TT*>(scalarPointer)));
+    }
+
+    image->GetPointData()->SetScalars(scalars);
+    return image;
+}
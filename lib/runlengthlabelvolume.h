@@ -0,0 +1,78 @@
+#ifndef RUNLENGTHLABELVOLUME_H
+#define RUNLENGTHLABELVOLUME_H
+
+#include <QHash>
+
+#include <cstdint>
+#include <vector>
+
+// VTK头文件
+#include <vtkSmartPointer.h>
+#include <vtkImageData.h>
+
+/**
+ * @brief 一行中值相同的一段连续体素
+ */
+struct LabelRun
+{
+    int x;        // 起始列
+    int length;   // 体素数
+    int value;    // 体素值（非0）
+};
+
+/**
+ * @brief 沿x方向游程编码的标签体数据
+ *
+ * 稀疏图谱（大视野中的少量小区域）的稠密标签图像几乎全是0。这里只保存非0的游程，
+ * 每行一个游程起点索引：随机访问为行内二分查找，按行遍历直接得到连续段，
+ * 标签统计、划分和切片提取都不需要解压成完整数组。体素值与源图像相同（可以是紧凑编号）。
+ */
+class RunLengthLabelVolume
+{
+public:
+    RunLengthLabelVolume();
+
+    // 按切片并行编码labelImage（只取第一个分量）；标量类型不支持时返回false。
+    // maxMemorySize大于0时，编码结果超过该字节数即提前放弃并返回false
+    bool build(vtkImageData* labelImage, int64_t maxMemorySize = 0);
+    void clear();
+
+    bool isValid() const { return geometry != nullptr; }
+    const int* getDimensions() const { return dimensions; }
+    // 与源图像几何相同、不含标量的图像
+    vtkImageData* getGeometry() const { return geometry; }
+    // 源图像的标量类型，解压时使用
+    int getScalarType() const { return scalarType; }
+
+    // 单个体素的值（行内二分查找）
+    int valueAt(int x, int y, int z) const;
+
+    // 第(y, z)行的游程，按x递增
+    const LabelRun* rowBegin(int y, int z) const { return runs.data() + rowOffsets[rowIndex(y, z)]; }
+    const LabelRun* rowEnd(int y, int z) const { return runs.data() + rowOffsets[rowIndex(y, z) + 1]; }
+
+    // 正值各自的体素数（编码时统计）
+    const QHash<int, vtkIdType>& getVoxelCounts() const { return voxelCounts; }
+
+    vtkIdType getRunCount() const { return static_cast<vtkIdType>(runs.size()); }
+    // 游程和行索引占用的字节数
+    int64_t memorySize() const;
+
+    // 解压为完整图像（源标量类型、单分量）
+    vtkSmartPointer<vtkImageData> toImage() const;
+    // 只解压第z层，输出范围的z为该层
+    vtkSmartPointer<vtkImageData> createSliceImage(int z) const;
+
+private:
+    size_t rowIndex(int y, int z) const { return static_cast<size_t>(z) * dimensions[1] + y; }
+    vtkSmartPointer<vtkImageData> decodeSlices(int firstSlice, int sliceCount) const;
+
+    std::vector<LabelRun> runs;
+    std::vector<vtkIdType> rowOffsets;   // 行(y, z)的游程为[rowOffsets[i], rowOffsets[i + 1])
+    QHash<int, vtkIdType> voxelCounts;
+    vtkSmartPointer<vtkImageData> geometry;
+    int dimensions[3];
+    int scalarType;
+};
+
+#endif // RUNLENGTHLABELVOLUME_H
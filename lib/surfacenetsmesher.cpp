@@ -0,0 +1,83 @@
+#include "surfacenetsmesher.h"
+
+#include <QDebug>
+#include <cstring>
+
+// VTK头文件
+#include <vtkImageData.h>
+#include <vtkPolyData.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+
+vtkSmartPointer<vtkPolyData> SurfaceNetsMesher::extract(vtkImageData* labelData, double labelValue,
+                                                        int relaxationIterations, double relaxationFactor)
+{
+    if (!labelData) return nullptr;
+
+    vtkDataArray* scalars = labelData->GetPointData()->GetScalars();
+    if (!scalars) return nullptr;
+
+    int dims[3];
+    double origin[3];
+    double spacing[3];
+    int extent[6];
+    labelData->GetDimensions(dims);
+    labelData->GetOrigin(origin);
+    labelData->GetSpacing(spacing);
+    labelData->GetExtent(extent);
+    for (int i = 0; i < 3; ++i) {
+        origin[i] += extent[i * 2] * spacing[i];
+    }
+
+    const int stride = scalars->GetNumberOfComponents();
+    void* scalarPointer = scalars->GetVoidPointer(0);
+
+    SurfaceNetsMesh mesh;
+    switch (scalars->GetDataType()) {
+        vtkTemplateMacro(extractSurfaceNets(static_cast<const VTK_TT*>(scalarPointer), stride, dims, origin,
+                                            spacing, labelValue, relaxationIterations, relaxationFactor, mesh));
+    default:
+        qDebug() << "表面网格: 不支持的标量类型" << scalars->GetDataType();
+        return nullptr;
+    }
+
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+    const vtkIdType numPoints = mesh.getNumberOfPoints();
+
+    auto coordinates = vtkSmartPointer<vtkFloatArray>::New();
+    coordinates->SetNumberOfComponents(3);
+    coordinates->SetNumberOfTuples(numPoints);
+    auto normals = vtkSmartPointer<vtkFloatArray>::New();
+    normals->SetName("Normals");
+    normals->SetNumberOfComponents(3);
+    normals->SetNumberOfTuples(numPoints);
+    if (numPoints > 0) {
+        std::memcpy(coordinates->GetPointer(0), mesh.points.data(), mesh.points.size() * sizeof(float));
+        std::memcpy(normals->GetPointer(0), mesh.normals.data(), mesh.normals.size() * sizeof(float));
+    }
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(coordinates);
+    polyData->SetPoints(points);
+    polyData->GetPointData()->SetNormals(normals);
+
+    // VTK 8.2的单元数组格式：每个四边形为 [4, a, b, c, d]
+    const vtkIdType numQuads = mesh.getNumberOfQuads();
+    auto connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    connectivity->SetNumberOfValues(numQuads * 5);
+    vtkIdType* cell = connectivity->GetPointer(0);
+    for (vtkIdType q = 0; q < numQuads; ++q) {
+        *cell++ = 4;
+        for (int k = 0; k < 4; ++k) {
+            *cell++ = mesh.quads[q * 4 + k];
+        }
+    }
+    auto quads = vtkSmartPointer<vtkCellArray>::New();
+    quads->SetCells(numQuads, connectivity);
+    polyData->SetPolys(quads);
+
+    return polyData;
+}
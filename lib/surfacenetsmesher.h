@@ -0,0 +1,335 @@
+#ifndef SURFACENETSMESHER_H
+#define SURFACENETSMESHER_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// VTK头文件
+#include <vtkType.h>
+#include <vtkSmartPointer.h>
+
+#include "marchingcubestables.h"
+
+class vtkImageData;
+class vtkPolyData;
+
+/**
+ * @brief 表面网格（surface nets）提取结果
+ *
+ * 每个跨越边界的单元只有一个顶点，每条跨越边界的体素棱生成一个四边形，
+ * 顶点数约为移动立方体的一半，且没有阶梯状的细小三角形。
+ */
+struct SurfaceNetsMesh
+{
+    std::vector<float> points;      // 顶点坐标 xyz（世界坐标）
+    std::vector<float> normals;     // 顶点法向 xyz（指向标签外侧）
+    std::vector<vtkIdType> quads;   // 每4个顶点索引为一个四边形
+
+    vtkIdType getNumberOfPoints() const { return static_cast<vtkIdType>(points.size() / 3); }
+    vtkIdType getNumberOfQuads() const { return static_cast<vtkIdType>(quads.size() / 4); }
+    void clear()
+    {
+        points.clear();
+        normals.clear();
+        quads.clear();
+    }
+};
+
+namespace SurfaceNetsDetail {
+
+// 每种角点情形下，被穿过棱的中点的平均位置（单元局部坐标，0..1）
+struct CaseCentroids
+{
+    float offset[256][3];
+
+    CaseCentroids()
+    {
+        using namespace MarchingCubesTables;
+        for (int cubeCase = 0; cubeCase < 256; ++cubeCase) {
+            double sum[3] = {0.0, 0.0, 0.0};
+            int crossings = 0;
+            for (int e = 0; e < 12; ++e) {
+                if (!(kEdgeTable[cubeCase] & (1 << e))) continue;
+                for (int axis = 0; axis < 3; ++axis) {
+                    sum[axis] += kEdgeOffset[e][axis] + (kEdgeAxis[e] == axis ? 0.5 : 0.0);
+                }
+                ++crossings;
+            }
+            for (int axis = 0; axis < 3; ++axis) {
+                offset[cubeCase][axis] = crossings > 0 ? static_cast<float>(sum[axis] / crossings) : 0.5f;
+            }
+        }
+    }
+};
+
+inline const CaseCentroids& caseCentroids()
+{
+    static const CaseCentroids centroids;
+    return centroids;
+}
+
+// 滚动的单元层：单元坐标从-1开始（体数据外一圈视为背景，保证表面闭合）
+class CellLayer
+{
+public:
+    void reset(int cellsX, int cellsY)
+    {
+        sizeX = cellsX;
+        ids.assign(static_cast<size_t>(cellsX) * cellsY, -1);
+    }
+
+    vtkIdType& at(int cx, int cy) { return ids[static_cast<size_t>(cy + 1) * sizeX + (cx + 1)]; }
+
+private:
+    std::vector<vtkIdType> ids;
+    int sizeX = 0;
+};
+
+// 带一圈背景填充的二值掩码，坐标范围 [-1, dims]，查询时不需要边界判断
+class PaddedMask
+{
+public:
+    template <typename T>
+    PaddedMask(const T* labels, int stride, const int dims[3], double labelValue)
+    {
+        sizeX = dims[0] + 2;
+        sizeY = dims[1] + 2;
+        mask.assign(static_cast<size_t>(sizeX) * sizeY * (dims[2] + 2), 0);
+        for (int z = 0; z < dims[2]; ++z) {
+            for (int y = 0; y < dims[1]; ++y) {
+                const T* row = labels + (static_cast<vtkIdType>(z) * dims[1] + y) * dims[0] * stride;
+                unsigned char* target = &mask[index(0, y, z)];
+                for (int x = 0; x < dims[0]; ++x) {
+                    target[x] = static_cast<double>(row[static_cast<vtkIdType>(x) * stride]) == labelValue ? 1 : 0;
+                }
+            }
+        }
+    }
+
+    int inside(int x, int y, int z) const { return mask[index(x, y, z)]; }
+
+private:
+    size_t index(int x, int y, int z) const
+    {
+        return (static_cast<size_t>(z + 1) * sizeY + (y + 1)) * sizeX + (x + 1);
+    }
+
+    std::vector<unsigned char> mask;
+    int sizeX = 0;
+    int sizeY = 0;
+};
+
+inline void emitQuad(vtkIdType a, vtkIdType b, vtkIdType c, vtkIdType d, bool flip, SurfaceNetsMesh& mesh)
+{
+    mesh.quads.push_back(a);
+    mesh.quads.push_back(flip ? d : b);
+    mesh.quads.push_back(c);
+    mesh.quads.push_back(flip ? b : d);
+}
+
+/**
+ * @brief 约束松弛：向邻点平均位置移动，但不离开各自的单元
+ *
+ * 代替通用的拉普拉斯平滑，表面不会收缩，也不会偏离标签边界超过半个体素。
+ */
+inline void relaxVertices(SurfaceNetsMesh& mesh, const std::vector<int>& cellCoordinates,
+                          const double origin[3], const double spacing[3],
+                          int iterations, double relaxationFactor)
+{
+    const vtkIdType numPoints = mesh.getNumberOfPoints();
+    if (iterations <= 0 || numPoints == 0) return;
+
+    // 邻接表（CSR）：四边形的每条有向边 a->b 记一次，流形网格上每条无向边两端各得一次
+    std::vector<vtkIdType> offsets(static_cast<size_t>(numPoints) + 1, 0);
+    const size_t numQuadIds = mesh.quads.size();
+    for (size_t q = 0; q < numQuadIds; q += 4) {
+        for (int k = 0; k < 4; ++k) {
+            ++offsets[static_cast<size_t>(mesh.quads[q + k]) + 1];
+        }
+    }
+    for (vtkIdType i = 0; i < numPoints; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    std::vector<vtkIdType> neighbors(static_cast<size_t>(offsets[numPoints]));
+    std::vector<vtkIdType> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t q = 0; q < numQuadIds; q += 4) {
+        for (int k = 0; k < 4; ++k) {
+            neighbors[static_cast<size_t>(cursor[mesh.quads[q + k]]++)] = mesh.quads[q + (k + 1) % 4];
+        }
+    }
+
+    std::vector<double> current(mesh.points.begin(), mesh.points.end());
+    std::vector<double> next(current.size());
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        for (vtkIdType i = 0; i < numPoints; ++i) {
+            const vtkIdType begin = offsets[i];
+            const vtkIdType end = offsets[i + 1];
+            for (int axis = 0; axis < 3; ++axis) {
+                const double position = current[static_cast<size_t>(i) * 3 + axis];
+                if (begin == end) {
+                    next[static_cast<size_t>(i) * 3 + axis] = position;
+                    continue;
+                }
+                double average = 0.0;
+                for (vtkIdType n = begin; n < end; ++n) {
+                    average += current[static_cast<size_t>(neighbors[static_cast<size_t>(n)]) * 3 + axis];
+                }
+                average /= static_cast<double>(end - begin);
+
+                // 单元范围：角点 cell .. cell+1（体素中心坐标）
+                const double cellMin = origin[axis] + cellCoordinates[static_cast<size_t>(i) * 3 + axis] * spacing[axis];
+                const double cellMax = cellMin + spacing[axis];
+                const double relaxed = position + relaxationFactor * (average - position);
+                next[static_cast<size_t>(i) * 3 + axis] =
+                    std::min(std::max(relaxed, std::min(cellMin, cellMax)), std::max(cellMin, cellMax));
+            }
+        }
+        current.swap(next);
+    }
+
+    for (size_t i = 0; i < current.size(); ++i) {
+        mesh.points[i] = static_cast<float>(current[i]);
+    }
+}
+
+// 四边形拆成两个三角形累加面积加权法向
+inline void computeQuadNormals(SurfaceNetsMesh& mesh)
+{
+    mesh.normals.assign(mesh.points.size(), 0.0f);
+    for (size_t q = 0; q < mesh.quads.size(); q += 4) {
+        const float* p[4];
+        for (int k = 0; k < 4; ++k) {
+            p[k] = &mesh.points[static_cast<size_t>(mesh.quads[q + k]) * 3];
+        }
+        // 对角线叉积等于两个三角形法向之和
+        const float u[3] = {p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2]};
+        const float v[3] = {p[3][0] - p[1][0], p[3][1] - p[1][1], p[3][2] - p[1][2]};
+        const float n[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+        for (int k = 0; k < 4; ++k) {
+            float* normal = &mesh.normals[static_cast<size_t>(mesh.quads[q + k]) * 3];
+            normal[0] += n[0];
+            normal[1] += n[1];
+            normal[2] += n[2];
+        }
+    }
+    for (size_t i = 0; i < mesh.normals.size(); i += 3) {
+        float* normal = &mesh.normals[i];
+        const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (length > 0.0f) {
+            normal[0] /= length;
+            normal[1] /= length;
+            normal[2] /= length;
+        }
+    }
+}
+
+} // namespace SurfaceNetsDetail
+
+/**
+ * @brief 在标签数据上提取 value == labelValue 区域的表面网格
+ *
+ * 按z单元层推进：先为当前层中跨越边界的单元生成顶点（被穿过棱中点的平均），
+ * 再为以当前层为上侧/所在层的体素棱输出四边形。只保留两层单元的顶点编号。
+ * 四边形法向指向标签外侧。
+ */
+template <typename T>
+void extractSurfaceNets(const T* labels, int stride, const int dims[3], const double origin[3],
+                        const double spacing[3], double labelValue, int relaxationIterations,
+                        double relaxationFactor, SurfaceNetsMesh& mesh)
+{
+    using namespace SurfaceNetsDetail;
+
+    mesh.clear();
+    if (!labels || dims[0] < 1 || dims[1] < 1 || dims[2] < 1) return;
+
+    const PaddedMask sampler(labels, stride, dims, labelValue);
+    const CaseCentroids& centroids = caseCentroids();
+    std::vector<int> cellCoordinates;
+
+    // 单元坐标范围 [-1, dims-1]
+    const int cellsX = dims[0] + 1;
+    const int cellsY = dims[1] + 1;
+    CellLayer previous;
+    CellLayer current;
+    previous.reset(cellsX, cellsY);
+    current.reset(cellsX, cellsY);
+
+    for (int cz = -1; cz < dims[2]; ++cz) {
+        // 为当前单元层生成顶点
+        for (int cy = -1; cy < dims[1]; ++cy) {
+            for (int cx = -1; cx < dims[0]; ++cx) {
+                int cubeCase = 0;
+                for (int corner = 0; corner < 8; ++corner) {
+                    cubeCase |= sampler.inside(cx + (corner & 1), cy + ((corner >> 1) & 1),
+                                               cz + ((corner >> 2) & 1)) << corner;
+                }
+                vtkIdType& id = current.at(cx, cy);
+                if (cubeCase == 0 || cubeCase == 255) {
+                    id = -1;
+                    continue;
+                }
+                id = mesh.getNumberOfPoints();
+                const int cell[3] = {cx, cy, cz};
+                for (int axis = 0; axis < 3; ++axis) {
+                    mesh.points.push_back(static_cast<float>(
+                        origin[axis] + (cell[axis] + centroids.offset[cubeCase][axis]) * spacing[axis]));
+                    cellCoordinates.push_back(cell[axis]);
+                }
+            }
+        }
+
+        // z方向的棱：点 (x, y, cz) -> (x, y, cz+1)，周围四个单元都在当前层
+        for (int y = 0; y < dims[1]; ++y) {
+            for (int x = 0; x < dims[0]; ++x) {
+                const int lower = sampler.inside(x, y, cz);
+                if (lower == sampler.inside(x, y, cz + 1)) continue;
+                emitQuad(current.at(x - 1, y - 1), current.at(x, y - 1), current.at(x, y), current.at(x - 1, y),
+                         !lower, mesh);
+            }
+        }
+
+        // 位于点层cz上的x/y方向棱，周围单元在上一层和当前层
+        if (cz >= 0) {
+            for (int y = 0; y < dims[1]; ++y) {
+                for (int x = -1; x < dims[0]; ++x) {
+                    const int lower = sampler.inside(x, y, cz);
+                    if (lower != sampler.inside(x + 1, y, cz)) {
+                        emitQuad(previous.at(x, y - 1), previous.at(x, y), current.at(x, y), current.at(x, y - 1),
+                                 !lower, mesh);
+                    }
+                }
+            }
+            for (int y = -1; y < dims[1]; ++y) {
+                for (int x = 0; x < dims[0]; ++x) {
+                    const int lower = sampler.inside(x, y, cz);
+                    if (lower != sampler.inside(x, y + 1, cz)) {
+                        emitQuad(previous.at(x - 1, y), current.at(x - 1, y), current.at(x, y), previous.at(x, y),
+                                 !lower, mesh);
+                    }
+                }
+            }
+        }
+
+        std::swap(previous, current);
+    }
+
+    relaxVertices(mesh, cellCoordinates, origin, spacing, relaxationIterations, relaxationFactor);
+    computeQuadNormals(mesh);
+}
+
+/**
+ * @brief 表面网格生成器（VTK封装）
+ *
+ * 用于二值/标签掩码，可在工作线程中调用。输出为四边形为主的vtkPolyData，
+ * 已完成约束松弛，通常不需要再做vtkSmoothPolyDataFilter平滑。
+ */
+class SurfaceNetsMesher
+{
+public:
+    static vtkSmartPointer<vtkPolyData> extract(vtkImageData* labelData, double labelValue,
+                                                int relaxationIterations = 10,
+                                                double relaxationFactor = 0.5);
+};
+
+#endif // SURFACENETSMESHER_H